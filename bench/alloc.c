@@ -0,0 +1,41 @@
+/// @file
+/// @author Raphaël
+/// @brief Microbenchmarks - Allocation counting
+///
+/// Replaces the allocator of the process with one that counts the calls made by each thread, then forwards to glibc's.
+/// Shared libraries such as json-c allocate through it too, so their allocations are counted.
+///
+/// @date 18/10/2026
+
+#include "bench.h"
+#include <stddef.h>
+
+void *__libc_malloc(size_t size);
+void *__libc_calloc(size_t n, size_t size);
+void *__libc_realloc(void *ptr, size_t size);
+void __libc_free(void *ptr);
+
+static _Thread_local size_t tl_n_allocs;
+
+size_t bench_n_allocs(void) {
+    return tl_n_allocs;
+}
+
+void *malloc(size_t size) {
+    ++tl_n_allocs;
+    return __libc_malloc(size);
+}
+
+void *calloc(size_t n, size_t size) {
+    ++tl_n_allocs;
+    return __libc_calloc(n, size);
+}
+
+void *realloc(void *ptr, size_t size) {
+    ++tl_n_allocs;
+    return __libc_realloc(ptr, size);
+}
+
+void free(void *ptr) {
+    __libc_free(ptr);
+}
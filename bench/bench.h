@@ -0,0 +1,67 @@
+/// @file
+/// @author Raphaël
+/// @brief Microbenchmarks - Interface
+/// @date 18/10/2026
+
+#ifndef BENCH_H
+#define BENCH_H
+
+#include <stdbool.h>
+#include <stddef.h>
+
+/// @brief X-macro that expands to the list of microbenchmarks.
+#define X_BENCHES(X)         \
+    X(parse_send_json_c)     \
+    X(parse_send_fast)       \
+    X(parse_inbox_json_c)    \
+    X(parse_inbox_fast)      \
+    X(write_inbox20_json_c)  \
+    X(write_inbox20_stream)  \
+    X(write_inbox200_json_c) \
+    X(write_inbox200_stream) \
+    X(memlst_add_collect)    \
+    X(turnstile_1m_ips)      \
+    X(uuid_parse_scalar)     \
+    X(uuid_parse_sse2)       \
+    X(uuid_parse_avx2)       \
+    X(uuid_repr_scalar)      \
+    X(uuid_repr_sse2)        \
+    X(uuid_repr_avx2)        \
+    X(uuid_parse_batch)      \
+    X(uuid_repr_batch)       \
+    X(escape_json_c)         \
+    X(escape_scalar)         \
+    X(escape_simd)           \
+    X(log_sync)              \
+    X(log_async)             \
+    X(log_evlog)
+
+/// @brief The state of a running microbenchmark.
+typedef struct {
+    /// @brief Number of operations to perform.
+    size_t n;
+    /// @brief Set by microbenchmarks to the number of bytes processed per operation, to report a throughput.
+    size_t bytes;
+    /// @brief Set by microbenchmarks that can't run on this machine.
+    bool skip;
+} bench_t;
+
+/// @brief Expands to the signature of a microbenchmark function.
+/// @param name The unquoted name of the microbenchmark.
+#define BENCH_SIGNATURE(name) void bench_##name(bench_t *b)
+
+#define DECLARE_BENCH(name) BENCH_SIGNATURE(name);
+X_BENCHES(DECLARE_BENCH)
+#undef DECLARE_BENCH
+
+/// @brief Get the number of allocations made by the calling thread so far.
+/// @return The number of calls to @c malloc, @c calloc and @c realloc.
+size_t bench_n_allocs(void);
+
+/// @brief Prevent the compiler from optimizing away the computation of a value.
+/// @param p Pointer to the value.
+static inline void bench_keep(void const *p) {
+    __asm__ volatile("" : : "g"(p) : "memory");
+}
+
+#endif // BENCH_H
@@ -0,0 +1,60 @@
+/// @file
+/// @author Raphaël
+/// @brief Microbenchmarks - JSON string escaping
+///
+/// Escapes message contents that look like what members and professionals send each other: French text with accents, emoji, a few quotes, slashes and line breaks.
+/// Most of the bytes need no escaping, and a third of the characters are multi-byte.
+///
+/// @date 18/10/2026
+
+#include "bench.h"
+#include "tchatator413/json_writer.h"
+#include "util.h"
+
+static char const *const gs_contents[] = {
+    "Bonjour ! Est-ce que la terrasse est ouverte ce week-end ? On serait 6, dont 2 enfants 😊",
+    "Merci beaucoup pour votre accueil, la crêpe au caramel beurre salé était délicieuse 🥞❤️\nÀ bientôt !",
+    "Bonsoir, votre annonce indique \"ouvert 7j/7\" mais vous étiez fermés mardi. Pouvez-vous mettre à jour les horaires ?",
+    "Réservation confirmée pour le 14/07 à 19h30, table près de la fenêtre. N'hésitez pas si besoin 🙏",
+    "Ça marche 👍",
+    "Bien reçu, nous avons remboursé l'acompte de 25 €. Désolés pour la gêne occasionnée, l'équipe du Café des Halles ☕",
+};
+
+static size_t total_length(void) {
+    size_t len = 0;
+    for (size_t i = 0; i < array_len(gs_contents); ++i) len += strlen(gs_contents[i]);
+    return len;
+}
+
+BENCH_SIGNATURE(escape_json_c) {
+    b->bytes = total_length();
+    for (size_t i = 0; i < b->n; ++i) {
+        for (size_t j = 0; j < array_len(gs_contents); ++j) {
+            json_object *jo = json_object_new_string(gs_contents[j]);
+            bench_keep(json_object_to_json_string_ext(jo, JSON_C_TO_STRING_PLAIN));
+            json_object_put(jo);
+        }
+    }
+}
+
+static void escape(bench_t *b, void (*escaped)(json_writer_t *, char const *, size_t)) {
+    b->bytes = total_length();
+    size_t lens[array_len(gs_contents)];
+    for (size_t j = 0; j < array_len(gs_contents); ++j) lens[j] = strlen(gs_contents[j]);
+
+    json_writer_t writer = JSON_WRITER_INIT;
+    for (size_t i = 0; i < b->n; ++i) {
+        json_writer_reset(&writer);
+        for (size_t j = 0; j < array_len(gs_contents); ++j) escaped(&writer, gs_contents[j], lens[j]);
+        bench_keep(writer.buf);
+    }
+    json_writer_destroy(&writer);
+}
+
+BENCH_SIGNATURE(escape_scalar) {
+    escape(b, json_writer_escaped_scalar);
+}
+
+BENCH_SIGNATURE(escape_simd) {
+    escape(b, json_writer_escaped);
+}
@@ -0,0 +1,67 @@
+/// @file
+/// @author Raphaël
+/// @brief Microbenchmarks - Logging
+///
+/// Logs the lines the server logs for each connection at @c -v, to @c /dev/null so only the cost on the logging thread is measured.
+/// The synchronous logger formats the timestamp for each entry and writes to an unbuffered stream, like the log file.
+/// The event log records the same two events in binary.
+///
+/// @date 18/10/2026
+
+#include "bench.h"
+#include "tchatator413/evlog.h"
+#include "tchatator413/logger.h"
+#include <fcntl.h>
+#include <stdio.h>
+#include <time.h>
+#include <unistd.h>
+
+ATTR_FORMAT(printf, 2, 3)
+static void log_sync(FILE *stream, char const *fmt, ...) {
+    time_t t = time(NULL);
+    char timestr[32];
+    strftime(timestr, sizeof timestr, "%F %H:%M:%S", localtime(&t));
+    fprintf(stream, "%s:%s:%d: %s", timestr, __FILE__, __LINE__, "info: ");
+    va_list ap;
+    va_start(ap, fmt);
+    vfprintf(stream, fmt, ap);
+    va_end(ap);
+}
+
+ATTR_FORMAT(printf, 2, 3)
+static void log_async(logger_t *logger, char const *fmt, ...) {
+    va_list ap;
+    va_start(ap, fmt);
+    logger_vlog(logger, __FILE__, __LINE__, "info: ", fmt, ap);
+    va_end(ap);
+}
+
+BENCH_SIGNATURE(log_sync) {
+    FILE *stream = fopen("/dev/null", "a");
+    setvbuf(stream, NULL, _IONBF, 0);
+    for (size_t i = 0; i < b->n; ++i) {
+        log_sync(stream, "accepted new connection from %s:%d with fd %d\n", "127.0.0.1", 51234, 5);
+        log_sync(stream, "wrote %zd bytes, %zu remaining\n", (ssize_t)1234, (size_t)0);
+    }
+    fclose(stream);
+}
+
+BENCH_SIGNATURE(log_async) {
+    int const fd = open("/dev/null", O_WRONLY);
+    logger_t *logger = logger_start(fd, 1 << 20, log_overflow_block, NULL);
+    for (size_t i = 0; i < b->n; ++i) {
+        log_async(logger, "accepted new connection from %s:%d with fd %d\n", "127.0.0.1", 51234, 5);
+        log_async(logger, "wrote %zd bytes, %zu remaining\n", (ssize_t)1234, (size_t)0);
+    }
+    logger_stop(logger);
+    close(fd);
+}
+
+BENCH_SIGNATURE(log_evlog) {
+    evlog_t *evlog = evlog_open("/dev/null", 1 << 20, log_overflow_block);
+    for (size_t i = 0; i < b->n; ++i) {
+        evlog_conn_accepted(evlog, &(evlog_conn_accepted_t) { .addr = 0x0100007f, .port = 51234, .fd = 5 });
+        evlog_response_written(evlog, &(evlog_response_written_t) { .fd = 5, .len = 1234 });
+    }
+    evlog_close(evlog);
+}
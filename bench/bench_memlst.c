@@ -0,0 +1,28 @@
+/// @file
+/// @author Raphaël
+/// @brief Microbenchmarks - Memory lists
+///
+/// One operation is the life of the memory list of a request: a few resources added, a few arena allocations, then a collection.
+///
+/// @date 18/10/2026
+
+#include "bench.h"
+#include "memlst.h"
+
+#define N_RESOURCES 16
+#define N_ALLOCS 16
+
+static void dtor_noop(void *ptr) {
+    bench_keep(ptr);
+}
+
+BENCH_SIGNATURE(memlst_add_collect) {
+    static char resources[N_RESOURCES];
+    memlst_t *mem = memlst_init();
+    for (size_t i = 0; i < b->n; ++i) {
+        for (size_t r = 0; r < N_RESOURCES; ++r) memlst_add(&mem, dtor_noop, &resources[r]);
+        for (size_t a = 0; a < N_ALLOCS; ++a) bench_keep(memlst_alloc(&mem, 64));
+        memlst_collect(&mem);
+    }
+    memlst_destroy(&mem);
+}
@@ -0,0 +1,63 @@
+/// @file
+/// @author Raphaël
+/// @brief Microbenchmarks - Request parsing
+///
+/// Compares the json-c path (DOM, then @ref action_parse) with the specialized parser on representative requests.
+/// The specialized parser decodes in place, so each operation starts by copying the request into a scratch buffer, like the server reads it into its receive buffer.
+///
+/// @date 18/10/2026
+
+#include "bench.h"
+#include "tchatator413/action.h"
+#include <stdio.h>
+#include <string.h>
+
+#define API_KEY "bb1b5a1f-a482-4858-8c6b-f4746481cffa"
+
+static char const gs_send[] = R"({"do":"send","with":{"constr":")" API_KEY R"(¤mot de passe","content":"Bonjour, la réservation de samedi soir pour 4 personnes est-elle toujours d'actualité ? Merci à vous !","dest":3}})";
+static char const gs_inbox[] = R"({"do":"inbox","with":{"constr":")" API_KEY R"(","page":2}})";
+
+static void parse_json_c(bench_t *b, char const *request) {
+    cfg_t *cfg = cfg_defaults();
+    memlst_t *mem = memlst_init();
+    for (size_t i = 0; i < b->n; ++i) {
+        json_object *jo = json_tokener_parse(request);
+        action_t action = action_parse(&mem, cfg, NULL, jo);
+        bench_keep(&action);
+        json_object_put(jo);
+        memlst_collect(&mem);
+    }
+    memlst_destroy(&mem);
+    cfg_destroy(cfg);
+}
+
+static void parse_fast(bench_t *b, char const *request, size_t len) {
+    cfg_t *cfg = cfg_defaults();
+    memlst_t *mem = memlst_init();
+    char buf[BUFSIZ];
+    for (size_t i = 0; i < b->n; ++i) {
+        memcpy(buf, request, len + 1);
+        action_scan_t *scan = action_scan(&mem, buf, len);
+        action_t action = action_parse_scanned(&mem, cfg, NULL, scan, 0);
+        bench_keep(&action);
+        memlst_collect(&mem);
+    }
+    memlst_destroy(&mem);
+    cfg_destroy(cfg);
+}
+
+BENCH_SIGNATURE(parse_send_json_c) {
+    parse_json_c(b, gs_send);
+}
+
+BENCH_SIGNATURE(parse_send_fast) {
+    parse_fast(b, gs_send, sizeof gs_send - 1);
+}
+
+BENCH_SIGNATURE(parse_inbox_json_c) {
+    parse_json_c(b, gs_inbox);
+}
+
+BENCH_SIGNATURE(parse_inbox_fast) {
+    parse_fast(b, gs_inbox, sizeof gs_inbox - 1);
+}
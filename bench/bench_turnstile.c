@@ -0,0 +1,32 @@
+/// @file
+/// @author Raphaël
+/// @brief Microbenchmarks - Turnstile
+///
+/// Checks random source IPs against a turnstile that has already seen a million of them, as a server facing many clients would.
+///
+/// @date 18/10/2026
+
+#include "bench.h"
+#include "tchatator413/turnstile.h"
+
+#define N_IPS 1000000
+
+BENCH_SIGNATURE(turnstile_1m_ips) {
+    // Filled once: the main program calls microbenchmarks repeatedly.
+    static cfg_t *cfg;
+    static turnstile_t turnstile;
+    if (!cfg) {
+        cfg = cfg_defaults();
+        for (in_addr_t ip = 0; ip < N_IPS; ++ip) turnstile_rate_limit(cfg, &turnstile, ip * 2654435761u);
+    }
+
+    uint32_t x = 88172645;
+    for (size_t i = 0; i < b->n; ++i) {
+        // xorshift32
+        x ^= x << 13;
+        x ^= x >> 17;
+        x ^= x << 5;
+        time_t const next_request_at = turnstile_rate_limit(cfg, &turnstile, (x % N_IPS) * 2654435761u);
+        bench_keep(&next_request_at);
+    }
+}
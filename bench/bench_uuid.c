@@ -0,0 +1,102 @@
+/// @file
+/// @author Raphaël
+/// @brief Microbenchmarks - UUID parsing and formatting
+///
+/// Runs each implementation on the same API keys. Implementations the CPU doesn't support are skipped.
+/// Batches are timed per UUID, with the fastest implementation.
+///
+/// @date 18/10/2026
+
+#include "bench.h"
+#include "tchatator413/uuid.h"
+#include <string.h>
+
+#define N_UUIDS 64
+
+static void fill(char reprs[N_UUIDS][UUID4_REPR_LENGTH], uuid4_t uuids[N_UUIDS]) {
+    uint64_t state = 0x9e3779b97f4a7c15;
+    for (int i = 0; i < N_UUIDS; ++i) {
+        for (size_t j = 0; j < sizeof uuids[i].data; ++j) {
+            state = state * 6364136223846793005 + 1442695040888963407;
+            uuids[i].data[j] = (uint8_t)(state >> 56);
+        }
+        uuid4_repr(uuids[i], reprs[i]);
+    }
+}
+
+static void parse(bench_t *b, uuid4_impl_t impl) {
+    char reprs[N_UUIDS][UUID4_REPR_LENGTH];
+    uuid4_t uuids[N_UUIDS];
+    fill(reprs, uuids);
+
+    uuid4_impl_t const initial = uuid4_impl_current();
+    if (!(b->skip = !uuid4_impl_select(impl))) {
+        for (size_t i = 0; i < b->n; ++i) {
+            uuid4_t uuid;
+            bool ok = uuid4_parse(&uuid, reprs[i % N_UUIDS]);
+            bench_keep(&ok);
+            bench_keep(&uuid);
+        }
+    }
+    uuid4_impl_select(initial);
+}
+
+static void repr(bench_t *b, uuid4_impl_t impl) {
+    char reprs[N_UUIDS][UUID4_REPR_LENGTH];
+    uuid4_t uuids[N_UUIDS];
+    fill(reprs, uuids);
+
+    uuid4_impl_t const initial = uuid4_impl_current();
+    if (!(b->skip = !uuid4_impl_select(impl))) {
+        for (size_t i = 0; i < b->n; ++i) {
+            char out[UUID4_REPR_LENGTH];
+            bench_keep(uuid4_repr(uuids[i % N_UUIDS], out));
+        }
+    }
+    uuid4_impl_select(initial);
+}
+
+BENCH_SIGNATURE(uuid_parse_scalar) {
+    parse(b, uuid4_impl_scalar);
+}
+
+BENCH_SIGNATURE(uuid_parse_sse2) {
+    parse(b, uuid4_impl_sse2);
+}
+
+BENCH_SIGNATURE(uuid_parse_avx2) {
+    parse(b, uuid4_impl_avx2);
+}
+
+BENCH_SIGNATURE(uuid_repr_scalar) {
+    repr(b, uuid4_impl_scalar);
+}
+
+BENCH_SIGNATURE(uuid_repr_sse2) {
+    repr(b, uuid4_impl_sse2);
+}
+
+BENCH_SIGNATURE(uuid_repr_avx2) {
+    repr(b, uuid4_impl_avx2);
+}
+
+BENCH_SIGNATURE(uuid_parse_batch) {
+    char reprs[N_UUIDS][UUID4_REPR_LENGTH];
+    uuid4_t uuids[N_UUIDS];
+    fill(reprs, uuids);
+    for (size_t i = 0; i < b->n; i += N_UUIDS) {
+        size_t n = uuid4_parse_batch(b->n - i < N_UUIDS ? b->n - i : N_UUIDS, uuids, (char const(*)[UUID4_REPR_LENGTH])reprs);
+        bench_keep(&n);
+        bench_keep(uuids);
+    }
+}
+
+BENCH_SIGNATURE(uuid_repr_batch) {
+    char reprs[N_UUIDS][UUID4_REPR_LENGTH];
+    uuid4_t uuids[N_UUIDS];
+    fill(reprs, uuids);
+    for (size_t i = 0; i < b->n; i += N_UUIDS) {
+        uuid4_repr_batch(b->n - i < N_UUIDS ? b->n - i : N_UUIDS, uuids, reprs);
+        bench_keep(reprs);
+    }
+}
@@ -0,0 +1,73 @@
+/// @file
+/// @author Raphaël
+/// @brief Microbenchmarks - Response writing
+///
+/// Compares building a json-c object tree then serializing it with streaming the response through a @ref json_writer_t, on a full inbox page of 20 messages and on one of 200.
+/// The JSON fragment cache is left disabled, so every message is encoded each time.
+///
+/// @date 18/10/2026
+
+#include "bench.h"
+#include "tchatator413/action.h"
+
+static response_t inbox_response(msg_t *msgs, size_t n_msgs) {
+    for (size_t i = 0; i < n_msgs; ++i) {
+        msgs[i] = (msg_t) {
+            .id = 1000 + (serial_t)i,
+            .sent_at = 1760000000 + (time_t)i * 60,
+            .content = "Bonjour, la réservation de samedi soir pour 4 personnes est-elle toujours d'actualité ? Merci à vous !",
+            .user_id_sender = 1003,
+            .user_id_recipient = 1001,
+            .read_age = i % 2 ? 30 : 0,
+        };
+    }
+    return (response_t) {
+        .type = action_type_inbox,
+        .has_next_page = true,
+        .body.inbox = { .msgs = msgs, .n_msgs = n_msgs },
+    };
+}
+
+static void write_json_c(bench_t *b, size_t n_msgs) {
+    msg_t *msgs = malloc(n_msgs * sizeof *msgs);
+    if (!msgs) errno_exit("malloc");
+    response_t response = inbox_response(msgs, n_msgs);
+    for (size_t i = 0; i < b->n; ++i) {
+        json_object *jo = response_to_json(&response);
+        size_t len;
+        char const *s = json_object_to_json_string_length(jo, JSON_C_TO_STRING_PLAIN, &len);
+        bench_keep(s);
+        json_object_put(jo);
+    }
+    free(msgs);
+}
+
+static void write_stream(bench_t *b, size_t n_msgs) {
+    msg_t *msgs = malloc(n_msgs * sizeof *msgs);
+    if (!msgs) errno_exit("malloc");
+    response_t response = inbox_response(msgs, n_msgs);
+    json_writer_t writer = JSON_WRITER_INIT;
+    for (size_t i = 0; i < b->n; ++i) {
+        json_writer_reset(&writer);
+        response_write(&writer, &response);
+        bench_keep(json_writer_str(&writer));
+    }
+    json_writer_destroy(&writer);
+    free(msgs);
+}
+
+BENCH_SIGNATURE(write_inbox20_json_c) {
+    write_json_c(b, 20);
+}
+
+BENCH_SIGNATURE(write_inbox20_stream) {
+    write_stream(b, 20);
+}
+
+BENCH_SIGNATURE(write_inbox200_json_c) {
+    write_json_c(b, 200);
+}
+
+BENCH_SIGNATURE(write_inbox200_stream) {
+    write_stream(b, 200);
+}
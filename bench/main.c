@@ -0,0 +1,66 @@
+/// @file
+/// @author Raphaël
+/// @brief Microbenchmarks - Main program
+///
+/// Usage: @c microbench [NAME...] runs the microbenchmarks whose name contains one of the arguments, or all of them.
+///
+/// Each microbenchmark is run with an increasing number of operations until it lasts long enough to be measured.
+/// Allocations are counted on the calling thread only: work handed to other threads is not.
+///
+/// @date 18/10/2026
+
+#include "bench.h"
+#include <stdbool.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+
+/// @brief Minimum duration of a measured run, in nanoseconds.
+#define MIN_DURATION_NS 500000000
+
+static inline double now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1e9 + ts.tv_nsec;
+}
+
+static void run(char const *name, void (*fn)(bench_t *)) {
+    bench_t b = { .n = 1 };
+    double elapsed;
+    size_t n_allocs;
+    while (true) {
+        size_t const allocs_before = bench_n_allocs();
+        double const start = now_ns();
+        fn(&b);
+        elapsed = now_ns() - start;
+        n_allocs = bench_n_allocs() - allocs_before;
+        if (b.skip) {
+            printf("%-24s skipped\n", name);
+            return;
+        }
+        if (elapsed >= MIN_DURATION_NS) break;
+        // Aim past the minimum duration, without growing too fast on noisy short runs.
+        size_t next = elapsed > 0 ? (size_t)(b.n * MIN_DURATION_NS * 1.2 / elapsed) : b.n * 100;
+        if (next > b.n * 100) next = b.n * 100;
+        b.n = next > b.n ? next : b.n + 1;
+    }
+    printf("%-24s %12zu %12.1f ns/op %10.2f allocs/op", name, b.n, elapsed / (double)b.n, (double)n_allocs / (double)b.n);
+    if (b.bytes) printf(" %10.1f MB/s", (double)b.bytes * (double)b.n / elapsed * 1e3);
+    putchar('\n');
+}
+
+static bool selected(char const *name, int argc, char **argv) {
+    if (argc <= 1) return true;
+    for (int i = 1; i < argc; ++i) {
+        if (strstr(name, argv[i])) return true;
+    }
+    return false;
+}
+
+int main(int argc, char **argv) {
+#define RUN_BENCH(name) \
+    if (selected(#name, argc, argv)) run(#name, bench_##name);
+    X_BENCHES(RUN_BENCH)
+#undef RUN_BENCH
+    return 0;
+}
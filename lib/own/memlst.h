@@ -7,6 +7,8 @@
 #define MEMLST_H
 
 #include <stdbool.h>
+#include <stddef.h>
+#include <string.h>
 
 // enable this for debuggin
 //#define MEMLST_TRACE
@@ -22,6 +24,8 @@
 typedef struct memlst memlst_t;
 
 /// @brief Create a new, empty memory list.
+///
+/// A memory list owns resources with their destructors, and an arena for plain allocations, which are freed all at once.
 /// @return A new memory list.
 memlst_t *memlst_init(void);
 
@@ -45,12 +49,54 @@ void *memlst_add(memlst_t *restrict *restrict p_memlst, dtor_fn dtor, void *rest
 
 /// @brief Empty a memory list's allocations and runs destructors.
 /// @param p_memlst Pointer to a memory list.
+/// @remark Arena memory is kept for the next allocations: a memory list reused across requests stops calling @c malloc once it has grown to fit them.
 void memlst_collect(memlst_t **p_memlst FILE_LINE_PARAMS);
 
+/// @brief Allocate memory from a memory list's arena.
+/// @param p_memlst Pointer to a memory list.
+/// @param size The size of the allocation.
+/// @return Memory suitably aligned for any type, valid until the memory list is collected. Never @c NULL.
+/// @remark Arena memory is released all at once: it must not be freed, nor added to a memory list.
+void *memlst_alloc(memlst_t **p_memlst, size_t size);
+
+/// @brief Copy a string to a memory list's arena.
+/// @param p_memlst Pointer to a memory list.
+/// @param s The string.
+/// @param len The length of @p s.
+/// @return A null-terminated copy of @p s, valid until the memory list is collected.
+char *memlst_strndup(memlst_t **p_memlst, char const *s, size_t len);
+
+/// @brief Copy a null-terminated string to a memory list's arena.
+/// @param p_memlst Pointer to a memory list.
+/// @param s The string.
+/// @return A copy of @p s, valid until the memory list is collected.
+static inline char *memlst_strdup(memlst_t **p_memlst, char const *s) {
+    return memlst_strndup(p_memlst, s, strlen(s));
+}
+
+/// @brief A point in the life of a memory list, to rewind it to.
+typedef struct {
+    size_t n_entries;
+    void *block;
+    size_t used;
+} memlst_mark_t;
+
+/// @brief Mark the current state of a memory list.
+/// @param memlst A memory list.
+/// @return A mark, to pass to @ref memlst_rewind.
+memlst_mark_t memlst_mark(memlst_t const *memlst);
+
+/// @brief Free what has been added to a memory list since a mark.
+/// @param p_memlst Pointer to a memory list.
+/// @param mark A mark of this memory list, taken since it was last collected.
+/// @remark Destructors run for the resources added after @p mark. Arena memory allocated after @p mark is reused.
+void memlst_rewind(memlst_t **p_memlst, memlst_mark_t mark FILE_LINE_PARAMS);
+
 #if !defined MEMLST_IMPL && defined MEMLST_TRACE
 #define memlst_destroy(memlst) memlst_destroy(memlst, __FILE__, __LINE__)
 #define memlst_add(memlst, dtor, ptr) memlst_add(memlst, dtor, ptr, __FILE__, __LINE__)
 #define memlst_collect(memlst) memlst_collect(memlst, __FILE__, __LINE__)
+#define memlst_rewind(memlst, mark) memlst_rewind(memlst, mark, __FILE__, __LINE__)
 #endif
 
 #endif // MEMLST_H
@@ -13,11 +13,13 @@
 #include "const.h"
 #include "db.h"
 #include "json-c.h"
+#include "json_writer.h"
 #include "types.h"
 
 /// @brief Status codes for the Tchatator413 protocol, modeled after HTTP status codes.
 /// @remark The resemblance with HTTP status codes is only for familiarity.
 typedef enum {
+    status_ok = 200,                    ///< @brief OK. Successful responses carry no status, this is for accounting.
     status_bad_request = 400,           ///< @brief Bad request.
     status_unauthorized = 401,          ///< @brief Unauthorized.
     status_forbidden = 403,             ///< @brief Forbidden.
@@ -28,6 +30,21 @@ typedef enum {
     status_internal_server_error = 500  ///< @brief Internal server error.
 } status_t;
 
+/// @brief X-macro that expands to the list of status codes, as X(name, code).
+#define X_STATUSES(X)             \
+    X(ok, 200)                    \
+    X(bad_request, 400)           \
+    X(unauthorized, 401)          \
+    X(forbidden, 403)             \
+    X(not_found, 404)             \
+    X(payload_too_large, 413)     \
+    X(unprocessable_content, 422) \
+    X(too_many_requests, 429)     \
+    X(internal_server_error, 500)
+
+/// @brief A snapshot of the metrics registry. See metrics.h.
+typedef struct metrics_snapshot metrics_snapshot_t;
+
 /// @brief Enumerates the type of errors that occur while parsing or running an action.
 typedef enum {
     action_error_type_type,        ///< @brief Parsing JSON type error.
@@ -129,12 +146,73 @@ typedef struct {
             constr_t constr;
             serial_t user_id;
         } block, unblock, ban, unban;
+        struct {
+            constr_t constr;
+        } stats, wait;
     } with;
 } action_t;
 
+/// @brief Enumerates the keys of action arguments.
+typedef enum {
+#define ENUM_VALUE(name) arg_key_##name,
+    X_ARG_KEYS(ENUM_VALUE)
+#undef ENUM_VALUE
+    arg_key_count,
+} arg_key_t;
+
+/// @brief Enumerates the kinds of action arguments. The kind of an argument determines its JSON type, how it is validated and the type of its field in @ref action_t.
+typedef enum {
+    arg_kind_constr, ///< @brief A connection string (@ref constr_t): an API key, optionally followed by a password. Must be a string.
+    arg_kind_user,   ///< @brief A user key (@ref serial_t): a user ID, or an e-mail, member pseudo or pro business name to look up.
+    arg_kind_string, ///< @brief A string (@ref slice_t).
+    arg_kind_int,    ///< @brief An integer (@c int32_t).
+    arg_kind_page,   ///< @brief A page number (@ref page_number_t). Must be positive, defaults to 1.
+} arg_kind_t;
+
+/// @brief Describes an argument of an action.
+typedef struct {
+    /// @brief The key of the argument.
+    arg_key_t key;
+    /// @brief The name of the key.
+    slice_t name;
+    /// @brief A human-friendly representation of the location of the argument in the JSON request structure.
+    char const *location;
+    /// @brief The kind of the argument.
+    arg_kind_t kind;
+    /// @brief Whether the argument must be provided.
+    bool required;
+    /// @brief The offset of the field of the argument in @ref action_t.
+    size_t offset;
+} arg_desc_t;
+
+/// @brief Describes an action.
+typedef struct {
+    /// @brief The type of the action.
+    action_type_t type;
+    /// @brief The name of the action.
+    slice_t name;
+    /// @brief The number of arguments.
+    size_t n_args;
+    /// @brief The arguments, in parsing order.
+    arg_desc_t const *args;
+} action_desc_t;
+
+/// @brief Look up an action by name.
+/// @param name The name of the action.
+/// @return The description of the action.
+/// @return @c NULL if there's no action named @p name.
+action_desc_t const *action_desc_lookup(slice_t name);
+
+/// @brief Get the description of an action.
+/// @param type The type of the action. Must not be @ref action_type_error.
+/// @return The description of the action.
+action_desc_t const *action_desc_of(action_type_t type);
+
 typedef struct {
     action_type_t type;
     bool has_next_page;
+    /// @brief Number of database round-trips the action took, its parsing included. Not serialized.
+    unsigned n_round_trips;
     union {
         action_error_t error;
         struct {
@@ -144,6 +222,13 @@ typedef struct {
             serial_t msg_id;
         } send;
         msg_list_t motd, inbox, outbox;
+        /// @brief Allocated from the memory list the action was evaluated with.
+        metrics_snapshot_t *stats;
+        struct {
+            bool has_unread;
+            /// @brief The caller, whose connection the server may park until it gets a message. Not serialized.
+            serial_t user_id;
+        } wait;
         /*struct {
 
         } edit;
@@ -170,6 +255,11 @@ typedef struct {
 /// @return A new response.
 response_t response_for_rate_limit(time_t next_request_at);
 
+/// @brief Get the status of a response.
+/// @param p_response The response.
+/// @return The status of the error, or @ref status_ok for a successful response.
+status_t response_status(response_t const *p_response);
+
 /// @brief Put an user role.
 /// @param role The role flags
 /// @param stream The stream to write to.
@@ -183,6 +273,33 @@ void put_role(role_t role, FILE *stream);
 /// @return The parsed action.
 action_t action_parse(memlst_t **p_mem, cfg_t *cfg, db_t *db, json_object const *jo);
 
+/// @brief A request validated by the specialized parser.
+typedef struct action_scan action_scan_t;
+
+/// @brief Scan a request with the specialized parser.
+/// @param p_mem Parent memory container of the returned scan.
+/// @param buf The request. It must outlive the actions parsed from the scan.
+/// @param len The length of @p buf.
+/// @return The scanned request, with the buffer left untouched.
+/// @return @c NULL if the request is outside of what the specialized parser handles: it must go through @ref action_parse instead.
+/// @remark Nothing is returned unless every action of the request is syntactically valid, so no actions are evaluated before falling back.
+/// @remark The scan is allocated from the arena of @p p_mem, even when @c NULL is returned.
+action_scan_t *action_scan(memlst_t **p_mem, char *buf, size_t len);
+
+/// @brief Get the number of actions in a scanned request.
+/// @param scan The scanned request.
+/// @return The number of actions.
+size_t action_scan_count(action_scan_t const *scan);
+
+/// @brief Parse an action from a scanned request.
+/// @param p_mem Parent memory container.
+/// @param cfg The configuration.
+/// @param db The database connection.
+/// @param scan The scanned request.
+/// @param i The index of the action. Each action must be parsed at most once.
+/// @return The parsed action. Its strings are decoded in place, they point into the request buffer.
+action_t action_parse_scanned(memlst_t **p_mem, cfg_t *cfg, db_t *db, action_scan_t const *scan, size_t i);
+
 /// @brief Evaluate an action.
 /// @param p_action The action to evaluate.
 /// @param p_mem Parent memory container.
@@ -196,6 +313,12 @@ response_t action_evaluate(action_t const *p_action, memlst_t **p_mem, cfg_t *cf
 /// @return A new JSON object.
 json_object *response_to_json(response_t const *p_response);
 
+/// @brief Write an action response as JSON.
+/// @param p_writer The writer to append to.
+/// @param p_response The action response.
+/// @remark Produces the same bytes as the plain serialization of @ref response_to_json.
+void response_write(json_writer_t *p_writer, response_t const *p_response);
+
 #ifndef NDEBUG
 /// @brief Explain an action.
 /// @param action The action to explain.
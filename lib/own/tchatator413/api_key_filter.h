@@ -0,0 +1,43 @@
+/// @file
+/// @author Raphaël
+/// @brief API key filter - Interface
+///
+/// A Bloom filter over the API keys of every user. It answers "definitely not a user" without a database round-trip, so unknown API keys can be rejected cheaply.
+/// Keys can be added, but not removed: the filter has to be rebuilt to forget them.
+///
+/// @date 18/10/2026
+
+#ifndef API_KEY_FILTER_H
+#define API_KEY_FILTER_H
+
+#include "tchatator413/uuid.h"
+#include <stdbool.h>
+#include <stddef.h>
+
+/// @brief An opaque handle to an API key filter.
+typedef struct api_key_filter api_key_filter_t;
+
+/// @brief Create a new, empty API key filter.
+/// @param n_keys The number of keys the filter is sized for. The false positive rate degrades past this number.
+/// @param fp_rate The target false positive rate, in ]0;1[.
+/// @return A new API key filter.
+/// @return @c NULL if @p fp_rate is out of bounds (filtering disabled).
+api_key_filter_t *api_key_filter_init(size_t n_keys, double fp_rate);
+
+/// @brief Destroy an API key filter.
+/// @param filter The filter to destroy. No-op if @c NULL.
+void api_key_filter_destroy(api_key_filter_t *filter);
+
+/// @brief Add an API key to a filter.
+/// @param filter The filter.
+/// @param api_key The API key.
+void api_key_filter_add(api_key_filter_t *filter, uuid4_t api_key);
+
+/// @brief Test whether an API key may have been added to a filter.
+/// @param filter The filter.
+/// @param api_key The API key.
+/// @return @c false if @p api_key has definitely not been added.
+/// @return @c true if @p api_key has probably been added.
+bool api_key_filter_may_contain(api_key_filter_t const *filter, uuid4_t api_key);
+
+#endif // API_KEY_FILTER_H
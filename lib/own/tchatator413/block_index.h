@@ -0,0 +1,71 @@
+/// @file
+/// @author Raphaël
+/// @brief Block index - Interface
+///
+/// An in-memory copy of the blocks and bans in effect, so senders can be refused without a database round-trip.
+///
+/// A block is scoped either to the messages sent to a single professionnal, or to every message (global, set by the administrator).
+/// A ban is a block that never expires.
+///
+/// @date 18/10/2026
+
+#ifndef BLOCK_INDEX_H
+#define BLOCK_INDEX_H
+
+#include "tchatator413/types.h"
+#include <stdbool.h>
+#include <stdint.h>
+#include <time.h>
+
+/// @brief An opaque handle to a block index.
+typedef struct block_index block_index_t;
+
+/// @brief The scope of global blocks. Any other scope is the user ID of a professionnal.
+#define BLOCK_SCOPE_GLOBAL 0
+
+/// @brief Expiry time of bans.
+#define BLOCK_FOREVER ((time_t)INT64_MAX)
+
+/// @brief Create a new, empty block index.
+/// @return A new block index.
+block_index_t *block_index_init(void);
+
+/// @brief Destroy a block index.
+/// @param index The index to destroy. No-op if @c NULL.
+void block_index_destroy(block_index_t *index);
+
+/// @brief Remove every block.
+/// @param index The index.
+void block_index_clear(block_index_t *index);
+
+/// @brief Block a member.
+/// @param index The index.
+/// @param scope @ref BLOCK_SCOPE_GLOBAL or the user ID of the professionnal blocking the member.
+/// @param member_id The user ID of the blocked member.
+/// @param expires_at When the block expires, or @ref BLOCK_FOREVER for a ban. Replaces any previous block in the same scope.
+void block_index_set(block_index_t *index, serial_t scope, serial_t member_id, time_t expires_at);
+
+/// @brief Unblock a member.
+/// @param index The index.
+/// @param scope @ref BLOCK_SCOPE_GLOBAL or the user ID of the professionnal that blocked the member.
+/// @param member_id The user ID of the blocked member.
+void block_index_unset(block_index_t *index, serial_t scope, serial_t member_id);
+
+/// @brief Get the block of a member in a scope.
+/// @param index The index.
+/// @param scope @ref BLOCK_SCOPE_GLOBAL or the user ID of a professionnal.
+/// @param member_id The user ID of a member.
+/// @param now The current time.
+/// @return When the block expires, @ref BLOCK_FOREVER for a ban.
+/// @return @c 0 if the member isn't blocked in this scope.
+time_t block_index_get(block_index_t *index, serial_t scope, serial_t member_id, time_t now);
+
+/// @brief Test whether a user may not send messages to another.
+/// @param index The index.
+/// @param sender_id The user ID of the sender.
+/// @param recipient_id The user ID of the recipient.
+/// @param now The current time.
+/// @return Whether @p sender_id is blocked globally or by @p recipient_id.
+bool block_index_is_blocked(block_index_t *index, serial_t sender_id, serial_t recipient_id, time_t now);
+
+#endif // BLOCK_INDEX_H
@@ -0,0 +1,80 @@
+/// @file
+/// @author Raphaël
+/// @brief Request capture - Interface
+///
+/// A capture file holds the raw bytes of requests with their arrival time, so real traffic can be replayed with @c --replay.
+/// Records are written through an asynchronous @ref logger_t. When a file grows past its maximum size, it is renamed with a @c .1 suffix, replacing the previous one, and a new file is started.
+///
+/// Credentials are pseudonymized before anything is written: each API key is replaced by a pseudonym, the same for all of its requests but unrelated to it, and passwords are removed.
+/// The root API key becomes the nil UUID. Pseudonyms are keyed by a secret drawn when the capture is opened, so they can't be reversed, nor matched across captures.
+///
+/// Layout, in native byte order:
+/// - Session header: @c 0xff, @c "T413CP", the format version (u8).
+/// - Request record: @c 'R', the wall clock time of arrival in nanoseconds since the epoch (i64), the length of the request (u32), then the request.
+/// - Drop record: @c 'D', the wall clock time (i64), then the number of requests dropped because the ring was full (u64).
+///
+/// @date 18/10/2026
+
+#ifndef CAPTURE_H
+#define CAPTURE_H
+
+#include "tchatator413/logger.h"
+#include "tchatator413/types.h"
+#include <stdint.h>
+#include <stdio.h>
+
+/// @brief An opaque handle to a capture file.
+typedef struct capture capture_t;
+
+/// @brief A record read from a capture file.
+typedef struct {
+    /// @brief When the request arrived, in nanoseconds since the epoch.
+    int64_t at_ns;
+    /// @brief The request, null-terminated at @ref len. Owned by the record, reused across reads.
+    char *buf;
+    /// @brief The length of the request. @c 0 for a report of dropped requests.
+    size_t len;
+    /// @brief The capacity of @ref buf.
+    size_t cap;
+    /// @brief The number of requests dropped, for a report of dropped requests.
+    uint64_t n_dropped;
+} capture_record_t;
+
+/// @brief Open a capture file, appending to it.
+/// @param filename The file name.
+/// @param max_size The size from which the file is rotated, in bytes. @c 0 to never rotate.
+/// @param ring_size The capacity of each thread's ring in bytes.
+/// @param overflow What to do with a request when a ring is full.
+/// @param root_api_key The root API key, pseudonymized as the nil UUID.
+/// @return A new capture file.
+/// @return @c NULL if the file could not be opened. @c errno is set.
+capture_t *capture_open(char const *filename, size_t max_size, size_t ring_size, log_overflow_t overflow, api_key_t root_api_key);
+
+/// @brief Close a capture file, writing every request it holds.
+/// @param capture The capture file. No-op if @c NULL.
+void capture_close(capture_t *capture);
+
+/// @brief Capture a request.
+/// @param capture The capture file. No-op if @c NULL.
+/// @param buf The request.
+/// @param len The length of the request.
+void capture_request(capture_t *capture, char const *buf, size_t len);
+
+/// @brief Pseudonymize the credentials of a request, in place.
+/// @param buf The request.
+/// @param len The length of the request.
+/// @param key The secret pseudonyms are derived from.
+/// @param root_api_key The root API key, pseudonymized as the nil UUID.
+/// @return The new length of the request, never greater than @p len.
+/// @remark A credential is a string that contains @c ¤: what precedes it is pseudonymized if it is an API key, and what follows it is removed, up to the end of the string.
+/// A string that is just an API key, as a constr without a password is, is pseudonymized too.
+size_t capture_pseudonymize(char *buf, size_t len, uint64_t key, api_key_t root_api_key);
+
+/// @brief Read the next record of a capture file.
+/// @param file The capture file, opened for reading.
+/// @param p_record The record to read into. Zero-initialize it before the first read, and free its @ref capture_record_t.buf after the last.
+/// @return @c true if a record was read.
+/// @return @c false at the end of the file, or if it is truncated or not a capture file.
+bool capture_read(FILE *file, capture_record_t *p_record);
+
+#endif // CAPTURE_H
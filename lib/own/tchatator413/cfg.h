@@ -6,6 +6,9 @@
 #ifndef CONFIG_H
 #define CONFIG_H
 
+#include "tchatator413/capture.h"
+#include "tchatator413/evlog.h"
+#include "tchatator413/trace.h"
 #include "tchatator413/types.h"
 #include "tchatator413/uuid.h"
 #include <stdbool.h>
@@ -72,6 +75,27 @@ bool i_cfg_log(char const *file, int line,
     cfg_t *cfg, log_lvl_t lvl, char const *fmt, ...);
 #define cfg_log(cfg, lvl, fmt, ...) i_cfg_log(__FILE__, __LINE__, cfg, lvl, fmt __VA_OPT__(, ) __VA_ARGS__)
 
+/// @brief Start logging asynchronously, if the configuration has a log buffer, and open the event log, the trace file and the capture file, if it has them.
+/// @param cfg The configuration.
+/// @remark Entries are then formatted into a per-thread ring and written in batches by a background thread, which @ref cfg_destroy stops after writing what is left.
+/// @remark Errors are written before @ref cfg_log returns.
+void cfg_log_start(cfg_t *cfg);
+
+/// @brief Get the event log.
+/// @param cfg The configuration.
+/// @return The event log, or @c NULL if there is none. Recording events to @c NULL is a no-op.
+evlog_t *cfg_evlog(cfg_t const *cfg);
+
+/// @brief Get the trace file.
+/// @param cfg The configuration.
+/// @return The trace file, or @c NULL if tracing is disabled. Requests traced to @c NULL are not traced.
+tracer_t *cfg_tracer(cfg_t const *cfg);
+
+/// @brief Get the capture file.
+/// @param cfg The configuration.
+/// @return The capture file, or @c NULL if capture is disabled. Requests captured to @c NULL are not captured.
+capture_t *cfg_capture(cfg_t const *cfg);
+
 /// @brief Log a single character.
 /// @param cfg The configuration.
 /// @param c A character.
@@ -89,6 +113,18 @@ int cfg_page_inbox(cfg_t const *cfg);
 /// @param cfg Configuration
 /// @return the configuration page_outbox.
 int cfg_page_outbox(cfg_t const *cfg);
+/// @brief Get the configuration page_motd.
+/// @param cfg Configuration
+/// @return the configuration page_motd.
+int cfg_page_motd(cfg_t const *cfg);
+/// @brief Get the configuration wait_timeout.
+/// @param cfg Configuration
+/// @return the configuration wait_timeout, in seconds. @c 0 if @c wait never parks connections.
+int cfg_wait_timeout(cfg_t const *cfg);
+/// @brief Get the configuration max_waiters.
+/// @param cfg Configuration
+/// @return the configuration max_waiters.
+int cfg_max_waiters(cfg_t const *cfg);
 /// @brief Get the configuration rate_limit_m.
 /// @param cfg Configuration
 /// @return the configuration rate_limit_m.
@@ -109,6 +145,58 @@ int cfg_backlog(cfg_t const *cfg);
 /// @param cfg Configuration
 /// @return the configuration port.
 uint16_t cfg_port(cfg_t const *cfg);
+/// @brief Get the configuration metrics_port.
+/// @param cfg Configuration
+/// @return the port of the metrics listener, or @c 0 if it is disabled or on a Unix socket.
+uint16_t cfg_metrics_port(cfg_t const *cfg);
+/// @brief Get the configuration metrics_socket_path.
+/// @param cfg Configuration
+/// @return the path of the Unix socket of the metrics listener, or @c NULL if it is disabled or on a TCP port.
+char const *cfg_metrics_socket_path(cfg_t const *cfg);
+/// @brief Get the configuration user_cache_size.
+/// @param cfg Configuration
+/// @return the configuration user_cache_size.
+int cfg_user_cache_size(cfg_t const *cfg);
+/// @brief Get the configuration user_cache_ttl.
+/// @param cfg Configuration
+/// @return the configuration user_cache_ttl.
+int cfg_user_cache_ttl(cfg_t const *cfg);
+/// @brief Get the configuration user_cache_negative_ttl.
+/// @param cfg Configuration
+/// @return the configuration user_cache_negative_ttl.
+int cfg_user_cache_negative_ttl(cfg_t const *cfg);
+/// @brief Get the configuration inbox_cache_recipients.
+/// @param cfg Configuration
+/// @return the configuration inbox_cache_recipients.
+int cfg_inbox_cache_recipients(cfg_t const *cfg);
+/// @brief Get the configuration api_key_filter_fp_rate.
+/// @param cfg Configuration
+/// @return the configuration api_key_filter_fp_rate.
+double cfg_api_key_filter_fp_rate(cfg_t const *cfg);
+/// @brief Get the configuration api_key_filter_rebuild_interval.
+/// @param cfg Configuration
+/// @return the configuration api_key_filter_rebuild_interval.
+int cfg_api_key_filter_rebuild_interval(cfg_t const *cfg);
+/// @brief Get the configuration json_cache_size.
+/// @param cfg Configuration
+/// @return the configuration json_cache_size.
+int cfg_json_cache_size(cfg_t const *cfg);
+/// @brief Get the configuration slow_query_ms.
+/// @param cfg Configuration
+/// @return the duration in milliseconds from which queries are logged, or @c -1 if the slow query log is disabled.
+int cfg_slow_query_ms(cfg_t const *cfg);
+/// @brief Get the configuration profile_file.
+/// @param cfg Configuration
+/// @return the file profiles are written to, or @c NULL if the profiler is disabled.
+char const *cfg_profile_file_name(cfg_t const *cfg);
+/// @brief Get the configuration profile_hz.
+/// @param cfg Configuration
+/// @return the configuration profile_hz.
+int cfg_profile_hz(cfg_t const *cfg);
+/// @brief Get the configuration profile_seconds.
+/// @param cfg Configuration
+/// @return the configuration profile_seconds.
+int cfg_profile_seconds(cfg_t const *cfg);
 /// @brief Get the verbosity.
 /// @param cfg Configuration
 /// @return the verbosity.
@@ -26,7 +26,65 @@ enum {
     X(block)         \
     X(unblock)       \
     X(ban)           \
-    X(unban)
+    X(unban)         \
+    X(stats)         \
+    X(wait)
+
+/// @brief X-macro that expands to the keys of action arguments.
+#define X_ARG_KEYS(X) \
+    X(constr)         \
+    X(user)           \
+    X(dest)           \
+    X(content)        \
+    X(new_content)    \
+    X(msg_id)         \
+    X(page)
+
+// X-macros that expand to the arguments of each action, in parsing order.
+// ARG(ctx, key, kind, field, required)
+//  - ctx is passed through
+//  - key is the argument key, from X_ARG_KEYS
+//  - kind is the argument kind (constr, user, string, int or page)
+//  - field is the name of the member of the action payload
+
+#define X_ARGS_whois(ARG, ctx)             \
+    ARG(ctx, constr, constr, constr, true) \
+    ARG(ctx, user, user, user_id, true)
+#define X_ARGS_send(ARG, ctx)                \
+    ARG(ctx, constr, constr, constr, true)   \
+    ARG(ctx, content, string, content, true) \
+    ARG(ctx, dest, user, dest_user_id, true)
+#define X_ARGS_motd(ARG, ctx) \
+    ARG(ctx, constr, constr, constr, true)
+#define X_ARGS_inbox(ARG, ctx)             \
+    ARG(ctx, constr, constr, constr, true) \
+    ARG(ctx, page, page, page, false)
+#define X_ARGS_outbox(ARG, ctx)            \
+    ARG(ctx, constr, constr, constr, true) \
+    ARG(ctx, page, page, page, false)
+#define X_ARGS_edit(ARG, ctx)              \
+    ARG(ctx, constr, constr, constr, true) \
+    ARG(ctx, msg_id, int, msg_id, true)    \
+    ARG(ctx, new_content, string, new_content, true)
+#define X_ARGS_rm(ARG, ctx)                \
+    ARG(ctx, constr, constr, constr, true) \
+    ARG(ctx, msg_id, int, msg_id, true)
+#define X_ARGS_block(ARG, ctx)             \
+    ARG(ctx, constr, constr, constr, true) \
+    ARG(ctx, user, user, user_id, true)
+#define X_ARGS_unblock(ARG, ctx)           \
+    ARG(ctx, constr, constr, constr, true) \
+    ARG(ctx, user, user, user_id, true)
+#define X_ARGS_ban(ARG, ctx)               \
+    ARG(ctx, constr, constr, constr, true) \
+    ARG(ctx, user, user, user_id, true)
+#define X_ARGS_unban(ARG, ctx)             \
+    ARG(ctx, constr, constr, constr, true) \
+    ARG(ctx, user, user, user_id, true)
+#define X_ARGS_stats(ARG, ctx) \
+    ARG(ctx, constr, constr, constr, true)
+#define X_ARGS_wait(ARG, ctx) \
+    ARG(ctx, constr, constr, constr, true)
 
 /// @brief The name of the program.
 #define PROG "tchatator-server"
@@ -37,6 +95,7 @@ enum {
 SYNOPSIS\n\
     " PROG " -[qv]... [-c FILE]\n\
     " PROG " -[qv]... [-c FILE] -i [REQUEST]\n\
+    " PROG " -[qv]... [-c FILE] --replay=CAPTURE [--max-speed]\n\
     " PROG " --dump-config\n\
     " PROG " --help\n\
     " PROG " --version\n\
@@ -50,6 +109,8 @@ DESCRIPTION\n\
     -v, --verbose      More verbose (can be repeated)\n\
     -i, --interactive  Run in interactive mode (read from STDIN or argument)\n\
     -c, --config=FILE  Configuration file\n\
+    --replay=CAPTURE   Replay a capture file (see capture_file) against the test database, then report throughput and latency\n\
+    --max-speed        Replay requests back-to-back rather than at their captured pace\n\
     --dump-config      Dump current configuration\n\
     --help             Show this help\n\
     --version          Show version\n\
@@ -8,11 +8,12 @@
 
 #include "errstatus.h"
 #include "memlst.h"
+#include "tchatator413/block_index.h"
 #include "tchatator413/cfg.h"
 #include "types.h"
 
 /// @brief An opaque handle to a database connection.
-typedef union db db_t;
+typedef struct db db_t;
 
 /// @brief Represents a user in the system.
 /// @details This struct contains the various fields that make up a user's profile, such as their ID, kind, email, names, and display name.
@@ -54,7 +55,41 @@ db_t *db_connect(cfg_t *cfg, char const *host, char const *port, char const *dat
 /// @param db The database connection to destroy. No-op if @c NULL.
 void db_destroy(db_t *db);
 
+/// @brief A function called when a user gets a new message.
+/// @param recipient_id The ID of the recipient of the message.
+/// @param ctx The context given to @ref db_on_new_msg.
+typedef void (*db_new_msg_fn)(serial_t recipient_id, void *ctx);
+
+/// @brief Set the function called when a user gets a new message.
+/// @param db The database.
+/// @param fn The function, or @c NULL for none. Called when a message is sent with @ref db_send_msg, and when another connection sends one, as notified by the database.
+/// @param ctx Passed to @p fn.
+/// @remark Messages sent in a transaction are reported before it commits, and again when it does: @p fn must cope with spurious calls.
+void db_on_new_msg(db_t *db, db_new_msg_fn fn, void *ctx);
+
+/// @brief Get the socket of the database connection, to wait for notifications.
+/// @param db The database.
+/// @return A file descriptor that becomes readable when notifications arrive. Pass it to @ref db_consume_notifications then.
+int db_socket(db_t const *db);
+
+/// @brief Process the notifications the database has sent. Doesn't block.
+/// @remark The cached inbox of a recipient whose messages were changed by another connection is dropped.
+/// @param db The database.
+/// @param cfg The configuration.
+void db_consume_notifications(db_t *db, cfg_t *cfg);
+
+/// @brief Drop everything the DAL has cached in memory.
+/// @param db The database.
+/// @remark Call this when the database may have changed behind the DAL's back.
+void db_invalidate_caches(db_t *db);
+
+/// @brief Get the number of round-trips made to the database so far.
+/// @param db The database. Can be @c NULL.
+/// @return A counter that only goes up: the difference between two calls is the number of round-trips made in between. Always @c 0 if @p db is @c NULL.
+uint64_t db_round_trips(db_t const *db);
+
 /// @brief Verify a connection string.
+/// @remark Unknown API keys are mostly rejected by an in-memory filter, without a database round-trip.
 /// @param db The database.
 /// @param cfg The configuration.
 /// @param out_user Assigned to the identity of the user.
@@ -65,6 +100,7 @@ void db_destroy(db_t *db);
 errstatus_t db_verify_user_constr(db_t *db, cfg_t *cfg, user_identity_t *out_user, constr_t constr);
 
 /// @brief Get the ID of an user from their e-mail.
+/// @remark Resolutions, including unknown e-mails, are cached for a limited time.
 /// @param db The database.
 /// @param cfg The configuration.
 /// @param email The e-mail to look for.
@@ -74,6 +110,7 @@ errstatus_t db_verify_user_constr(db_t *db, cfg_t *cfg, user_identity_t *out_use
 serial_t db_get_user_id_by_email(db_t *db, cfg_t *cfg, char const *email);
 
 /// @brief Get the ID of an user from their name.
+/// @remark Resolutions, including unknown names, are cached for a limited time.
 /// @param db The database.
 /// @param cfg The configuration.
 /// @param name The name to look for. It can be a member's pseudo or a pro's display name
@@ -152,12 +189,39 @@ serial_t db_send_msg(db_t *db, cfg_t *cfg, serial_t sender_id, serial_t recipien
 /// @return @ref errstatus_ok On success.
 /// @return @ref errstatus_handled A database error occured. A message has been shown. @p out_user is untouched.
 /// @remark The returned msg_list is owned by the caller.
+/// @remark The first page may be served from memory, when @p limit is the configured inbox page size.
 errstatus_t db_get_inbox(db_t *db, memlst_t **p_mem, cfg_t *cfg,
     int32_t limit,
     int32_t offset,
     serial_t recipient_id,
     msg_list_t *out_msgs);
 
+/// @brief Tests whether a user has unread messages.
+/// @param db The database.
+/// @param cfg The configuration.
+/// @param user_id The ID of the user.
+/// @return @ref errstatus_ok The user has unread messages.
+/// @return @ref errstatus_error The user has no unread messages.
+/// @return @ref errstatus_handled A database error occured. A message has been shown.
+errstatus_t db_has_unread(db_t *db, cfg_t *cfg, serial_t user_id);
+
+/// @brief Gets the oldest unread messages of a user and marks them as read, in a single statement.
+/// @param db The database.
+/// @param p_mem Parent memory owner.
+/// @param cfg The configuration.
+/// @param limit The maximum number of messages to fetch.
+/// @param recipient_id The ID of the user who recieved the messages.
+/// @param out_msgs Assigned to the messages, in chronological order.
+/// @param out_has_more Assigned to whether unread messages remain past @p limit.
+/// @return @ref errstatus_ok On success.
+/// @return @ref errstatus_handled A database error occured. A message has been shown. @p out_msgs is untouched.
+/// @remark Messages being marked read by a concurrent call are skipped rather than waited for, so each message is returned once.
+errstatus_t db_get_motd(db_t *db, memlst_t **p_mem, cfg_t *cfg,
+    int32_t limit,
+    serial_t recipient_id,
+    msg_list_t *out_msgs,
+    bool *out_has_more);
+
 /// @brief Removes a message from the database.
 /// @param db The database.
 /// @param cfg The configuration.
@@ -166,6 +230,58 @@ errstatus_t db_get_inbox(db_t *db, memlst_t **p_mem, cfg_t *cfg,
 /// @return @ref errstatus_error The message could not be removed.
 errstatus_t db_rm_msg(db_t *db, cfg_t *cfg, serial_t msg_id);
 
+/// @brief Edits the content of a message.
+/// @param db The database.
+/// @param cfg The configuration.
+/// @param msg_id The ID of the message to edit.
+/// @param new_content The null-terminated new content of the message.
+/// @return @ref errstatus_ok The message was successfully edited.
+/// @return @ref errstatus_error No message of ID @p msg_id exists in the database.
+/// @return @ref errstatus_handled A database error occured. A message has been shown.
+errstatus_t db_edit_msg(db_t *db, cfg_t *cfg, serial_t msg_id, char const *new_content);
+
+/// @brief Test whether a user may not send messages to another because of a block or a ban.
+/// @remark Answered from memory. The index is reloaded when the blocks change in the database.
+/// @param db The database.
+/// @param cfg The configuration.
+/// @param sender_id The ID of the sender.
+/// @param recipient_id The ID of the recipient.
+/// @return Whether @p sender_id is blocked globally or by @p recipient_id. @c false if it can't be determined (@ref db_send_msg checks again).
+bool db_is_blocked(db_t *db, cfg_t *cfg, serial_t sender_id, serial_t recipient_id);
+
+/// @brief Get the block of a member.
+/// @remark Answered from memory. The index is reloaded when the blocks change in the database.
+/// @param db The database.
+/// @param cfg The configuration.
+/// @param scope @ref BLOCK_SCOPE_GLOBAL or the ID of a professionnal.
+/// @param member_id The ID of the member.
+/// @return When the block expires, or @ref BLOCK_FOREVER for a ban.
+/// @return @c 0 The member isn't blocked in @p scope.
+/// @return @ref errstatus_handled A database error occured. A message has been shown.
+int64_t db_get_block(db_t *db, cfg_t *cfg, serial_t scope, serial_t member_id);
+
+/// @brief Block or ban a member.
+/// @param db The database.
+/// @param cfg The configuration.
+/// @param scope @ref BLOCK_SCOPE_GLOBAL or the ID of the professionnal blocking the member.
+/// @param member_id The ID of the member.
+/// @param forever @c true to ban, @c false to block for the configured duration. Replaces any previous block in @p scope.
+/// @return @ref errstatus_ok The member was blocked.
+/// @return @ref errstatus_error No member of ID @p member_id exists in the database.
+/// @return @ref errstatus_handled A database error occured. A message has been shown.
+errstatus_t db_block(db_t *db, cfg_t *cfg, serial_t scope, serial_t member_id, bool forever);
+
+/// @brief Lift the block or the ban of a member.
+/// @param db The database.
+/// @param cfg The configuration.
+/// @param scope @ref BLOCK_SCOPE_GLOBAL or the ID of the professionnal that blocked the member. The global scope also lifts the blocks of every professionnal.
+/// @param member_id The ID of the member.
+/// @param forever @c true to lift a ban, @c false to lift a block.
+/// @return @ref errstatus_ok The block was lifted.
+/// @return @ref errstatus_error The member wasn't blocked (or banned) in @p scope.
+/// @return @ref errstatus_handled A database error occured. A message has been shown.
+errstatus_t db_unblock(db_t *db, cfg_t *cfg, serial_t scope, serial_t member_id, bool forever);
+
 /// @brief A transaction body function
 ///
 /// This function is called by @ref db_transaction.
@@ -178,6 +294,7 @@ typedef errstatus_t (*transaction_fn)(db_t *db, cfg_t *cfg, void *ctx);
 /// @param body The transaction body function.
 /// @param ctx The context to pass to @p {body}. Can be @c {NULL}.
 /// @return The error status of @p {body}, or of the BEGIN, COMMIT or ROLLBACK action if they weren't successful.
+/// @remark On ROLLBACK, the DAL in-memory caches are invalidated.
 errstatus_t db_transaction(db_t *db, cfg_t *cfg, transaction_fn body, void *ctx);
 
 /// @brief Enumeration of test data types that can be loaded into the database.
@@ -195,4 +312,13 @@ typedef enum {
 /// @return @ref errstatus_handled A database error occured. A message has been shown.
 errstatus_t db_use_test_data(db_t *db, cfg_t *cfg, test_data_t subject);
 
+/// @brief Send a notification, as the database triggers do. For testing how notifications are consumed.
+/// @param db The database.
+/// @param cfg The configuration.
+/// @param channel The channel to notify.
+/// @param payload The payload of the notification.
+/// @return @ref errstatus_ok On success. Outside of a transaction, the notification can be consumed right away.
+/// @return @ref errstatus_handled A database error occured. A message has been shown.
+errstatus_t db_notify(db_t *db, cfg_t *cfg, char const *channel, char const *payload);
+
 #endif // DB_H
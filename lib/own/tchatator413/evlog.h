@@ -0,0 +1,82 @@
+/// @file
+/// @author Raphaël
+/// @brief Binary event log - Interface
+///
+/// An event log is a sequence of compact binary records, written through an asynchronous @ref logger_t.
+/// It is self-describing: each session starts with a header that lists the events and the names and types of their fields, so @c tool/evlog-decode.py needs no knowledge of them.
+///
+/// Layout, in native byte order (the decoder assumes little-endian):
+/// - Session header: @c 0xff, @c "T413EV", the format version (u8), the number of events (u8), then for each event in id order:
+///   its name (str), its number of fields (u8), and for each field its type code (u8, see @ref X_EVLOG_TYPES) and name (str).
+/// - Record: the event id (u8), the length of the fields (u16), the wall clock time in nanoseconds since the epoch (i64), then the fields.
+/// - A str is a u8 length followed by as many bytes. Longer strings are truncated.
+///
+/// @date 18/10/2026
+
+#ifndef EVLOG_H
+#define EVLOG_H
+
+#include "tchatator413/logger.h"
+#include <stdint.h>
+
+/// @brief X-macro that expands to the list of field types, as X(name, C type, type code).
+#define X_EVLOG_TYPES(X)      \
+    X(u8, uint8_t, 'B')       \
+    X(u16, uint16_t, 'H')     \
+    X(u32, uint32_t, 'I')     \
+    X(u64, uint64_t, 'Q')     \
+    X(i32, int32_t, 'i')      \
+    X(i64, int64_t, 'q')      \
+    X(ipv4, uint32_t, '4')    \
+    X(str, char const *, 's') \
+    //
+
+/// @brief X-macro that expands to the list of events, as X(name, fields), where fields is a sequence of F(type, name).
+/// @remark Append new events at the end, so ids stay stable across versions.
+#define X_EVLOG_EVENTS(X, F)                                                                    \
+    X(dropped, F(u64, n_events))                                                                \
+    X(conn_accepted, F(ipv4, addr) F(u16, port) F(i32, fd))                                     \
+    X(rate_limited, F(ipv4, addr) F(u16, port) F(i64, retry_at))                                \
+    X(action_parsed, F(u8, type) F(u8, fast))                                                   \
+    X(db_query, F(str, fn) F(i64, duration_ns) F(u8, status) F(i32, n_tuples))                  \
+    X(response_written, F(i32, fd) F(u32, len))                                                 \
+    //
+
+#define EVLOG_DECLARE_CTYPE(name, ctype, code) typedef ctype evlog_##name##_t;
+X_EVLOG_TYPES(EVLOG_DECLARE_CTYPE)
+#undef EVLOG_DECLARE_CTYPE
+
+/// @brief An opaque handle to an event log.
+typedef struct evlog evlog_t;
+
+/// @brief Open an event log, appending a session to it.
+/// @param filename The file name.
+/// @param ring_size The capacity of each thread's ring in bytes.
+/// @param overflow What to do with a record when a ring is full. Dropped records are counted by a @c dropped event.
+/// @return A new event log.
+/// @return @c NULL if the file could not be opened. @c errno is set.
+evlog_t *evlog_open(char const *filename, size_t ring_size, log_overflow_t overflow);
+
+/// @brief Close an event log, writing every record it holds.
+/// @param evlog The event log. No-op if @c NULL.
+void evlog_close(evlog_t *evlog);
+
+/// @brief Event ids.
+typedef enum {
+#define EVLOG_DECLARE_ID(name, fields) evlog_event_##name,
+    X_EVLOG_EVENTS(EVLOG_DECLARE_ID, )
+#undef EVLOG_DECLARE_ID
+} evlog_event_t;
+
+#define EVLOG_MEMBER(type, name) evlog_##type##_t name;
+#define EVLOG_DECLARE_EVENT(name, fields)                              \
+    typedef struct {                                                   \
+        fields                                                         \
+    } evlog_##name##_t;                                                \
+    void evlog_##name(evlog_t *evlog, evlog_##name##_t const *p_event);
+/// @brief Record an event. No-op if @p evlog is @c NULL.
+X_EVLOG_EVENTS(EVLOG_DECLARE_EVENT, EVLOG_MEMBER)
+#undef EVLOG_DECLARE_EVENT
+#undef EVLOG_MEMBER
+
+#endif // EVLOG_H
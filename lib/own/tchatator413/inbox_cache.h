@@ -0,0 +1,91 @@
+/// @file
+/// @author Raphaël
+/// @brief Inbox cache - Interface
+///
+/// Holds the newest messages of recently active recipients, so the first page of their inbox can be served without a database round-trip.
+///
+/// Each recipient gets a ring of the newest messages they've received. A ring is filled lazily from the database, then kept up-to-date by the writes performed by this process.
+/// The number of rings is bounded: the least recently used one is evicted first.
+///
+/// @date 18/10/2026
+
+#ifndef INBOX_CACHE_H
+#define INBOX_CACHE_H
+
+#include "memlst.h"
+#include "tchatator413/db.h"
+#include "tchatator413/types.h"
+#include <stdbool.h>
+#include <stddef.h>
+
+/// @brief An opaque handle to an inbox cache.
+typedef struct inbox_cache inbox_cache_t;
+
+/// @brief Create a new, empty inbox cache.
+/// @param max_recipients The maximum number of recipients whose inbox is cached.
+/// @param ring_size The number of messages held per recipient. Only inbox pages of this size are cached.
+/// @return A new inbox cache.
+/// @return @c NULL if @p max_recipients or @p ring_size is @c 0 (caching disabled).
+inbox_cache_t *inbox_cache_init(size_t max_recipients, int32_t ring_size);
+
+/// @brief Destroy an inbox cache.
+/// @param cache The cache to destroy. No-op if @c NULL.
+void inbox_cache_destroy(inbox_cache_t *cache);
+
+/// @brief Get the number of messages held per recipient.
+/// @param cache The cache.
+/// @return The ring size, or @c 0 if @p cache is @c NULL.
+int32_t inbox_cache_ring_size(inbox_cache_t const *cache);
+
+/// @brief Get the newest messages of a recipient.
+/// @param cache The cache. Can be @c NULL, in which case this always misses.
+/// @param p_mem Parent memory owner of the returned messages.
+/// @param recipient_id The ID of the recipient.
+/// @param out_msgs Assigned to the newest messages of the recipient, in reverse chronological order.
+/// @return @c true on a cache hit.
+/// @return @c false on a cache miss. @p out_msgs is untouched.
+bool inbox_cache_get(inbox_cache_t *cache, memlst_t **p_mem, serial_t recipient_id, msg_list_t *out_msgs);
+
+/// @brief Fill the ring of a recipient.
+/// @param cache The cache. No-op if @c NULL.
+/// @param recipient_id The ID of the recipient.
+/// @param msgs The newest messages of the recipient, in reverse chronological order. Contents are copied.
+/// @remark At most @ref inbox_cache_ring_size messages are used. If there are less, the recipient has no other messages.
+void inbox_cache_fill(inbox_cache_t *cache, serial_t recipient_id, msg_list_t msgs);
+
+/// @brief Add a message that has just been sent.
+/// @param cache The cache. No-op if @c NULL.
+/// @param p_msg The message. Its content is copied.
+/// @remark Nothing happens if the ring of the recipient isn't cached.
+void inbox_cache_push(inbox_cache_t *cache, msg_t const *p_msg);
+
+/// @brief Update a message that has been edited.
+/// @param cache The cache. No-op if @c NULL.
+/// @param recipient_id The ID of the recipient of the message. Only their ring is looked at.
+/// @param msg_id The ID of the message.
+/// @param content The new content of the message. It is copied.
+/// @param edited_age The new edit age of the message.
+void inbox_cache_edit(inbox_cache_t *cache, serial_t recipient_id, serial_t msg_id, char const *content, int32_t edited_age);
+
+/// @brief Update messages that have been read.
+/// @param cache The cache. No-op if @c NULL.
+/// @param recipient_id The ID of the recipient of the messages.
+/// @param msgs The messages, with their new read age.
+void inbox_cache_read(inbox_cache_t *cache, serial_t recipient_id, msg_list_t msgs);
+
+/// @brief Forget a message that has been removed.
+/// @param cache The cache. No-op if @c NULL.
+/// @param recipient_id The ID of the recipient of the message. Only their ring is looked at.
+/// @param msg_id The ID of the message.
+void inbox_cache_rm(inbox_cache_t *cache, serial_t recipient_id, serial_t msg_id);
+
+/// @brief Drop the ring of a recipient, whose messages have changed elsewhere.
+/// @param cache The cache. No-op if @c NULL.
+/// @param recipient_id The ID of the recipient.
+void inbox_cache_invalidate(inbox_cache_t *cache, serial_t recipient_id);
+
+/// @brief Drop every ring.
+/// @param cache The cache. No-op if @c NULL.
+void inbox_cache_clear(inbox_cache_t *cache);
+
+#endif // INBOX_CACHE_H
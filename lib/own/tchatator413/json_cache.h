@@ -0,0 +1,79 @@
+/// @file
+/// @author Raphaël
+/// @brief JSON fragment cache - Interface
+///
+/// Keeps the plain JSON serialization of recently serialized messages and users, so hot inbox pages and profiles are encoded only once.
+/// The streaming writer copies these fragments as-is. The json-c serializer also gets back the JSON object it built, which serializes to the stored bytes instead of being walked again.
+///
+/// The cache is process-wide. It is disabled until @ref json_cache_init is called.
+///
+/// @date 18/10/2026
+
+#ifndef JSON_CACHE_H
+#define JSON_CACHE_H
+
+#include "json-c.h"
+#include "tchatator413/db.h"
+#include "tchatator413/types.h"
+#include <stddef.h>
+
+/// @brief Enable the cache.
+/// @param capacity The maximum number of messages, and of users, held. Rounded up to a power of 2. @c 0 keeps the cache disabled.
+/// @remark Replaces the previous cache, if any.
+void json_cache_init(size_t capacity);
+
+/// @brief Disable the cache and free its memory.
+/// @remark Objects still referenced elsewhere stay valid.
+void json_cache_destroy(void);
+
+/// @brief Get the cached JSON object of a message.
+/// @param p_msg The message. Every serialized field must match the cached version.
+/// @return A new reference to the cached JSON object.
+/// @return @c NULL on a cache miss, or if only the fragment is cached.
+json_object *json_cache_get_msg(msg_t const *p_msg);
+
+/// @brief Store the JSON object of a message.
+/// @param p_msg The message @p jo was built from.
+/// @param jo The JSON object. A reference is kept. It must not be modified afterwards.
+/// @remark @p jo will serialize to its current plain JSON representation, whatever the flags.
+void json_cache_put_msg(msg_t const *p_msg, json_object *jo);
+
+/// @brief Get the cached plain JSON serialization of a message.
+/// @param p_msg The message. Every serialized field must match the cached version.
+/// @param out_len Assigned to the length of the fragment on a hit.
+/// @return The fragment, not null-terminated. Valid until the next call to a @c put function.
+/// @return @c NULL on a cache miss.
+char const *json_cache_get_msg_fragment(msg_t const *p_msg, size_t *out_len);
+
+/// @brief Store the plain JSON serialization of a message.
+/// @param p_msg The message @p fragment was written from.
+/// @param fragment The fragment. Copied.
+/// @param len The length of @p fragment.
+void json_cache_put_msg_fragment(msg_t const *p_msg, char const *fragment, size_t len);
+
+/// @brief Get the cached JSON object of a user.
+/// @param p_user The user. Every serialized field must match the cached version.
+/// @return A new reference to the cached JSON object.
+/// @return @c NULL on a cache miss, or if only the fragment is cached.
+json_object *json_cache_get_user(user_t const *p_user);
+
+/// @brief Store the JSON object of a user.
+/// @param p_user The user @p jo was built from.
+/// @param jo The JSON object. A reference is kept. It must not be modified afterwards.
+/// @remark @p jo will serialize to its current plain JSON representation, whatever the flags.
+void json_cache_put_user(user_t const *p_user, json_object *jo);
+
+/// @brief Get the cached plain JSON serialization of a user.
+/// @param p_user The user. Every serialized field must match the cached version.
+/// @param out_len Assigned to the length of the fragment on a hit.
+/// @return The fragment, not null-terminated. Valid until the next call to a @c put function.
+/// @return @c NULL on a cache miss.
+char const *json_cache_get_user_fragment(user_t const *p_user, size_t *out_len);
+
+/// @brief Store the plain JSON serialization of a user.
+/// @param p_user The user @p fragment was written from.
+/// @param fragment The fragment. Copied.
+/// @param len The length of @p fragment.
+void json_cache_put_user_fragment(user_t const *p_user, char const *fragment, size_t len);
+
+#endif // JSON_CACHE_H
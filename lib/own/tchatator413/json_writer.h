@@ -0,0 +1,118 @@
+/// @file
+/// @author Raphaël
+/// @brief Streaming JSON writer - Interface
+///
+/// Appends JSON text to a growable buffer, without building a json-c object tree first.
+/// The writer knows nothing of the document structure: callers emit punctuation themselves, which suits the fixed grammar of responses.
+/// Output matches the plain serialization of json-c byte for byte.
+///
+/// @date 18/10/2026
+
+#ifndef JSON_WRITER_H
+#define JSON_WRITER_H
+
+#include "json-c.h"
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+/// @brief A growable output buffer.
+typedef struct {
+    /// @brief The text written so far. Not null-terminated until @ref json_writer_str is called.
+    char *buf;
+    /// @brief The length of the text written so far.
+    size_t len;
+    /// @brief The allocated capacity of @ref buf.
+    size_t cap;
+} json_writer_t;
+
+/// @brief Create an empty JSON writer.
+#define JSON_WRITER_INIT ((json_writer_t) { 0 })
+
+/// @brief Free the memory of a JSON writer.
+/// @param p_writer The writer. It is empty afterwards and can be reused.
+void json_writer_destroy(json_writer_t *p_writer);
+
+/// @brief Empty a JSON writer, keeping its memory for reuse.
+/// @param p_writer The writer.
+static inline void json_writer_reset(json_writer_t *p_writer) {
+    p_writer->len = 0;
+}
+
+/// @brief Ensure a JSON writer can take more bytes without reallocating.
+/// @param p_writer The writer.
+/// @param n The number of bytes about to be written.
+void json_writer_reserve(json_writer_t *p_writer, size_t n);
+
+/// @brief Get the text written so far, null-terminated.
+/// @param p_writer The writer.
+/// @return The text. Valid until the next write.
+char const *json_writer_str(json_writer_t *p_writer);
+
+/// @brief Append bytes as-is.
+/// @param p_writer The writer.
+/// @param s The bytes.
+/// @param len The number of bytes.
+static inline void json_writer_raw(json_writer_t *p_writer, char const *s, size_t len) {
+    json_writer_reserve(p_writer, len);
+    memcpy(p_writer->buf + p_writer->len, s, len);
+    p_writer->len += len;
+}
+
+/// @brief Append a single character as-is.
+/// @param p_writer The writer.
+/// @param c The character.
+static inline void json_writer_char(json_writer_t *p_writer, char c) {
+    json_writer_reserve(p_writer, 1);
+    p_writer->buf[p_writer->len++] = c;
+}
+
+/// @brief Append a string literal as-is.
+#define json_writer_lit(p_writer, lit) json_writer_raw(p_writer, "" lit, sizeof lit - 1)
+
+/// @brief Append an object key and its colon.
+#define json_writer_key(p_writer, key) json_writer_lit(p_writer, "\"" key "\":")
+
+/// @brief Append an integer.
+/// @param p_writer The writer.
+/// @param value The integer.
+void json_writer_int(json_writer_t *p_writer, int64_t value);
+
+/// @brief Append the escaped contents of a string, without the surrounding quotes.
+/// @param p_writer The writer.
+/// @param s The string.
+/// @param len The length of @p s.
+/// @remark Escapes like json-c does: @c / is escaped, non-ASCII bytes are left as-is.
+/// @remark Where SSE2 is available, bytes that need no escaping are skipped 16 at a time.
+void json_writer_escaped(json_writer_t *p_writer, char const *s, size_t len);
+
+/// @brief Append the escaped contents of a string, one byte at a time.
+/// @param p_writer The writer.
+/// @param s The string.
+/// @param len The length of @p s.
+/// @remark Reference implementation of @ref json_writer_escaped, for tests and benchmarks.
+void json_writer_escaped_scalar(json_writer_t *p_writer, char const *s, size_t len);
+
+/// @brief Append a string.
+/// @param p_writer The writer.
+/// @param s The string.
+/// @param len The length of @p s.
+static inline void json_writer_string_len(json_writer_t *p_writer, char const *s, size_t len) {
+    json_writer_char(p_writer, '"');
+    json_writer_escaped(p_writer, s, len);
+    json_writer_char(p_writer, '"');
+}
+
+/// @brief Append a null-terminated string.
+/// @param p_writer The writer.
+/// @param s The string.
+static inline void json_writer_string(json_writer_t *p_writer, char const *s) {
+    json_writer_string_len(p_writer, s, strlen(s));
+}
+
+/// @brief Append the plain serialization of a JSON object.
+/// @param p_writer The writer.
+/// @param jo The JSON object.
+void json_writer_json_object(json_writer_t *p_writer, json_object *jo);
+
+#endif // JSON_WRITER_H
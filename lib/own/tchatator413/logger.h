@@ -0,0 +1,79 @@
+/// @file
+/// @author Raphaël
+/// @brief Asynchronous logger - Interface
+///
+/// Log entries are formatted by the logging thread into a ring of its own, without locking nor system calls.
+/// A background thread drains the rings and writes what they hold in as few system calls as possible.
+///
+/// @date 18/10/2026
+
+#ifndef LOGGER_H
+#define LOGGER_H
+
+#include "util.h"
+#include <stdarg.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+/// @brief What to do with an entry when the ring of the logging thread is full.
+typedef enum {
+    log_overflow_drop,  ///< Drop the entry. It is counted in @ref logger_dropped, and reported in the log.
+    log_overflow_block, ///< Wait for the background thread to make room.
+} log_overflow_t;
+
+/// @brief An opaque handle to an asynchronous logger.
+typedef struct logger logger_t;
+
+/// @brief Formats the report of dropped entries.
+/// @param buf The buffer to format the report into.
+/// @param size The size of @p buf.
+/// @param n_dropped The number of entries dropped since the last report.
+/// @return The length of the report.
+typedef size_t (*logger_fmt_dropped_fn)(char *buf, size_t size, size_t n_dropped);
+
+/// @brief Start an asynchronous logger.
+/// @param fd The file descriptor to write to. Not closed by the logger.
+/// @param ring_size The capacity of each thread's ring in bytes, rounded up to a power of two. Entries longer than this are truncated.
+/// @param overflow What to do with an entry when a ring is full.
+/// @param fmt_dropped Formats the report of dropped entries. @c NULL for a line of text.
+/// @return A new logger, whose background thread is running.
+logger_t *logger_start(int fd, size_t ring_size, log_overflow_t overflow, logger_fmt_dropped_fn fmt_dropped);
+
+/// @brief Stop an asynchronous logger, writing everything it holds.
+/// @param logger The logger. No-op if @c NULL.
+/// @remark No thread may log to @p logger concurrently or afterwards.
+void logger_stop(logger_t *logger);
+
+/// @brief Log a formatted entry.
+/// @param logger The logger.
+/// @param file The file the entry comes from.
+/// @param line The line the entry comes from.
+/// @param lvl_prefix The level of the entry, as a prefix to the message (e.g. <tt>"error: "</tt>).
+/// @param fmt The format string.
+/// @param ap Arguments to the format string.
+/// @remark Entries are prefixed like the synchronous log: <tt>YYYY-MM-DD HH:MM:SS:file:line: </tt>. The timestamp is formatted once per second.
+ATTR_FORMAT(printf, 5, 0)
+void logger_vlog(logger_t *logger, char const *file, int line, char const *lvl_prefix, char const *fmt, va_list ap);
+
+/// @brief Log bytes as-is.
+/// @param logger The logger.
+/// @param s The bytes.
+/// @param len The number of bytes.
+void logger_write(logger_t *logger, char const *s, size_t len);
+
+/// @brief Write everything logged so far, without waiting for the background thread.
+/// @param logger The logger.
+/// @remark Called after errors, so they are not lost if the process exits right after.
+void logger_flush(logger_t *logger);
+
+/// @brief Get the number of entries dropped so far because a ring was full.
+/// @param logger The logger.
+/// @return The number of dropped entries.
+size_t logger_dropped(logger_t const *logger);
+
+/// @brief Get the number of rings, that is of threads that have logged so far.
+/// @param logger The logger.
+/// @return The number of rings.
+size_t logger_rings(logger_t const *logger);
+
+#endif // LOGGER_H
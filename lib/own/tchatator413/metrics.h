@@ -0,0 +1,204 @@
+/// @file
+/// @author Raphaël
+/// @brief Metrics registry - Interface
+///
+/// The registry is always on and process-wide. Each thread records into a shard of its own, with plain relaxed stores: recording never locks nor contends.
+/// Readers sum the shards when they take a snapshot. Shards outlive their threads, so nothing recorded is ever lost.
+///
+/// Latencies go into log-linear histograms, in the manner of HDR histograms: values are exact below 2^@ref METRICS_SUB_BUCKET_BITS, then each power of two is split in 2^(@ref METRICS_SUB_BUCKET_BITS - 1) buckets, so a bucket is never wider than 1/16th of its values.
+///
+/// @date 18/10/2026
+
+#ifndef METRICS_H
+#define METRICS_H
+
+#include "tchatator413/action.h"
+#include <stddef.h>
+#include <stdint.h>
+
+/// @brief X-macro that expands to the list of timed stages of a request.
+/// - parse: parsing an action, from its JSON object or from the scan of the request.
+/// - auth: verifying a connection string.
+/// - db: running a database query.
+/// - serialize: writing a response.
+#define X_METRICS_STAGES(X) \
+    X(parse)                \
+    X(auth)                 \
+    X(db)                   \
+    X(serialize)
+
+/// @brief The timed stages of a request.
+typedef enum {
+#define ENUM_VALUE(name) metrics_stage_##name,
+    X_METRICS_STAGES(ENUM_VALUE)
+#undef ENUM_VALUE
+} metrics_stage_t;
+
+/// @brief X-macro that expands to the list of named database statements.
+/// - api_keys: loading every API key, to build the API key filter.
+/// - user_by_api_key: verifying a connection string.
+/// - user_role: getting the role of a user.
+/// - user_id_by_email: finding a user by email.
+/// - member_id_by_name, pro_id_by_name: finding a user by name.
+/// - user: getting a user.
+/// - count_msg: counting the messages between two users.
+/// - send_msg: sending a message.
+/// - inbox: getting a page of an inbox.
+/// - motd: getting and marking read the unread messages of a recipient.
+/// - has_unread: testing whether a recipient has unread messages.
+/// - msg: getting a message.
+/// - rm_msg: deleting a message.
+/// - edit_msg: editing a message.
+/// - blocks: loading the blocks and bans in effect.
+/// - block_global, block_single: blocking or banning a member.
+/// - unblock_global, unblock_single: unblocking or unbanning a member.
+/// - begin, end: beginning and ending (committing or rolling back) a transaction.
+/// - test_data: loading test data and sending test notifications.
+#define X_METRICS_QUERIES(X) \
+    X(api_keys)              \
+    X(user_by_api_key)       \
+    X(user_role)             \
+    X(user_id_by_email)      \
+    X(member_id_by_name)     \
+    X(pro_id_by_name)        \
+    X(user)                  \
+    X(count_msg)             \
+    X(send_msg)              \
+    X(inbox)                 \
+    X(motd)                  \
+    X(has_unread)            \
+    X(msg)                   \
+    X(rm_msg)                \
+    X(edit_msg)              \
+    X(blocks)                \
+    X(block_global)          \
+    X(block_single)          \
+    X(unblock_global)        \
+    X(unblock_single)        \
+    X(begin)                 \
+    X(end)                   \
+    X(test_data)
+
+/// @brief The named database statements.
+typedef enum {
+#define ENUM_VALUE(name) metrics_query_##name,
+    X_METRICS_QUERIES(ENUM_VALUE)
+#undef ENUM_VALUE
+} metrics_query_t;
+
+#define METRICS_COUNT(...) +1
+enum {
+    /// @brief Number of timed stages.
+    metrics_n_stages = 0 X_METRICS_STAGES(METRICS_COUNT),
+    /// @brief Number of named database statements.
+    metrics_n_queries = 0 X_METRICS_QUERIES(METRICS_COUNT),
+    /// @brief Number of action types, @ref action_type_error included.
+    metrics_n_action_types = 1 X_ACTIONS(METRICS_COUNT),
+    /// @brief Number of status codes.
+    metrics_n_statuses = 0 X_STATUSES(METRICS_COUNT),
+};
+#undef METRICS_COUNT
+
+/// @brief Number of bits of precision of histogram buckets.
+#define METRICS_SUB_BUCKET_BITS 5
+/// @brief Number of buckets of a histogram, enough for any 64-bit value.
+#define METRICS_N_BUCKETS ((64 - METRICS_SUB_BUCKET_BITS + 2) << (METRICS_SUB_BUCKET_BITS - 1))
+
+/// @brief A latency histogram, in nanoseconds.
+typedef struct {
+    uint64_t count, sum_ns, max_ns;
+    uint64_t buckets[METRICS_N_BUCKETS];
+} metrics_histogram_t;
+
+/// @brief The statistics of a database statement.
+typedef struct {
+    /// @brief Number of times the statement ran.
+    uint64_t n_calls;
+    /// @brief Total and maximum round-trip time, in nanoseconds.
+    uint64_t sum_ns, max_ns;
+    /// @brief Number of rows returned.
+    uint64_t n_rows;
+} metrics_query_stats_t;
+
+/// @brief The state of the registry at some point.
+struct metrics_snapshot {
+    /// @brief Number of actions evaluated, by type.
+    uint64_t n_actions[metrics_n_action_types];
+    /// @brief Total and highest number of database round-trips of an action, by type.
+    uint64_t n_round_trips[metrics_n_action_types], max_round_trips[metrics_n_action_types];
+    /// @brief Number of responses, by status, in the order of @ref X_STATUSES.
+    uint64_t n_statuses[metrics_n_statuses];
+    /// @brief Latency of each stage.
+    metrics_histogram_t latency[metrics_n_stages];
+    /// @brief Statistics of each database statement.
+    metrics_query_stats_t queries[metrics_n_queries];
+    /// @brief Number of connections refused by the rate limit.
+    uint64_t n_turnstile_rejections;
+    /// @brief Number of bytes received and sent.
+    uint64_t n_bytes_in, n_bytes_out;
+};
+
+/// @brief Read the clock latencies are measured with.
+/// @return A monotonic time in nanoseconds.
+uint64_t metrics_clock(void);
+
+/// @brief Record the latency of a stage.
+/// @param stage The stage.
+/// @param duration_ns The latency in nanoseconds.
+void metrics_record(metrics_stage_t stage, uint64_t duration_ns);
+
+/// @brief Record a run of a database statement.
+/// @param query The statement.
+/// @param duration_ns The round-trip time in nanoseconds.
+/// @param n_rows The number of rows returned.
+void metrics_record_query(metrics_query_t query, uint64_t duration_ns, uint64_t n_rows);
+
+/// @brief Get the name of a database statement.
+/// @param query The statement.
+/// @return A string literal.
+char const *metrics_query_name(metrics_query_t query);
+
+/// @brief Count an evaluated action.
+/// @param type The type of the action.
+void metrics_count_action(action_type_t type);
+
+/// @brief Count the database round-trips of an action.
+/// @param type The type of the action.
+/// @param n The number of round-trips, from the start of its parsing to the end of its evaluation.
+void metrics_count_round_trips(action_type_t type, uint64_t n);
+
+/// @brief Count a response.
+/// @param status The status of the response.
+void metrics_count_status(status_t status);
+
+/// @brief Count a connection refused by the rate limit.
+void metrics_count_turnstile_rejection(void);
+
+/// @brief Count bytes transferred.
+/// @param n_in Number of bytes received.
+/// @param n_out Number of bytes sent.
+void metrics_count_bytes(size_t n_in, size_t n_out);
+
+/// @brief Take a snapshot of the registry, summing every shard.
+/// @param out_snapshot Assigned to the snapshot.
+/// @remark Counters are read one by one while other threads keep recording: the snapshot is not atomic as a whole.
+void metrics_snapshot(metrics_snapshot_t *out_snapshot);
+
+/// @brief Get the bucket of a value.
+/// @param value The value.
+/// @return The index of the bucket of @p value in @ref metrics_histogram_t.buckets.
+size_t metrics_bucket_of(uint64_t value);
+
+/// @brief Get the highest value of a bucket.
+/// @param bucket The index of the bucket.
+/// @return The highest value that falls in @p bucket.
+uint64_t metrics_bucket_max(size_t bucket);
+
+/// @brief Estimate a quantile of a histogram.
+/// @param p_histogram The histogram.
+/// @param q The quantile, between 0 and 1.
+/// @return The highest value of the bucket the quantile falls in, capped to the maximum recorded.
+/// @return @c 0 if the histogram is empty.
+uint64_t metrics_quantile(metrics_histogram_t const *p_histogram, double q);
+
+#endif // METRICS_H
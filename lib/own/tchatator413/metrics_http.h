@@ -0,0 +1,38 @@
+/// @file
+/// @author Raphaël
+/// @brief Prometheus metrics listener - Interface
+///
+/// Serves the metrics registry over plain HTTP, in the Prometheus text exposition format, for monitoring to scrape.
+/// The listener runs on a thread of its own and only reads the registry, so it never holds up the serving of requests.
+///
+/// @date 18/10/2026
+
+#ifndef METRICS_HTTP_H
+#define METRICS_HTTP_H
+
+#include "tchatator413/cfg.h"
+#include "tchatator413/metrics.h"
+
+/// @brief An opaque handle to a metrics listener.
+typedef struct metrics_http metrics_http_t;
+
+/// @brief Start a metrics listener.
+/// @param cfg The configuration, to log with.
+/// @param port The TCP port to listen on, on the loopback interface. Ignored if @p socket_path is not @c NULL.
+/// @param socket_path The path of the Unix socket to listen on, or @c NULL to listen on @p port. A stale socket file is replaced.
+/// @return A new metrics listener, whose thread is running.
+/// @return @c NULL if the socket could not be set up. An error has been logged.
+metrics_http_t *metrics_http_start(cfg_t *cfg, uint16_t port, char const *socket_path);
+
+/// @brief Stop a metrics listener.
+/// @param mh The metrics listener. No-op if @c NULL.
+void metrics_http_stop(metrics_http_t *mh);
+
+/// @brief Format a snapshot in the Prometheus text exposition format.
+/// @param p_snapshot The snapshot.
+/// @param start_time The Unix time the server started at.
+/// @param out_len Assigned to the length of the text.
+/// @return The text, to be freed.
+char *metrics_format_prometheus(metrics_snapshot_t const *p_snapshot, time_t start_time, size_t *out_len);
+
+#endif // METRICS_HTTP_H
@@ -0,0 +1,43 @@
+/// @file
+/// @author Raphaël
+/// @brief USDT probes - Interface
+///
+/// Static tracepoints on the hot paths of the server, for perf and bpftrace. The provider is @c tchatator.
+/// A probe compiles to a single @c nop and a note in the ELF file: it costs nothing until a tracer attaches to it, and the server needn't be restarted for that.
+///
+/// Probes are compiled in when @c <sys/sdt.h> is available (package systemtap-sdt-dev or systemtap-sdt-devel). Define @c TCHATATOR_NO_PROBES to leave them out.
+///
+/// Probe|Arguments
+/// -|-
+/// @c conn__accept|fd, IPv4 address (network order), port
+/// @c request__read|fd, bytes read
+/// @c action__parsed|action type, whether it came from the scan of the request
+/// @c auth__done|user id (@c 0 for root), role, @ref errstatus_t
+/// @c action__evaluated|action type, response status
+/// @c query__start|statement name
+/// @c query__done|statement name, @c PGresult status, rows returned
+/// @c response__write|fd, bytes written
+///
+/// The server serves a request at a time on a single thread, so probes of the same request can be joined on the thread id.
+///
+/// @code{.sh}
+/// bpftrace -e 'usdt:bin/tchatator-server:tchatator:query__start { @s[tid] = nsecs }
+///     usdt:bin/tchatator-server:tchatator:query__done /@s[tid]/ { @us[str(arg0)] = hist((nsecs - @s[tid]) / 1000); delete(@s[tid]) }'
+/// @endcode
+///
+/// @date 18/10/2026
+
+#ifndef PROBES_H
+#define PROBES_H
+
+#if !defined TCHATATOR_NO_PROBES && __has_include(<sys/sdt.h>)
+#include <sys/sdt.h>
+/// @brief Fire a probe.
+/// @param name The name of the probe. Double underscores show as dashes in tracers.
+/// @param ... Up to 12 integer or pointer arguments.
+#define PROBE(name, ...) STAP_PROBEV(tchatator, name __VA_OPT__(, ) __VA_ARGS__)
+#else
+#define PROBE(name, ...) ((void)0)
+#endif
+
+#endif // PROBES_H
@@ -0,0 +1,42 @@
+/// @file
+/// @author Raphaël
+/// @brief Sampling CPU profiler - Interface
+///
+/// Samples the stack of a thread at a fixed rate of its CPU time, and writes the samples as collapsed stacks: one line per distinct stack, its frames from the outermost separated by @c ;, then its count.
+/// That is the input format of flamegraph.pl, inferno and speedscope.
+///
+/// A POSIX CPU-time timer sends @c SIGPROF, whose handler only copies the return addresses of the stack into a buffer allocated beforehand. Symbols are resolved when the profile is written.
+/// Functions are named from the dynamic symbol table, which is why the server is linked with @c -rdynamic. Static functions aren't in it: they show as their module and offset, as in @c [tchatator-server+0x1a2b], for @c addr2line.
+///
+/// @c SIGPROF is installed with @c SA_RESTART, so sampling doesn't interrupt system calls.
+/// The timer signal is process-directed: the background threads block every signal, so it lands on the thread being profiled.
+///
+/// @date 18/10/2026
+
+#ifndef PROFILER_H
+#define PROFILER_H
+
+#include <stddef.h>
+#include <stdio.h>
+
+/// @brief Maximum number of frames kept per sample. Deeper stacks are cut at their outermost frames.
+#define PROFILER_MAX_DEPTH 64
+
+/// @brief An opaque handle to a running profiler.
+typedef struct profiler profiler_t;
+
+/// @brief Start sampling the calling thread. Only one profiler may run at a time.
+/// @param frequency_hz The number of samples per second of CPU time.
+/// @param max_samples The number of samples to keep at most. Further samples are counted as lost.
+/// @return A new profiler.
+/// @return @c NULL if a profiler is already running (@c errno is @c EBUSY) or the timer could not be created. @c errno is set.
+profiler_t *profiler_start(int frequency_hz, size_t max_samples);
+
+/// @brief Stop sampling and write the profile.
+/// @param profiler The profiler. It is freed.
+/// @param out The file to write collapsed stacks to, or @c NULL to discard the profile.
+/// @param out_n_lost Assigned to the number of samples lost because the buffer was full. Can be @c NULL.
+/// @return The number of samples written.
+size_t profiler_stop(profiler_t *profiler, FILE *out, size_t *out_n_lost);
+
+#endif // PROFILER_H
@@ -27,6 +27,20 @@ typedef void (*on_response_fn)(const response_t *response, void *ctx);
 /// @return The JSON response object to the request.
 json_object *tchatator413_interpret(json_object *jo_input, cfg_t *cfg, db_t *db, on_action_fn on_action, on_response_fn on_response, void *on_ctx);
 
+/// @brief Interpret a request from its text, streaming the response.
+/// @param p_writer The writer to append the JSON response to.
+/// @param p_mem Working memory. It is rewound before returning, so a memory list reused across requests keeps its arena.
+/// @param buf The request, null-terminated at @p len. It is modified.
+/// @param len The length of the request.
+/// @param cfg The configuration.
+/// @param db The database.
+/// @param on_action Event handler to call when the action is parsed. Cab be @c NULL.
+/// @param on_response Event handler to call when the action is interpreted. Cab be @c NULL.
+/// @param on_ctx The contect to pass to the previous event handlers.
+/// @remark Requests are parsed with the specialized parser when possible, with json-c otherwise.
+/// @remark The response is the same as the plain serialization of what @ref tchatator413_interpret returns, but no JSON object is built for it.
+void tchatator413_interpret_str(json_writer_t *p_writer, memlst_t **p_mem, char *buf, size_t len, cfg_t *cfg, db_t *db, on_action_fn on_action, on_response_fn on_response, void *on_ctx);
+
 /// @brief Run the server in interactive mode.
 /// @param cfg The configuration.
 /// @param db The database.
@@ -41,4 +55,14 @@ int tchatator413_run_interactive(cfg_t *cfg, db_t *db, int argc, char **argv);
 /// @return The exit code of the server.
 int tchatator413_run_socket(cfg_t *cfg, db_t *db);
 
+/// @brief Replay a capture file, then report throughput and per-action latency on standard output.
+/// @param cfg The configuration.
+/// @param db The database. It should be the test database: pseudonyms are assigned to its users, in order of first appearance.
+/// @param filename The capture file.
+/// @param max_speed Whether to replay requests back-to-back, rather than at the pace they were captured at.
+/// @param root_api_key The root API key, that the nil UUID stands for.
+/// @param root_password The root password.
+/// @return The exit code of the server.
+int tchatator413_run_replay(cfg_t *cfg, db_t *db, char const *filename, bool max_speed, api_key_t root_api_key, char const *root_password);
+
 #endif // TCHATATOR_413_H
@@ -0,0 +1,87 @@
+/// @file
+/// @author Raphaël
+/// @brief Request tracing - Interface
+///
+/// A trace is a list of timed spans for the stages of a request: reading it, parsing, authentication, bcrypt, each database query, evaluating each action, serialization and writing the response.
+/// Traces are recorded into a buffer of the serving thread, then written as a line of JSON to the trace file if the request took at least the configured threshold.
+///
+/// Tracing is opt-in: with no trace file configured, no trace is begun, and spans cost a thread-local load.
+///
+/// @date 18/10/2026
+
+#ifndef TRACE_H
+#define TRACE_H
+
+#include "tchatator413/logger.h"
+#include <stdbool.h>
+#include <stdint.h>
+
+/// @brief Maximum number of spans of a trace. Further spans are counted, but not recorded.
+#define TRACE_MAX_SPANS 64
+
+/// @brief Length of the representation of a trace id, without null terminator.
+#define TRACE_ID_REPR_LENGTH 16
+
+typedef struct {
+    /// @brief The stage. A string literal.
+    char const *name;
+    /// @brief What the stage worked on, such as the name of a query. A string with static storage, or @c NULL.
+    char const *detail;
+    uint64_t start_ns, end_ns;
+} trace_span_t;
+
+/// @brief The trace of a request.
+typedef struct {
+    uint64_t id;
+    /// @brief When the request started, on the monotonic clock.
+    uint64_t start_ns;
+    /// @brief When the request started, in nanoseconds since the epoch.
+    int64_t started_at_ns;
+    size_t n_spans, n_dropped;
+    trace_span_t spans[TRACE_MAX_SPANS];
+} trace_t;
+
+/// @brief An opaque handle to a trace file.
+typedef struct tracer tracer_t;
+
+/// @brief The trace of the request the calling thread is serving, or @c NULL if it isn't traced.
+extern _Thread_local trace_t *tl_trace;
+
+/// @brief Open a trace file, appending to it.
+/// @param filename The file name.
+/// @param threshold_ns The duration from which requests are written.
+/// @param ring_size The capacity of each thread's ring in bytes.
+/// @param overflow What to do with a trace when a ring is full.
+/// @return A new trace file.
+/// @return @c NULL if the file could not be opened. @c errno is set.
+tracer_t *tracer_open(char const *filename, uint64_t threshold_ns, size_t ring_size, log_overflow_t overflow);
+
+/// @brief Close a trace file, writing every trace it holds.
+/// @param tracer The trace file. No-op if @c NULL.
+void tracer_close(tracer_t *tracer);
+
+/// @brief Begin tracing a request on the calling thread.
+/// @param tracer The trace file. If @c NULL, the request is not traced.
+/// @param p_trace The trace to record into.
+void trace_begin(tracer_t *tracer, trace_t *p_trace);
+
+/// @brief End tracing the request of the calling thread, writing its trace if it was slow.
+/// @param tracer The trace file given to @ref trace_begin.
+void trace_end(tracer_t *tracer);
+
+/// @brief Read the clock spans are measured with.
+/// @return A monotonic time in nanoseconds, or @c 0 if the request isn't traced, to spare the clock read.
+uint64_t trace_clock(void);
+
+/// @brief Record a span in the trace of the calling thread. No-op if the request isn't traced.
+/// @param name The stage. A string literal.
+/// @param detail What the stage worked on. A string with static storage, or @c NULL.
+/// @param start_ns When the stage started, from @ref trace_clock or @ref metrics_clock.
+void trace_span(char const *name, char const *detail, uint64_t start_ns);
+
+/// @brief Write the id of a trace.
+/// @param id The id.
+/// @param out_repr Assigned to the representation of @p id, null-terminated.
+void trace_id_repr(uint64_t id, char out_repr[static TRACE_ID_REPR_LENGTH + 1]);
+
+#endif // TRACE_H
@@ -0,0 +1,48 @@
+/// @file
+/// @author Raphaël
+/// @brief Turnstile - Interface
+///
+/// Rate limits connections by source IP, per minute and per hour, as configured by @c rate_limit_m and @c rate_limit_h.
+///
+/// @date 18/10/2026
+
+#ifndef TURNSTILE_H
+#define TURNSTILE_H
+
+#include "tchatator413/cfg.h"
+#include <netinet/in.h>
+#include <time.h>
+
+typedef struct {
+    /// @brief Timestamp of the last request.
+    time_t last_request_at;
+    /// @brief Number of requests performed since an hour.
+    int n_requests_h;
+    /// @brief Number of requests performed since a minute.
+    int n_requests_m;
+} user_stats_t;
+
+typedef struct {
+    in_addr_t key;
+    user_stats_t value;
+} turnstile_entry;
+
+/// @brief A turnstile. Zero-initialize.
+typedef struct {
+    /// @brief The stb_ds hash map of the statistics of each source IP.
+    turnstile_entry *entries;
+} turnstile_t;
+
+/// @brief Checks and increments the rate limit for the specified user.
+/// @param cfg The configuration.
+/// @param turnstile The turnstile.
+/// @param in_addr The source IP of the request.
+/// @return @c 0 The turnstile passes (the rate limit hasn't been reached)
+/// @return > @c 0 The turnstile blocks (the rate limit has been reached). The return value is time of the next allowed request.
+time_t turnstile_rate_limit(cfg_t const *cfg, turnstile_t *turnstile, in_addr_t in_addr);
+
+/// @brief Free the memory of a turnstile.
+/// @param turnstile The turnstile. It is left empty and can be reused.
+void turnstile_destroy(turnstile_t *turnstile);
+
+#endif // TURNSTILE_H
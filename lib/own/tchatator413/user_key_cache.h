@@ -0,0 +1,67 @@
+/// @file
+/// @author Raphaël
+/// @brief User key cache - Interface
+///
+/// A bounded, direct-mapped cache from user keys (e-mail, member pseudo or pro business name) to user IDs.
+/// Used by the DAL to resolve the @c user and @c dest action arguments without a database round-trip.
+///
+/// @date 18/10/2026
+
+#ifndef USER_KEY_CACHE_H
+#define USER_KEY_CACHE_H
+
+#include "tchatator413/types.h"
+#include <stdbool.h>
+#include <stddef.h>
+#include <time.h>
+
+/// @brief An opaque handle to a user key cache.
+typedef struct user_key_cache user_key_cache_t;
+
+/// @brief The kind of a user key. Keys of different kinds never collide.
+typedef enum {
+    user_key_email, ///< @brief An e-mail.
+    user_key_name,  ///< @brief A member pseudo or a pro business name.
+} user_key_kind_t;
+
+/// @brief Create a new, empty user key cache.
+/// @param capacity The maximum number of entries. Rounded up to a power of 2.
+/// @param ttl Time to live of positive entries, in seconds.
+/// @param negative_ttl Time to live of negative entries (unknown keys), in seconds.
+/// @return A new user key cache.
+/// @return @c NULL if @p capacity is @c 0 (caching disabled).
+user_key_cache_t *user_key_cache_init(size_t capacity, int ttl, int negative_ttl);
+
+/// @brief Destroy a user key cache.
+/// @param cache The cache to destroy. No-op if @c NULL.
+void user_key_cache_destroy(user_key_cache_t *cache);
+
+/// @brief Look up a user key.
+/// @param cache The cache. Can be @c NULL, in which case this always misses.
+/// @param kind The kind of @p key.
+/// @param key The null-terminated key.
+/// @param now The current time.
+/// @param out_user_id Assigned to the cached user ID, or to @ref errstatus_error for a negative entry.
+/// @return @c true on a cache hit.
+/// @return @c false on a cache miss. @p out_user_id is untouched.
+bool user_key_cache_get(user_key_cache_t *cache, user_key_kind_t kind, char const *key, time_t now, serial_t *out_user_id);
+
+/// @brief Store the resolution of a user key.
+/// @param cache The cache. No-op if @c NULL.
+/// @param kind The kind of @p key.
+/// @param key The null-terminated key. It is copied.
+/// @param now The current time.
+/// @param user_id The user ID, or @ref errstatus_error to store a negative entry. @ref errstatus_handled is not cached.
+/// @remark The entry replaces whichever entry occupied the same slot.
+void user_key_cache_put(user_key_cache_t *cache, user_key_kind_t kind, char const *key, time_t now, serial_t user_id);
+
+/// @brief Drop every entry that resolves to a user ID.
+/// @param cache The cache. No-op if @c NULL.
+/// @param user_id The user ID whose keys to forget, or @ref errstatus_error to drop the negative entries.
+void user_key_cache_invalidate_user(user_key_cache_t *cache, serial_t user_id);
+
+/// @brief Drop every entry.
+/// @param cache The cache. No-op if @c NULL.
+void user_key_cache_clear(user_key_cache_t *cache);
+
+#endif // USER_KEY_CACHE_H
@@ -8,6 +8,7 @@
 
 #include "tchatator413/slice.h"
 #include <stdbool.h>
+#include <stddef.h>
 #include <stdint.h>
 #include <stdio.h>
 
@@ -37,6 +38,47 @@ bool uuid4_parse_slice(uuid4_t *out_uuid, slice_t repr_slice);
 /// @remark The syntax ABNF can be found at https://www.rfc-editor.org/rfc/rfc9562.html#section-4-5. Lowercase hex digits are allowed.
 bool uuid4_parse(uuid4_t *out_uuid, char const repr[static const UUID4_REPR_LENGTH]);
 
+/// @brief Generate the representations of many version 4 UUIDs.
+/// @param n The number of UUIDs.
+/// @param uuids The UUIDs.
+/// @param reprs The representation buffers, one per UUID. No null terminators are added.
+void uuid4_repr_batch(size_t n, uuid4_t const *uuids, char (*reprs)[UUID4_REPR_LENGTH]);
+
+/// @brief Parse many version 4 UUIDs from their canonical representations.
+/// @param n The number of representations.
+/// @param out_uuids Mutated to the parsed UUIDs, one per representation.
+/// @param reprs The representations.
+/// @return The number of UUIDs parsed. Parsing stops at the first invalid representation.
+size_t uuid4_parse_batch(size_t n, uuid4_t *out_uuids, char const (*reprs)[UUID4_REPR_LENGTH]);
+
+/// @brief Implementations of UUID parsing and formatting.
+typedef enum {
+    uuid4_impl_scalar, ///< @brief Portable, one digit at a time.
+    uuid4_impl_sse2,   ///< @brief 16 digits at a time. x86 only.
+    uuid4_impl_avx2,   ///< @brief 32 digits at a time. x86 only.
+    uuid4_impl_count,  ///< @brief Number of implementations.
+} uuid4_impl_t;
+
+/// @brief Get the name of a UUID implementation.
+/// @param impl The implementation.
+/// @return A static string.
+char const *uuid4_impl_name(uuid4_impl_t impl);
+
+/// @brief Does the CPU support a UUID implementation?
+/// @param impl The implementation.
+/// @return A boolean indicating whether @p impl can be selected.
+bool uuid4_impl_supported(uuid4_impl_t impl);
+
+/// @brief Get the UUID implementation in use.
+/// @return The selected implementation. Defaults to the fastest one the CPU supports.
+uuid4_impl_t uuid4_impl_current(void);
+
+/// @brief Select the UUID implementation to use.
+/// @param impl The implementation.
+/// @return @c true if @p impl is now in use.
+/// @return @c false if the CPU doesn't support @p impl. The implementation in use is unchanged.
+bool uuid4_impl_select(uuid4_impl_t impl);
+
 /// @brief Put the canonical representation of version 4 UUID.
 /// @param uuid The UUID Version 4 to write.
 /// @param stream The stream to write to.
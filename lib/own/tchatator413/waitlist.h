@@ -0,0 +1,73 @@
+/// @file
+/// @author Raphaël
+/// @brief Wait list - Interface
+///
+/// Holds the connections parked by the @c wait action until their user gets a new message or their deadline passes.
+///
+/// Only bookkeeping is done here: the server polls the parked connections, answers them and closes them.
+/// A waiter is a small fixed-size record, indexed by connection and by user, so notifying a user costs as much as the number of connections they have parked.
+/// Waiters are kept in deadline order; when every wait lasts as long, that is arrival order and parking is constant-time.
+///
+/// @date 18/10/2026
+
+#ifndef WAITLIST_H
+#define WAITLIST_H
+
+#include "tchatator413/types.h"
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/// @brief An opaque handle to a wait list.
+typedef struct waitlist waitlist_t;
+
+/// @brief Create a new, empty wait list.
+/// @param max_waiters The maximum number of connections parked at once.
+/// @return A new wait list.
+/// @return @c NULL if @p max_waiters is @c 0 (waiting disabled).
+waitlist_t *waitlist_init(size_t max_waiters);
+
+/// @brief Destroy a wait list.
+/// @param waitlist The wait list to destroy. No-op if @c NULL.
+/// @remark The connections still parked are not closed: pop them first.
+void waitlist_destroy(waitlist_t *waitlist);
+
+/// @brief Get the number of connections parked.
+/// @param waitlist The wait list. Can be @c NULL.
+/// @return The number of connections parked.
+size_t waitlist_len(waitlist_t const *waitlist);
+
+/// @brief Park a connection.
+/// @param waitlist The wait list. Can be @c NULL, in which case this always fails.
+/// @param fd The connection. Must not be parked already.
+/// @param user_id The user to wait for a message for.
+/// @param deadline_ns When to stop waiting, on the clock of @ref metrics_clock.
+/// @return @c true if the connection was parked.
+/// @return @c false if the wait list is full. The connection must be answered right away.
+bool waitlist_park(waitlist_t *waitlist, int fd, serial_t user_id, uint64_t deadline_ns);
+
+/// @brief Wake the connections waiting for a message for a user.
+/// @param waitlist The wait list. No-op if @c NULL.
+/// @param user_id The user who got a message.
+void waitlist_notify(waitlist_t *waitlist, serial_t user_id);
+
+/// @brief Forget a connection, for instance because the client hung up.
+/// @param waitlist The wait list. No-op if @c NULL.
+/// @param fd The connection.
+/// @return Whether the connection was parked.
+bool waitlist_remove(waitlist_t *waitlist, int fd);
+
+/// @brief Get when the next connection is due to be answered.
+/// @param waitlist The wait list. Can be @c NULL.
+/// @return The earliest deadline, @c 0 if a connection has been woken, or @c UINT64_MAX if none are parked.
+uint64_t waitlist_next_due(waitlist_t const *waitlist);
+
+/// @brief Take a connection whose wait is over out of the wait list. Woken connections come first, in the order they were woken.
+/// @param waitlist The wait list. Can be @c NULL.
+/// @param now_ns The current time, on the clock of @ref metrics_clock.
+/// @param out_fd Assigned to the connection.
+/// @param out_woken Assigned to whether the connection was woken, rather than past its deadline.
+/// @return @c false if no wait is over. @p out_fd and @p out_woken are untouched.
+bool waitlist_pop(waitlist_t *waitlist, uint64_t now_ns, int *out_fd, bool *out_woken);
+
+#endif // WAITLIST_H
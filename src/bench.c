@@ -0,0 +1,492 @@
+/// @file
+/// @author Raphaël
+/// @brief Tchatator413 load generator - Main program
+///
+/// Open-loop: requests are scheduled at a fixed rate whatever the server does, and their latency is measured from the time they were scheduled at, not the time they were sent.
+/// A server that stalls thus delays every request scheduled meanwhile, as it would real clients, rather than silently lowering the load (coordinated omission).
+///
+/// @date 18/10/2026
+
+#include "json-c.h"
+#include "tchatator413/metrics.h"
+#include "util.h"
+#include <arpa/inet.h>
+#include <errno.h>
+#include <getopt.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <time.h>
+#include <unistd.h>
+
+#define BENCH_PROG "tchatator-bench"
+
+#define BENCH_HELP BENCH_PROG " - Tchatator413 load generator\n\
+\n\
+SYNOPSIS\n\
+    " BENCH_PROG " [OPTION]...\n\
+    " BENCH_PROG " --help\n\
+\n\
+DESCRIPTION\n\
+    Sends a mix of requests to a Tchatator413 server at a fixed rate, from the users of the test database,\n\
+    and reports throughput and latency. Latency is measured from the time each request was scheduled at,\n\
+    so a stalling server is not hidden by the generator waiting for it (coordinated omission).\n\
+\n\
+    The server must be run against the test database (make testdb), with rate_limit_m, rate_limit_h and\n\
+    backlog raised above the load, otherwise the turnstile answers most requests. send requests add messages\n\
+    to the database and motd marks them read.\n\
+\n\
+    Mandatory arguments to long options are mandatory for short options too.\n\
+\n\
+    -a, --address=ADDR       Server address (default " DEFAULT_ADDR ")\n\
+    -p, --port=PORT          Server port (default " STR(DEFAULT_PORT) ")\n\
+    -r, --rate=N             Requests per second (default " STR(DEFAULT_RATE) ")\n\
+    -d, --duration=S         Measured seconds (default " STR(DEFAULT_DURATION) ")\n\
+    -w, --warmup=S           Seconds to run before measuring (default " STR(DEFAULT_WARMUP) ")\n\
+    -t, --threads=N          Connections in flight at most (default " STR(DEFAULT_THREADS) ")\n\
+    -m, --mix=MIX            Weights of request kinds (default " DEFAULT_MIX ")\n\
+                             Kinds: whois, send, inbox, motd, batch (whois, inbox and motd in one request)\n\
+    -o, --output=FILE        Save the results as JSON\n\
+    -b, --baseline=FILE      Compare against results saved with --output\n\
+    -x, --max-regression=PCT With --baseline, fail if throughput or a latency quantile is PCT% worse\n\
+    --help                   Show this help"
+
+#define DEFAULT_ADDR "127.0.0.1"
+#define DEFAULT_PORT 4113
+#define DEFAULT_RATE 500
+#define DEFAULT_DURATION 10
+#define DEFAULT_WARMUP 1
+#define DEFAULT_THREADS 16
+#define DEFAULT_MIX "whois=4,send=1,inbox=2,motd=2,batch=1"
+
+/// @brief X-macro that expands to the list of request kinds.
+#define X_KINDS(X) \
+    X(whois)       \
+    X(send)        \
+    X(inbox)       \
+    X(motd)        \
+    X(batch)
+
+typedef enum {
+#define ENUM_VALUE(name) kind_##name,
+    X_KINDS(ENUM_VALUE)
+#undef ENUM_VALUE
+        n_kinds,
+} kind_t;
+
+static char const *const gs_kind_names[] = {
+#define NAME(name) #name,
+    X_KINDS(NAME)
+#undef NAME
+};
+
+/// @brief X-macro that expands to the list of quantiles reported, as (name, quantile).
+#define X_QUANTILES(X) \
+    X(p50, .5)         \
+    X(p99, .99)        \
+    X(p999, .999)
+
+/// @brief The users of the test database, members first.
+static struct {
+    char const *constr, *name;
+} const gs_users[] = {
+    { "123e4567-e89b-12d3-a456-426614174000¤member1_mdp", "member1" },
+    { "9ea59c5b-bb75-4cc9-8f80-77b4ce851a0b¤member2_mdp", "member2" },
+    { "bb1b5a1f-a482-4858-8c6b-f4746481cffa¤pro1_mdp", "pro1 corp" },
+    { "52d43379-8f75-4fbd-8b06-d80a87b2c2b4¤pro2_mdp", "pro2 inc" },
+};
+
+typedef struct {
+    struct sockaddr_in addr;
+    double rate;
+    uint64_t start_ns, warmup_ns, duration_ns;
+    int n_threads;
+    unsigned weights[n_kinds], total_weight;
+} plan_t;
+
+typedef struct {
+    /// @brief Latency from the time requests were scheduled at, by kind.
+    metrics_histogram_t latency[n_kinds];
+    /// @brief Latency from the time requests were sent at, of all kinds.
+    metrics_histogram_t service;
+    uint64_t n_requests, n_ok;
+    /// @brief Number of failed requests, by status. Index 0 counts connection failures.
+    uint64_t n_errors[600];
+} results_t;
+
+typedef struct {
+    plan_t const *plan;
+    int index;
+    results_t results;
+} worker_t;
+
+static void record(metrics_histogram_t *p_histogram, uint64_t duration_ns) {
+    ++p_histogram->count;
+    p_histogram->sum_ns += duration_ns;
+    p_histogram->max_ns = MAX(p_histogram->max_ns, duration_ns);
+    ++p_histogram->buckets[metrics_bucket_of(duration_ns)];
+}
+
+static void merge(metrics_histogram_t *p_into, metrics_histogram_t const *p_from) {
+    p_into->count += p_from->count;
+    p_into->sum_ns += p_from->sum_ns;
+    p_into->max_ns = MAX(p_into->max_ns, p_from->max_ns);
+    for (size_t b = 0; b < METRICS_N_BUCKETS; ++b) p_into->buckets[b] += p_from->buckets[b];
+}
+
+static int put_request(char *buf, size_t size, kind_t kind, unsigned *p_seed) {
+    size_t const u = (size_t)rand_r(p_seed) % array_len(gs_users);
+    char const *constr = gs_users[u].constr;
+    switch (kind) {
+    case kind_whois:
+        return snprintf(buf, size, "{\"do\":\"whois\",\"with\":{\"constr\":\"%s\",\"user\":\"%s\"}}",
+            constr, gs_users[(u + 1) % array_len(gs_users)].name);
+    case kind_send: {
+        // Members may only write to professionals
+        size_t const m = u % 2, p = 2 + (size_t)rand_r(p_seed) % 2;
+        return snprintf(buf, size, "{\"do\":\"send\",\"with\":{\"constr\":\"%s\",\"dest\":\"%s\",\"content\":\"bench\"}}",
+            gs_users[m].constr, gs_users[p].name);
+    }
+    case kind_inbox: return snprintf(buf, size, "{\"do\":\"inbox\",\"with\":{\"constr\":\"%s\"}}", constr);
+    case kind_motd: return snprintf(buf, size, "{\"do\":\"motd\",\"with\":{\"constr\":\"%s\"}}", constr);
+    case kind_batch:
+        return snprintf(buf, size,
+            "[{\"do\":\"whois\",\"with\":{\"constr\":\"%s\",\"user\":\"%s\"}},"
+            "{\"do\":\"inbox\",\"with\":{\"constr\":\"%s\"}},"
+            "{\"do\":\"motd\",\"with\":{\"constr\":\"%s\"}}]",
+            constr, gs_users[(u + 1) % array_len(gs_users)].name, constr, constr);
+    default: unreachable();
+    }
+}
+
+/// @brief Send a request and read the whole response.
+/// @return The length of the response, in @p p_buf.
+/// @return @c -1 on failure.
+static ssize_t roundtrip(struct sockaddr_in const *addr, char const *request, size_t len, char **p_buf, size_t *p_cap) {
+    int const fd = socket(AF_INET, SOCK_STREAM, 0);
+    if (fd == -1) errno_exit("socket");
+    if (connect(fd, (struct sockaddr const *)addr, sizeof *addr) == -1) goto fail;
+    for (size_t sent = 0; sent < len;) {
+        ssize_t const n = send(fd, request + sent, len - sent, MSG_NOSIGNAL);
+        if (n == -1) goto fail;
+        sent += (size_t)n;
+    }
+
+    size_t n_read = 0;
+    ssize_t n;
+    do {
+        if (n_read + 1 >= *p_cap && !(*p_buf = realloc(*p_buf, *p_cap *= 2))) errno_exit("realloc");
+        n = read(fd, *p_buf + n_read, *p_cap - n_read - 1);
+        if (n == -1) goto fail;
+        n_read += (size_t)n;
+    } while (n > 0);
+    (*p_buf)[n_read] = '\0';
+
+    close(fd);
+    return (ssize_t)n_read;
+
+fail:
+    close(fd);
+    return -1;
+}
+
+/// @brief Get the status of the first failed action of a response.
+/// @return The status, or @c 0 if every action succeeded.
+static int failed_status(char const *response) {
+    json_object *jo = json_tokener_parse(response);
+    if (!jo) return 500;
+    int status = 0;
+    for (size_t i = 0; !status && i < json_object_array_length(jo); ++i) {
+        json_object *jo_error, *jo_status;
+        if (json_object_object_get_ex(json_object_array_get_idx(jo, i), "error", &jo_error)) {
+            status = json_object_object_get_ex(jo_error, "status", &jo_status) ? json_object_get_int(jo_status) : 500;
+        }
+    }
+    json_object_put(jo);
+    return status;
+}
+
+static void *run(void *arg) {
+    worker_t *w = arg;
+    plan_t const *plan = w->plan;
+    unsigned seed = (unsigned)w->index + 1;
+
+    size_t cap = BUFSIZ;
+    char *response = malloc(cap);
+    if (!response) errno_exit("malloc");
+    char request[1024];
+
+    // Request i is scheduled at start + i / rate. Worker k sends requests k, k + n_threads, ...
+    for (uint64_t i = (uint64_t)w->index;; i += (uint64_t)plan->n_threads) {
+        uint64_t const intended_ns = plan->start_ns + (uint64_t)((double)i * 1e9 / plan->rate);
+        if (intended_ns >= plan->start_ns + plan->warmup_ns + plan->duration_ns) break;
+
+        kind_t kind = 0;
+        for (unsigned pick = (unsigned)rand_r(&seed) % plan->total_weight; pick >= plan->weights[kind]; ++kind) pick -= plan->weights[kind];
+        int const len = put_request(request, sizeof request, kind, &seed);
+
+        // Late workers send at once: their lateness is part of the latency.
+        struct timespec const at = { .tv_sec = (time_t)(intended_ns / 1000000000), .tv_nsec = (long)(intended_ns % 1000000000) };
+        while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &at, NULL) == EINTR);
+
+        uint64_t const sent_ns = metrics_clock();
+        ssize_t const n = roundtrip(&plan->addr, request, (size_t)len, &response, &cap);
+        uint64_t const done_ns = metrics_clock();
+
+        if (intended_ns < plan->start_ns + plan->warmup_ns) continue;
+
+        results_t *r = &w->results;
+        ++r->n_requests;
+        record(&r->latency[kind], done_ns - intended_ns);
+        record(&r->service, done_ns - sent_ns);
+        int const status = n == -1 ? 0 : failed_status(response);
+        if (n != -1 && !status) {
+            ++r->n_ok;
+        } else {
+            ++r->n_errors[status > 0 && status < (int)array_len(r->n_errors) ? status : 0];
+        }
+    }
+
+    free(response);
+    return NULL;
+}
+
+static bool parse_mix(plan_t *plan, char const *mix) {
+    memset(plan->weights, 0, sizeof plan->weights);
+    plan->total_weight = 0;
+    while (*mix) {
+        size_t const name_len = strcspn(mix, "=");
+        kind_t kind = 0;
+        while (kind < n_kinds && (strlen(gs_kind_names[kind]) != name_len || strncmp(gs_kind_names[kind], mix, name_len))) ++kind;
+        if (kind == n_kinds || mix[name_len] != '=') return false;
+        char *end;
+        unsigned long const weight = strtoul(mix + name_len + 1, &end, 10);
+        if (end == mix + name_len + 1 || *end && *end != ',' || weight > 1000) return false;
+        plan->total_weight += plan->weights[kind] = (unsigned)weight;
+        mix = *end ? end + 1 : end;
+    }
+    return plan->total_weight > 0;
+}
+
+static json_object *histogram_to_json(metrics_histogram_t const *h) {
+    json_object *jo = json_object_new_object();
+    json_object_object_add_ex(jo, "count", json_object_new_int64((int64_t)h->count), JSON_C_OBJECT_ADD_KEY_IS_NEW);
+#define ADD(name, q) json_object_object_add_ex(jo, #name, json_object_new_int64((int64_t)metrics_quantile(h, q)), JSON_C_OBJECT_ADD_KEY_IS_NEW);
+    X_QUANTILES(ADD)
+#undef ADD
+    json_object_object_add_ex(jo, "max", json_object_new_int64((int64_t)h->max_ns), JSON_C_OBJECT_ADD_KEY_IS_NEW);
+    return jo;
+}
+
+static void put_histogram(char const *name, metrics_histogram_t const *h) {
+    printf("%-9s %9lu", name, h->count);
+#define PUT(name, q) printf(" %11.3f", (double)metrics_quantile(h, q) / 1e6);
+    X_QUANTILES(PUT)
+#undef PUT
+    printf(" %11.3f\n", (double)h->max_ns / 1e6);
+}
+
+/// @brief Print the change of a value from the baseline.
+/// @return Whether the value regressed by more than @p max_regression percent.
+static bool put_change(char const *name, double baseline, double current, bool higher_is_better, double max_regression) {
+    double const change = baseline > 0 ? (current - baseline) / baseline * 100 : 0;
+    double const regression = higher_is_better ? -change : change;
+    bool const failed = max_regression >= 0 && regression > max_regression;
+    printf("%-16s %14.3f %14.3f %+8.1f%%%s\n", name, baseline, current, change, failed ? "  REGRESSION" : "");
+    return failed;
+}
+
+/// @brief Compare results against a baseline.
+/// @return Whether a value regressed by more than @p max_regression percent.
+static bool compare(json_object *jo_baseline, json_object *jo_results, double max_regression) {
+    bool failed = false;
+    json_object *jo_b, *jo_c;
+
+    printf("\n%-16s %14s %14s %9s\n", "vs baseline", "baseline", "current", "change");
+    if (json_object_object_get_ex(jo_baseline, "throughput", &jo_b) && json_object_object_get_ex(jo_results, "throughput", &jo_c)) {
+        failed |= put_change("req/s", json_object_get_double(jo_b), json_object_get_double(jo_c), true, max_regression);
+    }
+
+    json_object *jo_latency_b, *jo_latency_c;
+    if (!json_object_object_get_ex(jo_baseline, "latency_ns", &jo_latency_b)
+        || !json_object_object_get_ex(jo_results, "latency_ns", &jo_latency_c)) return failed;
+    json_object_object_foreach(jo_latency_c, kind, jo_h_c) {
+        json_object *jo_h_b;
+        if (!json_object_object_get_ex(jo_latency_b, kind, &jo_h_b)) continue;
+#define PUT(name, q)                                                                                          \
+    if (json_object_object_get_ex(jo_h_b, #name, &jo_b) && json_object_object_get_ex(jo_h_c, #name, &jo_c)) { \
+        char label[32];                                                                                       \
+        snprintf(label, sizeof label, "%s " #name " ms", kind);                                               \
+        failed |= put_change(label, json_object_get_double(jo_b) / 1e6, json_object_get_double(jo_c) / 1e6,   \
+            false, max_regression);                                                                           \
+    }
+        X_QUANTILES(PUT)
+#undef PUT
+    }
+    return failed;
+}
+
+int main(int argc, char **argv) {
+    plan_t plan = {
+        .addr = { .sin_family = AF_INET, .sin_port = htons(DEFAULT_PORT) },
+        .rate = DEFAULT_RATE,
+        .warmup_ns = DEFAULT_WARMUP * 1000000000ull,
+        .duration_ns = DEFAULT_DURATION * 1000000000ull,
+        .n_threads = DEFAULT_THREADS,
+    };
+    plan.addr.sin_addr.s_addr = inet_addr(DEFAULT_ADDR);
+    parse_mix(&plan, DEFAULT_MIX);
+    char const *output = NULL, *baseline = NULL;
+    double max_regression = -1;
+
+    // Arguments
+    {
+        enum {
+            OPT_HELP,
+            OPT_ADDRESS = 'a',
+            OPT_PORT = 'p',
+            OPT_RATE = 'r',
+            OPT_DURATION = 'd',
+            OPT_WARMUP = 'w',
+            OPT_THREADS = 't',
+            OPT_MIX = 'm',
+            OPT_OUTPUT = 'o',
+            OPT_BASELINE = 'b',
+            OPT_MAX_REGRESSION = 'x',
+        };
+        struct option long_options[] = {
+            { .name = "help", .val = OPT_HELP },
+            { .name = "address", .has_arg = required_argument, .val = OPT_ADDRESS },
+            { .name = "port", .has_arg = required_argument, .val = OPT_PORT },
+            { .name = "rate", .has_arg = required_argument, .val = OPT_RATE },
+            { .name = "duration", .has_arg = required_argument, .val = OPT_DURATION },
+            { .name = "warmup", .has_arg = required_argument, .val = OPT_WARMUP },
+            { .name = "threads", .has_arg = required_argument, .val = OPT_THREADS },
+            { .name = "mix", .has_arg = required_argument, .val = OPT_MIX },
+            { .name = "output", .has_arg = required_argument, .val = OPT_OUTPUT },
+            { .name = "baseline", .has_arg = required_argument, .val = OPT_BASELINE },
+            { .name = "max-regression", .has_arg = required_argument, .val = OPT_MAX_REGRESSION },
+            { 0 },
+        };
+
+        int opt;
+        while (-1 != (opt = getopt_long(argc, argv, "a:p:r:d:w:t:m:o:b:x:", long_options, NULL))) {
+            bool ok = true;
+            switch (opt) {
+            case OPT_HELP: puts(BENCH_HELP); return EXIT_SUCCESS;
+            case OPT_ADDRESS: ok = inet_pton(AF_INET, optarg, &plan.addr.sin_addr) == 1; break;
+            case OPT_PORT: {
+                int const port = atoi(optarg);
+                ok = port > 0 && port <= UINT16_MAX;
+                plan.addr.sin_port = htons((uint16_t)port);
+                break;
+            }
+            case OPT_RATE: ok = (plan.rate = atof(optarg)) > 0; break;
+            case OPT_DURATION: ok = (plan.duration_ns = (uint64_t)(atof(optarg) * 1e9)) > 0; break;
+            case OPT_WARMUP: {
+                double const warmup = atof(optarg);
+                ok = warmup >= 0;
+                plan.warmup_ns = (uint64_t)(warmup * 1e9);
+                break;
+            }
+            case OPT_THREADS: ok = (plan.n_threads = atoi(optarg)) > 0; break;
+            case OPT_MIX: ok = parse_mix(&plan, optarg); break;
+            case OPT_OUTPUT: output = optarg; break;
+            case OPT_BASELINE: baseline = optarg; break;
+            case OPT_MAX_REGRESSION: ok = (max_regression = atof(optarg)) >= 0; break;
+            case '?': puts(BENCH_HELP); return EX_USAGE;
+            default: unreachable();
+            }
+            if (!ok) {
+                fprintf(stderr, BENCH_PROG ": invalid argument: %s\n", optarg);
+                return EX_USAGE;
+            }
+        }
+    }
+
+    json_object *jo_baseline = NULL;
+    if (baseline && !(jo_baseline = json_object_from_file(baseline))) {
+        fprintf(stderr, BENCH_PROG ": %s: %s\n", baseline, json_util_get_last_err());
+        return EX_NOINPUT;
+    }
+
+    worker_t *workers = calloc((size_t)plan.n_threads, sizeof *workers);
+    pthread_t *threads = malloc((size_t)plan.n_threads * sizeof *threads);
+    if (!workers || !threads) errno_exit("malloc");
+
+    // Leave the workers time to start before the first request is due
+    plan.start_ns = metrics_clock() + 10000000;
+    for (int i = 0; i < plan.n_threads; ++i) {
+        workers[i].plan = &plan;
+        workers[i].index = i;
+        if ((errno = pthread_create(&threads[i], NULL, run, &workers[i]))) errno_exit("pthread_create");
+    }
+    for (int i = 0; i < plan.n_threads; ++i) pthread_join(threads[i], NULL);
+    uint64_t const end_ns = metrics_clock();
+    free(threads);
+
+    results_t *total = calloc(1, sizeof *total);
+    metrics_histogram_t *all = calloc(1, sizeof *all);
+    if (!total || !all) errno_exit("calloc");
+    for (int i = 0; i < plan.n_threads; ++i) {
+        results_t const *r = &workers[i].results;
+        for (kind_t k = 0; k < n_kinds; ++k) merge(&total->latency[k], &r->latency[k]);
+        merge(&total->service, &r->service);
+        total->n_requests += r->n_requests;
+        total->n_ok += r->n_ok;
+        for (size_t s = 0; s < array_len(total->n_errors); ++s) total->n_errors[s] += r->n_errors[s];
+    }
+    free(workers);
+    for (kind_t k = 0; k < n_kinds; ++k) merge(all, &total->latency[k]);
+
+    // Requests complete after their schedule: measure up to the last completion
+    double const elapsed_s = (double)(end_ns - plan.start_ns - plan.warmup_ns) / 1e9;
+    double const throughput = (double)total->n_requests / elapsed_s;
+
+    printf("target     %.1f req/s for %.1f s, %d threads\n", plan.rate, (double)plan.duration_ns / 1e9, plan.n_threads);
+    printf("achieved   %.1f req/s, %lu requests, %lu ok\n", throughput, total->n_requests, total->n_ok);
+    if (total->n_errors[0]) printf("errors     %lu connection failures\n", total->n_errors[0]);
+    for (size_t s = 1; s < array_len(total->n_errors); ++s) {
+        if (total->n_errors[s]) printf("errors     %lu with status %zu\n", total->n_errors[s], s);
+    }
+    printf("\nlatency (ms, from schedule)\n%-9s %9s", "kind", "count");
+#define PUT(name, q) printf(" %11s", #name);
+    X_QUANTILES(PUT)
+#undef PUT
+    printf(" %11s\n", "max");
+    for (kind_t k = 0; k < n_kinds; ++k) {
+        if (total->latency[k].count) put_histogram(gs_kind_names[k], &total->latency[k]);
+    }
+    put_histogram("all", all);
+    put_histogram("(service)", &total->service);
+
+    json_object *jo_results = json_object_new_object();
+    json_object_object_add_ex(jo_results, "rate", json_object_new_double(plan.rate), JSON_C_OBJECT_ADD_KEY_IS_NEW);
+    json_object_object_add_ex(jo_results, "duration_s", json_object_new_double((double)plan.duration_ns / 1e9), JSON_C_OBJECT_ADD_KEY_IS_NEW);
+    json_object_object_add_ex(jo_results, "threads", json_object_new_int(plan.n_threads), JSON_C_OBJECT_ADD_KEY_IS_NEW);
+    json_object_object_add_ex(jo_results, "throughput", json_object_new_double(throughput), JSON_C_OBJECT_ADD_KEY_IS_NEW);
+    json_object_object_add_ex(jo_results, "requests", json_object_new_int64((int64_t)total->n_requests), JSON_C_OBJECT_ADD_KEY_IS_NEW);
+    json_object_object_add_ex(jo_results, "ok", json_object_new_int64((int64_t)total->n_ok), JSON_C_OBJECT_ADD_KEY_IS_NEW);
+    json_object *jo_latency = json_object_new_object();
+    for (kind_t k = 0; k < n_kinds; ++k) {
+        if (total->latency[k].count) json_object_object_add_ex(jo_latency, gs_kind_names[k], histogram_to_json(&total->latency[k]), JSON_C_OBJECT_ADD_KEY_IS_NEW);
+    }
+    json_object_object_add_ex(jo_latency, "all", histogram_to_json(all), JSON_C_OBJECT_ADD_KEY_IS_NEW);
+    json_object_object_add_ex(jo_results, "latency_ns", jo_latency, JSON_C_OBJECT_ADD_KEY_IS_NEW);
+    json_object_object_add_ex(jo_results, "service_ns", histogram_to_json(&total->service), JSON_C_OBJECT_ADD_KEY_IS_NEW);
+    free(total);
+    free(all);
+
+    int status = EXIT_SUCCESS;
+    if (output && json_object_to_file_ext(output, jo_results, JSON_C_TO_STRING_PRETTY)) {
+        fprintf(stderr, BENCH_PROG ": %s: %s\n", output, json_util_get_last_err());
+        status = EX_CANTCREAT;
+    }
+    if (jo_baseline && compare(jo_baseline, jo_results, max_regression)) status = EXIT_FAILURE;
+
+    json_object_put(jo_baseline);
+    json_object_put(jo_results);
+    return status;
+}
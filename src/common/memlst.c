@@ -3,16 +3,44 @@
 #include "memlst.h"
 #include "json-c.h"
 #include "stb_ds.h"
+#include "util.h"
 #include <assert.h>
+#include <stdalign.h>
+#include <stddef.h>
 #include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
 
-struct memlst {
+/// @brief Capacity of the first arena block.
+#define ARENA_MIN_BLOCK 4096
+/// @brief Capacity past which arena blocks stop doubling.
+#define ARENA_MAX_BLOCK 65536
+/// @brief Alignment of arena allocations.
+#define ARENA_ALIGN alignof(max_align_t)
+
+typedef struct {
     void *ptr;
     dtor_fn dtor;
+} entry_t;
+
+/// @brief A chunk of arena memory.
+typedef struct block {
+    struct block *next;
+    size_t cap, used;
+    alignas(max_align_t) char data[];
+} block_t;
+
+struct memlst {
+    /// @brief Resources to destroy, in order of addition (stb_ds dynamic array).
+    entry_t *entries;
+    /// @brief Arena blocks. Allocations bump @ref current; the blocks after it are empty.
+    block_t *first, *current;
 };
 
 memlst_t *memlst_init() {
-    return NULL;
+    memlst_t *memlst = calloc(1, sizeof *memlst);
+    if (!memlst) errno_exit("calloc");
+    return memlst;
 }
 
 void dtor_json_object(void *jo) {
@@ -21,40 +49,112 @@ void dtor_json_object(void *jo) {
 
 void memlst_destroy(memlst_t **p_memlst FILE_LINE_PARAMS) {
 #ifdef MEMLST_TRACE
-    fprintf(stderr, "%s:%d memlst_destroy(%p)\n", file, line, memlst);
+    fprintf(stderr, "%s:%d memlst_destroy(%p)\n", file, line, (void *)*p_memlst);
 #endif
     memlst_collect(p_memlst FILE_LINE_ARGS);
-    arrfree(*p_memlst);
+    arrfree((*p_memlst)->entries);
+    for (block_t *p_block = (*p_memlst)->first, *next; p_block; p_block = next) {
+        next = p_block->next;
+        free(p_block);
+    }
+    free(*p_memlst);
+    *p_memlst = NULL;
 }
 
 void *memlst_add(memlst_t *restrict *restrict p_memlst, dtor_fn dtor, void *restrict ptr FILE_LINE_PARAMS) {
 #ifdef MEMLST_TRACE
-    fprintf(stderr, "%s:%d memlst_add(%p, dtor=%p, ptr=%p)\n", file, line, memlst, dtor, ptr);
+    fprintf(stderr, "%s:%d memlst_add(%p, dtor=%p, ptr=%p)\n", file, line, (void *)*p_memlst, dtor, ptr);
 #endif
     if (!ptr) return NULL;
 
 #ifndef NDEBUG
-    for (ptrdiff_t i = 0; i < arrlen(*p_memlst); ++i) {
-        assert((*p_memlst)[i].ptr != ptr);
+    for (ptrdiff_t i = 0; i < arrlen((*p_memlst)->entries); ++i) {
+        assert((*p_memlst)->entries[i].ptr != ptr);
     }
 #endif
 
-    arrput(*p_memlst, ((memlst_t) {
-                        .ptr = ptr,
-                        .dtor = dtor,
-                    }));
+    arrput((*p_memlst)->entries, ((entry_t) {
+                                     .ptr = ptr,
+                                     .dtor = dtor,
+                                 }));
     return ptr;
 }
 
-void memlst_collect(memlst_t **p_memlst FILE_LINE_PARAMS) {
+void *memlst_alloc(memlst_t **p_memlst, size_t size) {
+    memlst_t *memlst = *p_memlst;
+    size = (size + ARENA_ALIGN - 1) & ~(ARENA_ALIGN - 1);
+
+    // Bump the current block, or move on to the next one that fits. Blocks only get skipped once per collection.
+    for (block_t *p_block = memlst->current; p_block; p_block = p_block->next) {
+        if (p_block->cap - p_block->used >= size) {
+            memlst->current = p_block;
+            void *ptr = p_block->data + p_block->used;
+            p_block->used += size;
+            return ptr;
+        }
+    }
+
+    // Grow geometrically, so a request needs few blocks. Larger allocations get a block of their own.
+    size_t cap = memlst->current ? MIN(memlst->current->cap * 2, ARENA_MAX_BLOCK) : ARENA_MIN_BLOCK;
+    if (cap < size) cap = size;
+    block_t *p_block = malloc(sizeof *p_block + cap);
+    if (!p_block) errno_exit("malloc");
+    p_block->cap = cap;
+    p_block->used = size;
+
+    // Insert after the current block
+    if (memlst->current) {
+        p_block->next = memlst->current->next;
+        memlst->current->next = p_block;
+    } else {
+        p_block->next = NULL;
+        memlst->first = p_block;
+    }
+    memlst->current = p_block;
+    return p_block->data;
+}
+
+char *memlst_strndup(memlst_t **p_memlst, char const *s, size_t len) {
+    char *copy = memlst_alloc(p_memlst, len + 1);
+    memcpy(copy, s, len);
+    copy[len] = '\0';
+    return copy;
+}
+
+memlst_mark_t memlst_mark(memlst_t const *memlst) {
+    return (memlst_mark_t) {
+        .n_entries = (size_t)arrlen(memlst->entries),
+        .block = memlst->current,
+        .used = memlst->current ? memlst->current->used : 0,
+    };
+}
+
+void memlst_rewind(memlst_t **p_memlst, memlst_mark_t mark FILE_LINE_PARAMS) {
 #ifdef MEMLST_TRACE
-    fprintf(stderr, "%s:%d memlst_collect(%p)\n", file, line, memlst);
+    fprintf(stderr, "%s:%d memlst_rewind(%p, %zu)\n", file, line, (void *)*p_memlst, mark.n_entries);
 #endif
-    for (ptrdiff_t i = 0; i < arrlen(*p_memlst); ++i) {
+    memlst_t *memlst = *p_memlst;
+    for (size_t i = mark.n_entries; i < (size_t)arrlen(memlst->entries); ++i) {
 #ifdef MEMLST_TRACE
-        fprintf(stderr, "  clean %p\n", (*memlst)[i].ptr);
+        fprintf(stderr, "  clean %p\n", memlst->entries[i].ptr);
 #endif
-        (*p_memlst)[i].dtor((*p_memlst)[i].ptr);
+        memlst->entries[i].dtor(memlst->entries[i].ptr);
+    }
+    arrsetlen(memlst->entries, mark.n_entries);
+
+    // Blocks are kept for reuse
+    block_t *p_block = mark.block ? mark.block : memlst->first;
+    if (!p_block) return;
+    memlst->current = p_block;
+    p_block->used = mark.block ? mark.used : 0;
+    for (p_block = p_block->next; p_block; p_block = p_block->next) {
+        p_block->used = 0;
     }
-    arrsetlen(*p_memlst, 0);
+}
+
+void memlst_collect(memlst_t **p_memlst FILE_LINE_PARAMS) {
+#ifdef MEMLST_TRACE
+    fprintf(stderr, "%s:%d memlst_collect(%p)\n", file, line, (void *)*p_memlst);
+#endif
+    memlst_rewind(p_memlst, (memlst_mark_t) { 0 } FILE_LINE_ARGS);
 }
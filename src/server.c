@@ -5,6 +5,7 @@
 
 #include "memlst.h"
 #include "tchatator413/cfg.h"
+#include "tchatator413/json_cache.h"
 #include "tchatator413/tchatator413.h"
 #include "util.h"
 #include <assert.h>
@@ -26,20 +27,20 @@ nc 127.0.0.1 4113 <<< '[]'
 
 int main(int argc, char **argv) {
     int verbosity = 0;
-    bool dump_config = false, interactive = false;
+    bool dump_config = false, interactive = false, config_loaded = false, max_speed = false;
+    char const *replay = NULL;
 
     memlst_t *mem = memlst_init();
 
     cfg_t *cfg = memlst_add(&mem, (dtor_fn)cfg_destroy, cfg_defaults());
 
-    {
-        api_key_t root_api_key;
-        if (!uuid4_parse(&root_api_key, require_env(cfg, "ROOT_API_KEY"))) {
-            cfg_log(cfg, log_error, "invalid ROOT_API_KEY\n");
-            CLEAN_RETURN(mem, EX_USAGE);
-        }
-        cfg_load_root_credentials(cfg, root_api_key, require_env(cfg, "ROOT_PASSWORD"));
+    api_key_t root_api_key;
+    if (!uuid4_parse(&root_api_key, require_env(cfg, "ROOT_API_KEY"))) {
+        cfg_log(cfg, log_error, "invalid ROOT_API_KEY\n");
+        CLEAN_RETURN(mem, EX_USAGE);
     }
+    char const *const root_password = require_env(cfg, "ROOT_PASSWORD");
+    cfg_load_root_credentials(cfg, root_api_key, root_password);
 
     // Arguments
     {
@@ -47,6 +48,8 @@ int main(int argc, char **argv) {
             OPT_HELP,
             OPT_VERSION,
             OPT_DUMP_CONFIG,
+            OPT_REPLAY,
+            OPT_MAX_SPEED,
             OPT_QUIET = 'q',
             OPT_VERBOSE = 'v',
             OPT_INTERACTIVE = 'i',
@@ -65,6 +68,15 @@ int main(int argc, char **argv) {
                 .name = "dump-config",
                 .val = OPT_DUMP_CONFIG,
             },
+            {
+                .name = "replay",
+                .has_arg = required_argument,
+                .val = OPT_REPLAY,
+            },
+            {
+                .name = "max-speed",
+                .val = OPT_MAX_SPEED,
+            },
             {
                 .name = "quiet",
                 .val = OPT_QUIET,
@@ -79,6 +91,7 @@ int main(int argc, char **argv) {
             },
             {
                 .name = "config",
+                .has_arg = required_argument,
                 .val = OPT_CONFIG,
             },
             { 0 },
@@ -96,15 +109,18 @@ int main(int argc, char **argv) {
             case OPT_DUMP_CONFIG:
                 dump_config = true;
                 break;
+            case OPT_REPLAY: replay = optarg; break;
+            case OPT_MAX_SPEED: max_speed = true; break;
             case OPT_QUIET: --verbosity; break;
             case OPT_VERBOSE: ++verbosity; break;
             case OPT_INTERACTIVE: interactive = true; break;
             case OPT_CONFIG:
-                if (cfg) {
+                if (config_loaded) {
                     cfg_log(cfg, log_error, "config already specified by previous argument\n");
                     CLEAN_RETURN(mem, EX_USAGE);
                 }
                 cfg_load_from_file(cfg, optarg);
+                config_loaded = true;
                 break;
             case '?':
                 puts(HELP);
@@ -122,6 +138,8 @@ int main(int argc, char **argv) {
         CLEAN_RETURN(mem, EX_OK);
     }
 
+    cfg_log_start(cfg);
+
     db_t *db = memlst_add(&mem, (dtor_fn)db_destroy,
         db_connect(cfg,
             require_env(cfg, "DB_HOST"),
@@ -131,5 +149,10 @@ int main(int argc, char **argv) {
             require_env(cfg, "DB_PASSWORD")));
     if (!db) CLEAN_RETURN(mem, EX_NODB);
 
-    CLEAN_RETURN(mem, interactive ? tchatator413_run_interactive(cfg, db, argc, argv) : tchatator413_run_socket(cfg, db));
+    json_cache_init((size_t)MAX(cfg_json_cache_size(cfg), 0));
+    atexit(json_cache_destroy);
+
+    CLEAN_RETURN(mem, replay ? tchatator413_run_replay(cfg, db, replay, max_speed, root_api_key, root_password)
+            : interactive    ? tchatator413_run_interactive(cfg, db, argc, argv)
+                             : tchatator413_run_socket(cfg, db));
 }
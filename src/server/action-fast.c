@@ -0,0 +1,415 @@
+/// @file
+/// @author Raphaël
+/// @brief Tchatator413 protocol - Implementation (specialized request parser)
+///
+/// A single-pass parser for the request grammar. It works in two phases:
+///
+/// 1. @ref action_scan validates the whole request and indexes argument values, without modifying the buffer. Anything it doesn't fully understand makes it give up, so the json-c path can produce the exact same response.
+/// 2. @ref action_parse_scanned decodes the arguments of one action in place and fills an @ref action_t whose strings point into the buffer.
+///
+/// @date 18/10/2026
+
+#include "tchatator413/action.h"
+#include "tchatator413/errstatus.h"
+#include "util.h"
+#include <assert.h>
+#include <stdint.h>
+#include <string.h>
+
+static slice_t const gs_arg_keys[] = {
+#define SLICE_VALUE(name) SLICE_CONST(STR(name)),
+    X_ARG_KEYS(SLICE_VALUE)
+#undef SLICE_VALUE
+};
+
+/// @brief A scalar value, still encoded in the request buffer.
+typedef struct {
+    enum {
+        value_none,
+        value_string,
+        value_int,
+    } kind;
+    /// @brief First character after the opening quote of a string.
+    char *val;
+    /// @brief Encoded length of a string.
+    size_t len;
+    /// @brief Length of a string once escapes are decoded.
+    size_t decoded_len;
+    /// @brief Whether a string contains escape sequences.
+    bool escaped;
+    /// @brief Value of an integer.
+    int32_t integer;
+} value_t;
+
+typedef struct {
+    action_type_t type;
+    value_t args[arg_key_count];
+    /// @brief The API key of the @c constr argument, parsed while checking it.
+    uuid4_t api_key;
+} scanned_t;
+
+struct action_scan {
+    size_t n_actions;
+    scanned_t actions[];
+};
+
+typedef struct {
+    char *p;
+    char const *end;
+} cursor_t;
+
+/// @remark Past the end of the buffer, this returns a null character, which is never valid where a token is expected.
+static inline char peek(cursor_t const *c) {
+    return c->p < c->end ? *c->p : '\0';
+}
+
+static inline void skip_ws(cursor_t *c) {
+    while (c->p < c->end && (*c->p == ' ' || *c->p == '\t' || *c->p == '\n' || *c->p == '\r')) ++c->p;
+}
+
+static inline bool eat(cursor_t *c, char token) {
+    skip_ws(c);
+    if (peek(c) != token) return false;
+    ++c->p;
+    return true;
+}
+
+static inline int hex_digit(char c) {
+    if (c >= '0' && c <= '9') return c - '0';
+    if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+    if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+    return -1;
+}
+
+/// @return The code unit, or @c -1 if @p s doesn't start with 4 hex digits.
+static inline int32_t hex4(char const *s, char const *end) {
+    if (end - s < 4) return -1;
+    int32_t unit = 0;
+    for (int i = 0; i < 4; ++i) {
+        int d = hex_digit(s[i]);
+        if (d == -1) return -1;
+        unit = unit << 4 | d;
+    }
+    return unit;
+}
+
+#define is_high_surrogate(unit) ((unit) >= 0xd800 && (unit) < 0xdc00)
+#define is_low_surrogate(unit) ((unit) >= 0xdc00 && (unit) < 0xe000)
+
+static inline size_t utf8_len(int32_t cp) {
+    return cp < 0x80 ? 1 : cp < 0x800 ? 2 : cp < 0x10000 ? 3 : 4;
+}
+
+static bool scan_string(cursor_t *c, value_t *out_value) {
+    if (!eat(c, '"')) return false;
+    *out_value = (value_t) { .kind = value_string, .val = c->p };
+    while (true) {
+        char const ch = peek(c);
+        if (ch == '"') break;
+        // Raw control characters and null bytes (including the end of the buffer) are left to json-c.
+        if ((unsigned char)ch < 0x20) return false;
+        ++c->p;
+        if (ch != '\\') {
+            ++out_value->decoded_len;
+            continue;
+        }
+        out_value->escaped = true;
+        switch (peek(c)) {
+        case '"':
+        case '\\':
+        case '/':
+        case 'b':
+        case 'f':
+        case 'n':
+        case 'r':
+        case 't':
+            ++c->p;
+            ++out_value->decoded_len;
+            break;
+        case 'u': {
+            int32_t unit = hex4(++c->p, c->end);
+            // U+0000 would truncate the string, lone surrogates are replaced by json-c.
+            if (unit <= 0 || is_low_surrogate(unit)) return false;
+            c->p += 4;
+            if (is_high_surrogate(unit)) {
+                if (c->end - c->p < 2 || c->p[0] != '\\' || c->p[1] != 'u') return false;
+                int32_t low = hex4(c->p + 2, c->end);
+                if (!is_low_surrogate(low)) return false;
+                c->p += 6;
+                out_value->decoded_len += 4;
+            } else {
+                out_value->decoded_len += utf8_len(unit);
+            }
+            break;
+        }
+        default: return false;
+        }
+    }
+    out_value->len = (size_t)(c->p - out_value->val);
+    ++c->p;
+    return true;
+}
+
+static bool scan_int(cursor_t *c, value_t *out_value) {
+    bool const negative = peek(c) == '-';
+    if (negative) ++c->p;
+    if (peek(c) < '0' || peek(c) > '9') return false;
+    // Leading zeros are left to json-c.
+    if (peek(c) == '0' && c->end - c->p > 1 && c->p[1] >= '0' && c->p[1] <= '9') return false;
+    int64_t value = 0;
+    while (peek(c) >= '0' && peek(c) <= '9') {
+        value = value * 10 + (*c->p++ - '0');
+        if (value > (int64_t)INT32_MAX + 1) return false;
+    }
+    // Fractions and exponents make a double.
+    if (peek(c) == '.' || peek(c) == 'e' || peek(c) == 'E') return false;
+    if (negative) value = -value;
+    // json-c clamps out of range integers.
+    if (value > INT32_MAX) return false;
+    *out_value = (value_t) { .kind = value_int, .integer = (int32_t)value };
+    return true;
+}
+
+static inline bool scan_value(cursor_t *c, value_t *out_value) {
+    skip_ws(c);
+    return peek(c) == '"' ? scan_string(c, out_value) : scan_int(c, out_value);
+}
+
+static inline bool key_is(value_t const *p_key, slice_t name) {
+    return p_key->len == name.len && memcmp(p_key->val, name.val, name.len) == 0;
+}
+
+static inline bool scan_key(cursor_t *c, value_t *out_key) {
+    return scan_string(c, out_key) && !out_key->escaped && eat(c, ':');
+}
+
+static bool scan_with(cursor_t *c, scanned_t *p_scanned) {
+    if (!eat(c, '{')) return false;
+    if (eat(c, '}')) return true;
+    do {
+        value_t key;
+        if (!scan_key(c, &key)) return false;
+        arg_key_t arg = 0;
+        while (arg < arg_key_count && !key_is(&key, gs_arg_keys[arg])) ++arg;
+        // Unknown and duplicate keys are left to json-c.
+        if (arg == arg_key_count || p_scanned->args[arg].kind != value_none) return false;
+        if (!scan_value(c, &p_scanned->args[arg])) return false;
+    } while (eat(c, ','));
+    return eat(c, '}');
+}
+
+static inline bool arg_is_constr(value_t const *p_value, uuid4_t *out_api_key) {
+    // The API key must be readable as-is: no escapes in the first characters.
+    return p_value->kind == value_string
+        && p_value->len >= UUID4_REPR_LENGTH
+        && !memchr(p_value->val, '\\', UUID4_REPR_LENGTH)
+        && uuid4_parse(out_api_key, p_value->val);
+}
+
+static inline bool arg_is_user(value_t const *p_value) {
+    return p_value->kind == value_int ? p_value->integer > 0
+        : p_value->kind == value_string && p_value->decoded_len <= MAX(EMAIL_LENGTH, PSEUDO_LENGTH);
+}
+
+/// @brief Check that an action has every argument it needs, with valid values.
+/// @remark Errors that can be detected without a database round-trip are left to json-c, so they're reported with the same location and faulty object.
+static bool check_args(scanned_t *p_scanned) {
+    action_desc_t const *p_desc = action_desc_of(p_scanned->type);
+    for (size_t i = 0; i < p_desc->n_args; ++i) {
+        value_t const *p_value = &p_scanned->args[p_desc->args[i].key];
+        if (p_value->kind == value_none) {
+            if (p_desc->args[i].required) return false;
+            continue;
+        }
+        bool valid = false;
+        switch (p_desc->args[i].kind) {
+        case arg_kind_constr: valid = arg_is_constr(p_value, &p_scanned->api_key); break;
+        case arg_kind_user: valid = arg_is_user(p_value); break;
+        case arg_kind_string: valid = p_value->kind == value_string; break;
+        case arg_kind_int: valid = p_value->kind == value_int; break;
+        case arg_kind_page: valid = p_value->kind == value_int && p_value->integer >= 1; break;
+        }
+        if (!valid) return false;
+    }
+    return true;
+}
+
+static bool scan_action(cursor_t *c, scanned_t *out_scanned) {
+    *out_scanned = (scanned_t) { .type = action_type_error };
+    bool has_do = false, has_with = false;
+    if (!eat(c, '{')) return false;
+    do {
+        value_t key;
+        if (!scan_key(c, &key)) return false;
+        if (!has_do && key_is(&key, SLICE_CONST("do"))) {
+            has_do = true;
+            value_t name;
+            skip_ws(c);
+            if (!scan_string(c, &name) || name.escaped) return false;
+            action_desc_t const *p_desc = action_desc_lookup((slice_t) { .len = name.len, .val = name.val });
+            // Unknown actions are left to json-c, which logs them.
+            if (!p_desc) return false;
+            out_scanned->type = p_desc->type;
+        } else if (!has_with && key_is(&key, SLICE_CONST("with"))) {
+            has_with = true;
+            if (!scan_with(c, out_scanned)) return false;
+        } else {
+            return false;
+        }
+    } while (eat(c, ','));
+    return eat(c, '}') && has_do && has_with && check_args(out_scanned);
+}
+
+action_scan_t *action_scan(memlst_t **p_mem, char *buf, size_t len) {
+    cursor_t c = { .p = buf, .end = buf + len };
+    size_t capacity = 1;
+    action_scan_t *scan = memlst_alloc(p_mem, sizeof *scan + capacity * sizeof *scan->actions);
+    scan->n_actions = 0;
+
+    bool const is_array = eat(&c, '[');
+    if (!is_array || !eat(&c, ']')) {
+        do {
+            if (scan->n_actions == capacity) {
+                capacity *= 2;
+                action_scan_t *grown = memlst_alloc(p_mem, sizeof *scan + capacity * sizeof *scan->actions);
+                memcpy(grown, scan, sizeof *scan + scan->n_actions * sizeof *scan->actions);
+                scan = grown;
+            }
+            if (!scan_action(&c, &scan->actions[scan->n_actions++])) return NULL;
+        } while (is_array && eat(&c, ','));
+        if (is_array && !eat(&c, ']')) return NULL;
+    }
+
+    skip_ws(&c);
+    if (c.p != c.end) return NULL;
+
+    return scan;
+}
+
+size_t action_scan_count(action_scan_t const *scan) {
+    return scan->n_actions;
+}
+
+static inline char *put_utf8(char *w, int32_t cp) {
+    if (cp < 0x80) {
+        *w++ = (char)cp;
+    } else if (cp < 0x800) {
+        *w++ = (char)(0xc0 | cp >> 6);
+        *w++ = (char)(0x80 | (cp & 0x3f));
+    } else if (cp < 0x10000) {
+        *w++ = (char)(0xe0 | cp >> 12);
+        *w++ = (char)(0x80 | (cp >> 6 & 0x3f));
+        *w++ = (char)(0x80 | (cp & 0x3f));
+    } else {
+        *w++ = (char)(0xf0 | cp >> 18);
+        *w++ = (char)(0x80 | (cp >> 12 & 0x3f));
+        *w++ = (char)(0x80 | (cp >> 6 & 0x3f));
+        *w++ = (char)(0x80 | (cp & 0x3f));
+    }
+    return w;
+}
+
+/// @brief Decode a string value in place.
+/// @return A null-terminated slice of the buffer. The closing quote is overwritten.
+/// @remark Decoding never makes a string longer, so the write head never overtakes the read head.
+static slice_t decode(value_t const *p_value) {
+    assert(p_value->kind == value_string);
+    char *const val = p_value->val;
+    if (p_value->escaped) {
+        char const *r = val, *const end = val + p_value->len;
+        char *w = val;
+        while (r < end) {
+            if (*r != '\\') {
+                *w++ = *r++;
+                continue;
+            }
+            switch (r[1]) {
+            case 'b': *w++ = '\b'; break;
+            case 'f': *w++ = '\f'; break;
+            case 'n': *w++ = '\n'; break;
+            case 'r': *w++ = '\r'; break;
+            case 't': *w++ = '\t'; break;
+            case 'u': {
+                int32_t cp = hex4(r + 2, end);
+                if (is_high_surrogate(cp)) {
+                    cp = 0x10000 + ((cp - 0xd800) << 10) + (hex4(r + 8, end) - 0xdc00);
+                    r += 6;
+                }
+                w = put_utf8(w, cp);
+                r += 4;
+                break;
+            }
+            default: *w++ = r[1]; // '"', '\\' or '/'
+            }
+            r += 2;
+        }
+        assert((size_t)(w - val) == p_value->decoded_len);
+    }
+    val[p_value->decoded_len] = '\0';
+    return (slice_t) { .len = p_value->decoded_len, .val = val };
+}
+
+#define DELIMITER "¤"
+
+static inline constr_t get_constr(scanned_t const *p_scanned, value_t const *p_value) {
+    slice_t const repr = decode(p_value);
+    constr_t constr;
+    constr.api_key = p_scanned->api_key;
+    constr.password = repr.len >= UUID4_REPR_LENGTH + sizeof DELIMITER - 1
+            && strneq(repr.val + UUID4_REPR_LENGTH, DELIMITER, sizeof DELIMITER - 1)
+        ? repr.val + UUID4_REPR_LENGTH + sizeof DELIMITER - 1
+        : NULL;
+    return constr;
+}
+
+/// @return @ref serial_t The user ID.
+/// @return @ref errstatus_handled An error occured and was handled.
+/// @return @ref errstatus_error Unknown user key.
+static inline serial_t get_user_id(cfg_t *cfg, db_t *db, value_t const *p_value) {
+    if (p_value->kind == value_int) return p_value->integer;
+    char const *email_or_pseudo = decode(p_value).val;
+    return strchr(email_or_pseudo, '@')
+        ? db_get_user_id_by_email(db, cfg, email_or_pseudo)
+        : db_get_user_id_by_name(db, cfg, email_or_pseudo);
+}
+
+action_t action_parse_scanned(memlst_t **p_mem, cfg_t *cfg, db_t *db, action_scan_t const *scan, size_t i) {
+    assert(i < scan->n_actions);
+    scanned_t const *p_scanned = &scan->actions[i];
+    action_desc_t const *p_desc = action_desc_of(p_scanned->type);
+
+    action_t action = { .type = p_scanned->type };
+
+    for (size_t j = 0; j < p_desc->n_args; ++j) {
+        arg_desc_t const *p_arg = &p_desc->args[j];
+        value_t const *p_value = &p_scanned->args[p_arg->key];
+        void *p_field = (char *)&action + p_arg->offset;
+
+        switch (p_arg->kind) {
+        case arg_kind_constr: *(constr_t *)p_field = get_constr(p_scanned, p_value); break;
+        case arg_kind_string: *(slice_t *)p_field = decode(p_value); break;
+        case arg_kind_int: *(int32_t *)p_field = p_value->integer; break;
+        case arg_kind_page: *(page_number_t *)p_field = p_value->kind == value_int ? p_value->integer : 1; break;
+        case arg_kind_user:
+            switch (*(serial_t *)p_field = get_user_id(cfg, db, p_value)) {
+            case errstatus_error:
+                action.type = action_type_error;
+                action.with.error.type = action_error_type_invalid;
+                action.with.error.info.invalid.location = p_arg->location;
+                action.with.error.info.invalid.jo_bad = memlst_add(p_mem, dtor_json_object,
+                    json_object_new_string_len(p_value->val, (int)p_value->decoded_len));
+                action.with.error.info.invalid.reason = "invalid user key";
+                return action;
+            case errstatus_handled:
+                action.type = action_type_error;
+                action.with.error.type = action_error_type_other;
+                action.with.error.info.other.status = status_internal_server_error;
+                return action;
+            default:;
+            }
+            break;
+        }
+    }
+
+    return action;
+}
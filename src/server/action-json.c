@@ -6,6 +6,9 @@
 #include "tchatator413/action.h"
 #include "tchatator413/errstatus.h"
 #include "tchatator413/json-helpers.h"
+#include "tchatator413/json_cache.h"
+#include "tchatator413/json_writer.h"
+#include "tchatator413/metrics.h"
 #include "util.h"
 
 /// @return @ref serial_t The user ID.
@@ -70,88 +73,6 @@ action_t action_parse(memlst_t **p_mem, cfg_t *cfg, db_t *db, json_object const
         return action;                                       \
     } while (0)
 
-#define getarg(jo, key, out_value, json_type, getter)          \
-    do {                                                       \
-        if (!json_object_object_get_ex(jo_with, key, &(jo))) { \
-            fail_missing_key(arg_loc(key));                    \
-        }                                                      \
-        if (!getter(jo, out_value)) {                          \
-            fail_type(arg_loc(key), jo, json_type);            \
-        }                                                      \
-    } while (0)
-
-#define getarg_int(jo, key, out_value) getarg(jo, key, out_value, json_type_int, json_object_get_int_strict)
-#define getarg_int64(jo, key, out_value) getarg(jo, key, out_value, json_type_int, json_object_get_int64_strict)
-#define getarg_string(jo, key, out_value)                          \
-    do {                                                           \
-        if (!json_object_object_get_ex(jo_with, key, &(jo))) {     \
-            fail_missing_key(arg_loc(key));                        \
-        }                                                          \
-        if (!json_object_get_string_strict(jo, out_value)) {       \
-            fail_type(arg_loc(key), jo, json_type_string);         \
-        }                                                          \
-        if (!((out_value)->val = memlst_add(p_mem, free,            \
-                  strndup((out_value)->val, (out_value)->len)))) { \
-            errno_exit("strdup");                                  \
-        }                                                          \
-    } while (0)
-#define DELIMITER "¤"
-#define getarg_constr(jo, key, out_value)                                                 \
-    do {                                                                                  \
-        if (!json_object_object_get_ex(jo_with, key, &(jo))) {                            \
-            fail_missing_key(arg_loc(key));                                               \
-        }                                                                                 \
-        slice_t constr;                                                                   \
-        if (!json_object_get_string_strict(jo, &constr)) {                                \
-            fail_type(arg_loc(key), jo, json_type_string);                                \
-        }                                                                                 \
-        if (!uuid4_parse_slice(&(out_value)->api_key, constr)) {                          \
-            fail_invalid(arg_loc(key), jo, "invalid API key");                            \
-        }                                                                                 \
-        if (constr.len >= UUID4_REPR_LENGTH + sizeof DELIMITER - 1                        \
-            && strneq(constr.val + UUID4_REPR_LENGTH, DELIMITER, sizeof DELIMITER - 1)) { \
-            if (!((out_value)->password = memlst_add(p_mem, free,                          \
-                      strdup(constr.val + UUID4_REPR_LENGTH + sizeof DELIMITER - 1)))) {  \
-                errno_exit("strdup");                                                     \
-            }                                                                             \
-        } else {                                                                          \
-            (out_value)->password = NULL;                                                 \
-        }                                                                                 \
-    } while (0)
-
-#define getarg_user(jo, key, out_value)                                           \
-    do {                                                                          \
-        if (!json_object_object_get_ex(jo_with, key, &(jo))) {                    \
-            fail_missing_key(arg_loc(key));                                       \
-        }                                                                         \
-        switch (*(out_value) = get_user_id(cfg, db, jo)) {                        \
-        case errstatus_error: fail_invalid(arg_loc(key), jo, "invalid user key"); \
-        case errstatus_handled: fail();                                           \
-        default:;                                                                 \
-        }                                                                         \
-    } while (0)
-#define getarg_page(jo, key, out_value)                                \
-    do {                                                               \
-        if (json_object_object_get_ex(jo_with, key, &(jo))) {          \
-            getarg_int(jo, key, out_value);                            \
-            if (*(out_value) < 1) {                                    \
-                fail_invalid(arg_loc(key), jo, "invalid page number"); \
-            }                                                          \
-        } else {                                                       \
-            *(out_value) = 1;                                          \
-        }                                                              \
-    } while (0)
-#define getarg_api_key(jo, get)                                          \
-    do {                                                                 \
-        slice_t api_key_repr;                                            \
-        getarg_string(jo, "api_key", &api_key_repr);                     \
-        if (!uuid4_parse_slice(&action.with.DO.api_key, api_key_repr)) { \
-            fail_invalid(arg_loc("api_key"), jo, "invalid API key");     \
-        }                                                                \
-    } while (0)
-
-#define arg_loc(key) (STR(DO) ".with." key)
-
     json_object *jo_do;
     if (!json_object_object_get_ex(jo, "do", &jo_do)) fail_missing_key("action.do");
 
@@ -161,118 +82,190 @@ action_t action_parse(memlst_t **p_mem, cfg_t *cfg, db_t *db, json_object const
     json_object *jo_with;
     if (!json_object_object_get_ex(jo, "with", &jo_with)) fail_missing_key("action.with");
 
-// this is save because the null terminator of the literal string STR(name) will stop strcmp
-#define action_is(name) streq(STR(name), action_name.val)
-
-#define DO whois
-    if (action_is(DO)) {
-        action.type = ACTION_TYPE(DO);
-        json_object *jo_constr;
-        getarg_constr(jo_constr, "constr", &action.with.DO.constr);
-        json_object *jo_user;
-        getarg_user(jo_user, "user", &action.with.DO.user_id);
-#undef DO
-#define DO send
-    } else if (action_is(DO)) {
-        action.type = ACTION_TYPE(DO);
-        json_object *jo_constr;
-        getarg_constr(jo_constr, "constr", &action.with.DO.constr);
-        json_object *jo_content;
-        getarg_string(jo_content, "content", &action.with.DO.content);
-        json_object *jo_dest;
-        getarg_user(jo_dest, "dest", &action.with.DO.dest_user_id);
-#undef DO
-#define DO motd
-    } else if (action_is(DO)) {
-        action.type = ACTION_TYPE(DO);
-        json_object *jo_constr;
-        getarg_constr(jo_constr, "constr", &action.with.DO.constr);
-#undef DO
-#define DO inbox
-    } else if (action_is(DO)) {
-        action.type = ACTION_TYPE(DO);
-        json_object *jo_constr;
-        getarg_constr(jo_constr, "constr", &action.with.DO.constr);
-        json_object *jo_page;
-        getarg_page(jo_page, "page", &action.with.DO.page);
-#undef DO
-#define DO outbox
-    } else if (action_is(DO)) {
-        action.type = ACTION_TYPE(DO);
-        json_object *jo_constr;
-        getarg_constr(jo_constr, "constr", &action.with.DO.constr);
-        json_object *jo_page;
-        getarg_page(jo_page, "page", &action.with.DO.page);
-#undef DO
-#define DO edit
-    } else if (action_is(DO)) {
-        action.type = ACTION_TYPE(DO);
-        json_object *jo_constr;
-        getarg_constr(jo_constr, "constr", &action.with.DO.constr);
-        json_object *jo_msg_id;
-        getarg_int(jo_msg_id, "msg_id", &action.with.DO.msg_id);
-        json_object *jo_new_content;
-        getarg_string(jo_new_content, "new_content", &action.with.DO.new_content);
-#undef DO
-#define DO rm
-    } else if (action_is(DO)) {
-        action.type = ACTION_TYPE(DO);
-        json_object *jo_constr;
-        getarg_constr(jo_constr, "constr", &action.with.DO.constr);
-        json_object *jo_msg_id;
-        getarg_int(jo_msg_id, "msg_id", &action.with.DO.msg_id);
-#undef DO
-#define DO block
-    } else if (action_is(DO)) {
-        action.type = ACTION_TYPE(DO);
-        json_object *jo_constr;
-        getarg_constr(jo_constr, "constr", &action.with.DO.constr);
-        json_object *jo_user;
-        getarg_user(jo_user, "user", &action.with.DO.user_id);
-#undef DO
-#define DO unblock
-    } else if (action_is(DO)) {
-        action.type = ACTION_TYPE(DO);
-        json_object *jo_constr;
-        getarg_constr(jo_constr, "constr", &action.with.DO.constr);
-        json_object *jo_user;
-        getarg_user(jo_user, "user", &action.with.DO.user_id);
-#undef DO
-#define DO ban
-    } else if (action_is(DO)) {
-        action.type = ACTION_TYPE(DO);
-        json_object *jo_constr;
-        getarg_constr(jo_constr, "constr", &action.with.DO.constr);
-        json_object *jo_user;
-        getarg_user(jo_user, "user", &action.with.DO.user_id);
-#undef DO
-#define DO unban
-    } else if (action_is(DO)) {
-        action.type = ACTION_TYPE(DO);
-        json_object *jo_constr;
-        getarg_constr(jo_constr, "constr", &action.with.DO.constr);
-        json_object *jo_user;
-        getarg_user(jo_user, "user", &action.with.DO.user_id);
-    } else {
+    action_desc_t const *p_desc = action_desc_lookup(action_name);
+    if (!p_desc) {
         cfg_log(cfg, log_error, "unknown action: %s\n", action_name.val);
         fail();
     }
+    action.type = p_desc->type;
+
+#define DELIMITER "¤"
+
+    for (size_t i = 0; i < p_desc->n_args; ++i) {
+        arg_desc_t const *p_arg = &p_desc->args[i];
+        void *p_field = (char *)&action + p_arg->offset;
+
+        json_object *jo_arg;
+        if (!json_object_object_get_ex(jo_with, p_arg->name.val, &jo_arg)) {
+            if (p_arg->required) fail_missing_key(p_arg->location);
+            if (p_arg->kind == arg_kind_page) *(page_number_t *)p_field = 1;
+            continue;
+        }
+
+        switch (p_arg->kind) {
+        case arg_kind_constr: {
+            constr_t *p_constr = p_field;
+            slice_t constr;
+            if (!json_object_get_string_strict(jo_arg, &constr)) fail_type(p_arg->location, jo_arg, json_type_string);
+            if (!uuid4_parse_slice(&p_constr->api_key, constr)) fail_invalid(p_arg->location, jo_arg, "invalid API key");
+            if (constr.len >= UUID4_REPR_LENGTH + sizeof DELIMITER - 1
+                && strneq(constr.val + UUID4_REPR_LENGTH, DELIMITER, sizeof DELIMITER - 1)) {
+                p_constr->password = memlst_strdup(p_mem, constr.val + UUID4_REPR_LENGTH + sizeof DELIMITER - 1);
+            } else {
+                p_constr->password = NULL;
+            }
+            break;
+        }
+        case arg_kind_user:
+            switch (*(serial_t *)p_field = get_user_id(cfg, db, jo_arg)) {
+            case errstatus_error: fail_invalid(p_arg->location, jo_arg, "invalid user key");
+            case errstatus_handled: fail();
+            default:;
+            }
+            break;
+        case arg_kind_string: {
+            slice_t *p_string = p_field;
+            if (!json_object_get_string_strict(jo_arg, p_string)) fail_type(p_arg->location, jo_arg, json_type_string);
+            p_string->val = memlst_strndup(p_mem, p_string->val, p_string->len);
+            break;
+        }
+        case arg_kind_int:
+            if (!json_object_get_int_strict(jo_arg, p_field)) fail_type(p_arg->location, jo_arg, json_type_int);
+            break;
+        case arg_kind_page:
+            if (!json_object_get_int_strict(jo_arg, p_field)) fail_type(p_arg->location, jo_arg, json_type_int);
+            if (*(page_number_t *)p_field < 1) fail_invalid(p_arg->location, jo_arg, "invalid page number");
+            break;
+        }
+    }
 
     return action;
 }
 
 #define add_key(o, k, v) json_object_object_add_ex(o, k, v, JSON_C_OBJECT_ADD_KEY_IS_NEW | JSON_C_OBJECT_KEY_IS_CONSTANT)
 
-static json_object *msg_to_json_object(msg_t msg) {
+static json_object *msg_to_json_object(msg_t const *p_msg) {
+    json_object *jo = json_cache_get_msg(p_msg);
+    if (jo) return jo;
+
+    jo = json_object_new_object();
+    add_key(jo, "msg_id", json_object_new_int(p_msg->id));
+    add_key(jo, "sent_at", json_object_new_int64(p_msg->sent_at));
+    add_key(jo, "content", json_object_new_string(p_msg->content));
+    add_key(jo, "sender", json_object_new_int(p_msg->user_id_sender));
+    add_key(jo, "recipient", json_object_new_int(p_msg->user_id_recipient));
+    if (p_msg->deleted_age) add_key(jo, "deleted_age", json_object_new_int(p_msg->deleted_age));
+    if (p_msg->read_age) add_key(jo, "read_age", json_object_new_int(p_msg->read_age));
+    if (p_msg->edited_age) add_key(jo, "edited_age", json_object_new_int(p_msg->edited_age));
+
+    json_cache_put_msg(p_msg, jo);
+    return jo;
+}
+
+static json_object *user_to_json_object(user_t const *p_user) {
+    json_object *jo = json_cache_get_user(p_user);
+    if (jo) return jo;
+
+    jo = json_object_new_object();
+    add_key(jo, "user_id", json_object_new_int(p_user->id));
+    json_object *jo_role = json_object_new_object();
+    const char *role_key;
+    switch (p_user->role) {
+    case role_admin:
+        role_key = "admin";
+        break;
+    case role_member:
+        role_key = "member";
+        add_key(jo_role, "user_name", json_object_new_string(p_user->member.user_name));
+        break;
+    case role_pro:
+        role_key = "pro";
+        add_key(jo_role, "business_name", json_object_new_string(p_user->pro.business_name));
+        break;
+    default:
+        unreachable();
+    }
+    add_key(jo, role_key, jo_role);
+
+    json_cache_put_user(p_user, jo);
+    return jo;
+}
+
+/// @brief X-macro that expands to the quantiles reported for each latency histogram, as X(key, quantile).
+#define X_QUANTILES(X) \
+    X(p50, .5)         \
+    X(p90, .9)         \
+    X(p99, .99)        \
+    X(p999, .999)
+
+static json_object *stats_to_json_object(metrics_snapshot_t const *p_stats) {
     json_object *jo = json_object_new_object();
-    add_key(jo, "msg_id", json_object_new_int(msg.id));
-    add_key(jo, "sent_at", json_object_new_int64(msg.sent_at));
-    add_key(jo, "content", json_object_new_string(msg.content));
-    add_key(jo, "sender", json_object_new_int(msg.user_id_sender));
-    add_key(jo, "recipient", json_object_new_int(msg.user_id_recipient));
-    if (msg.deleted_age) add_key(jo, "deleted_age", json_object_new_int(msg.deleted_age));
-    if (msg.read_age) add_key(jo, "read_age", json_object_new_int(msg.read_age));
-    if (msg.edited_age) add_key(jo, "edited_age", json_object_new_int(msg.edited_age));
+
+    json_object *jo_actions = json_object_new_object();
+    add_key(jo_actions, "error", json_object_new_int64((int64_t)p_stats->n_actions[action_type_error]));
+#define ADD_ACTION(name) add_key(jo_actions, #name, json_object_new_int64((int64_t)p_stats->n_actions[action_type_##name]));
+    X_ACTIONS(ADD_ACTION)
+#undef ADD_ACTION
+    add_key(jo, "actions", jo_actions);
+
+    json_object *jo_round_trips = json_object_new_object();
+#define ADD_ROUND_TRIPS(type, name)                                                                \
+    {                                                                                              \
+        json_object *jo_action = json_object_new_object();                                         \
+        add_key(jo_action, "sum", json_object_new_int64((int64_t)p_stats->n_round_trips[type]));   \
+        add_key(jo_action, "max", json_object_new_int64((int64_t)p_stats->max_round_trips[type])); \
+        add_key(jo_round_trips, name, jo_action);                                                  \
+    }
+    ADD_ROUND_TRIPS(action_type_error, "error")
+#define ADD_ACTION(name) ADD_ROUND_TRIPS(action_type_##name, #name)
+    X_ACTIONS(ADD_ACTION)
+#undef ADD_ACTION
+#undef ADD_ROUND_TRIPS
+    add_key(jo, "round_trips", jo_round_trips);
+
+    json_object *jo_statuses = json_object_new_object();
+    size_t i_status = 0;
+#define ADD_STATUS(name, code) add_key(jo_statuses, #code, json_object_new_int64((int64_t)p_stats->n_statuses[i_status++]));
+    X_STATUSES(ADD_STATUS)
+#undef ADD_STATUS
+    add_key(jo, "statuses", jo_statuses);
+
+    json_object *jo_latency = json_object_new_object();
+#define ADD_STAGE(name)                                                         \
+    {                                                                           \
+        metrics_histogram_t const *h = &p_stats->latency[metrics_stage_##name]; \
+        json_object *jo_stage = json_object_new_object();                       \
+        add_key(jo_stage, "count", json_object_new_int64((int64_t)h->count));   \
+        add_key(jo_stage, "sum", json_object_new_int64((int64_t)h->sum_ns));    \
+        add_key(jo_stage, "max", json_object_new_int64((int64_t)h->max_ns));    \
+        X_QUANTILES(ADD_QUANTILE)                                               \
+        add_key(jo_latency, #name, jo_stage);                                   \
+    }
+#define ADD_QUANTILE(key, q) add_key(jo_stage, #key, json_object_new_int64((int64_t)metrics_quantile(h, q)));
+    X_METRICS_STAGES(ADD_STAGE)
+#undef ADD_QUANTILE
+#undef ADD_STAGE
+    add_key(jo, "latency_ns", jo_latency);
+
+    json_object *jo_queries = json_object_new_object();
+#define ADD_QUERY(name)                                                           \
+    {                                                                             \
+        metrics_query_stats_t const *q = &p_stats->queries[metrics_query_##name]; \
+        json_object *jo_query = json_object_new_object();                         \
+        add_key(jo_query, "calls", json_object_new_int64((int64_t)q->n_calls));   \
+        add_key(jo_query, "sum", json_object_new_int64((int64_t)q->sum_ns));      \
+        add_key(jo_query, "max", json_object_new_int64((int64_t)q->max_ns));      \
+        add_key(jo_query, "rows", json_object_new_int64((int64_t)q->n_rows));     \
+        add_key(jo_queries, #name, jo_query);                                     \
+    }
+    X_METRICS_QUERIES(ADD_QUERY)
+#undef ADD_QUERY
+    add_key(jo, "queries", jo_queries);
+
+    add_key(jo, "turnstile_rejections", json_object_new_int64((int64_t)p_stats->n_turnstile_rejections));
+    add_key(jo, "bytes_in", json_object_new_int64((int64_t)p_stats->n_bytes_in));
+    add_key(jo, "bytes_out", json_object_new_int64((int64_t)p_stats->n_bytes_out));
+
     return jo;
 }
 
@@ -281,11 +274,9 @@ json_object *response_to_json(response_t const *p_response) {
 
     switch (p_response->type) {
     case action_type_error: {
-        status_t status;
         jo_error = json_object_new_object();
         switch (p_response->body.error.type) {
         case action_error_type_type: {
-            status = status_bad_request;
             json_object *jo_actual = p_response->body.error.info.type.jo_actual;
             json_type actual_type = json_object_get_type(jo_actual);
             char *msg = actual_type == json_type_null
@@ -303,14 +294,12 @@ json_object *response_to_json(response_t const *p_response) {
             break;
         }
         case action_error_type_missing_key: {
-            status = status_bad_request;
             char *msg = strfmt("%s: key missing", p_response->body.error.info.missing_key.location);
             if (msg) add_key(jo_error, "message", json_object_new_string(msg));
             free(msg);
             break;
         }
         case action_error_type_invalid: {
-            status = status_bad_request;
             char *msg = strfmt("%s: %s: %s", p_response->body.error.info.invalid.location,
                 p_response->body.error.info.invalid.reason,
                 json_object_to_json_string(p_response->body.error.info.invalid.jo_bad));
@@ -318,56 +307,40 @@ json_object *response_to_json(response_t const *p_response) {
             free(msg);
             break;
         }
-        case action_error_type_other: {
-            status = p_response->body.error.info.other.status;
+        case action_error_type_other: break;
+        case action_error_type_invariant: {
+            add_key(jo_error, "reason", json_object_new_string(p_response->body.error.info.invariant.name));
             break;
         }
         case action_error_type_rate_limit: {
-            status = status_too_many_requests;
             add_key(jo_error, "next_request_at", json_object_new_int64(p_response->body.error.info.rate_limit.next_request_at));
             break;
         }
         default: unreachable();
         }
-        add_key(jo_error, "status", json_object_new_int(status));
+        add_key(jo_error, "status", json_object_new_int(response_status(p_response)));
         break;
     }
-    case action_type_whois: {
-        jo_body = json_object_new_object();
-        user_t const *p_user = &p_response->body.whois.user;
-        add_key(jo_body, "user_id", json_object_new_int(p_user->id));
-        json_object *jo_role = json_object_new_object();
-        const char *role_key;
-        switch (p_user->role) {
-        case role_admin:
-            role_key = "admin";
-            break;
-        case role_member:
-            role_key = "member";
-            add_key(jo_role, "user_name", json_object_new_string(p_user->member.user_name));
-            break;
-        case role_pro:
-            role_key = "pro";
-            add_key(jo_role, "business_name", json_object_new_string(p_user->pro.business_name));
-            break;
-        default:
-            unreachable();
-        }
-        add_key(jo_body, role_key, jo_body);
+    case action_type_whois:
+        jo_body = user_to_json_object(&p_response->body.whois.user);
         break;
-    }
     case action_type_send:
         jo_body = json_object_new_object();
         add_key(jo_body, "msg_id", json_object_new_int(p_response->body.send.msg_id));
         break;
-    case action_type_motd:
+    case action_type_motd: {
+        jo_body = json_object_new_array();
 
+        for (size_t i = 0; i < p_response->body.motd.n_msgs; ++i) {
+            json_object_array_add(jo_body, msg_to_json_object(&p_response->body.motd.msgs[i]));
+        }
         break;
+    }
     case action_type_inbox: {
         jo_body = json_object_new_array();
 
         for (size_t i = 0; i < p_response->body.inbox.n_msgs; ++i) {
-            json_object_array_add(jo_body, msg_to_json_object(p_response->body.inbox.msgs[i]));
+            json_object_array_add(jo_body, msg_to_json_object(&p_response->body.inbox.msgs[i]));
         }
         break;
     }
@@ -392,6 +365,13 @@ json_object *response_to_json(response_t const *p_response) {
     case action_type_unban:
         // todo
         break;
+    case action_type_stats:
+        jo_body = stats_to_json_object(p_response->body.stats);
+        break;
+    case action_type_wait:
+        jo_body = json_object_new_object();
+        add_key(jo_body, "has_unread", json_object_new_boolean(p_response->body.wait.has_unread));
+        break;
     default: unreachable();
     }
 
@@ -405,3 +385,314 @@ json_object *response_to_json(response_t const *p_response) {
 
     return jo;
 }
+
+static void msg_write(json_writer_t *p_writer, msg_t const *p_msg) {
+    size_t len;
+    char const *fragment = json_cache_get_msg_fragment(p_msg, &len);
+    if (fragment) {
+        json_writer_raw(p_writer, fragment, len);
+        return;
+    }
+    size_t const start = p_writer->len;
+
+    json_writer_lit(p_writer, "{");
+    json_writer_key(p_writer, "msg_id");
+    json_writer_int(p_writer, p_msg->id);
+    json_writer_lit(p_writer, ",");
+    json_writer_key(p_writer, "sent_at");
+    json_writer_int(p_writer, p_msg->sent_at);
+    json_writer_lit(p_writer, ",");
+    json_writer_key(p_writer, "content");
+    json_writer_string(p_writer, p_msg->content);
+    json_writer_lit(p_writer, ",");
+    json_writer_key(p_writer, "sender");
+    json_writer_int(p_writer, p_msg->user_id_sender);
+    json_writer_lit(p_writer, ",");
+    json_writer_key(p_writer, "recipient");
+    json_writer_int(p_writer, p_msg->user_id_recipient);
+    if (p_msg->deleted_age) {
+        json_writer_lit(p_writer, ",");
+        json_writer_key(p_writer, "deleted_age");
+        json_writer_int(p_writer, p_msg->deleted_age);
+    }
+    if (p_msg->read_age) {
+        json_writer_lit(p_writer, ",");
+        json_writer_key(p_writer, "read_age");
+        json_writer_int(p_writer, p_msg->read_age);
+    }
+    if (p_msg->edited_age) {
+        json_writer_lit(p_writer, ",");
+        json_writer_key(p_writer, "edited_age");
+        json_writer_int(p_writer, p_msg->edited_age);
+    }
+    json_writer_lit(p_writer, "}");
+    json_cache_put_msg_fragment(p_msg, p_writer->buf + start, p_writer->len - start);
+}
+
+static void user_write(json_writer_t *p_writer, user_t const *p_user) {
+    size_t len;
+    char const *fragment = json_cache_get_user_fragment(p_user, &len);
+    if (fragment) {
+        json_writer_raw(p_writer, fragment, len);
+        return;
+    }
+    size_t const start = p_writer->len;
+
+    json_writer_lit(p_writer, "{");
+    json_writer_key(p_writer, "user_id");
+    json_writer_int(p_writer, p_user->id);
+    json_writer_lit(p_writer, ",");
+    switch (p_user->role) {
+    case role_admin:
+        json_writer_key(p_writer, "admin");
+        json_writer_lit(p_writer, "{}");
+        break;
+    case role_member:
+        json_writer_key(p_writer, "member");
+        json_writer_lit(p_writer, "{");
+        json_writer_key(p_writer, "user_name");
+        json_writer_string(p_writer, p_user->member.user_name);
+        json_writer_lit(p_writer, "}");
+        break;
+    case role_pro:
+        json_writer_key(p_writer, "pro");
+        json_writer_lit(p_writer, "{");
+        json_writer_key(p_writer, "business_name");
+        json_writer_string(p_writer, p_user->pro.business_name);
+        json_writer_lit(p_writer, "}");
+        break;
+    default:
+        unreachable();
+    }
+    json_writer_lit(p_writer, "}");
+    json_cache_put_user_fragment(p_user, p_writer->buf + start, p_writer->len - start);
+}
+
+/// @brief Append the escaped contents of a null-terminated string, without the surrounding quotes.
+static inline void write_escaped(json_writer_t *p_writer, char const *s) {
+    json_writer_escaped(p_writer, s, strlen(s));
+}
+
+static void error_write(json_writer_t *p_writer, response_t const *p_response) {
+    json_writer_lit(p_writer, "{");
+    switch (p_response->body.error.type) {
+    case action_error_type_type: {
+        json_object *jo_actual = p_response->body.error.info.type.jo_actual;
+        json_type actual_type = json_object_get_type(jo_actual);
+        json_writer_key(p_writer, "message");
+        json_writer_lit(p_writer, "\"");
+        write_escaped(p_writer, p_response->body.error.info.type.location);
+        json_writer_lit(p_writer, ": expected ");
+        write_escaped(p_writer, json_type_to_name(p_response->body.error.info.type.expected));
+        json_writer_lit(p_writer, ", got ");
+        write_escaped(p_writer, json_type_to_name(actual_type));
+        if (actual_type != json_type_null) {
+            json_writer_lit(p_writer, ": ");
+            write_escaped(p_writer, min_json(jo_actual));
+        }
+        json_writer_lit(p_writer, "\",");
+        break;
+    }
+    case action_error_type_missing_key:
+        json_writer_key(p_writer, "message");
+        json_writer_lit(p_writer, "\"");
+        write_escaped(p_writer, p_response->body.error.info.missing_key.location);
+        json_writer_lit(p_writer, ": key missing\",");
+        break;
+    case action_error_type_invalid:
+        json_writer_key(p_writer, "message");
+        json_writer_lit(p_writer, "\"");
+        write_escaped(p_writer, p_response->body.error.info.invalid.location);
+        json_writer_lit(p_writer, ": ");
+        write_escaped(p_writer, p_response->body.error.info.invalid.reason);
+        json_writer_lit(p_writer, ": ");
+        write_escaped(p_writer, json_object_to_json_string(p_response->body.error.info.invalid.jo_bad));
+        json_writer_lit(p_writer, "\",");
+        break;
+    case action_error_type_other:
+        break;
+    case action_error_type_invariant:
+        json_writer_key(p_writer, "reason");
+        json_writer_string(p_writer, p_response->body.error.info.invariant.name);
+        json_writer_lit(p_writer, ",");
+        break;
+    case action_error_type_rate_limit:
+        json_writer_key(p_writer, "next_request_at");
+        json_writer_int(p_writer, p_response->body.error.info.rate_limit.next_request_at);
+        json_writer_lit(p_writer, ",");
+        break;
+    default: unreachable();
+    }
+    json_writer_key(p_writer, "status");
+    json_writer_int(p_writer, response_status(p_response));
+    json_writer_lit(p_writer, "}");
+}
+
+static void stats_write(json_writer_t *p_writer, metrics_snapshot_t const *p_stats) {
+    bool first;
+#define write_int(key, value)                        \
+    do {                                             \
+        if (!first) json_writer_char(p_writer, ','); \
+        first = false;                               \
+        json_writer_key(p_writer, key);              \
+        json_writer_int(p_writer, (int64_t)(value)); \
+    } while (0)
+
+    json_writer_lit(p_writer, "{\"actions\":{");
+    first = true;
+    write_int("error", p_stats->n_actions[action_type_error]);
+#define WRITE_ACTION(name) write_int(#name, p_stats->n_actions[action_type_##name]);
+    X_ACTIONS(WRITE_ACTION)
+#undef WRITE_ACTION
+
+    json_writer_lit(p_writer, "},\"round_trips\":{");
+    bool first_action = true;
+#define WRITE_ROUND_TRIPS(type, name)                       \
+    {                                                       \
+        if (!first_action) json_writer_char(p_writer, ','); \
+        first_action = false;                               \
+        json_writer_key(p_writer, name);                    \
+        json_writer_char(p_writer, '{');                    \
+        first = true;                                       \
+        write_int("sum", p_stats->n_round_trips[type]);     \
+        write_int("max", p_stats->max_round_trips[type]);   \
+        json_writer_char(p_writer, '}');                    \
+    }
+    WRITE_ROUND_TRIPS(action_type_error, "error")
+#define WRITE_ACTION(name) WRITE_ROUND_TRIPS(action_type_##name, #name)
+    X_ACTIONS(WRITE_ACTION)
+#undef WRITE_ACTION
+#undef WRITE_ROUND_TRIPS
+
+    json_writer_lit(p_writer, "},\"statuses\":{");
+    first = true;
+    size_t i_status = 0;
+#define WRITE_STATUS(name, code) write_int(#code, p_stats->n_statuses[i_status++]);
+    X_STATUSES(WRITE_STATUS)
+#undef WRITE_STATUS
+
+    json_writer_lit(p_writer, "},\"latency_ns\":{");
+    bool first_stage = true;
+#define WRITE_STAGE(name)                                                       \
+    {                                                                           \
+        metrics_histogram_t const *h = &p_stats->latency[metrics_stage_##name]; \
+        if (!first_stage) json_writer_char(p_writer, ',');                      \
+        first_stage = false;                                                    \
+        json_writer_key(p_writer, #name);                                       \
+        json_writer_char(p_writer, '{');                                        \
+        first = true;                                                           \
+        write_int("count", h->count);                                           \
+        write_int("sum", h->sum_ns);                                            \
+        write_int("max", h->max_ns);                                            \
+        X_QUANTILES(WRITE_QUANTILE)                                             \
+        json_writer_char(p_writer, '}');                                        \
+    }
+#define WRITE_QUANTILE(key, q) write_int(#key, metrics_quantile(h, q));
+    X_METRICS_STAGES(WRITE_STAGE)
+#undef WRITE_QUANTILE
+#undef WRITE_STAGE
+
+    json_writer_lit(p_writer, "},\"queries\":{");
+    bool first_query = true;
+#define WRITE_QUERY(name)                                                         \
+    {                                                                             \
+        metrics_query_stats_t const *q = &p_stats->queries[metrics_query_##name]; \
+        if (!first_query) json_writer_char(p_writer, ',');                        \
+        first_query = false;                                                      \
+        json_writer_key(p_writer, #name);                                         \
+        json_writer_char(p_writer, '{');                                          \
+        first = true;                                                             \
+        write_int("calls", q->n_calls);                                           \
+        write_int("sum", q->sum_ns);                                              \
+        write_int("max", q->max_ns);                                              \
+        write_int("rows", q->n_rows);                                             \
+        json_writer_char(p_writer, '}');                                          \
+    }
+    X_METRICS_QUERIES(WRITE_QUERY)
+#undef WRITE_QUERY
+
+    json_writer_lit(p_writer, "}");
+    first = false;
+    write_int("turnstile_rejections", p_stats->n_turnstile_rejections);
+    write_int("bytes_in", p_stats->n_bytes_in);
+    write_int("bytes_out", p_stats->n_bytes_out);
+    json_writer_lit(p_writer, "}");
+
+#undef write_int
+}
+
+void response_write(json_writer_t *p_writer, response_t const *p_response) {
+    json_writer_lit(p_writer, "{");
+    if (p_response->has_next_page) json_writer_lit(p_writer, "\"has_next_page\":true");
+
+#define write_top_key(key)                                             \
+    do {                                                               \
+        if (p_response->has_next_page) json_writer_lit(p_writer, ","); \
+        json_writer_key(p_writer, key);                                \
+    } while (0)
+
+    switch (p_response->type) {
+    case action_type_error:
+        write_top_key("error");
+        error_write(p_writer, p_response);
+        break;
+    case action_type_whois:
+        write_top_key("body");
+        user_write(p_writer, &p_response->body.whois.user);
+        break;
+    case action_type_send:
+        write_top_key("body");
+        json_writer_lit(p_writer, "{");
+        json_writer_key(p_writer, "msg_id");
+        json_writer_int(p_writer, p_response->body.send.msg_id);
+        json_writer_lit(p_writer, "}");
+        break;
+    case action_type_motd:
+        write_top_key("body");
+        json_writer_lit(p_writer, "[");
+        for (size_t i = 0; i < p_response->body.motd.n_msgs; ++i) {
+            if (i) json_writer_lit(p_writer, ",");
+            msg_write(p_writer, &p_response->body.motd.msgs[i]);
+        }
+        json_writer_lit(p_writer, "]");
+        break;
+    case action_type_inbox:
+        write_top_key("body");
+        json_writer_lit(p_writer, "[");
+        for (size_t i = 0; i < p_response->body.inbox.n_msgs; ++i) {
+            if (i) json_writer_lit(p_writer, ",");
+            msg_write(p_writer, &p_response->body.inbox.msgs[i]);
+        }
+        json_writer_lit(p_writer, "]");
+        break;
+    case action_type_stats:
+        write_top_key("body");
+        stats_write(p_writer, p_response->body.stats);
+        break;
+    case action_type_wait:
+        write_top_key("body");
+        json_writer_lit(p_writer, "{");
+        json_writer_key(p_writer, "has_unread");
+        if (p_response->body.wait.has_unread) {
+            json_writer_lit(p_writer, "true");
+        } else {
+            json_writer_lit(p_writer, "false");
+        }
+        json_writer_lit(p_writer, "}");
+        break;
+    case action_type_outbox:
+    case action_type_edit:
+    case action_type_rm:
+    case action_type_block:
+    case action_type_unblock:
+    case action_type_ban:
+    case action_type_unban:
+        // No body
+        break;
+    default: unreachable();
+    }
+
+#undef write_top_key
+
+    json_writer_lit(p_writer, "}");
+}
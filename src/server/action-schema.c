@@ -0,0 +1,89 @@
+/// @file
+/// @author Raphaël
+/// @brief Tchatator413 protocol - Implementation (action descriptions)
+/// @date 18/10/2026
+
+#include "tchatator413/action.h"
+#include "util.h"
+#include <assert.h>
+#include <stddef.h>
+#include <string.h>
+
+// The type of the field of each argument kind
+#define ARG_FIELD_TYPE_constr constr_t
+#define ARG_FIELD_TYPE_user serial_t
+#define ARG_FIELD_TYPE_string slice_t
+#define ARG_FIELD_TYPE_int int32_t
+#define ARG_FIELD_TYPE_page page_number_t
+
+#define ARG_DESC(action, _key, _kind, field, _required)  \
+    {                                                    \
+        .key = arg_key_##_key,                           \
+        .name = SLICE_CONST(STR(_key)),                  \
+        .location = STR(action) ".with." STR(_key),      \
+        .kind = arg_kind_##_kind,                        \
+        .required = _required,                           \
+        .offset = offsetof(action_t, with.action.field), \
+    },
+#define CHECK_ARG_FIELD_TYPE(action, key, kind, field, required)                                             \
+    static_assert(_Generic(((action_t *)0)->with.action.field, ARG_FIELD_TYPE_##kind: true, default: false), \
+        STR(action) ".with." STR(key) " has the wrong type for a " STR(kind) " argument");
+
+#define ARGS(name)                                                                \
+    static arg_desc_t const gs_args_##name[] = { X_ARGS_##name(ARG_DESC, name) }; \
+    X_ARGS_##name(CHECK_ARG_FIELD_TYPE, name)
+X_ACTIONS(ARGS)
+#undef ARGS
+
+#define countof(array) (sizeof(array) / sizeof *(array))
+
+static action_desc_t const gs_actions[] = {
+#define ACTION_DESC(_name)                  \
+    [ACTION_TYPE(_name)] = {                \
+        .type = ACTION_TYPE(_name),         \
+        .name = SLICE_CONST(STR(_name)),    \
+        .n_args = countof(gs_args_##_name), \
+        .args = gs_args_##_name,            \
+    },
+    X_ACTIONS(ACTION_DESC)
+#undef ACTION_DESC
+};
+
+// Action names can't be hashed in a constant expression, so the index is built on first use.
+
+/// @brief Number of slots in the index. Must be a power of 2, at least twice the number of actions to keep probe sequences short.
+#define INDEX_SIZE 32
+static_assert(INDEX_SIZE >= 2 * countof(gs_actions), "action index too small");
+
+/// @brief Open-addressed index from name hashes to action types. @ref action_type_error marks an empty slot.
+static action_type_t gs_index[INDEX_SIZE];
+static bool gs_index_built;
+
+/// @remark With the current set of actions, length, first and last characters are enough for each name but @c wait, which collides with @c whois, to get its own slot.
+static inline size_t hash_name(slice_t name) {
+    return (name.len + (unsigned char)name.val[0] + (unsigned char)name.val[name.len - 1]) & (INDEX_SIZE - 1);
+}
+
+static void build_index(void) {
+    for (size_t type = 1; type < countof(gs_actions); ++type) {
+        size_t slot = hash_name(gs_actions[type].name);
+        while (gs_index[slot] != action_type_error) slot = (slot + 1) & (INDEX_SIZE - 1);
+        gs_index[slot] = (action_type_t)type;
+    }
+    gs_index_built = true;
+}
+
+action_desc_t const *action_desc_lookup(slice_t name) {
+    if (!gs_index_built) build_index();
+    if (name.len == 0) return NULL;
+    for (size_t slot = hash_name(name); gs_index[slot] != action_type_error; slot = (slot + 1) & (INDEX_SIZE - 1)) {
+        action_desc_t const *p_desc = &gs_actions[gs_index[slot]];
+        if (p_desc->name.len == name.len && memcmp(p_desc->name.val, name.val, name.len) == 0) return p_desc;
+    }
+    return NULL;
+}
+
+action_desc_t const *action_desc_of(action_type_t type) {
+    assert(type != action_type_error && type < countof(gs_actions));
+    return &gs_actions[type];
+}
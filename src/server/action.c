@@ -5,6 +5,7 @@
 
 #include "tchatator413/action.h"
 #include "tchatator413/db.h"
+#include "tchatator413/metrics.h"
 #include <assert.h>
 #include <limits.h>
 
@@ -19,6 +20,19 @@ response_t response_for_rate_limit(time_t next_request_at) {
     };
 }
 
+status_t response_status(response_t const *p_response) {
+    if (p_response->type != action_type_error) return status_ok;
+    switch (p_response->body.error.type) {
+    case action_error_type_type:
+    case action_error_type_missing_key:
+    case action_error_type_invalid: return status_bad_request;
+    case action_error_type_rate_limit: return status_too_many_requests;
+    case action_error_type_invariant: return status_unprocessable_content;
+    case action_error_type_other: return p_response->body.error.info.other.status;
+    default: unreachable();
+    }
+}
+
 response_t action_evaluate(action_t const *p_action, memlst_t **p_mem, cfg_t *cfg, db_t *db) {
     response_t rep = { 0 };
 
@@ -35,6 +49,7 @@ response_t action_evaluate(action_t const *p_action, memlst_t **p_mem, cfg_t *cf
         rep.type = action_type_error;                        \
         rep.body.error.type = action_error_type_invariant;   \
         rep.body.error.info.invariant.name = invariant_name; \
+        return rep;                                          \
     } while (0)
 
 #define check_role(allowed_roles) \
@@ -91,6 +106,9 @@ response_t action_evaluate(action_t const *p_action, memlst_t **p_mem, cfg_t *cf
         if (user.role & role_pro && (!(dest_role & role_member) || !db_count_msg(db, cfg, p_action->with.DO.dest_user_id, user.id)))
             fail_invariant("pro_responds_client");
 
+        // Refuse blocked senders before any write
+        if (db_is_blocked(db, cfg, user.id, p_action->with.DO.dest_user_id)) fail(status_forbidden);
+
         switch (rep.body.DO.msg_id = db_send_msg(db, cfg, user.id, p_action->with.DO.dest_user_id, p_action->with.DO.content.val)) {
         case errstatus_handled: fail(status_internal_server_error);
         case errstatus_error: fail(status_forbidden);
@@ -108,6 +126,9 @@ response_t action_evaluate(action_t const *p_action, memlst_t **p_mem, cfg_t *cf
         default: check_role(role_all);
         }
 
+        if (errstatus_ok != db_get_motd(db, p_mem, cfg, cfg_page_motd(cfg), user.id, &rep.body.DO, &rep.has_next_page)) {
+            fail(status_internal_server_error);
+        }
         break;
 #undef DO
 #define DO inbox
@@ -134,14 +155,37 @@ response_t action_evaluate(action_t const *p_action, memlst_t **p_mem, cfg_t *cf
         break;
 #undef DO
 #define DO edit
-    case ACTION_TYPE(DO):
+    case ACTION_TYPE(DO): {
         switch (db_verify_user_constr(db, cfg, &user, p_action->with.DO.constr)) {
         case errstatus_handled: fail(status_internal_server_error);
         case errstatus_error: fail(status_unauthorized);
         default: check_role(role_all);
         }
 
+        // if message length is greater than maximum
+        if (p_action->with.DO.new_content.len > cfg_max_msg_length(cfg)) fail(status_payload_too_large);
+
+        msg_t msg = { .id = p_action->with.DO.msg_id };
+        switch (db_get_msg(db, p_mem, cfg, &msg)) {
+        case errstatus_handled: fail(status_internal_server_error);
+        case errstatus_error: fail(status_not_found);
+        default:;
+        }
+        if (msg.deleted_age) fail(status_not_found);
+
+        // if user is not admin and not the sender of the message
+        if (!(user.role & role_admin) && msg.user_id_sender != user.id) fail_invariant("owns_msg");
+
+        if (db_is_blocked(db, cfg, user.id, msg.user_id_recipient)) fail(status_forbidden);
+
+        switch (db_edit_msg(db, cfg, p_action->with.DO.msg_id, p_action->with.DO.new_content.val)) {
+        case errstatus_handled: fail(status_internal_server_error);
+        case errstatus_error: fail(status_not_found);
+        default:;
+        }
+
         break;
+    }
 #undef DO
 #define DO rm
     case ACTION_TYPE(DO):
@@ -159,46 +203,155 @@ response_t action_evaluate(action_t const *p_action, memlst_t **p_mem, cfg_t *cf
 
         break;
 #undef DO
+#define check_target_is_client(target_id)                       \
+    switch (db_get_user_role(db, cfg, target_id)) {             \
+    case errstatus_handled: fail(status_internal_server_error); \
+    case errstatus_error: fail(status_not_found);               \
+    case role_member: break;                                    \
+    default: fail_invariant("target_is_client");                \
+    }
+
 #define DO block
-    case ACTION_TYPE(DO):
+    case ACTION_TYPE(DO): {
         switch (db_verify_user_constr(db, cfg, &user, p_action->with.DO.constr)) {
         case errstatus_handled: fail(status_internal_server_error);
         case errstatus_error: fail(status_unauthorized);
         default: check_role(role_admin | role_pro);
         }
 
+        serial_t const scope = user.role & role_admin ? BLOCK_SCOPE_GLOBAL : user.id;
+        check_target_is_client(p_action->with.DO.user_id);
+
+        switch (db_get_block(db, cfg, scope, p_action->with.DO.user_id)) {
+        case errstatus_handled: fail(status_internal_server_error);
+        case 0: break;
+        default: fail_invariant("target_not_blocked");
+        }
+
+        switch (db_block(db, cfg, scope, p_action->with.DO.user_id, false)) {
+        case errstatus_handled: fail(status_internal_server_error);
+        case errstatus_error: fail(status_not_found);
+        default:;
+        }
+
         break;
+    }
 #undef DO
 #define DO unblock
-    case ACTION_TYPE(DO):
+    case ACTION_TYPE(DO): {
         switch (db_verify_user_constr(db, cfg, &user, p_action->with.DO.constr)) {
         case errstatus_handled: fail(status_internal_server_error);
         case errstatus_error: fail(status_unauthorized);
         default: check_role(role_admin | role_pro);
         }
 
+        serial_t const scope = user.role & role_admin ? BLOCK_SCOPE_GLOBAL : user.id;
+        switch (db_get_user_role(db, cfg, p_action->with.DO.user_id)) {
+        case errstatus_handled: fail(status_internal_server_error);
+        case errstatus_error: fail(status_not_found);
+        default:;
+        }
+
+        switch (db_unblock(db, cfg, scope, p_action->with.DO.user_id, false)) {
+        case errstatus_handled: fail(status_internal_server_error);
+        // The administrator may lift blocks that aren't theirs: having none to lift is fine.
+        case errstatus_error:
+            if (scope != BLOCK_SCOPE_GLOBAL) fail_invariant("target_blocked");
+            break;
+        default:;
+        }
+
         break;
+    }
 #undef DO
 #define DO ban
-    case ACTION_TYPE(DO):
+    case ACTION_TYPE(DO): {
         switch (db_verify_user_constr(db, cfg, &user, p_action->with.DO.constr)) {
         case errstatus_handled: fail(status_internal_server_error);
         case errstatus_error: fail(status_unauthorized);
         default: check_role(role_admin | role_pro);
         }
 
+        serial_t const scope = user.role & role_admin ? BLOCK_SCOPE_GLOBAL : user.id;
+        check_target_is_client(p_action->with.DO.user_id);
+
+        // A block can be turned into a ban
+        switch (db_get_block(db, cfg, scope, p_action->with.DO.user_id)) {
+        case errstatus_handled: fail(status_internal_server_error);
+        case BLOCK_FOREVER: fail_invariant("target_not_banned");
+        default:;
+        }
+
+        switch (db_block(db, cfg, scope, p_action->with.DO.user_id, true)) {
+        case errstatus_handled: fail(status_internal_server_error);
+        case errstatus_error: fail(status_not_found);
+        default:;
+        }
+
         break;
+    }
 #undef DO
 #define DO unban
-    case ACTION_TYPE(DO):
+    case ACTION_TYPE(DO): {
         switch (db_verify_user_constr(db, cfg, &user, p_action->with.DO.constr)) {
         case errstatus_handled: fail(status_internal_server_error);
         case errstatus_error: fail(status_unauthorized);
         default: check_role(role_admin | role_pro);
         }
 
+        serial_t const scope = user.role & role_admin ? BLOCK_SCOPE_GLOBAL : user.id;
+        switch (db_get_user_role(db, cfg, p_action->with.DO.user_id)) {
+        case errstatus_handled: fail(status_internal_server_error);
+        case errstatus_error: fail(status_not_found);
+        default:;
+        }
+
+        switch (db_unblock(db, cfg, scope, p_action->with.DO.user_id, true)) {
+        case errstatus_handled: fail(status_internal_server_error);
+        // The administrator may lift bans that aren't theirs: having none to lift is fine.
+        case errstatus_error:
+            if (scope != BLOCK_SCOPE_GLOBAL) fail_invariant("target_banned");
+            break;
+        default:;
+        }
+
         break;
     }
+#undef DO
+#undef check_target_is_client
+#define DO stats
+    case ACTION_TYPE(DO):
+        switch (db_verify_user_constr(db, cfg, &user, p_action->with.DO.constr)) {
+        case errstatus_handled: fail(status_internal_server_error);
+        case errstatus_error: fail(status_unauthorized);
+        default:;
+        }
+
+        // Reserved to root: the registry reveals the activity of every user.
+        if (user.id != 0) fail(status_forbidden);
+
+        rep.body.DO = memlst_alloc(p_mem, sizeof *rep.body.DO);
+        metrics_snapshot(rep.body.DO);
+        break;
+#undef DO
+#define DO wait
+    case ACTION_TYPE(DO):
+        switch (db_verify_user_constr(db, cfg, &user, p_action->with.DO.constr)) {
+        case errstatus_handled: fail(status_internal_server_error);
+        case errstatus_error: fail(status_unauthorized);
+        default: check_role(role_all);
+        }
+
+        // Answered right away here. The server parks the connection when there is nothing unread yet.
+        switch (db_has_unread(db, cfg, user.id)) {
+        case errstatus_handled: fail(status_internal_server_error);
+        case errstatus_error: rep.body.DO.has_unread = false; break;
+        default: rep.body.DO.has_unread = true;
+        }
+        rep.body.DO.user_id = user.id;
+        break;
+#undef DO
+    }
 
     return rep;
 }
@@ -247,6 +400,12 @@ void action_explain(action_t const *action, FILE *output) {
     case action_type_unban:
         fprintf(output, "unban\n");
         break;
+    case action_type_stats:
+        fprintf(output, "stats\n");
+        break;
+    case action_type_wait:
+        fprintf(output, "wait\n");
+        break;
     }
 }
 #endif // NDEBUG
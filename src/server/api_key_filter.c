@@ -0,0 +1,79 @@
+/// @file
+/// @author Raphaël
+/// @brief API key filter - Implementation
+/// @date 18/10/2026
+
+#include "tchatator413/api_key_filter.h"
+#include "util.h"
+#include <math.h>
+#include <stdint.h>
+#include <string.h>
+#include <time.h>
+
+/// @brief Maximum number of hash functions. Past this, lookups get slower for a negligible gain.
+#define MAX_HASHES 16
+
+struct api_key_filter {
+    uint64_t mask; ///< @brief Number of bits - 1. The number of bits is a power of 2.
+    uint64_t seed;
+    int n_hashes;
+    uint64_t bits[];
+};
+
+/// @brief splitmix64 finalizer.
+static inline uint64_t mix64(uint64_t x) {
+    x ^= x >> 30;
+    x *= 0xbf58476d1ce4e5b9;
+    x ^= x >> 27;
+    x *= 0x94d049bb133111eb;
+    x ^= x >> 31;
+    return x;
+}
+
+/// @brief Compute the two base hashes of a key. The i-th hash is @c h1+i*h2 (Kirsch-Mitzenmacher).
+static inline void hash_key(api_key_filter_t const *filter, uuid4_t api_key, uint64_t *out_h1, uint64_t *out_h2) {
+    uint64_t lo, hi;
+    memcpy(&lo, api_key.data, sizeof lo);
+    memcpy(&hi, api_key.data + sizeof lo, sizeof hi);
+    // API keys are random, but whoever chooses the keys we test shouldn't be able to aim for set bits.
+    *out_h1 = mix64(lo ^ filter->seed);
+    *out_h2 = mix64(hi ^ *out_h1) | 1; // odd, so all probes are distinct
+}
+
+api_key_filter_t *api_key_filter_init(size_t n_keys, double fp_rate) {
+    if (!(fp_rate > 0 && fp_rate < 1)) return NULL;
+    n_keys = MAX(n_keys, 1);
+
+    // Optimal sizing: m = -n ln(p) / ln(2)^2 bits, k = -log2(p) hashes
+    double const ideal_bits = -(double)n_keys * log(fp_rate) / (M_LN2 * M_LN2);
+    uint64_t n_bits = 64;
+    while (n_bits < ideal_bits) n_bits <<= 1;
+
+    api_key_filter_t *filter = calloc(1, sizeof *filter + n_bits / 64 * sizeof *filter->bits);
+    if (!filter) errno_exit("calloc");
+    filter->mask = n_bits - 1;
+    filter->n_hashes = (int)MIN(MAX(lround(-log2(fp_rate)), 1), MAX_HASHES);
+    filter->seed = mix64((uint64_t)time(NULL) ^ (uint64_t)(uintptr_t)filter);
+    return filter;
+}
+
+void api_key_filter_destroy(api_key_filter_t *filter) {
+    free(filter);
+}
+
+void api_key_filter_add(api_key_filter_t *filter, uuid4_t api_key) {
+    uint64_t h1, h2;
+    hash_key(filter, api_key, &h1, &h2);
+    for (int i = 0; i < filter->n_hashes; ++i, h1 += h2) {
+        filter->bits[(h1 & filter->mask) / 64] |= UINT64_C(1) << (h1 % 64);
+    }
+}
+
+bool api_key_filter_may_contain(api_key_filter_t const *filter, uuid4_t api_key) {
+    uint64_t h1, h2;
+    hash_key(filter, api_key, &h1, &h2);
+    for (int i = 0; i < filter->n_hashes; ++i, h1 += h2) {
+        if (!(filter->bits[(h1 & filter->mask) / 64] & UINT64_C(1) << (h1 % 64))) return false;
+    }
+    return true;
+}
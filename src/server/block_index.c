@@ -0,0 +1,60 @@
+/// @file
+/// @author Raphaël
+/// @brief Block index - Implementation
+/// @date 18/10/2026
+
+#include "tchatator413/block_index.h"
+#include "stb_ds.h"
+#include "util.h"
+
+typedef struct {
+    uint64_t key; ///< @brief Scope in the high half, member ID in the low half.
+    time_t value; ///< @brief Expiry time.
+} block_entry;
+
+struct block_index {
+    block_entry *blocks;
+};
+
+static inline uint64_t block_key(serial_t scope, serial_t member_id) {
+    return (uint64_t)(uint32_t)scope << 32 | (uint32_t)member_id;
+}
+
+block_index_t *block_index_init(void) {
+    block_index_t *index = calloc(1, sizeof *index);
+    if (!index) errno_exit("calloc");
+    return index;
+}
+
+void block_index_destroy(block_index_t *index) {
+    if (!index) return;
+    hmfree(index->blocks);
+    free(index);
+}
+
+void block_index_clear(block_index_t *index) {
+    hmfree(index->blocks);
+}
+
+void block_index_set(block_index_t *index, serial_t scope, serial_t member_id, time_t expires_at) {
+    hmput(index->blocks, block_key(scope, member_id), expires_at);
+}
+
+void block_index_unset(block_index_t *index, serial_t scope, serial_t member_id) {
+    (void)hmdel(index->blocks, block_key(scope, member_id));
+}
+
+time_t block_index_get(block_index_t *index, serial_t scope, serial_t member_id, time_t now) {
+    uint64_t const key = block_key(scope, member_id);
+    ptrdiff_t const i = hmgeti(index->blocks, key);
+    if (i == -1) return 0;
+    if (index->blocks[i].value > now) return index->blocks[i].value;
+    // Expired blocks are forgotten lazily
+    (void)hmdel(index->blocks, key);
+    return 0;
+}
+
+bool block_index_is_blocked(block_index_t *index, serial_t sender_id, serial_t recipient_id, time_t now) {
+    return block_index_get(index, BLOCK_SCOPE_GLOBAL, sender_id, now)
+        || block_index_get(index, recipient_id, sender_id, now);
+}
@@ -0,0 +1,239 @@
+/// @file
+/// @author Raphaël
+/// @brief Request capture - Implementation
+/// @date 18/10/2026
+
+#include "tchatator413/capture.h"
+#include <errno.h>
+#include <fcntl.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+#include <sys/random.h>
+#include <time.h>
+#include <unistd.h>
+
+/// @brief Version of the format, written in session headers.
+#define FORMAT_VERSION 1
+/// @brief Magic number that starts session headers. Its first byte is not a valid record tag.
+#define MAGIC "\xffT413CP"
+#define TAG_REQUEST 'R'
+#define TAG_DROPPED 'D'
+/// @brief Length of the header of a request record: tag, timestamp and length.
+#define RECORD_HEADER_LEN (1 + 8 + 4)
+/// @brief Maximum length of a captured request. The server reads at most this much.
+#define REQUEST_MAX BUFSIZ
+/// @brief Minimum capacity of a ring, so records are never truncated.
+#define RING_MIN (2 * (RECORD_HEADER_LEN + REQUEST_MAX))
+
+#define DELIMITER "¤"
+#define DELIMITER_ESCAPED "\\u00a4"
+
+struct capture {
+    logger_t *logger;
+    int fd;
+    char *filename, *filename_rotated;
+    size_t max_size, size, ring_size;
+    log_overflow_t overflow;
+    uint64_t key;
+    api_key_t root_api_key;
+};
+
+/// @brief Mix a value (splitmix64).
+static inline uint64_t mix(uint64_t x) {
+    x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9;
+    x = (x ^ (x >> 27)) * 0x94d049bb133111eb;
+    return x ^ (x >> 31);
+}
+
+static inline int64_t now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_REALTIME, &ts);
+    return (int64_t)ts.tv_sec * 1000000000 + ts.tv_nsec;
+}
+
+static size_t fmt_dropped(char *buf, size_t size, size_t n_dropped) {
+    char rec[1 + 8 + 8], *p = rec;
+    *p++ = TAG_DROPPED;
+    int64_t const at_ns = now_ns();
+    uint64_t const n = n_dropped;
+    memcpy(p, &at_ns, sizeof at_ns);
+    memcpy(p + sizeof at_ns, &n, sizeof n);
+    size_t const len = MIN(sizeof rec, size);
+    memcpy(buf, rec, len);
+    return len;
+}
+
+/// @brief Open the file and start writing to it.
+static bool start(capture_t *capture) {
+    capture->fd = open(capture->filename, O_WRONLY | O_CREAT | O_APPEND | O_CLOEXEC, 0644);
+    if (capture->fd == -1) return false;
+    char header[sizeof MAGIC] = MAGIC;
+    header[sizeof MAGIC - 1] = FORMAT_VERSION;
+    if (write(capture->fd, header, sizeof header) != (ssize_t)sizeof header) {
+        close(capture->fd);
+        return false;
+    }
+    off_t const size = lseek(capture->fd, 0, SEEK_END);
+    capture->size = size < 0 ? sizeof header : (size_t)size;
+    capture->logger = logger_start(capture->fd, MAX(capture->ring_size, RING_MIN), capture->overflow, fmt_dropped);
+    return true;
+}
+
+static void stop(capture_t *capture) {
+    logger_stop(capture->logger);
+    close(capture->fd);
+}
+
+capture_t *capture_open(char const *filename, size_t max_size, size_t ring_size, log_overflow_t overflow, api_key_t root_api_key) {
+    capture_t *capture = malloc(sizeof *capture);
+    if (!capture) errno_exit("malloc");
+    if (!(capture->filename = strdup(filename))) errno_exit("strdup");
+    if (!(capture->filename_rotated = strfmt("%s.1", filename))) errno_exit("strfmt");
+    capture->max_size = max_size;
+    capture->ring_size = ring_size;
+    capture->overflow = overflow;
+    capture->root_api_key = root_api_key;
+    if (getrandom(&capture->key, sizeof capture->key, 0) != sizeof capture->key) errno_exit("getrandom");
+
+    if (!start(capture)) {
+        int const err = errno;
+        free(capture->filename);
+        free(capture->filename_rotated);
+        free(capture);
+        errno = err;
+        return NULL;
+    }
+    return capture;
+}
+
+void capture_close(capture_t *capture) {
+    if (!capture) return;
+    stop(capture);
+    free(capture->filename);
+    free(capture->filename_rotated);
+    free(capture);
+}
+
+/// @brief Start a new file, keeping the current one as the rotated file.
+static void rotate(capture_t *capture) {
+    stop(capture);
+    // If the file can't be renamed, keep appending to it rather than retrying on every request.
+    if (rename(capture->filename, capture->filename_rotated)) capture->max_size = 0;
+    if (!start(capture)) errno_exit("capture: open");
+}
+
+void capture_request(capture_t *capture, char const *buf, size_t len) {
+    if (!capture) return;
+    len = MIN(len, REQUEST_MAX);
+
+    char rec[RECORD_HEADER_LEN + REQUEST_MAX], *p = rec;
+    *p++ = TAG_REQUEST;
+    int64_t const at_ns = now_ns();
+    memcpy(p, &at_ns, sizeof at_ns);
+    p += sizeof at_ns + sizeof(uint32_t);
+    memcpy(p, buf, len);
+    uint32_t const pseudonymized_len = (uint32_t)capture_pseudonymize(p, len, capture->key, capture->root_api_key);
+    memcpy(rec + 1 + sizeof at_ns, &pseudonymized_len, sizeof pseudonymized_len);
+
+    size_t const rec_len = RECORD_HEADER_LEN + pseudonymized_len;
+    logger_write(capture->logger, rec, rec_len);
+    if ((capture->size += rec_len) >= capture->max_size && capture->max_size) rotate(capture);
+}
+
+/// @brief Derive the pseudonym of an API key.
+static api_key_t pseudonym(api_key_t api_key, uint64_t key) {
+    uint64_t lo, hi;
+    memcpy(&lo, api_key.data, sizeof lo);
+    memcpy(&hi, api_key.data + sizeof lo, sizeof hi);
+    uint64_t const a = mix(mix(lo ^ key) ^ hi), b = mix(a ^ key);
+    api_key_t p;
+    memcpy(p.data, &a, sizeof a);
+    memcpy(p.data + sizeof a, &b, sizeof b);
+    // Still looks like a version 4 UUID
+    p.data[6] = (uint8_t)(p.data[6] & 0x0f) | 0x40;
+    p.data[8] = (uint8_t)(p.data[8] & 0x3f) | 0x80;
+    return p;
+}
+
+/// @brief Get the length of the credential delimiter at some position, or @c 0 if there is none.
+static inline size_t delimiter_len(char const *s, size_t len) {
+    if (len >= sizeof DELIMITER - 1 && !memcmp(s, DELIMITER, sizeof DELIMITER - 1)) return sizeof DELIMITER - 1;
+    if (len >= sizeof DELIMITER_ESCAPED - 1 && !strncasecmp(s, DELIMITER_ESCAPED, sizeof DELIMITER_ESCAPED - 1)) return sizeof DELIMITER_ESCAPED - 1;
+    return 0;
+}
+
+/// @brief Pseudonymize a string in place if it is exactly an API key.
+static inline void pseudonymize_key(char *str, size_t str_len, uint64_t key, api_key_t root_api_key) {
+    api_key_t api_key;
+    if (str_len == UUID4_REPR_LENGTH && uuid4_parse(&api_key, str)) {
+        uuid4_repr(uuid4_eq(api_key, root_api_key) ? (api_key_t) { 0 } : pseudonym(api_key, key), str);
+    }
+}
+
+size_t capture_pseudonymize(char *buf, size_t len, uint64_t key, api_key_t root_api_key) {
+    // Read at r, write at w <= r.
+    size_t r = 0, w = 0, str_start = 0;
+    bool in_str = false;
+    while (r < len) {
+        if (!in_str) {
+            if (buf[r] == '"') {
+                in_str = true;
+                str_start = w + 1;
+            }
+            buf[w++] = buf[r++];
+            continue;
+        }
+        if (buf[r] == '"') {
+            // A constr can be a bare API key.
+            pseudonymize_key(buf + str_start, w - str_start, key, root_api_key);
+            in_str = false;
+            buf[w++] = buf[r++];
+            continue;
+        }
+        size_t const dlen = delimiter_len(buf + r, len - r);
+        if (!dlen) {
+            if (buf[r] == '\\' && r + 1 < len) buf[w++] = buf[r++];
+            buf[w++] = buf[r++];
+            continue;
+        }
+
+        pseudonymize_key(buf + str_start, w - str_start, key, root_api_key);
+        // The delimiter is never shorter than its unescaped form.
+        memcpy(buf + w, DELIMITER, sizeof DELIMITER - 1);
+        w += sizeof DELIMITER - 1;
+        r += dlen;
+        // Drop the password
+        while (r < len && buf[r] != '"') r += buf[r] == '\\' ? 2 : 1;
+        r = MIN(r, len);
+    }
+    return w;
+}
+
+bool capture_read(FILE *file, capture_record_t *p_record) {
+    int tag;
+    while ((tag = getc(file)) == (unsigned char)MAGIC[0]) {
+        char header[sizeof MAGIC - 1];
+        if (fread(header, sizeof header, 1, file) != 1 || memcmp(header, MAGIC + 1, sizeof MAGIC - 2) || header[sizeof header - 1] != FORMAT_VERSION) return false;
+    }
+
+    if (fread(&p_record->at_ns, sizeof p_record->at_ns, 1, file) != 1) return false;
+    switch (tag) {
+    case TAG_REQUEST: {
+        uint32_t len;
+        if (fread(&len, sizeof len, 1, file) != 1) return false;
+        if (len + 1 > p_record->cap) {
+            p_record->cap = len + 1;
+            if (!(p_record->buf = realloc(p_record->buf, p_record->cap))) errno_exit("realloc");
+        }
+        if (len && fread(p_record->buf, len, 1, file) != 1) return false;
+        p_record->buf[p_record->len = len] = '\0';
+        p_record->n_dropped = 0;
+        return true;
+    }
+    case TAG_DROPPED:
+        p_record->len = 0;
+        return fread(&p_record->n_dropped, sizeof p_record->n_dropped, 1, file) == 1;
+    default: return false;
+    }
+}
@@ -4,7 +4,10 @@
 /// @date 29/01/2025
 
 #include "tchatator413/cfg.h"
+#include "tchatator413/evlog.h"
 #include "tchatator413/json-helpers.h"
+#include "tchatator413/logger.h"
+#include "tchatator413/trace.h"
 #include "tchatator413/uuid.h"
 #include "util.h"
 #include <bcrypt/bcrypt.h>
@@ -18,14 +21,41 @@
 
 struct cfg {
     FILE *log_file;
+    logger_t *logger; ///< @remark @c NULL until @ref cfg_log_start is called, logging is synchronous until then.
+    size_t log_buffer_size;
+    log_overflow_t log_overflow;
+    evlog_t *evlog; ///< @remark @c NULL until @ref cfg_log_start is called, or if there is no event log.
+    char *event_log_file_name;
+    tracer_t *tracer; ///< @remark @c NULL until @ref cfg_log_start is called, or if tracing is disabled.
+    char *trace_file_name;
+    int trace_threshold_ms;
+    int slow_query_ms; ///< @remark @c -1 if the slow query log is disabled.
+    capture_t *capture; ///< @remark @c NULL until @ref cfg_log_start is called, or if capture is disabled.
+    char *capture_file_name;
+    size_t capture_max_size;
+    char *profile_file_name; ///< @remark @c NULL if the profiler is disabled.
+    int profile_hz;
+    int profile_seconds;
     size_t max_msg_length;
     int page_inbox;
     int page_outbox;
+    int page_motd;
+    int wait_timeout;
+    int max_waiters;
     int rate_limit_m;
     int rate_limit_h;
     int block_for;
     int backlog;
     uint16_t port;
+    uint16_t metrics_port; ///< @remark @c 0 if the metrics listener is disabled or on a Unix socket.
+    char *metrics_socket_path; ///< @remark @c NULL unless the metrics listener is on a Unix socket.
+    int user_cache_size;
+    int user_cache_ttl;
+    int user_cache_negative_ttl;
+    int inbox_cache_recipients;
+    double api_key_filter_fp_rate;
+    int api_key_filter_rebuild_interval;
+    int json_cache_size;
     char *log_file_name; ///< @remark Can be @c NULL if log_file is a standard stream.
     int verbosity;
     uuid4_t root_api_key;
@@ -43,17 +73,21 @@ char const *require_env(cfg_t *cfg, char const *name) {
     return value;
 }
 
+static inline char const *lvl_prefix(log_lvl_t lvl) {
+    switch (lvl) {
+    case log_error: return "error: ";
+    case log_warning: return "warning: ";
+    case log_info: return "info: ";
+    case log_debug: return "debug: ";
+    }
+    unreachable();
+}
+
 static inline void i_vlog(char const *file, int line, FILE *stream, log_lvl_t lvl, char const *fmt, va_list ap) {
     time_t t = time(NULL);
     char timestr[32];
     strftime(timestr, sizeof timestr, "%F %H:%M:%S", localtime(&t));
-    fprintf(stream, "%s:%s:%d: ", timestr, file, line);
-    switch (lvl) {
-    case log_error: fputs("error: ", stream); break;
-    case log_warning: fputs("warning: ", stream); break;
-    case log_info: fputs("info: ", stream); break;
-    case log_debug: fputs("debug: ", stream); break;
-    }
+    fprintf(stream, "%s:%s:%d: %s", timestr, file, line, lvl_prefix(lvl));
     vfprintf(stream, fmt, ap);
 }
 
@@ -87,6 +121,21 @@ cfg_t *cfg_defaults(void) {
 
     p_cfg->log_file = STD_LOG_STREAM;
     p_cfg->log_file_name = NULL;
+    p_cfg->logger = NULL;
+    p_cfg->log_buffer_size = 1 << 20;
+    p_cfg->log_overflow = log_overflow_drop;
+    p_cfg->evlog = NULL;
+    p_cfg->event_log_file_name = NULL;
+    p_cfg->tracer = NULL;
+    p_cfg->trace_file_name = NULL;
+    p_cfg->trace_threshold_ms = 100;
+    p_cfg->slow_query_ms = 100;
+    p_cfg->capture = NULL;
+    p_cfg->capture_file_name = NULL;
+    p_cfg->capture_max_size = 64 << 20;
+    p_cfg->profile_file_name = NULL;
+    p_cfg->profile_hz = 99;
+    p_cfg->profile_seconds = 30;
     p_cfg->verbosity = 0;
 
     p_cfg->backlog = 1;
@@ -94,9 +143,21 @@ cfg_t *cfg_defaults(void) {
     p_cfg->max_msg_length = 1000;
     p_cfg->page_inbox = 20;
     p_cfg->page_outbox = 20;
+    p_cfg->page_motd = 20;
+    p_cfg->wait_timeout = 30;
+    p_cfg->max_waiters = 1000;
     p_cfg->port = 4113;
+    p_cfg->metrics_port = 0;
+    p_cfg->metrics_socket_path = NULL;
     p_cfg->rate_limit_h = 90;
     p_cfg->rate_limit_m = 12;
+    p_cfg->user_cache_size = 4096;
+    p_cfg->user_cache_ttl = 300;
+    p_cfg->user_cache_negative_ttl = 10;
+    p_cfg->inbox_cache_recipients = 1024;
+    p_cfg->api_key_filter_fp_rate = 0.01;
+    p_cfg->api_key_filter_rebuild_interval = 3600;
+    p_cfg->json_cache_size = 4096;
     return p_cfg;
 }
 
@@ -109,6 +170,15 @@ void cfg_load_root_credentials(cfg_t *cfg, uuid4_t root_api_key, const char *roo
 
 void cfg_destroy(cfg_t *cfg) {
     if (!cfg) return;
+    evlog_close(cfg->evlog);
+    free(cfg->event_log_file_name);
+    tracer_close(cfg->tracer);
+    free(cfg->trace_file_name);
+    capture_close(cfg->capture);
+    free(cfg->capture_file_name);
+    free(cfg->profile_file_name);
+    free(cfg->metrics_socket_path);
+    logger_stop(cfg->logger);
     if (cfg->log_file && cfg->log_file != STD_LOG_STREAM) fclose(cfg->log_file);
     free(cfg->log_file_name);
     free(cfg);
@@ -135,6 +205,107 @@ void cfg_load_from_file(cfg_t *cfg, char const *filename) {
             errno_exit("strndup");
         }
     }
+    if (json_object_object_get_ex(jo_cfg, "log_buffer_size", &jo)) {
+        int64_t log_buffer_size;
+        if (!json_object_get_int64_strict(jo, &log_buffer_size)) {
+            log(STD_LOG_STREAM, log_error, INTRO LOG_FMT_JSON_TYPE(json_type_int, json_object_get_type(jo), "log_buffer_size"));
+        } else if (log_buffer_size < 0) {
+            log(STD_LOG_STREAM, log_error, INTRO "log_buffer_size: must be >= 0\n");
+        } else {
+            cfg->log_buffer_size = (size_t)log_buffer_size;
+        }
+    }
+    if (json_object_object_get_ex(jo_cfg, "log_overflow", &jo)) {
+        if (!json_object_is_type(jo, json_type_string)) {
+            log(STD_LOG_STREAM, log_error, INTRO LOG_FMT_JSON_TYPE(json_type_string, json_object_get_type(jo), "log_overflow"));
+        } else if (streq(json_object_get_string(jo), "drop")) {
+            cfg->log_overflow = log_overflow_drop;
+        } else if (streq(json_object_get_string(jo), "block")) {
+            cfg->log_overflow = log_overflow_block;
+        } else {
+            log(STD_LOG_STREAM, log_error, INTRO "log_overflow: must be \"drop\" or \"block\"\n");
+        }
+    }
+    if (json_object_object_get_ex(jo_cfg, "event_log_file", &jo) && !json_object_is_type(jo, json_type_null)) {
+        if (!json_object_is_type(jo, json_type_string)) {
+            log(STD_LOG_STREAM, log_error, INTRO LOG_FMT_JSON_TYPE(json_type_string, json_object_get_type(jo), "event_log_file"));
+        } else if (!(cfg->event_log_file_name = strdup(json_object_get_string(jo)))) {
+            errno_exit("strdup");
+        }
+    }
+    if (json_object_object_get_ex(jo_cfg, "trace_file", &jo) && !json_object_is_type(jo, json_type_null)) {
+        if (!json_object_is_type(jo, json_type_string)) {
+            log(STD_LOG_STREAM, log_error, INTRO LOG_FMT_JSON_TYPE(json_type_string, json_object_get_type(jo), "trace_file"));
+        } else if (!(cfg->trace_file_name = strdup(json_object_get_string(jo)))) {
+            errno_exit("strdup");
+        }
+    }
+    if (json_object_object_get_ex(jo_cfg, "trace_threshold_ms", &jo)) {
+        int trace_threshold_ms;
+        if (!json_object_get_int_strict(jo, &trace_threshold_ms)) {
+            log(STD_LOG_STREAM, log_error, INTRO LOG_FMT_JSON_TYPE(json_type_int, json_object_get_type(jo), "trace_threshold_ms"));
+        } else if (trace_threshold_ms < 0) {
+            log(STD_LOG_STREAM, log_error, INTRO "trace_threshold_ms: must be >= 0\n");
+        } else {
+            cfg->trace_threshold_ms = trace_threshold_ms;
+        }
+    }
+    if (json_object_object_get_ex(jo_cfg, "slow_query_ms", &jo)) {
+        int slow_query_ms;
+        if (json_object_is_type(jo, json_type_null)) {
+            cfg->slow_query_ms = -1;
+        } else if (!json_object_get_int_strict(jo, &slow_query_ms)) {
+            log(STD_LOG_STREAM, log_error, INTRO LOG_FMT_JSON_TYPE(json_type_int, json_object_get_type(jo), "slow_query_ms"));
+        } else if (slow_query_ms < 0) {
+            log(STD_LOG_STREAM, log_error, INTRO "slow_query_ms: must be >= 0\n");
+        } else {
+            cfg->slow_query_ms = slow_query_ms;
+        }
+    }
+    if (json_object_object_get_ex(jo_cfg, "capture_file", &jo) && !json_object_is_type(jo, json_type_null)) {
+        if (!json_object_is_type(jo, json_type_string)) {
+            log(STD_LOG_STREAM, log_error, INTRO LOG_FMT_JSON_TYPE(json_type_string, json_object_get_type(jo), "capture_file"));
+        } else if (!(cfg->capture_file_name = strdup(json_object_get_string(jo)))) {
+            errno_exit("strdup");
+        }
+    }
+    if (json_object_object_get_ex(jo_cfg, "capture_max_size", &jo)) {
+        int64_t capture_max_size;
+        if (!json_object_get_int64_strict(jo, &capture_max_size)) {
+            log(STD_LOG_STREAM, log_error, INTRO LOG_FMT_JSON_TYPE(json_type_int, json_object_get_type(jo), "capture_max_size"));
+        } else if (capture_max_size < 0) {
+            log(STD_LOG_STREAM, log_error, INTRO "capture_max_size: must be >= 0\n");
+        } else {
+            cfg->capture_max_size = (size_t)capture_max_size;
+        }
+    }
+    if (json_object_object_get_ex(jo_cfg, "profile_file", &jo) && !json_object_is_type(jo, json_type_null)) {
+        if (!json_object_is_type(jo, json_type_string)) {
+            log(STD_LOG_STREAM, log_error, INTRO LOG_FMT_JSON_TYPE(json_type_string, json_object_get_type(jo), "profile_file"));
+        } else if (!(cfg->profile_file_name = strdup(json_object_get_string(jo)))) {
+            errno_exit("strdup");
+        }
+    }
+    if (json_object_object_get_ex(jo_cfg, "profile_hz", &jo)) {
+        int profile_hz;
+        if (!json_object_get_int_strict(jo, &profile_hz)) {
+            log(STD_LOG_STREAM, log_error, INTRO LOG_FMT_JSON_TYPE(json_type_int, json_object_get_type(jo), "profile_hz"));
+        } else if (profile_hz < 1 || profile_hz > 10000) {
+            log(STD_LOG_STREAM, log_error, INTRO "profile_hz: must be between 1 and 10000\n");
+        } else {
+            cfg->profile_hz = profile_hz;
+        }
+    }
+    if (json_object_object_get_ex(jo_cfg, "profile_seconds", &jo)) {
+        int profile_seconds;
+        if (!json_object_get_int_strict(jo, &profile_seconds)) {
+            log(STD_LOG_STREAM, log_error, INTRO LOG_FMT_JSON_TYPE(json_type_int, json_object_get_type(jo), "profile_seconds"));
+        } else if (profile_seconds < 1) {
+            log(STD_LOG_STREAM, log_error, INTRO "profile_seconds: must be >= 1\n");
+        } else {
+            cfg->profile_seconds = profile_seconds;
+        }
+    }
     if (json_object_object_get_ex(jo_cfg, "backlog", &jo) && !json_object_get_int_strict(jo, &cfg->backlog)) {
         log(STD_LOG_STREAM, log_error, INTRO LOG_FMT_JSON_TYPE(json_type_int, json_object_get_type(jo), "backlog"));
     }
@@ -158,15 +329,91 @@ void cfg_load_from_file(cfg_t *cfg, char const *filename) {
     if (json_object_object_get_ex(jo_cfg, "page_outbox", &jo) && !json_object_get_int_strict(jo, &cfg->page_outbox)) {
         log(STD_LOG_STREAM, log_error, INTRO LOG_FMT_JSON_TYPE(json_type_int, json_object_get_type(jo), "page_outbox"));
     }
+    if (json_object_object_get_ex(jo_cfg, "page_motd", &jo)) {
+        int page_motd;
+        if (!json_object_get_int_strict(jo, &page_motd)) {
+            log(STD_LOG_STREAM, log_error, INTRO LOG_FMT_JSON_TYPE(json_type_int, json_object_get_type(jo), "page_motd"));
+        } else if (page_motd < 1) {
+            log(STD_LOG_STREAM, log_error, INTRO "page_motd: must be at least 1\n");
+        } else {
+            cfg->page_motd = page_motd;
+        }
+    }
+    if (json_object_object_get_ex(jo_cfg, "wait_timeout", &jo)) {
+        int wait_timeout;
+        if (!json_object_get_int_strict(jo, &wait_timeout)) {
+            log(STD_LOG_STREAM, log_error, INTRO LOG_FMT_JSON_TYPE(json_type_int, json_object_get_type(jo), "wait_timeout"));
+        } else if (wait_timeout < 0) {
+            log(STD_LOG_STREAM, log_error, INTRO "wait_timeout: must be positive or zero\n");
+        } else {
+            cfg->wait_timeout = wait_timeout;
+        }
+    }
+    if (json_object_object_get_ex(jo_cfg, "max_waiters", &jo)) {
+        int max_waiters;
+        if (!json_object_get_int_strict(jo, &max_waiters)) {
+            log(STD_LOG_STREAM, log_error, INTRO LOG_FMT_JSON_TYPE(json_type_int, json_object_get_type(jo), "max_waiters"));
+        } else if (max_waiters < 0) {
+            log(STD_LOG_STREAM, log_error, INTRO "max_waiters: must be positive or zero\n");
+        } else {
+            cfg->max_waiters = max_waiters;
+        }
+    }
     if (json_object_object_get_ex(jo_cfg, "port", &jo) && !json_object_get_uint16_strict(jo, &cfg->port)) {
         log(STD_LOG_STREAM, log_error, INTRO LOG_FMT_JSON_TYPE(json_type_int, json_object_get_type(jo), "port"));
     }
+    if (json_object_object_get_ex(jo_cfg, "metrics_listen", &jo)) {
+        switch (json_object_get_type(jo)) {
+        case json_type_null: break;
+        case json_type_int:
+            if (!json_object_get_uint16_strict(jo, &cfg->metrics_port) || !cfg->metrics_port) {
+                log(STD_LOG_STREAM, log_error, INTRO "metrics_listen: must be a port between 1 and 65535, a socket path or null\n");
+            }
+            break;
+        case json_type_string:
+            if (!(cfg->metrics_socket_path = strdup(json_object_get_string(jo)))) errno_exit("strdup");
+            break;
+        default:
+            log(STD_LOG_STREAM, log_error, INTRO "metrics_listen: must be a port between 1 and 65535, a socket path or null\n");
+        }
+    }
     if (json_object_object_get_ex(jo_cfg, "rate_limit_h", &jo) && !json_object_get_int_strict(jo, &cfg->rate_limit_h)) {
         log(STD_LOG_STREAM, log_error, INTRO LOG_FMT_JSON_TYPE(json_type_int, json_object_get_type(jo), "rate_limit_h"));
     }
     if (json_object_object_get_ex(jo_cfg, "rate_limit_m", &jo) && !json_object_get_int_strict(jo, &cfg->rate_limit_m)) {
         log(STD_LOG_STREAM, log_error, INTRO LOG_FMT_JSON_TYPE(json_type_int, json_object_get_type(jo), "rate_limit_m"));
     }
+    if (json_object_object_get_ex(jo_cfg, "user_cache_size", &jo) && !json_object_get_int_strict(jo, &cfg->user_cache_size)) {
+        log(STD_LOG_STREAM, log_error, INTRO LOG_FMT_JSON_TYPE(json_type_int, json_object_get_type(jo), "user_cache_size"));
+    }
+    if (json_object_object_get_ex(jo_cfg, "user_cache_ttl", &jo) && !json_object_get_int_strict(jo, &cfg->user_cache_ttl)) {
+        log(STD_LOG_STREAM, log_error, INTRO LOG_FMT_JSON_TYPE(json_type_int, json_object_get_type(jo), "user_cache_ttl"));
+    }
+    if (json_object_object_get_ex(jo_cfg, "user_cache_negative_ttl", &jo) && !json_object_get_int_strict(jo, &cfg->user_cache_negative_ttl)) {
+        log(STD_LOG_STREAM, log_error, INTRO LOG_FMT_JSON_TYPE(json_type_int, json_object_get_type(jo), "user_cache_negative_ttl"));
+    }
+    if (json_object_object_get_ex(jo_cfg, "inbox_cache_recipients", &jo) && !json_object_get_int_strict(jo, &cfg->inbox_cache_recipients)) {
+        log(STD_LOG_STREAM, log_error, INTRO LOG_FMT_JSON_TYPE(json_type_int, json_object_get_type(jo), "inbox_cache_recipients"));
+    }
+    if (json_object_object_get_ex(jo_cfg, "api_key_filter_fp_rate", &jo)) {
+        json_type const type = json_object_get_type(jo);
+        if (type != json_type_double && type != json_type_int) {
+            log(STD_LOG_STREAM, log_error, INTRO LOG_FMT_JSON_TYPE(json_type_double, type, "api_key_filter_fp_rate"));
+        } else {
+            double const fp_rate = json_object_get_double(jo);
+            if (fp_rate < 0 || fp_rate >= 1) {
+                log(STD_LOG_STREAM, log_error, INTRO "api_key_filter_fp_rate: must be >= 0 and < 1\n");
+            } else {
+                cfg->api_key_filter_fp_rate = fp_rate;
+            }
+        }
+    }
+    if (json_object_object_get_ex(jo_cfg, "api_key_filter_rebuild_interval", &jo) && !json_object_get_int_strict(jo, &cfg->api_key_filter_rebuild_interval)) {
+        log(STD_LOG_STREAM, log_error, INTRO LOG_FMT_JSON_TYPE(json_type_int, json_object_get_type(jo), "api_key_filter_rebuild_interval"));
+    }
+    if (json_object_object_get_ex(jo_cfg, "json_cache_size", &jo) && !json_object_get_int_strict(jo, &cfg->json_cache_size)) {
+        log(STD_LOG_STREAM, log_error, INTRO LOG_FMT_JSON_TYPE(json_type_int, json_object_get_type(jo), "json_cache_size"));
+    }
 
     json_object_put(jo_cfg);
 }
@@ -176,12 +423,44 @@ void cfg_dump(cfg_t const *cfg) {
     printf("backlog         %d\n", cfg->backlog);
     printf("block_for       %d seconds\n", cfg->block_for);
     printf("log_file        %s\n", COALESCE(cfg->log_file_name, "-"));
+    printf("log_buffer_size %zu bytes\n", cfg->log_buffer_size);
+    printf("log_overflow    %s\n", cfg->log_overflow == log_overflow_block ? "block" : "drop");
+    printf("event_log_file  %s\n", COALESCE(cfg->event_log_file_name, "(none)"));
+    printf("trace_file      %s\n", COALESCE(cfg->trace_file_name, "(none)"));
+    printf("trace_threshold_ms %d ms\n", cfg->trace_threshold_ms);
+    if (cfg->slow_query_ms < 0) {
+        printf("slow_query_ms   (none)\n");
+    } else {
+        printf("slow_query_ms   %d ms\n", cfg->slow_query_ms);
+    }
+    printf("capture_file    %s\n", COALESCE(cfg->capture_file_name, "(none)"));
+    printf("capture_max_size %zu bytes\n", cfg->capture_max_size);
+    printf("profile_file    %s\n", COALESCE(cfg->profile_file_name, "(none)"));
+    printf("profile_hz      %d Hz\n", cfg->profile_hz);
+    printf("profile_seconds %d seconds\n", cfg->profile_seconds);
     printf("max_msg_length  %zu characters\n", cfg->max_msg_length);
     printf("page_inbox      %d\n", cfg->page_inbox);
     printf("page_outbox     %d\n", cfg->page_outbox);
+    printf("page_motd       %d\n", cfg->page_motd);
+    printf("wait_timeout    %d seconds\n", cfg->wait_timeout);
+    printf("max_waiters     %d\n", cfg->max_waiters);
     printf("port            %hd\n", cfg->port);
+    if (cfg->metrics_socket_path) {
+        printf("metrics_listen  %s\n", cfg->metrics_socket_path);
+    } else if (cfg->metrics_port) {
+        printf("metrics_listen  %hu\n", cfg->metrics_port);
+    } else {
+        printf("metrics_listen  (none)\n");
+    }
     printf("rate_limit_h    %d\n", cfg->rate_limit_h);
-    printf("rate_limit_m    %d\n\n", cfg->rate_limit_m);
+    printf("rate_limit_m    %d\n", cfg->rate_limit_m);
+    printf("user_cache_size %d entries\n", cfg->user_cache_size);
+    printf("user_cache_ttl  %d seconds\n", cfg->user_cache_ttl);
+    printf("user_cache_negative_ttl %d seconds\n", cfg->user_cache_negative_ttl);
+    printf("inbox_cache_recipients %d\n", cfg->inbox_cache_recipients);
+    printf("api_key_filter_fp_rate %g\n", cfg->api_key_filter_fp_rate);
+    printf("api_key_filter_rebuild_interval %d seconds\n", cfg->api_key_filter_rebuild_interval);
+    printf("json_cache_size %d entries\n\n", cfg->json_cache_size);
 
     printf("log verbosity   %d\n", cfg->verbosity);
 }
@@ -192,18 +471,60 @@ bool i_cfg_log(char const *file, int line, cfg_t *cfg, log_lvl_t lvl, char const
         || lvl == log_debug && cfg->verbosity != INT_MAX) return false;
     va_list ap;
     va_start(ap, fmt);
-    i_vlog(file, line, open_log_file(cfg), lvl, fmt, ap);
+    if (cfg->logger) {
+        logger_vlog(cfg->logger, file, line, lvl_prefix(lvl), fmt, ap);
+        // Errors often precede an exit: don't leave them in the ring.
+        if (lvl == log_error) logger_flush(cfg->logger);
+    } else {
+        i_vlog(file, line, open_log_file(cfg), lvl, fmt, ap);
+    }
     va_end(ap);
     return true;
 }
 
 void cfg_log_putc(cfg_t *cfg, char c) {
-    putc(c, open_log_file(cfg));
+    if (cfg->logger) {
+        logger_write(cfg->logger, &c, 1);
+    } else {
+        putc(c, open_log_file(cfg));
+    }
+}
+
+void cfg_log_start(cfg_t *cfg) {
+    if (cfg->event_log_file_name && !cfg->evlog
+        && !(cfg->evlog = evlog_open(cfg->event_log_file_name, cfg->log_buffer_size, cfg->log_overflow))) {
+        cfg_log(cfg, log_error, INTRO "could not open event log file: %s\n", strerror(errno));
+    }
+    if (cfg->trace_file_name && !cfg->tracer
+        && !(cfg->tracer = tracer_open(cfg->trace_file_name, (uint64_t)cfg->trace_threshold_ms * 1000000, cfg->log_buffer_size, cfg->log_overflow))) {
+        cfg_log(cfg, log_error, INTRO "could not open trace file: %s\n", strerror(errno));
+    }
+    if (cfg->capture_file_name && !cfg->capture
+        && !(cfg->capture = capture_open(cfg->capture_file_name, cfg->capture_max_size, cfg->log_buffer_size, cfg->log_overflow, cfg->root_api_key))) {
+        cfg_log(cfg, log_error, INTRO "could not open capture file: %s\n", strerror(errno));
+    }
+    if (cfg->logger || !cfg->log_buffer_size) return;
+    cfg->logger = logger_start(fileno(open_log_file(cfg)), cfg->log_buffer_size, cfg->log_overflow, NULL);
+}
+
+evlog_t *cfg_evlog(cfg_t const *cfg) {
+    return cfg->evlog;
+}
+
+tracer_t *cfg_tracer(cfg_t const *cfg) {
+    return cfg->tracer;
+}
+
+capture_t *cfg_capture(cfg_t const *cfg) {
+    return cfg->capture;
 }
 
 bool cfg_verify_root_constr(cfg_t const *cfg, constr_t constr) {
     if (!uuid4_eq(cfg->root_api_key, constr.api_key)) return false;
-    switch (bcrypt_checkpw(constr.password, cfg->root_password_hash)) {
+    uint64_t const start = trace_clock();
+    int const res = bcrypt_checkpw(constr.password, cfg->root_password_hash);
+    trace_span("bcrypt", NULL, start);
+    switch (res) {
     case -1: errno_exit("bcrypt_checkpw");
     case 0: return true;
     default: return false;
@@ -218,9 +539,25 @@ bool cfg_verify_root_constr(cfg_t const *cfg, constr_t constr) {
 DEFINE_CONFIG_GETTER(size_t, max_msg_length)
 DEFINE_CONFIG_GETTER(int, page_inbox)
 DEFINE_CONFIG_GETTER(int, page_outbox)
+DEFINE_CONFIG_GETTER(int, page_motd)
+DEFINE_CONFIG_GETTER(int, wait_timeout)
+DEFINE_CONFIG_GETTER(int, max_waiters)
 DEFINE_CONFIG_GETTER(int, rate_limit_m)
 DEFINE_CONFIG_GETTER(int, rate_limit_h)
 DEFINE_CONFIG_GETTER(int, block_for)
 DEFINE_CONFIG_GETTER(int, backlog)
 DEFINE_CONFIG_GETTER(uint16_t, port)
+DEFINE_CONFIG_GETTER(uint16_t, metrics_port)
+DEFINE_CONFIG_GETTER(char const *, metrics_socket_path)
+DEFINE_CONFIG_GETTER(int, user_cache_size)
+DEFINE_CONFIG_GETTER(int, user_cache_ttl)
+DEFINE_CONFIG_GETTER(int, user_cache_negative_ttl)
+DEFINE_CONFIG_GETTER(int, inbox_cache_recipients)
+DEFINE_CONFIG_GETTER(double, api_key_filter_fp_rate)
+DEFINE_CONFIG_GETTER(int, api_key_filter_rebuild_interval)
+DEFINE_CONFIG_GETTER(int, json_cache_size)
+DEFINE_CONFIG_GETTER(int, slow_query_ms)
+DEFINE_CONFIG_GETTER(char const *, profile_file_name)
+DEFINE_CONFIG_GETTER(int, profile_hz)
+DEFINE_CONFIG_GETTER(int, profile_seconds)
 DEFINE_CONFIG_GETTER(int, verbosity)
@@ -4,7 +4,15 @@
 /// @date 23/01/2025
 
 #include "tchatator413/db.h"
+#include "tchatator413/api_key_filter.h"
+#include "tchatator413/block_index.h"
 #include "tchatator413/cfg.h"
+#include "tchatator413/evlog.h"
+#include "tchatator413/inbox_cache.h"
+#include "tchatator413/metrics.h"
+#include "tchatator413/probes.h"
+#include "tchatator413/trace.h"
+#include "tchatator413/user_key_cache.h"
 #include "util.h"
 #include <assert.h>
 #include <bcrypt/bcrypt.h>
@@ -12,14 +20,23 @@
 #include <netinet/in.h>
 #include <postgresql/libpq-fe.h>
 #include <stdlib.h>
+#include <string.h>
+#include <time.h>
 
 #define SCHEMA "tchatator"
 #define TBL_USER SCHEMA ".user"
+#define TBL__USER SCHEMA "._user"
 #define TBL_MSG SCHEMA ".msg"
 #define TBL__MSG SCHEMA "._msg"
 #define TBL_MSG_ORDERED SCHEMA ".msg_ordered"
 #define TBL_MEMBER SCHEMA ".member"
 #define TBL_PRO SCHEMA ".pro"
+#define TBL__MEMBER SCHEMA "._member"
+#define TBL__SINGLE_BLOCK SCHEMA "._single_block"
+#define CHANNEL_API_KEY "tchatator_api_key"
+#define CHANNEL_BLOCK "tchatator_block"
+#define CHANNEL_MSG "tchatator_msg"
+#define CHANNEL_USER_KEY "tchatator_user_key"
 #define CALL_SEND_MSG(arg1, arg2, arg3) SCHEMA ".send_msg(" arg1 "::int," arg2 "::int," arg3 "::varchar)"
 
 #if __BYTE_ORDER == __BIG_ENDIAN
@@ -48,12 +65,68 @@
 #define log_fmt_pq(db) LOG_CATEGORY ": %s\n", PQerrorMessage(db)
 #define log_fmt_pq_result(result) LOG_CATEGORY ": %s\n", PQresultErrorMessage(result)
 
-union db {
-    PGconn *i_conn_do_not_use_directly;
+struct db {
+    PGconn *conn;
+    /// @brief Resolved user keys. @c NULL if disabled.
+    user_key_cache_t *user_key_cache;
+    /// @brief Newest messages of recently active recipients. @c NULL if disabled.
+    inbox_cache_t *inbox_cache;
+    /// @brief API keys of every user. @c NULL if disabled or not built yet.
+    api_key_filter_t *api_key_filter;
+    /// @brief When @ref api_key_filter has last been built.
+    time_t api_key_filter_built_at;
+    /// @brief Blocks and bans in effect.
+    block_index_t *block_index;
+    /// @brief Whether @ref block_index must be reloaded before use.
+    bool block_index_stale;
+    /// @brief Number of statements run so far.
+    uint64_t n_round_trips;
+    /// @brief Called when a user gets a new message. Can be @c NULL.
+    db_new_msg_fn on_new_msg;
+    void *on_new_msg_ctx;
 };
-_Static_assert(sizeof(db_t) == sizeof(PGconn *));
-#define db2conn(db) (PGconn *)(db)
-#define conn2db(conn) (db_t *)(conn)
+#define db2conn(db) ((db)->conn)
+
+/// @brief Run a query, recording it in the metrics and the event log, and logging it if it is slow.
+/// @param query The name of the statement.
+/// @param sql The text of the statement.
+/// @param n_params The number of parameters, or @c -1 to run @p sql with @c PQexec, which allows several statements.
+/// @remark The other parameters are those of @c PQexecParams.
+/// @remark Parameter values are never logged: they hold passwords, API keys and message contents.
+static PGresult *i_exec(db_t *db, cfg_t *cfg, metrics_query_t query,
+    char const *sql, int n_params, Oid const *param_types, char const *const *param_values, int const *param_lengths, int const *param_formats, int result_format) {
+    char const *const name = metrics_query_name(query);
+    PROBE(query__start, name);
+    uint64_t const start = metrics_clock();
+
+    PGresult *result = n_params < 0
+        ? PQexec(db2conn(db), sql)
+        : PQexecParams(db2conn(db), sql, n_params, param_types, param_values, param_lengths, param_formats, result_format);
+
+    uint64_t const duration_ns = metrics_clock() - start;
+    ++db->n_round_trips;
+    int const n_tuples = PQntuples(result);
+    PROBE(query__done, name, PQresultStatus(result), n_tuples);
+    metrics_record(metrics_stage_db, duration_ns);
+    metrics_record_query(query, duration_ns, (uint64_t)n_tuples);
+    trace_span("db", name, start);
+    evlog_db_query(cfg_evlog(cfg), &(evlog_db_query_t) {
+                                       .fn = name,
+                                       .duration_ns = (int64_t)duration_ns,
+                                       .status = (uint8_t)PQresultStatus(result),
+                                       .n_tuples = n_tuples,
+                                   });
+
+    int const slow_query_ms = cfg_slow_query_ms(cfg);
+    if (slow_query_ms >= 0 && duration_ns >= (uint64_t)slow_query_ms * 1000000) {
+        cfg_log(cfg, log_warning, LOG_CATEGORY ": slow query %s: %.3f ms, %d rows, %d parameters (redacted): %s\n",
+            name, (double)duration_ns / 1e6, n_tuples, MAX(n_params, 0), sql);
+    }
+    return result;
+}
+#define exec_params(db, cfg, query, sql, n_params, param_types, param_values, param_lengths, param_formats, result_format) \
+    i_exec(db, cfg, metrics_query_##query, sql, n_params, param_types, param_values, param_lengths, param_formats, result_format)
+#define exec_query(db, cfg, query, sql) i_exec(db, cfg, metrics_query_##query, sql, -1, NULL, NULL, NULL, NULL, 0)
 
 db_t *db_connect(cfg_t *cfg, char const *host, char const *port, char const *database, char const *username, char const *password) {
     PGconn *conn = PQsetdbLogin(
@@ -82,17 +155,108 @@ db_t *db_connect(cfg_t *cfg, char const *host, char const *port, char const *dat
 
     cfg_log(cfg, log_info, "connected to db '%s' on %s:%s as %s\n", database, host, port, username);
 
-    return conn2db(conn);
+    db_t *db = malloc(sizeof *db);
+    if (!db) errno_exit("malloc");
+    db->conn = conn;
+    db->user_key_cache = user_key_cache_init((size_t)MAX(cfg_user_cache_size(cfg), 0),
+        cfg_user_cache_ttl(cfg), cfg_user_cache_negative_ttl(cfg));
+    db->inbox_cache = inbox_cache_init((size_t)MAX(cfg_inbox_cache_recipients(cfg), 0), cfg_page_inbox(cfg));
+    db->api_key_filter = NULL;
+    db->api_key_filter_built_at = 0;
+    db->block_index = block_index_init();
+    db->block_index_stale = true;
+    db->n_round_trips = 0;
+    db->on_new_msg = NULL;
+    db->on_new_msg_ctx = NULL;
+
+    // Listen before the first load, so no change can fall in between.
+    PGresult *result = PQexec(conn, cfg_api_key_filter_fp_rate(cfg) > 0
+            ? "listen " CHANNEL_BLOCK "; listen " CHANNEL_USER_KEY "; listen " CHANNEL_MSG "; listen " CHANNEL_API_KEY
+            : "listen " CHANNEL_BLOCK "; listen " CHANNEL_USER_KEY "; listen " CHANNEL_MSG);
+    if (PQresultStatus(result) != PGRES_COMMAND_OK) cfg_log(cfg, log_error, log_fmt_pq_result(result));
+    PQclear(result);
+
+    return db;
 }
 
 void db_destroy(db_t *db) {
+    if (!db) return;
     PQfinish(db2conn(db));
+    user_key_cache_destroy(db->user_key_cache);
+    inbox_cache_destroy(db->inbox_cache);
+    api_key_filter_destroy(db->api_key_filter);
+    block_index_destroy(db->block_index);
+    free(db);
+}
+
+uint64_t db_round_trips(db_t const *db) {
+    return db ? db->n_round_trips : 0;
+}
+
+void db_invalidate_caches(db_t *db) {
+    user_key_cache_clear(db->user_key_cache);
+    inbox_cache_clear(db->inbox_cache);
+    db->block_index_stale = true;
+}
+
+/// @brief Set the function called when a user gets a new message.
+void db_on_new_msg(db_t *db, db_new_msg_fn fn, void *ctx) {
+    db->on_new_msg = fn;
+    db->on_new_msg_ctx = ctx;
+}
+
+int db_socket(db_t const *db) {
+    return PQsocket(db2conn(db));
+}
+
+/// @brief Process the notifications received since the last call.
+void db_consume_notifications(db_t *db, cfg_t *cfg) {
+    if (!PQconsumeInput(db2conn(db))) cfg_log(cfg, log_error, log_fmt_pq(db2conn(db)));
+    PGnotify *notify;
+    while ((notify = PQnotifies(db2conn(db)))) {
+        if (streq(notify->relname, CHANNEL_BLOCK)) {
+            db->block_index_stale = true;
+        } else if (streq(notify->relname, CHANNEL_API_KEY)) {
+            uuid4_t new_key;
+            if (strlen(notify->extra) != UUID4_REPR_LENGTH || !uuid4_parse(&new_key, notify->extra)) {
+                cfg_log(cfg, log_warning, LOG_CATEGORY ": invalid api key notification: %s\n", notify->extra);
+            } else if (db->api_key_filter) {
+                api_key_filter_add(db->api_key_filter, new_key);
+            }
+        } else if (streq(notify->relname, CHANNEL_USER_KEY)) {
+            char *end;
+            long const user_id = strtol(notify->extra, &end, 10);
+            if (*end || end == notify->extra) {
+                cfg_log(cfg, log_warning, LOG_CATEGORY ": invalid user key notification: %s\n", notify->extra);
+                user_key_cache_clear(db->user_key_cache);
+            } else {
+                // The old keys of the user may now be free or someone else's, and its new keys may be cached as unknown.
+                user_key_cache_invalidate_user(db->user_key_cache, (serial_t)user_id);
+                user_key_cache_invalidate_user(db->user_key_cache, errstatus_error);
+            }
+        } else if (streq(notify->relname, CHANNEL_MSG)) {
+            char *end;
+            long const recipient_id = strtol(notify->extra, &end, 10);
+            if (*end != ' ' || end == notify->extra) {
+                cfg_log(cfg, log_warning, LOG_CATEGORY ": invalid message notification: %s\n", notify->extra);
+                inbox_cache_clear(db->inbox_cache);
+            } else {
+                // Changes made through this connection have already been applied to the cache.
+                if (notify->be_pid != PQbackendPID(db2conn(db))) inbox_cache_invalidate(db->inbox_cache, (serial_t)recipient_id);
+                if (db->on_new_msg && streq(end + 1, "insert")) db->on_new_msg((serial_t)recipient_id, db->on_new_msg_ctx);
+            }
+        }
+        PQfreemem(notify);
+    }
 }
 
 static inline bool check_password(char const *password, char const hash[static const BCRYPT_HASHSIZE]) {
     if (!password && !hash) return true;
     if (!password || !hash) return false;
-    switch (bcrypt_checkpw(password, hash)) {
+    uint64_t const start = trace_clock();
+    int const res = bcrypt_checkpw(password, hash);
+    trace_span("bcrypt", NULL, start);
+    switch (res) {
     case -1: errno_exit("bcrypt_checkpw");
     case 0: return true;
     default: return false;
@@ -111,18 +275,69 @@ static inline bool validate_db_role(cfg_t *cfg, role_t role) {
     return true;
 }
 
-errstatus_t db_verify_user_constr(db_t *db, cfg_t *cfg, user_identity_t *out_user, constr_t constr) {
+/// @brief Rebuild the API key filter from every user.
+/// @return @c false on database error. The previous filter is kept.
+static bool api_key_filter_rebuild(db_t *db, cfg_t *cfg, time_t now) {
+    PGresult *result = exec_params(db, cfg, api_keys, "select api_key from " TBL__USER,
+        0, NULL, NULL, NULL, NULL, 1);
+
+    if (PQresultStatus(result) != PGRES_TUPLES_OK) {
+        cfg_log(cfg, log_error, log_fmt_pq_result(result));
+        PQclear(result);
+        return false;
+    }
+
+    int const ntuples = PQntuples(result);
+    // Leave room for the keys that will be notified until the next rebuild.
+    api_key_filter_t *filter = api_key_filter_init((size_t)ntuples * 2, cfg_api_key_filter_fp_rate(cfg));
+    for (int i = 0; i < ntuples; ++i) {
+        uuid4_t api_key;
+        assert(PQgetlength(result, i, 0) == sizeof api_key.data);
+        memcpy(api_key.data, PQgetvalue(result, i, 0), sizeof api_key.data);
+        api_key_filter_add(filter, api_key);
+    }
+    PQclear(result);
+
+    api_key_filter_destroy(db->api_key_filter);
+    db->api_key_filter = filter;
+    db->api_key_filter_built_at = now;
+    cfg_log(cfg, log_info, LOG_CATEGORY ": api key filter rebuilt with %d keys\n", ntuples);
+    return true;
+}
+
+/// @brief Test whether an API key may belong to a user, without a database round-trip when possible.
+/// @return @c false if no user has the API key.
+/// @return @c true if a user may have the API key.
+static bool api_key_may_exist(db_t *db, cfg_t *cfg, uuid4_t api_key) {
+    if (cfg_api_key_filter_fp_rate(cfg) <= 0) return true;
+    // Keys created in the current transaction aren't notified until commit.
+    if (PQtransactionStatus(db2conn(db)) != PQTRANS_IDLE) return true;
+
+    time_t const now = time(NULL);
+    if ((!db->api_key_filter || now - db->api_key_filter_built_at >= cfg_api_key_filter_rebuild_interval(cfg))
+        && !api_key_filter_rebuild(db, cfg, now)
+        && !db->api_key_filter) return true;
+
+    // Add the keys created since
+    db_consume_notifications(db, cfg);
+
+    return api_key_filter_may_contain(db->api_key_filter, api_key);
+}
+
+static errstatus_t verify_user_constr(db_t *db, cfg_t *cfg, user_identity_t *out_user, constr_t constr) {
     if (cfg_verify_root_constr(cfg, constr)) {
         out_user->role = role_admin;
         out_user->id = 0;
         return errstatus_ok;
     }
 
+    if (!api_key_may_exist(db, cfg, constr.api_key)) return errstatus_error;
+
     char api_key_repr[UUID4_REPR_LENGTH + 1];
     uuid4_repr(constr.api_key, api_key_repr)[UUID4_REPR_LENGTH] = '\0';
     const char *args[] = { api_key_repr };
 
-    PGresult *result = PQexecParams(db2conn(db), "select role,password_hash,user_id from " TBL_USER " where api_key=$1",
+    PGresult *result = exec_params(db, cfg, user_by_api_key, "select role,password_hash,user_id from " TBL_USER " where api_key=$1",
         1, NULL, args, NULL, NULL, 1);
 
     errstatus_t res;
@@ -145,12 +360,21 @@ errstatus_t db_verify_user_constr(db_t *db, cfg_t *cfg, user_identity_t *out_use
     return res;
 }
 
+errstatus_t db_verify_user_constr(db_t *db, cfg_t *cfg, user_identity_t *out_user, constr_t constr) {
+    uint64_t const start = metrics_clock();
+    errstatus_t const res = verify_user_constr(db, cfg, out_user, constr);
+    metrics_record(metrics_stage_auth, metrics_clock() - start);
+    trace_span("auth", NULL, start);
+    PROBE(auth__done, res == errstatus_ok ? out_user->id : 0, res == errstatus_ok ? out_user->role : 0, res);
+    return res;
+}
+
 int db_get_user_role(db_t *db, cfg_t *cfg, serial_t user_id) {
     uint32_t const arg1 = pq_send_l(user_id);
     char const *const args[] = { (char const *)&arg1 };
     int const args_len[array_len(args)] = { sizeof arg1 };
     int const args_fmt[array_len(args)] = { 1 };
-    PGresult *result = PQexecParams(db2conn(db), "select role from " TBL_USER " where user_id=$1",
+    PGresult *result = exec_params(db, cfg, user_role, "select role from " TBL_USER " where user_id=$1",
         array_len(args), NULL, args, args_len, args_fmt, 1);
 
     int res;
@@ -170,10 +394,14 @@ int db_get_user_role(db_t *db, cfg_t *cfg, serial_t user_id) {
 }
 
 serial_t db_get_user_id_by_email(db_t *db, cfg_t *cfg, const char *email) {
-    PGresult *result = PQexecParams(db2conn(db), "select user_id from " TBL_USER " where email = $1",
-        1, NULL, &email, NULL, NULL, 1);
-
+    time_t const now = time(NULL);
     serial_t res;
+    // Drop the keys changed since
+    db_consume_notifications(db, cfg);
+    if (user_key_cache_get(db->user_key_cache, user_key_email, email, now, &res)) return res;
+
+    PGresult *result = exec_params(db, cfg, user_id_by_email, "select user_id from " TBL_USER " where email = $1",
+        1, NULL, &email, NULL, NULL, 1);
 
     if (PQresultStatus(result) != PGRES_TUPLES_OK) {
         cfg_log(cfg, log_error, log_fmt_pq_result(result));
@@ -185,23 +413,28 @@ serial_t db_get_user_id_by_email(db_t *db, cfg_t *cfg, const char *email) {
     }
 
     PQclear(result);
+    user_key_cache_put(db->user_key_cache, user_key_email, email, now, res);
     return res;
 }
 
 serial_t db_get_user_id_by_name(db_t *db, cfg_t *cfg, const char *name) {
+    time_t const now = time(NULL);
+    serial_t res;
+    // Drop the keys changed since
+    db_consume_notifications(db, cfg);
+    if (user_key_cache_get(db->user_key_cache, user_key_name, name, now, &res)) return res;
+
     // First search by member user_name since they are unique
-    PGresult *result = PQexecParams(db2conn(db), "select user_id from " TBL_MEMBER " where user_name=$1",
+    PGresult *result = exec_params(db, cfg, member_id_by_name, "select user_id from " TBL_MEMBER " where user_name=$1",
         1, NULL, &name, NULL, NULL, 1);
 
-    serial_t res;
-
     if (PQresultStatus(result) != PGRES_TUPLES_OK) {
         cfg_log(cfg, log_error, log_fmt_pq_result(result));
         res = errstatus_handled;
     } else if (PQntuples(result) == 0) {
         PQclear(result);
         // Fallback to pro business name (there must be only 1)
-        result = PQexecParams(db2conn(db), "select user_id from " TBL_PRO " where business_name=$1",
+        result = exec_params(db, cfg, pro_id_by_name, "select user_id from " TBL_PRO " where business_name=$1",
             1, NULL, &name, NULL, NULL, 1);
 
         if (PQresultStatus(result) != PGRES_TUPLES_OK) {
@@ -217,7 +450,7 @@ serial_t db_get_user_id_by_name(db_t *db, cfg_t *cfg, const char *name) {
     }
 
     PQclear(result);
-
+    user_key_cache_put(db->user_key_cache, user_key_name, name, now, res);
     return res;
 }
 
@@ -227,7 +460,7 @@ errstatus_t db_get_user(db_t *db, memlst_t **p_mem, cfg_t *cfg, user_t *p_user)
     int const args_len[array_len(args)] = { sizeof arg1 };
     int const args_fmt[array_len(args)] = { 1 };
     PGresult *result = memlst_add(p_mem, (dtor_fn)PQclear,
-        PQexecParams(db2conn(db), "select role,user_id,member_user_name,pro_business_name from " TBL_USER " where user_id=$1",
+        exec_params(db, cfg, user, "select role,user_id,member_user_name,pro_business_name from " TBL_USER " where user_id=$1",
             array_len(args), NULL, args, args_len, args_fmt, 1));
 
     if (PQresultStatus(result) != PGRES_TUPLES_OK) {
@@ -260,7 +493,7 @@ int db_count_msg(db_t *db, cfg_t *cfg, serial_t sender_id, serial_t recipient_id
     char const *const args[] = { (char const *)&arg1, (char const *)&arg2 };
     int const args_len[array_len(args)] = { sizeof arg1, sizeof arg2 };
     int const args_fmt[array_len(args)] = { 1, 1 };
-    PGresult *result = PQexecParams(db2conn(db), "select count(*) from " TBL_MSG " where coalesce(user_id_sender,0)=$1 and user_id_recipient=$2",
+    PGresult *result = exec_params(db, cfg, count_msg, "select count(*) from " TBL_MSG " where coalesce(user_id_sender,0)=$1 and user_id_recipient=$2",
         array_len(args), NULL, args, args_len, args_fmt, 1);
 
     int res;
@@ -281,7 +514,8 @@ serial_t db_send_msg(db_t *db, cfg_t *cfg, serial_t sender_id, serial_t recipien
     char const *const args[] = { (char const *)&arg1, (char const *)&arg2, content };
     int const args_len[array_len(args)] = { sizeof arg1, sizeof arg2 };
     int const args_fmt[array_len(args)] = { 1, 1, 0 };
-    PGresult *result = PQexecParams(db2conn(db), "select " CALL_SEND_MSG("$1", "$2", "$3"),
+    // send_msg returns sent_at, so the inbox cache gets the exact value without another round-trip
+    PGresult *result = exec_params(db, cfg, send_msg, "select msg_id, sent_at from " CALL_SEND_MSG("$1", "$2", "$3"),
         array_len(args), NULL, args, args_len, args_fmt, 1);
 
     serial_t res;
@@ -293,8 +527,26 @@ serial_t db_send_msg(db_t *db, cfg_t *cfg, serial_t sender_id, serial_t recipien
         // the sql function returns errstatus_error on error
         res = pq_recv_l(serial_t, PQgetvalue(result, 0, 0));
         _Static_assert(errstatus_error == 0, "DB compatiblity");
+        if (res != errstatus_error) {
+            if (PQgetisnull(result, 0, 1)) {
+                // Can't happen, but a message missing from the cache would go unseen: start over.
+                cfg_log(cfg, log_error, "database: send_msg returned no sent_at for msg %d\n", res);
+                inbox_cache_clear(db->inbox_cache);
+            } else {
+                msg_t const msg = {
+                    .id = res,
+                    .content = (char *)(uintptr_t)content, // copied by the cache
+                    .sent_at = pq_recv_timestamp(PQgetvalue(result, 0, 1)),
+                    .user_id_sender = sender_id,
+                    .user_id_recipient = recipient_id,
+                };
+                inbox_cache_push(db->inbox_cache, &msg);
+            }
+            if (db->on_new_msg) db->on_new_msg(recipient_id, db->on_new_msg_ctx);
+        }
     }
 
+    PQclear(result);
     return res;
 }
 
@@ -304,12 +556,17 @@ errstatus_t db_get_inbox(db_t *db, memlst_t **p_mem, cfg_t *cfg,
     serial_t recipient_id,
     msg_list_t *out_msgs) {
 
+    // The first page is the most requested: serve it from memory when we can.
+    bool const is_first_page = offset == 0 && limit == inbox_cache_ring_size(db->inbox_cache);
+    if (is_first_page) db_consume_notifications(db, cfg);
+    if (is_first_page && inbox_cache_get(db->inbox_cache, p_mem, recipient_id, out_msgs)) return errstatus_ok;
+
     uint32_t const arg1 = pq_send_l(recipient_id), arg2 = pq_send_l(limit), arg3 = pq_send_l(offset);
     char const *const args[] = { (char const *)&arg1, (char const *)&arg2, (char const *)&arg3 };
     int const args_len[array_len(args)] = { sizeof arg1, sizeof arg2, sizeof arg3 };
     int const args_fmt[array_len(args)] = { 1, 1, 1 };
     PGresult *result = memlst_add(p_mem, (dtor_fn)PQclear,
-        PQexecParams(db2conn(db), "select msg_id, content, sent_at, read_age, edited_age, user_id_sender from " TBL_MSG_ORDERED " where user_id_recipient=$1 limit $2::int offset $3::int",
+        exec_params(db, cfg, inbox, "select msg_id, content, sent_at, read_age, edited_age, user_id_sender from " TBL_MSG_ORDERED " where user_id_recipient=$1 limit $2::int offset $3::int",
             array_len(args), NULL, args, args_len, args_fmt, 1));
 
     if (PQresultStatus(result) != PGRES_TUPLES_OK) {
@@ -318,8 +575,7 @@ errstatus_t db_get_inbox(db_t *db, memlst_t **p_mem, cfg_t *cfg,
     }
 
     int32_t ntuples = MIN(PQntuples(result), limit);
-    out_msgs->msgs = memlst_add(p_mem, free, malloc(sizeof *out_msgs->msgs * ntuples));
-    if (!out_msgs->msgs) errno_exit("malloc");
+    out_msgs->msgs = memlst_alloc(p_mem, sizeof *out_msgs->msgs * (size_t)ntuples);
     out_msgs->n_msgs = (size_t)ntuples;
     for (int32_t i = 0; i < ntuples; ++i) {
         msg_t *p_msg = &out_msgs->msgs[i];
@@ -333,6 +589,77 @@ errstatus_t db_get_inbox(db_t *db, memlst_t **p_mem, cfg_t *cfg,
         p_msg->user_id_recipient = recipient_id;
     }
 
+    if (is_first_page) inbox_cache_fill(db->inbox_cache, recipient_id, *out_msgs);
+
+    return errstatus_ok;
+}
+
+errstatus_t db_has_unread(db_t *db, cfg_t *cfg, serial_t user_id) {
+    uint32_t const arg1 = pq_send_l(user_id);
+    char const *const args[] = { (char const *)&arg1 };
+    int const args_len[array_len(args)] = { sizeof arg1 };
+    int const args_fmt[array_len(args)] = { 1 };
+    // Served by the unread index, like motd.
+    PGresult *result = exec_params(db, cfg, has_unread,
+        "select 1 from " TBL__MSG " where user_id_recipient=$1 and read_age is null and deleted_age is null limit 1",
+        array_len(args), NULL, args, args_len, args_fmt, 1);
+
+    errstatus_t res;
+
+    if (PQresultStatus(result) != PGRES_TUPLES_OK) {
+        cfg_log(cfg, log_error, log_fmt_pq_result(result));
+        res = errstatus_handled;
+    } else {
+        res = PQntuples(result) ? errstatus_ok : errstatus_error;
+    }
+
+    PQclear(result);
+    return res;
+}
+
+errstatus_t db_get_motd(db_t *db, memlst_t **p_mem, cfg_t *cfg,
+    int32_t limit,
+    serial_t recipient_id,
+    msg_list_t *out_msgs,
+    bool *out_has_more) {
+    // One more row than the page is locked to tell whether another page follows; it is left unread.
+    uint32_t const arg1 = pq_send_l(recipient_id), arg2 = pq_send_l(limit);
+    char const *const args[] = { (char const *)&arg1, (char const *)&arg2 };
+    int const args_len[array_len(args)] = { sizeof arg1, sizeof arg2 };
+    int const args_fmt[array_len(args)] = { 1, 1 };
+    PGresult *result = memlst_add(p_mem, (dtor_fn)PQclear,
+        exec_params(db, cfg, motd,
+            "with unread as (select msg_id, sent_at from " TBL__MSG " where user_id_recipient=$1 and read_age is null and deleted_age is null"
+            " order by sent_at, msg_id limit $2::int + 1 for update skip locked),"
+            " marked as (update " TBL__MSG " set read_age=" SCHEMA "._seconds_diff(localtimestamp, sent_at)"
+            " where msg_id in (select msg_id from unread order by sent_at, msg_id limit $2::int)"
+            " returning msg_id, content, sent_at, read_age, edited_age, user_id_sender)"
+            " select *, (select count(*) from unread) > $2::int from marked order by sent_at, msg_id",
+            array_len(args), NULL, args, args_len, args_fmt, 1));
+
+    if (PQresultStatus(result) != PGRES_TUPLES_OK) {
+        cfg_log(cfg, log_error, log_fmt_pq_result(result));
+        return errstatus_handled;
+    }
+
+    int32_t ntuples = MIN(PQntuples(result), limit);
+    out_msgs->msgs = memlst_alloc(p_mem, sizeof *out_msgs->msgs * (size_t)ntuples);
+    out_msgs->n_msgs = (size_t)ntuples;
+    for (int32_t i = 0; i < ntuples; ++i) {
+        msg_t *p_msg = &out_msgs->msgs[i];
+        p_msg->id = pq_recv_l(serial_t, PQgetvalue(result, i, 0));
+        p_msg->content = PQgetvalue(result, i, 1);
+        p_msg->sent_at = pq_recv_timestamp(PQgetvalue(result, i, 2));
+        p_msg->read_age = pq_recv_l(int32_t, PQgetvalue(result, i, 3));
+        p_msg->edited_age = PQgetisnull(result, i, 4) ? 0 : pq_recv_l(int32_t, PQgetvalue(result, i, 4));
+        p_msg->deleted_age = 0;
+        p_msg->user_id_sender = PQgetisnull(result, i, 5) ? 0 : pq_recv_l(serial_t, PQgetvalue(result, i, 5));
+        p_msg->user_id_recipient = recipient_id;
+    }
+    *out_has_more = ntuples && *PQgetvalue(result, 0, 6);
+
+    inbox_cache_read(db->inbox_cache, recipient_id, *out_msgs);
+
     return errstatus_ok;
 }
 
@@ -342,7 +669,7 @@ errstatus_t db_get_msg(db_t *db, memlst_t **p_mem, cfg_t *cfg, msg_t *p_msg) {
     int const args_len[array_len(args)] = { sizeof arg1 };
     int const args_fmt[array_len(args)] = { 1 };
     PGresult *result = memlst_add(p_mem, (dtor_fn)PQclear,
-        PQexecParams(db2conn(db), "select content, sent_at, read_age, edited_age, deleted_age, user_id_sender, user_id_recipient from " TBL__MSG " where msg_id=$1",
+        exec_params(db, cfg, msg, "select content, sent_at, read_age, edited_age, deleted_age, user_id_sender, user_id_recipient from " TBL__MSG " where msg_id=$1",
             array_len(args), NULL, args, args_len, args_fmt, 1));
 
     if (PQresultStatus(result) != PGRES_TUPLES_OK) {
@@ -368,11 +695,115 @@ errstatus_t db_rm_msg(db_t *db, cfg_t *cfg, serial_t msg_id) {
     char const *const args[] = { (char const *)&arg1 };
     int const args_len[array_len(args)] = { sizeof arg1 };
     int const args_fmt[array_len(args)] = { 1 };
-    PGresult *result = PQexecParams(db2conn(db), "delete from " TBL_MSG " where msg_id=$1",
+    // The recipient tells which cached inbox to update.
+    PGresult *result = exec_params(db, cfg, rm_msg, "delete from " TBL_MSG " where msg_id=$1 returning user_id_recipient",
         array_len(args), NULL, args, args_len, args_fmt, 1);
 
     errstatus_t res;
 
+    if (PQresultStatus(result) != PGRES_TUPLES_OK) {
+        cfg_log(cfg, log_error, log_fmt_pq_result(result));
+        res = errstatus_handled;
+    } else if (PQntuples(result) != 1) {
+        res = errstatus_error;
+    } else {
+        res = errstatus_ok;
+        inbox_cache_rm(db->inbox_cache, pq_recv_l(serial_t, PQgetvalue(result, 0, 0)), msg_id);
+    }
+
+    PQclear(result);
+    return res;
+}
+
+errstatus_t db_edit_msg(db_t *db, cfg_t *cfg, serial_t msg_id, char const *new_content) {
+    uint32_t const arg1 = pq_send_l(msg_id);
+    char const *const args[] = { (char const *)&arg1, new_content };
+    int const args_len[array_len(args)] = { sizeof arg1 };
+    int const args_fmt[array_len(args)] = { 1, 0 };
+    PGresult *result = exec_params(db, cfg, edit_msg, "update " TBL__MSG " set content=$2::varchar, edited_age=" SCHEMA "._seconds_diff(localtimestamp, sent_at)"
+                                                           " where msg_id=$1 and deleted_age is null returning edited_age, user_id_recipient",
+        array_len(args), NULL, args, args_len, args_fmt, 1);
+
+    errstatus_t res;
+
+    if (PQresultStatus(result) != PGRES_TUPLES_OK) {
+        cfg_log(cfg, log_error, log_fmt_pq_result(result));
+        res = errstatus_handled;
+    } else if (PQntuples(result) == 0) {
+        res = errstatus_error;
+    } else {
+        res = errstatus_ok;
+        inbox_cache_edit(db->inbox_cache, pq_recv_l(serial_t, PQgetvalue(result, 0, 1)), msg_id, new_content, pq_recv_l(int32_t, PQgetvalue(result, 0, 0)));
+    }
+
+    PQclear(result);
+    return res;
+}
+
+/// @brief Make sure the block index matches the tables.
+/// @return @c false on database error. The index may be out of date.
+static bool block_index_sync(db_t *db, cfg_t *cfg) {
+    db_consume_notifications(db, cfg);
+    if (!db->block_index_stale) return true;
+
+    // Expiry times are sent as remaining seconds, so they don't depend on the clocks agreeing.
+    PGresult *result = exec_params(db, cfg, blocks,
+        "select user_id, 0, case when full_block_expires_at = 'infinity' then null else " SCHEMA "._seconds_diff(full_block_expires_at, localtimestamp) end"
+        " from " TBL__MEMBER " where full_block_expires_at > localtimestamp"
+        " union all "
+        "select user_id_member, user_id_pro, case when expires_at = 'infinity' then null else " SCHEMA "._seconds_diff(expires_at, localtimestamp) end"
+        " from " TBL__SINGLE_BLOCK " where expires_at > localtimestamp",
+        0, NULL, NULL, NULL, NULL, 1);
+
+    if (PQresultStatus(result) != PGRES_TUPLES_OK) {
+        cfg_log(cfg, log_error, log_fmt_pq_result(result));
+        PQclear(result);
+        return false;
+    }
+
+    time_t const now = time(NULL);
+    block_index_clear(db->block_index);
+    int const ntuples = PQntuples(result);
+    for (int i = 0; i < ntuples; ++i) {
+        block_index_set(db->block_index,
+            pq_recv_l(serial_t, PQgetvalue(result, i, 1)),
+            pq_recv_l(serial_t, PQgetvalue(result, i, 0)),
+            PQgetisnull(result, i, 2) ? BLOCK_FOREVER : now + pq_recv_l(int32_t, PQgetvalue(result, i, 2)));
+    }
+    PQclear(result);
+
+    db->block_index_stale = false;
+    cfg_log(cfg, log_info, LOG_CATEGORY ": block index loaded with %d blocks\n", ntuples);
+    return true;
+}
+
+bool db_is_blocked(db_t *db, cfg_t *cfg, serial_t sender_id, serial_t recipient_id) {
+    // If we can't tell, let send_msg decide.
+    return block_index_sync(db, cfg) && block_index_is_blocked(db->block_index, sender_id, recipient_id, time(NULL));
+}
+
+int64_t db_get_block(db_t *db, cfg_t *cfg, serial_t scope, serial_t member_id) {
+    if (!block_index_sync(db, cfg)) return errstatus_handled;
+    return block_index_get(db->block_index, scope, member_id, time(NULL));
+}
+
+errstatus_t db_block(db_t *db, cfg_t *cfg, serial_t scope, serial_t member_id, bool forever) {
+    int32_t const duration = forever ? -1 : cfg_block_for(cfg);
+    uint32_t const arg1 = pq_send_l(member_id), arg2 = pq_send_l(duration), arg3 = pq_send_l(scope);
+    char const *const args[] = { (char const *)&arg1, (char const *)&arg2, (char const *)&arg3 };
+    int const args_len[array_len(args)] = { sizeof arg1, sizeof arg2, sizeof arg3 };
+    int const args_fmt[array_len(args)] = { 1, 1, 1 };
+#define EXPIRES_AT "case when $2::int < 0 then 'infinity'::timestamp else localtimestamp + $2::int * interval '1 second' end"
+    PGresult *result = scope == BLOCK_SCOPE_GLOBAL
+        ? exec_params(db, cfg, block_global, "update " TBL__MEMBER " set full_block_expires_at=" EXPIRES_AT " where user_id=$1",
+              array_len(args) - 1, NULL, args, args_len, args_fmt, 1)
+        : exec_params(db, cfg, block_single, "insert into " TBL__SINGLE_BLOCK " (user_id_member, user_id_pro, expires_at) values ($1, $3, " EXPIRES_AT ")"
+                                                  " on conflict on constraint single_block_pk do update set expires_at=excluded.expires_at",
+              array_len(args), NULL, args, args_len, args_fmt, 1);
+#undef EXPIRES_AT
+
+    errstatus_t res;
+
     if (PQresultStatus(result) != PGRES_COMMAND_OK) {
         cfg_log(cfg, log_error, log_fmt_pq_result(result));
         res = errstatus_handled;
@@ -380,6 +811,52 @@ errstatus_t db_rm_msg(db_t *db, cfg_t *cfg, serial_t msg_id) {
         res = errstatus_error;
     } else {
         res = errstatus_ok;
+        block_index_set(db->block_index, scope, member_id, forever ? BLOCK_FOREVER : time(NULL) + duration);
+    }
+
+    PQclear(result);
+    return res;
+}
+
+errstatus_t db_unblock(db_t *db, cfg_t *cfg, serial_t scope, serial_t member_id, bool forever) {
+    uint32_t const arg1 = pq_send_l(member_id), arg2 = pq_send_l(scope);
+    char const *const args[] = { (char const *)&arg1, (char const *)&arg2 };
+    int const args_len[array_len(args)] = { sizeof arg1, sizeof arg2 };
+    int const args_fmt[array_len(args)] = { 1, 1 };
+#define IS_BLOCK(col) col " > localtimestamp and " col " <> 'infinity'"
+#define IS_BAN(col) col " = 'infinity'"
+    // The administrator also lifts the blocks of every professionnal
+#define QUERY_GLOBAL(is_kind)                                                                                                                  \
+    "with g as (update " TBL__MEMBER " set full_block_expires_at=null where user_id=$1 and " is_kind("full_block_expires_at") " returning 1)," \
+    " s as (delete from " TBL__SINGLE_BLOCK " where user_id_member=$1 and " is_kind("expires_at") " returning 1)"                              \
+    " select (select count(*) from g) + (select count(*) from s)"
+#define QUERY_SINGLE(is_kind)                                                                                                            \
+    "with s as (delete from " TBL__SINGLE_BLOCK " where user_id_member=$1 and user_id_pro=$2 and " is_kind("expires_at") " returning 1)" \
+    " select count(*) from s"
+    PGresult *result = scope == BLOCK_SCOPE_GLOBAL
+        ? exec_params(db, cfg, unblock_global, forever ? QUERY_GLOBAL(IS_BAN) : QUERY_GLOBAL(IS_BLOCK),
+              1, NULL, args, args_len, args_fmt, 1)
+        : exec_params(db, cfg, unblock_single, forever ? QUERY_SINGLE(IS_BAN) : QUERY_SINGLE(IS_BLOCK),
+              2, NULL, args, args_len, args_fmt, 1);
+#undef QUERY_SINGLE
+#undef QUERY_GLOBAL
+#undef IS_BAN
+#undef IS_BLOCK
+
+    errstatus_t res;
+
+    if (PQresultStatus(result) != PGRES_TUPLES_OK) {
+        cfg_log(cfg, log_error, log_fmt_pq_result(result));
+        res = errstatus_handled;
+    } else if (pq_recv_ll(int64_t, PQgetvalue(result, 0, 0)) == 0) {
+        res = errstatus_error;
+    } else {
+        res = errstatus_ok;
+        if (scope == BLOCK_SCOPE_GLOBAL) {
+            db->block_index_stale = true;
+        } else {
+            block_index_unset(db->block_index, scope, member_id);
+        }
     }
 
     PQclear(result);
@@ -387,7 +864,7 @@ errstatus_t db_rm_msg(db_t *db, cfg_t *cfg, serial_t msg_id) {
 }
 
 errstatus_t db_transaction(db_t *db, cfg_t *cfg, transaction_fn body, void *ctx) {
-    PGresult *result = PQexec(db2conn(db), "begin");
+    PGresult *result = exec_query(db, cfg, begin, "begin");
     cfg_log(cfg, log_debug, LOG_CATEGORY ": BEGIN\n");
 
     errstatus_t res;
@@ -402,8 +879,10 @@ errstatus_t db_transaction(db_t *db, cfg_t *cfg, transaction_fn body, void *ctx)
         res = body(db, cfg, ctx);
 
         // End the transaction now.
-        result = PQexec(db2conn(db), res == errstatus_ok ? "commit" : "rollback");
+        result = exec_query(db, cfg, end, res == errstatus_ok ? "commit" : "rollback");
         cfg_log(cfg, log_debug, LOG_CATEGORY ": %s\n", res == errstatus_ok ? "COMMIT" : "ROLLBACK");
+        // What we've cached during the transaction may have been rolled back.
+        if (res != errstatus_ok) db_invalidate_caches(db);
 
         if (PQresultStatus(result) != PGRES_COMMAND_OK) {
             cfg_log(cfg, log_error, log_fmt_pq_result(result));
@@ -424,7 +903,7 @@ errstatus_t db_use_test_data(db_t *db, cfg_t *cfg, test_data_t subject) {
     };
 
     cfg_log(cfg, log_info, LOG_CATEGORY ": %s\n", test_data_queries[subject]);
-    PGresult *result = PQexec(db2conn(db), test_data_queries[subject]);
+    PGresult *result = exec_query(db, cfg, test_data, test_data_queries[subject]);
 
     errstatus_t res;
     if (PQresultStatus(result) != PGRES_COMMAND_OK) {
@@ -437,3 +916,20 @@ errstatus_t db_use_test_data(db_t *db, cfg_t *cfg, test_data_t subject) {
     PQclear(result);
     return res;
 }
+
+errstatus_t db_notify(db_t *db, cfg_t *cfg, char const *channel, char const *payload) {
+    char const *const args[] = { channel, payload };
+    PGresult *result = exec_params(db, cfg, test_data, "select pg_notify($1, $2)",
+        array_len(args), NULL, args, NULL, NULL, 0);
+
+    errstatus_t res;
+    if (PQresultStatus(result) != PGRES_TUPLES_OK) {
+        cfg_log(cfg, log_error, log_fmt_pq_result(result));
+        res = errstatus_handled;
+    } else {
+        res = errstatus_ok;
+    }
+
+    PQclear(result);
+    return res;
+}
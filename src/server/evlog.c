@@ -0,0 +1,143 @@
+/// @file
+/// @author Raphaël
+/// @brief Binary event log - Implementation
+/// @date 18/10/2026
+
+#include "tchatator413/evlog.h"
+#include <fcntl.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+/// @brief Version of the format, written in session headers.
+#define FORMAT_VERSION 1
+/// @brief Magic number that starts session headers. Its first byte is not a valid event id.
+#define MAGIC "\xffT413EV"
+/// @brief Length of a record header: event id, fields length and timestamp.
+#define RECORD_HEADER_LEN (1 + 2 + 8)
+/// @brief Maximum length of a record.
+#define RECORD_MAX 1024
+/// @brief Minimum capacity of a ring, so records are never truncated.
+#define RING_MIN RECORD_MAX
+
+struct evlog {
+    logger_t *logger;
+    int fd;
+};
+
+#define DEFINE_PUT_SCALAR(type)                                          \
+    static inline void put_##type(char **p_p, evlog_##type##_t value) { \
+        memcpy(*p_p, &value, sizeof value);                              \
+        *p_p += sizeof value;                                            \
+    }
+DEFINE_PUT_SCALAR(u8)
+DEFINE_PUT_SCALAR(u16)
+DEFINE_PUT_SCALAR(u32)
+DEFINE_PUT_SCALAR(u64)
+DEFINE_PUT_SCALAR(i32)
+DEFINE_PUT_SCALAR(i64)
+DEFINE_PUT_SCALAR(ipv4)
+#undef DEFINE_PUT_SCALAR
+
+static inline void put_str(char **p_p, char const *s) {
+    size_t const len = MIN(strlen(s), UINT8_MAX);
+    put_u8(p_p, (uint8_t)len);
+    memcpy(*p_p, s, len);
+    *p_p += len;
+}
+
+/// @brief Fill in the header of a record.
+/// @param rec The record, whose fields have been written.
+/// @param len The length of the record, header included.
+static inline size_t seal(char *rec, size_t len, evlog_event_t event) {
+    struct timespec ts;
+    clock_gettime(CLOCK_REALTIME, &ts);
+    char *p = rec;
+    put_u8(&p, (uint8_t)event);
+    put_u16(&p, (uint16_t)(len - RECORD_HEADER_LEN));
+    put_i64(&p, (int64_t)ts.tv_sec * 1000000000 + ts.tv_nsec);
+    return len;
+}
+
+static size_t fmt_dropped(char *buf, size_t size, size_t n_dropped) {
+    char rec[RECORD_HEADER_LEN + sizeof(evlog_u64_t)], *p = rec + RECORD_HEADER_LEN;
+    put_u64(&p, n_dropped);
+    size_t const len = MIN(seal(rec, (size_t)(p - rec), evlog_event_dropped), size);
+    memcpy(buf, rec, len);
+    return len;
+}
+
+/// @brief Description of a field, for session headers.
+typedef struct {
+    char type_code;
+    char const *field_name;
+} field_desc_t;
+
+#define TYPE_CODE(name, ctype, code) static char const type_code_##name = code;
+X_EVLOG_TYPES(TYPE_CODE)
+#undef TYPE_CODE
+
+#define DESCRIBE_FIELD(type, name) { type_code_##type, #name },
+#define DESCRIBE_EVENT(name, fields) static field_desc_t const gs_fields_##name[] = { fields };
+X_EVLOG_EVENTS(DESCRIBE_EVENT, DESCRIBE_FIELD)
+#undef DESCRIBE_EVENT
+#undef DESCRIBE_FIELD
+
+/// @brief Write the header of a session.
+static bool write_header(int fd) {
+    char header[RECORD_MAX], *p = header;
+    memcpy(p, MAGIC, sizeof MAGIC - 1);
+    p += sizeof MAGIC - 1;
+    put_u8(&p, FORMAT_VERSION);
+    char *const p_n_events = p++;
+    uint8_t n_events = 0;
+#define HEADER_EVENT(name, fields)                             \
+    ++n_events;                                                \
+    put_str(&p, #name);                                        \
+    put_u8(&p, (uint8_t)array_len(gs_fields_##name));          \
+    for (size_t i = 0; i < array_len(gs_fields_##name); ++i) { \
+        put_u8(&p, (uint8_t)gs_fields_##name[i].type_code);    \
+        put_str(&p, gs_fields_##name[i].field_name);           \
+    }
+    X_EVLOG_EVENTS(HEADER_EVENT, )
+#undef HEADER_EVENT
+    *p_n_events = (char)n_events;
+
+    size_t const len = (size_t)(p - header);
+    return write(fd, header, len) == (ssize_t)len;
+}
+
+evlog_t *evlog_open(char const *filename, size_t ring_size, log_overflow_t overflow) {
+    int const fd = open(filename, O_WRONLY | O_CREAT | O_APPEND | O_CLOEXEC, 0644);
+    if (fd == -1) return NULL;
+    if (!write_header(fd)) {
+        close(fd);
+        return NULL;
+    }
+
+    evlog_t *evlog = malloc(sizeof *evlog);
+    if (!evlog) errno_exit("malloc");
+    evlog->fd = fd;
+    evlog->logger = logger_start(fd, MAX(ring_size, RING_MIN), overflow, fmt_dropped);
+    return evlog;
+}
+
+void evlog_close(evlog_t *evlog) {
+    if (!evlog) return;
+    logger_stop(evlog->logger);
+    close(evlog->fd);
+    free(evlog);
+}
+
+#define ENCODE_FIELD(type, name) put_##type(&p, p_event->name);
+#define DEFINE_EVENT(name, fields)                                                          \
+    void evlog_##name(evlog_t *evlog, evlog_##name##_t const *p_event) {                    \
+        if (!evlog) return;                                                                 \
+        char rec[RECORD_MAX], *p = rec + RECORD_HEADER_LEN;                                 \
+        fields                                                                              \
+        logger_write(evlog->logger, rec, seal(rec, (size_t)(p - rec), evlog_event_##name)); \
+    }
+X_EVLOG_EVENTS(DEFINE_EVENT, ENCODE_FIELD)
+#undef DEFINE_EVENT
+#undef ENCODE_FIELD
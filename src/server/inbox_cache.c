@@ -0,0 +1,223 @@
+/// @file
+/// @author Raphaël
+/// @brief Inbox cache - Implementation
+/// @date 18/10/2026
+
+#include "tchatator413/inbox_cache.h"
+#include "stb_ds.h"
+#include "util.h"
+
+/// @brief The newest messages of a recipient.
+typedef struct ring {
+    serial_t recipient_id;
+    /// @brief Neighbours in the LRU list. @ref prev is more recently used.
+    struct ring *prev, *next;
+    /// @brief Number of messages held.
+    int32_t len;
+    /// @brief Index of the newest message in @ref msgs.
+    int32_t head;
+    /// @brief Whether the ring holds every message of the recipient.
+    bool exhaustive;
+    /// @brief Circular buffer of owned messages, from newest to oldest starting at @ref head.
+    msg_t msgs[];
+} ring_t;
+
+typedef struct {
+    serial_t key;
+    ring_t *value;
+} ring_entry;
+
+struct inbox_cache {
+    size_t max_recipients;
+    int32_t ring_size;
+    ring_t *lru_first, *lru_last;
+    ring_entry *rings;
+};
+
+#define ring_at(cache, p_ring, i) (&(p_ring)->msgs[((p_ring)->head + (i)) % (cache)->ring_size])
+
+static inline void lru_unlink(inbox_cache_t *cache, ring_t *p_ring) {
+    if (p_ring->prev) p_ring->prev->next = p_ring->next;
+    else cache->lru_first = p_ring->next;
+    if (p_ring->next) p_ring->next->prev = p_ring->prev;
+    else cache->lru_last = p_ring->prev;
+    p_ring->prev = p_ring->next = NULL;
+}
+
+static inline void lru_push_first(inbox_cache_t *cache, ring_t *p_ring) {
+    p_ring->prev = NULL;
+    p_ring->next = cache->lru_first;
+    if (cache->lru_first) cache->lru_first->prev = p_ring;
+    else cache->lru_last = p_ring;
+    cache->lru_first = p_ring;
+}
+
+static inline void ring_empty(inbox_cache_t *cache, ring_t *p_ring) {
+    for (int32_t i = 0; i < p_ring->len; ++i) {
+        free(ring_at(cache, p_ring, i)->content);
+    }
+    p_ring->len = 0;
+    p_ring->head = 0;
+}
+
+static void ring_drop(inbox_cache_t *cache, ring_t *p_ring) {
+    lru_unlink(cache, p_ring);
+    (void)hmdel(cache->rings, p_ring->recipient_id);
+    ring_empty(cache, p_ring);
+    free(p_ring);
+}
+
+static inline ring_t *ring_find(inbox_cache_t *cache, serial_t recipient_id) {
+    ptrdiff_t i = hmgeti(cache->rings, recipient_id);
+    return i == -1 ? NULL : cache->rings[i].value;
+}
+
+static inline void msg_copy(msg_t *p_dst, msg_t const *p_src) {
+    *p_dst = *p_src;
+    if (!(p_dst->content = strdup(p_src->content))) errno_exit("strdup");
+}
+
+inbox_cache_t *inbox_cache_init(size_t max_recipients, int32_t ring_size) {
+    if (max_recipients == 0 || ring_size <= 0) return NULL;
+    inbox_cache_t *cache = calloc(1, sizeof *cache);
+    if (!cache) errno_exit("calloc");
+    cache->max_recipients = max_recipients;
+    cache->ring_size = ring_size;
+    return cache;
+}
+
+void inbox_cache_destroy(inbox_cache_t *cache) {
+    if (!cache) return;
+    inbox_cache_clear(cache);
+    hmfree(cache->rings);
+    free(cache);
+}
+
+int32_t inbox_cache_ring_size(inbox_cache_t const *cache) {
+    return cache ? cache->ring_size : 0;
+}
+
+bool inbox_cache_get(inbox_cache_t *cache, memlst_t **p_mem, serial_t recipient_id, msg_list_t *out_msgs) {
+    if (!cache) return false;
+    ring_t *p_ring = ring_find(cache, recipient_id);
+    if (!p_ring) return false;
+
+    // A ring that isn't full only knows the newest messages if it knows them all.
+    if (!p_ring->exhaustive && p_ring->len < cache->ring_size) {
+        ring_drop(cache, p_ring);
+        return false;
+    }
+
+    lru_unlink(cache, p_ring);
+    lru_push_first(cache, p_ring);
+
+    out_msgs->n_msgs = (size_t)p_ring->len;
+    out_msgs->msgs = memlst_alloc(p_mem, sizeof *out_msgs->msgs * out_msgs->n_msgs);
+    for (int32_t i = 0; i < p_ring->len; ++i) {
+        out_msgs->msgs[i] = *ring_at(cache, p_ring, i);
+        // The ring may change before the response is written.
+        out_msgs->msgs[i].content = memlst_strdup(p_mem, out_msgs->msgs[i].content);
+    }
+    return true;
+}
+
+void inbox_cache_fill(inbox_cache_t *cache, serial_t recipient_id, msg_list_t msgs) {
+    if (!cache) return;
+
+    ring_t *p_ring = ring_find(cache, recipient_id);
+    if (p_ring) {
+        ring_empty(cache, p_ring);
+        lru_unlink(cache, p_ring);
+    } else {
+        if ((size_t)hmlen(cache->rings) >= cache->max_recipients) ring_drop(cache, cache->lru_last);
+        p_ring = malloc(sizeof *p_ring + sizeof *p_ring->msgs * (size_t)cache->ring_size);
+        if (!p_ring) errno_exit("malloc");
+        p_ring->recipient_id = recipient_id;
+        p_ring->len = p_ring->head = 0;
+        hmput(cache->rings, recipient_id, p_ring);
+    }
+    lru_push_first(cache, p_ring);
+
+    p_ring->exhaustive = msgs.n_msgs < (size_t)cache->ring_size;
+    p_ring->len = (int32_t)MIN(msgs.n_msgs, (size_t)cache->ring_size);
+    for (int32_t i = 0; i < p_ring->len; ++i) {
+        msg_copy(&p_ring->msgs[i], &msgs.msgs[i]);
+    }
+}
+
+void inbox_cache_push(inbox_cache_t *cache, msg_t const *p_msg) {
+    if (!cache) return;
+    ring_t *p_ring = ring_find(cache, p_msg->user_id_recipient);
+    if (!p_ring) return;
+
+    p_ring->head = (p_ring->head + cache->ring_size - 1) % cache->ring_size;
+    if (p_ring->len == cache->ring_size) {
+        // The oldest message is overwritten
+        free(p_ring->msgs[p_ring->head].content);
+        p_ring->exhaustive = false;
+    } else {
+        ++p_ring->len;
+    }
+    msg_copy(&p_ring->msgs[p_ring->head], p_msg);
+}
+
+void inbox_cache_edit(inbox_cache_t *cache, serial_t recipient_id, serial_t msg_id, char const *content, int32_t edited_age) {
+    if (!cache) return;
+    ring_t *p_ring = ring_find(cache, recipient_id);
+    if (!p_ring) return;
+    for (int32_t i = 0; i < p_ring->len; ++i) {
+        msg_t *p_msg = ring_at(cache, p_ring, i);
+        if (p_msg->id != msg_id) continue;
+        char *new_content = strdup(content);
+        if (!new_content) errno_exit("strdup");
+        free(p_msg->content);
+        p_msg->content = new_content;
+        p_msg->edited_age = edited_age;
+        return;
+    }
+}
+
+void inbox_cache_read(inbox_cache_t *cache, serial_t recipient_id, msg_list_t msgs) {
+    if (!cache) return;
+    ring_t *p_ring = ring_find(cache, recipient_id);
+    if (!p_ring) return;
+    for (int32_t i = 0; i < p_ring->len; ++i) {
+        msg_t *p_msg = ring_at(cache, p_ring, i);
+        for (size_t j = 0; j < msgs.n_msgs; ++j) {
+            if (msgs.msgs[j].id != p_msg->id) continue;
+            p_msg->read_age = msgs.msgs[j].read_age;
+            break;
+        }
+    }
+}
+
+void inbox_cache_rm(inbox_cache_t *cache, serial_t recipient_id, serial_t msg_id) {
+    if (!cache) return;
+    ring_t *p_ring = ring_find(cache, recipient_id);
+    if (!p_ring) return;
+    for (int32_t i = 0; i < p_ring->len; ++i) {
+        if (ring_at(cache, p_ring, i)->id != msg_id) continue;
+        // Without the message that would come next, the ring can only stay if it's exhaustive.
+        if (!p_ring->exhaustive) {
+            ring_drop(cache, p_ring);
+            return;
+        }
+        free(ring_at(cache, p_ring, i)->content);
+        for (; i < p_ring->len - 1; ++i) {
+            *ring_at(cache, p_ring, i) = *ring_at(cache, p_ring, i + 1);
+        }
+        --p_ring->len;
+        return;
+    }
+}
+
+void inbox_cache_invalidate(inbox_cache_t *cache, serial_t recipient_id) {
+    if (!cache) return;
+    ring_t *p_ring = ring_find(cache, recipient_id);
+    if (p_ring) ring_drop(cache, p_ring);
+}
+
+void inbox_cache_clear(inbox_cache_t *cache) {
+    if (!cache) return;
+    while (cache->lru_first) ring_drop(cache, cache->lru_first);
+}
@@ -0,0 +1,198 @@
+/// @file
+/// @author Raphaël
+/// @brief JSON fragment cache - Implementation
+/// @date 18/10/2026
+
+#include "tchatator413/json_cache.h"
+#include "util.h"
+#include <stdlib.h>
+#include <string.h>
+
+typedef struct {
+    /// @brief The plain JSON serialization. @remark @c NULL if the slot is empty.
+    char *fragment;
+    size_t len;
+    /// @brief The JSON object. @c NULL until built by the json-c serializer.
+    json_object *jo;
+    /// @brief The message the fragment was written from. Its content is owned by the entry.
+    msg_t msg;
+} msg_entry_t;
+
+typedef struct {
+    /// @brief The plain JSON serialization. @remark @c NULL if the slot is empty.
+    char *fragment;
+    size_t len;
+    /// @brief The JSON object. @c NULL until built by the json-c serializer.
+    json_object *jo;
+    serial_t id;
+    role_t role;
+    char *name; ///< @brief Member user name or pro business name. @c NULL for administrators.
+} user_entry_t;
+
+static size_t gs_mask;
+static msg_entry_t *gs_msgs;
+static user_entry_t *gs_users;
+
+static void delete_fragment(json_object *jo, void *userdata) {
+    (void)jo;
+    free(userdata);
+}
+
+/// @brief Make a JSON object serialize to a fragment from now on.
+static inline void freeze(json_object *jo, char const *fragment, size_t len) {
+    char *copy = strndup(fragment, len);
+    if (!copy) errno_exit("strndup");
+    json_object_set_serializer(jo, json_object_userdata_to_json_string, copy, delete_fragment);
+}
+
+static inline char *dup_fragment(char const *fragment, size_t len) {
+    char *copy = malloc(len);
+    if (!copy) errno_exit("malloc");
+    memcpy(copy, fragment, len);
+    return copy;
+}
+
+static inline char *dup_nullable(char const *s) {
+    if (!s) return NULL;
+    char *copy = strdup(s);
+    if (!copy) errno_exit("strdup");
+    return copy;
+}
+
+static inline char const *user_name(user_t const *p_user) {
+    switch (p_user->role) {
+    case role_member: return p_user->member.user_name;
+    case role_pro: return p_user->pro.business_name;
+    default: return NULL;
+    }
+}
+
+static void msg_entry_set(msg_entry_t *p_entry, msg_t const *p_msg, char const *fragment, size_t len, json_object *jo) {
+    free(p_entry->fragment);
+    free(p_entry->msg.content);
+    json_object_put(p_entry->jo);
+    p_entry->fragment = dup_fragment(fragment, len);
+    p_entry->len = len;
+    p_entry->jo = json_object_get(jo);
+    p_entry->msg = *p_msg;
+    p_entry->msg.content = dup_nullable(p_msg->content);
+}
+
+static void user_entry_set(user_entry_t *p_entry, user_t const *p_user, char const *fragment, size_t len, json_object *jo) {
+    free(p_entry->fragment);
+    free(p_entry->name);
+    json_object_put(p_entry->jo);
+    p_entry->fragment = dup_fragment(fragment, len);
+    p_entry->len = len;
+    p_entry->jo = json_object_get(jo);
+    p_entry->id = p_user->id;
+    p_entry->role = p_user->role;
+    p_entry->name = dup_nullable(user_name(p_user));
+}
+
+/// @return The entry of a message, or @c NULL if it isn't cached as it is.
+static msg_entry_t *find_msg(msg_t const *p_msg) {
+    if (!gs_msgs) return NULL;
+    msg_entry_t *p_entry = &gs_msgs[(size_t)p_msg->id & gs_mask];
+    // The edit ages tell most changes apart, the content catches the rest.
+    if (!p_entry->fragment
+        || p_entry->msg.id != p_msg->id
+        || p_entry->msg.edited_age != p_msg->edited_age
+        || p_entry->msg.read_age != p_msg->read_age
+        || p_entry->msg.deleted_age != p_msg->deleted_age
+        || p_entry->msg.sent_at != p_msg->sent_at
+        || p_entry->msg.user_id_sender != p_msg->user_id_sender
+        || p_entry->msg.user_id_recipient != p_msg->user_id_recipient
+        || !streq(p_entry->msg.content, p_msg->content)) return NULL;
+    return p_entry;
+}
+
+/// @return The entry of a user, or @c NULL if it isn't cached as it is.
+static user_entry_t *find_user(user_t const *p_user) {
+    if (!gs_users) return NULL;
+    user_entry_t *p_entry = &gs_users[(size_t)p_user->id & gs_mask];
+    if (!p_entry->fragment
+        || p_entry->id != p_user->id
+        || p_entry->role != p_user->role
+        || !streq_nullable(p_entry->name, user_name(p_user))) return NULL;
+    return p_entry;
+}
+
+void json_cache_init(size_t capacity) {
+    json_cache_destroy();
+    if (capacity == 0) return;
+
+    size_t n = 1;
+    while (n < capacity) n <<= 1;
+    gs_mask = n - 1;
+    if (!(gs_msgs = calloc(n, sizeof *gs_msgs))) errno_exit("calloc");
+    if (!(gs_users = calloc(n, sizeof *gs_users))) errno_exit("calloc");
+}
+
+void json_cache_destroy(void) {
+    if (!gs_msgs) return;
+    for (size_t i = 0; i <= gs_mask; ++i) {
+        free(gs_msgs[i].fragment);
+        free(gs_msgs[i].msg.content);
+        json_object_put(gs_msgs[i].jo);
+        free(gs_users[i].fragment);
+        free(gs_users[i].name);
+        json_object_put(gs_users[i].jo);
+    }
+    free(gs_msgs);
+    free(gs_users);
+    gs_msgs = NULL;
+    gs_users = NULL;
+}
+
+json_object *json_cache_get_msg(msg_t const *p_msg) {
+    msg_entry_t const *p_entry = find_msg(p_msg);
+    return p_entry && p_entry->jo ? json_object_get(p_entry->jo) : NULL;
+}
+
+void json_cache_put_msg(msg_t const *p_msg, json_object *jo) {
+    if (!gs_msgs) return;
+    size_t len;
+    char const *fragment = json_object_to_json_string_length(jo, JSON_C_TO_STRING_PLAIN, &len);
+    msg_entry_t *p_entry = &gs_msgs[(size_t)p_msg->id & gs_mask];
+    msg_entry_set(p_entry, p_msg, fragment, len, jo);
+    freeze(jo, p_entry->fragment, p_entry->len);
+}
+
+char const *json_cache_get_msg_fragment(msg_t const *p_msg, size_t *out_len) {
+    msg_entry_t const *p_entry = find_msg(p_msg);
+    if (!p_entry) return NULL;
+    *out_len = p_entry->len;
+    return p_entry->fragment;
+}
+
+void json_cache_put_msg_fragment(msg_t const *p_msg, char const *fragment, size_t len) {
+    if (!gs_msgs) return;
+    msg_entry_set(&gs_msgs[(size_t)p_msg->id & gs_mask], p_msg, fragment, len, NULL);
+}
+
+json_object *json_cache_get_user(user_t const *p_user) {
+    user_entry_t const *p_entry = find_user(p_user);
+    return p_entry && p_entry->jo ? json_object_get(p_entry->jo) : NULL;
+}
+
+void json_cache_put_user(user_t const *p_user, json_object *jo) {
+    if (!gs_users) return;
+    size_t len;
+    char const *fragment = json_object_to_json_string_length(jo, JSON_C_TO_STRING_PLAIN, &len);
+    user_entry_t *p_entry = &gs_users[(size_t)p_user->id & gs_mask];
+    user_entry_set(p_entry, p_user, fragment, len, jo);
+    freeze(jo, p_entry->fragment, p_entry->len);
+}
+
+char const *json_cache_get_user_fragment(user_t const *p_user, size_t *out_len) {
+    user_entry_t const *p_entry = find_user(p_user);
+    if (!p_entry) return NULL;
+    *out_len = p_entry->len;
+    return p_entry->fragment;
+}
+
+void json_cache_put_user_fragment(user_t const *p_user, char const *fragment, size_t len) {
+    if (!gs_users) return;
+    user_entry_set(&gs_users[(size_t)p_user->id & gs_mask], p_user, fragment, len, NULL);
+}
@@ -0,0 +1,139 @@
+/// @file
+/// @author Raphaël
+/// @brief Streaming JSON writer - Implementation
+/// @date 18/10/2026
+
+#include "tchatator413/json_writer.h"
+#include "util.h"
+#include <stdbool.h>
+#include <stdlib.h>
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+/// @brief Escape of each byte: the character following the backslash, @c u for a @c \\u00XX sequence, or @c 0 to keep it as-is.
+static char const gs_escapes[256] = {
+    'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u', 'b', 't', 'n', 'u', 'f', 'r', 'u', 'u',
+    'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u', 'u',
+    ['"'] = '"',
+    ['/'] = '/',
+    ['\\'] = '\\',
+};
+
+static char const gs_digit_pairs[] = "00010203040506070809"
+                                     "10111213141516171819"
+                                     "20212223242526272829"
+                                     "30313233343536373839"
+                                     "40414243444546474849"
+                                     "50515253545556575859"
+                                     "60616263646566676869"
+                                     "70717273747576777879"
+                                     "80818283848586878889"
+                                     "90919293949596979899";
+
+void json_writer_destroy(json_writer_t *p_writer) {
+    free(p_writer->buf);
+    *p_writer = JSON_WRITER_INIT;
+}
+
+void json_writer_reserve(json_writer_t *p_writer, size_t n) {
+    if (p_writer->len + n <= p_writer->cap) return;
+    size_t cap = p_writer->cap ? p_writer->cap : 256;
+    while (cap < p_writer->len + n) cap *= 2;
+    char *buf = realloc(p_writer->buf, cap);
+    if (!buf) errno_exit("realloc");
+    p_writer->buf = buf;
+    p_writer->cap = cap;
+}
+
+char const *json_writer_str(json_writer_t *p_writer) {
+    json_writer_reserve(p_writer, 1);
+    p_writer->buf[p_writer->len] = '\0';
+    return p_writer->buf;
+}
+
+void json_writer_int(json_writer_t *p_writer, int64_t value) {
+    char tmp[24], *const end = tmp + sizeof tmp, *p = end;
+    uint64_t u = value < 0 ? -(uint64_t)value : (uint64_t)value;
+
+    // Two digits at a time, from the right
+    while (u >= 100) {
+        char const *pair = gs_digit_pairs + u % 100 * 2;
+        u /= 100;
+        *--p = pair[1];
+        *--p = pair[0];
+    }
+    if (u >= 10) {
+        char const *pair = gs_digit_pairs + u * 2;
+        *--p = pair[1];
+        *--p = pair[0];
+    } else {
+        *--p = (char)('0' + u);
+    }
+    if (value < 0) *--p = '-';
+
+    json_writer_raw(p_writer, p, (size_t)(end - p));
+}
+
+/// @brief Append the escape sequence of a byte that needs one.
+static inline void write_escape(json_writer_t *p_writer, unsigned char c) {
+    static char const hex[] = "0123456789abcdef";
+    char const escape = gs_escapes[c];
+    if (escape == 'u') {
+        char const seq[] = { '\\', 'u', '0', '0', hex[c >> 4], hex[c & 0xf] };
+        json_writer_raw(p_writer, seq, sizeof seq);
+    } else {
+        char const seq[] = { '\\', escape };
+        json_writer_raw(p_writer, seq, sizeof seq);
+    }
+}
+
+/// @brief Get the length of the prefix of a string that needs no escaping.
+static inline size_t clean_prefix_len(char const *s, size_t len) {
+    size_t i = 0;
+#ifdef __SSE2__
+    // 16 bytes at a time: control bytes, quotes, backslashes and slashes
+    __m128i const max_control = _mm_set1_epi8(0x1f), quote = _mm_set1_epi8('"'), backslash = _mm_set1_epi8('\\'), slash = _mm_set1_epi8('/');
+    for (; i + 16 <= len; i += 16) {
+        __m128i const c = _mm_loadu_si128((__m128i const *)(s + i));
+        __m128i const needs_escape = _mm_or_si128(
+            _mm_or_si128(_mm_cmpeq_epi8(_mm_min_epu8(c, max_control), c), _mm_cmpeq_epi8(c, quote)),
+            _mm_or_si128(_mm_cmpeq_epi8(c, backslash), _mm_cmpeq_epi8(c, slash)));
+        int const mask = _mm_movemask_epi8(needs_escape);
+        if (mask) return i + (size_t)__builtin_ctz((unsigned)mask);
+    }
+#endif
+    while (i < len && !gs_escapes[(unsigned char)s[i]]) ++i;
+    return i;
+}
+
+void json_writer_escaped(json_writer_t *p_writer, char const *s, size_t len) {
+    // Copy runs of bytes that need no escaping at once
+    json_writer_reserve(p_writer, len);
+    while (true) {
+        size_t const run = clean_prefix_len(s, len);
+        json_writer_raw(p_writer, s, run);
+        if (run == len) break;
+        write_escape(p_writer, (unsigned char)s[run]);
+        s += run + 1;
+        len -= run + 1;
+    }
+}
+
+void json_writer_escaped_scalar(json_writer_t *p_writer, char const *s, size_t len) {
+    size_t run = 0;
+    for (size_t i = 0; i < len; ++i) {
+        if (!gs_escapes[(unsigned char)s[i]]) continue;
+        json_writer_raw(p_writer, s + run, i - run);
+        write_escape(p_writer, (unsigned char)s[i]);
+        run = i + 1;
+    }
+    json_writer_raw(p_writer, s + run, len - run);
+}
+
+void json_writer_json_object(json_writer_t *p_writer, json_object *jo) {
+    size_t len;
+    char const *s = json_object_to_json_string_length(jo, JSON_C_TO_STRING_PLAIN, &len);
+    json_writer_raw(p_writer, s, len);
+}
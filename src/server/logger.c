@@ -0,0 +1,270 @@
+/// @file
+/// @author Raphaël
+/// @brief Asynchronous logger - Implementation
+///
+/// Each ring has a single producer, its thread, and a single consumer at a time, serialized by @c drain_lock.
+/// Producers only touch @c head and consumers only touch @c tail, so neither side waits on the other unless a ring is full.
+///
+/// @date 18/10/2026
+
+#include "tchatator413/logger.h"
+#include <errno.h>
+#include <pthread.h>
+#include <sched.h>
+#include <signal.h>
+#include <stdatomic.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/uio.h>
+#include <time.h>
+#include <unistd.h>
+
+/// @brief Interval at which the background thread drains the rings, in milliseconds.
+#define FLUSH_INTERVAL_MS 50
+/// @brief Maximum length of a formatted entry. Longer entries are truncated.
+#define ENTRY_MAX 4096
+/// @brief Minimum capacity of a ring.
+#define RING_MIN 64
+
+/// @brief The ring of a logging thread.
+typedef struct ring {
+    /// @brief The next ring of the same logger.
+    struct ring *next;
+    /// @brief The buffer, of @c mask + 1 bytes.
+    char *data;
+    size_t mask;
+    /// @brief Number of bytes ever written. Only advanced by the producer.
+    atomic_size_t head;
+    /// @brief Number of bytes ever drained. Only advanced by the consumer.
+    atomic_size_t tail;
+} ring_t;
+
+struct logger {
+    /// @brief The ring of each thread that has logged, so a thread switching between loggers keeps its rings.
+    pthread_key_t ring_key;
+    int fd;
+    log_overflow_t overflow;
+    logger_fmt_dropped_fn fmt_dropped;
+    size_t ring_size;
+    /// @brief The rings of every thread that has logged, newest first.
+    _Atomic(ring_t *) rings;
+    atomic_size_t n_rings;
+    atomic_size_t n_dropped;
+    /// @brief Value of @ref n_dropped last reported in the log.
+    size_t n_dropped_reported;
+    pthread_mutex_t drain_lock;
+    pthread_mutex_t wake_lock;
+    pthread_cond_t wake;
+    bool stopping;
+    pthread_t thread;
+};
+
+/// @brief State of the logging thread.
+static _Thread_local struct {
+    /// @brief The second @ref stamp was formatted for.
+    time_t second;
+    char stamp[32];
+    /// @brief Scratch buffer entries are formatted into.
+    char entry[ENTRY_MAX];
+} tl;
+
+static void write_all(int fd, struct iovec *iov, int iovcnt) {
+    while (iovcnt > 0) {
+        ssize_t written = writev(fd, iov, iovcnt);
+        if (written < 0) {
+            if (errno == EINTR) continue;
+            return; // Nowhere to report it.
+        }
+        while (iovcnt > 0 && (size_t)written >= iov->iov_len) {
+            written -= (ssize_t)iov->iov_len;
+            ++iov;
+            --iovcnt;
+        }
+        if (iovcnt > 0) {
+            iov->iov_base = (char *)iov->iov_base + written;
+            iov->iov_len -= (size_t)written;
+        }
+    }
+}
+
+/// @brief Write what the rings hold.
+static void drain(logger_t *logger) {
+    pthread_mutex_lock(&logger->drain_lock);
+
+    for (ring_t *ring = atomic_load_explicit(&logger->rings, memory_order_acquire); ring; ring = ring->next) {
+        size_t const tail = atomic_load_explicit(&ring->tail, memory_order_relaxed);
+        size_t const head = atomic_load_explicit(&ring->head, memory_order_acquire);
+        if (head == tail) continue;
+
+        // At most two segments, if the contents wrap around.
+        size_t const at = tail & ring->mask, len = head - tail, first = MIN(len, ring->mask + 1 - at);
+        struct iovec iov[] = {
+            { .iov_base = ring->data + at, .iov_len = first },
+            { .iov_base = ring->data, .iov_len = len - first },
+        };
+        write_all(logger->fd, iov, len > first ? 2 : 1);
+
+        atomic_store_explicit(&ring->tail, head, memory_order_release);
+    }
+
+    size_t const n_dropped = atomic_load_explicit(&logger->n_dropped, memory_order_relaxed);
+    if (n_dropped != logger->n_dropped_reported) {
+        char msg[64];
+        size_t const len = logger->fmt_dropped(msg, sizeof msg, n_dropped - logger->n_dropped_reported);
+        write_all(logger->fd, &(struct iovec) { .iov_base = msg, .iov_len = len }, 1);
+        logger->n_dropped_reported = n_dropped;
+    }
+
+    pthread_mutex_unlock(&logger->drain_lock);
+}
+
+static size_t fmt_dropped_text(char *buf, size_t size, size_t n_dropped) {
+    return MIN((size_t)snprintf(buf, size, "logger: %zu entries dropped\n", n_dropped), size - 1);
+}
+
+static void *run(void *arg) {
+    logger_t *logger = arg;
+    pthread_mutex_lock(&logger->wake_lock);
+    while (!logger->stopping) {
+        struct timespec deadline;
+        clock_gettime(CLOCK_REALTIME, &deadline);
+        deadline.tv_nsec += FLUSH_INTERVAL_MS * 1000000L;
+        if (deadline.tv_nsec >= 1000000000L) {
+            ++deadline.tv_sec;
+            deadline.tv_nsec -= 1000000000L;
+        }
+        pthread_cond_timedwait(&logger->wake, &logger->wake_lock, &deadline);
+
+        pthread_mutex_unlock(&logger->wake_lock);
+        drain(logger);
+        pthread_mutex_lock(&logger->wake_lock);
+    }
+    pthread_mutex_unlock(&logger->wake_lock);
+    return NULL;
+}
+
+logger_t *logger_start(int fd, size_t ring_size, log_overflow_t overflow, logger_fmt_dropped_fn fmt_dropped) {
+    logger_t *logger = calloc(1, sizeof *logger);
+    if (!logger) errno_exit("calloc");
+
+    if ((errno = pthread_key_create(&logger->ring_key, NULL))) errno_exit("pthread_key_create");
+    logger->fd = fd;
+    logger->overflow = overflow;
+    logger->fmt_dropped = fmt_dropped ? fmt_dropped : fmt_dropped_text;
+    logger->ring_size = RING_MIN;
+    while (logger->ring_size < ring_size) logger->ring_size *= 2;
+
+    pthread_mutex_init(&logger->drain_lock, NULL);
+    pthread_mutex_init(&logger->wake_lock, NULL);
+    pthread_cond_init(&logger->wake, NULL);
+    // Signals are for the thread serving requests: their handlers expect to interrupt its accept().
+    sigset_t all, old;
+    sigfillset(&all);
+    pthread_sigmask(SIG_SETMASK, &all, &old);
+    if ((errno = pthread_create(&logger->thread, NULL, run, logger))) errno_exit("pthread_create");
+    pthread_sigmask(SIG_SETMASK, &old, NULL);
+
+    return logger;
+}
+
+void logger_stop(logger_t *logger) {
+    if (!logger) return;
+
+    pthread_mutex_lock(&logger->wake_lock);
+    logger->stopping = true;
+    pthread_cond_signal(&logger->wake);
+    pthread_mutex_unlock(&logger->wake_lock);
+    pthread_join(logger->thread, NULL);
+
+    drain(logger);
+
+    for (ring_t *ring = atomic_load(&logger->rings), *next; ring; ring = next) {
+        next = ring->next;
+        free(ring->data);
+        free(ring);
+    }
+    pthread_key_delete(logger->ring_key);
+    pthread_cond_destroy(&logger->wake);
+    pthread_mutex_destroy(&logger->wake_lock);
+    pthread_mutex_destroy(&logger->drain_lock);
+    free(logger);
+}
+
+/// @brief Get the ring of the calling thread, registering one on first use.
+static ring_t *own_ring(logger_t *logger) {
+    ring_t *ring = pthread_getspecific(logger->ring_key);
+    if (ring) return ring;
+
+    ring = calloc(1, sizeof *ring);
+    if (!ring) errno_exit("calloc");
+    if (!(ring->data = malloc(logger->ring_size))) errno_exit("malloc");
+    ring->mask = logger->ring_size - 1;
+
+    ring->next = atomic_load(&logger->rings);
+    while (!atomic_compare_exchange_weak(&logger->rings, &ring->next, ring));
+    atomic_fetch_add_explicit(&logger->n_rings, 1, memory_order_relaxed);
+
+    if ((errno = pthread_setspecific(logger->ring_key, ring))) errno_exit("pthread_setspecific");
+    return ring;
+}
+
+static void wake(logger_t *logger) {
+    pthread_cond_signal(&logger->wake);
+}
+
+void logger_write(logger_t *logger, char const *s, size_t len) {
+    ring_t *ring = own_ring(logger);
+    size_t const cap = ring->mask + 1;
+    if (len > cap) len = cap;
+
+    size_t const head = atomic_load_explicit(&ring->head, memory_order_relaxed);
+    size_t tail;
+    while (cap - (head - (tail = atomic_load_explicit(&ring->tail, memory_order_acquire))) < len) {
+        if (logger->overflow == log_overflow_drop) {
+            atomic_fetch_add_explicit(&logger->n_dropped, 1, memory_order_relaxed);
+            return;
+        }
+        wake(logger);
+        sched_yield();
+    }
+
+    size_t const at = head & ring->mask, first = MIN(len, cap - at);
+    memcpy(ring->data + at, s, first);
+    memcpy(ring->data, s + first, len - first);
+    atomic_store_explicit(&ring->head, head + len, memory_order_release);
+
+    // Wake the background thread early when the ring gets half full, rather than for every entry.
+    size_t const used = head + len - tail;
+    if (used > cap / 2 && used - len <= cap / 2) wake(logger);
+}
+
+void logger_vlog(logger_t *logger, char const *file, int line, char const *lvl_prefix, char const *fmt, va_list ap) {
+    time_t const now = time(NULL);
+    if (now != tl.second || !tl.stamp[0]) {
+        struct tm tm;
+        strftime(tl.stamp, sizeof tl.stamp, "%F %H:%M:%S", localtime_r(&now, &tm));
+        tl.second = now;
+    }
+
+    size_t len = (size_t)snprintf(tl.entry, sizeof tl.entry, "%s:%s:%d: %s", tl.stamp, file, line, lvl_prefix);
+    if (len < sizeof tl.entry) len += (size_t)vsnprintf(tl.entry + len, sizeof tl.entry - len, fmt, ap);
+    if (len >= sizeof tl.entry) {
+        len = sizeof tl.entry - 1;
+        tl.entry[len - 1] = '\n';
+    }
+
+    logger_write(logger, tl.entry, len);
+}
+
+void logger_flush(logger_t *logger) {
+    drain(logger);
+}
+
+size_t logger_dropped(logger_t const *logger) {
+    return atomic_load_explicit(&logger->n_dropped, memory_order_relaxed);
+}
+
+size_t logger_rings(logger_t const *logger) {
+    return atomic_load_explicit(&logger->n_rings, memory_order_relaxed);
+}
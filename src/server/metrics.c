@@ -0,0 +1,200 @@
+/// @file
+/// @author Raphaël
+/// @brief Metrics registry - Implementation
+///
+/// A shard only has one writer, its thread, so counters are bumped with a relaxed load and store rather than a locked read-modify-write.
+/// Readers may see a counter lag behind, but never torn.
+///
+/// @date 18/10/2026
+
+#include "tchatator413/metrics.h"
+#include <stdatomic.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#define SUB_BUCKET_COUNT (1u << METRICS_SUB_BUCKET_BITS)
+#define SUB_BUCKET_HALF (SUB_BUCKET_COUNT / 2)
+
+typedef atomic_uint_fast64_t counter_t;
+
+/// @brief Indexes of statuses in @ref metrics_snapshot_t.n_statuses.
+enum {
+#define ENUM_VALUE(name, code) status_index_##name,
+    X_STATUSES(ENUM_VALUE)
+#undef ENUM_VALUE
+};
+
+typedef struct {
+    counter_t count, sum_ns, max_ns;
+    counter_t buckets[METRICS_N_BUCKETS];
+} histogram_shard_t;
+
+typedef struct {
+    counter_t n_calls, sum_ns, max_ns, n_rows;
+} query_shard_t;
+
+/// @brief The counters of a thread.
+typedef struct shard {
+    /// @brief The next shard.
+    struct shard *next;
+    counter_t n_actions[metrics_n_action_types];
+    counter_t n_round_trips[metrics_n_action_types], max_round_trips[metrics_n_action_types];
+    counter_t n_statuses[metrics_n_statuses];
+    histogram_shard_t latency[metrics_n_stages];
+    query_shard_t queries[metrics_n_queries];
+    counter_t n_turnstile_rejections;
+    counter_t n_bytes_in, n_bytes_out;
+} shard_t;
+
+/// @brief The shards of every thread that has recorded, newest first.
+static _Atomic(shard_t *) gs_shards;
+
+static _Thread_local shard_t *tl_shard;
+
+/// @brief Get the shard of the calling thread, registering one on first use.
+static inline shard_t *own_shard(void) {
+    if (tl_shard) return tl_shard;
+
+    shard_t *shard = calloc(1, sizeof *shard);
+    if (!shard) errno_exit("calloc");
+
+    shard->next = atomic_load(&gs_shards);
+    while (!atomic_compare_exchange_weak(&gs_shards, &shard->next, shard));
+
+    return tl_shard = shard;
+}
+
+static inline void bump(counter_t *p_counter, uint64_t n) {
+    atomic_store_explicit(p_counter, atomic_load_explicit(p_counter, memory_order_relaxed) + n, memory_order_relaxed);
+}
+
+static inline uint64_t load(counter_t const *p_counter) {
+    return atomic_load_explicit(p_counter, memory_order_relaxed);
+}
+
+uint64_t metrics_clock(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000 + (uint64_t)ts.tv_nsec;
+}
+
+size_t metrics_bucket_of(uint64_t value) {
+    if (value < SUB_BUCKET_COUNT) return value;
+    // The shift that brings the value within [SUB_BUCKET_HALF, SUB_BUCKET_COUNT)
+    unsigned const shift = 64 - (unsigned)__builtin_clzll(value) - METRICS_SUB_BUCKET_BITS;
+    return ((size_t)shift * SUB_BUCKET_HALF) + (size_t)(value >> shift);
+}
+
+uint64_t metrics_bucket_max(size_t bucket) {
+    if (bucket < SUB_BUCKET_COUNT) return bucket;
+    size_t const shift = bucket / SUB_BUCKET_HALF - 1;
+    return ((uint64_t)(bucket - shift * SUB_BUCKET_HALF + 1) << shift) - 1;
+}
+
+void metrics_record(metrics_stage_t stage, uint64_t duration_ns) {
+    histogram_shard_t *h = &own_shard()->latency[stage];
+    bump(&h->count, 1);
+    bump(&h->sum_ns, duration_ns);
+    if (duration_ns > load(&h->max_ns)) atomic_store_explicit(&h->max_ns, duration_ns, memory_order_relaxed);
+    bump(&h->buckets[metrics_bucket_of(duration_ns)], 1);
+}
+
+void metrics_record_query(metrics_query_t query, uint64_t duration_ns, uint64_t n_rows) {
+    query_shard_t *q = &own_shard()->queries[query];
+    bump(&q->n_calls, 1);
+    bump(&q->sum_ns, duration_ns);
+    if (duration_ns > load(&q->max_ns)) atomic_store_explicit(&q->max_ns, duration_ns, memory_order_relaxed);
+    bump(&q->n_rows, n_rows);
+}
+
+char const *metrics_query_name(metrics_query_t query) {
+    static char const *const names[] = {
+#define NAME(name) [metrics_query_##name] = #name,
+        X_METRICS_QUERIES(NAME)
+#undef NAME
+    };
+    return names[query];
+}
+
+void metrics_count_action(action_type_t type) {
+    bump(&own_shard()->n_actions[type], 1);
+}
+
+void metrics_count_round_trips(action_type_t type, uint64_t n) {
+    shard_t *shard = own_shard();
+    bump(&shard->n_round_trips[type], n);
+    if (n > load(&shard->max_round_trips[type])) atomic_store_explicit(&shard->max_round_trips[type], n, memory_order_relaxed);
+}
+
+void metrics_count_status(status_t status) {
+    size_t i;
+    switch (status) {
+#define STATUS_INDEX(name, code) \
+    case status_##name: i = status_index_##name; break;
+        X_STATUSES(STATUS_INDEX)
+#undef STATUS_INDEX
+    default: unreachable();
+    }
+    bump(&own_shard()->n_statuses[i], 1);
+}
+
+void metrics_count_turnstile_rejection(void) {
+    bump(&own_shard()->n_turnstile_rejections, 1);
+}
+
+void metrics_count_bytes(size_t n_in, size_t n_out) {
+    shard_t *shard = own_shard();
+    bump(&shard->n_bytes_in, n_in);
+    bump(&shard->n_bytes_out, n_out);
+}
+
+void metrics_snapshot(metrics_snapshot_t *out_snapshot) {
+    memset(out_snapshot, 0, sizeof *out_snapshot);
+
+    for (shard_t const *shard = atomic_load(&gs_shards); shard; shard = shard->next) {
+        for (size_t i = 0; i < metrics_n_action_types; ++i) {
+            out_snapshot->n_actions[i] += load(&shard->n_actions[i]);
+            out_snapshot->n_round_trips[i] += load(&shard->n_round_trips[i]);
+            out_snapshot->max_round_trips[i] = MAX(out_snapshot->max_round_trips[i], load(&shard->max_round_trips[i]));
+        }
+        for (size_t i = 0; i < metrics_n_statuses; ++i) out_snapshot->n_statuses[i] += load(&shard->n_statuses[i]);
+        for (size_t s = 0; s < metrics_n_stages; ++s) {
+            metrics_histogram_t *h = &out_snapshot->latency[s];
+            histogram_shard_t const *h_shard = &shard->latency[s];
+            h->count += load(&h_shard->count);
+            h->sum_ns += load(&h_shard->sum_ns);
+            h->max_ns = MAX(h->max_ns, load(&h_shard->max_ns));
+            for (size_t b = 0; b < METRICS_N_BUCKETS; ++b) h->buckets[b] += load(&h_shard->buckets[b]);
+        }
+        for (size_t i = 0; i < metrics_n_queries; ++i) {
+            metrics_query_stats_t *q = &out_snapshot->queries[i];
+            query_shard_t const *q_shard = &shard->queries[i];
+            q->n_calls += load(&q_shard->n_calls);
+            q->sum_ns += load(&q_shard->sum_ns);
+            q->max_ns = MAX(q->max_ns, load(&q_shard->max_ns));
+            q->n_rows += load(&q_shard->n_rows);
+        }
+        out_snapshot->n_turnstile_rejections += load(&shard->n_turnstile_rejections);
+        out_snapshot->n_bytes_in += load(&shard->n_bytes_in);
+        out_snapshot->n_bytes_out += load(&shard->n_bytes_out);
+    }
+}
+
+uint64_t metrics_quantile(metrics_histogram_t const *p_histogram, double q) {
+    // The buckets are summed rather than trusting count, which may lag behind them in a snapshot.
+    uint64_t total = 0;
+    for (size_t b = 0; b < METRICS_N_BUCKETS; ++b) total += p_histogram->buckets[b];
+    if (!total) return 0;
+
+    double const exact_rank = q * (double)total;
+    uint64_t rank = (uint64_t)exact_rank;
+    if ((double)rank < exact_rank) ++rank;
+    rank = rank < 1 ? 1 : MIN(rank, total);
+
+    uint64_t seen = 0;
+    for (size_t b = 0; b < METRICS_N_BUCKETS; ++b) {
+        if ((seen += p_histogram->buckets[b]) >= rank) return MIN(metrics_bucket_max(b), p_histogram->max_ns);
+    }
+    unreachable();
+}
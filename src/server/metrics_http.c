@@ -0,0 +1,304 @@
+/// @file
+/// @author Raphaël
+/// @brief Prometheus metrics listener - Implementation
+/// @date 18/10/2026
+
+#include "tchatator413/metrics_http.h"
+#include <arpa/inet.h>
+#include <errno.h>
+#include <pthread.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <time.h>
+#include <unistd.h>
+
+#define LISTEN_ADDR "127.0.0.1"
+/// @brief Maximum length of a scrape request. The rest is ignored.
+#define REQUEST_MAX 1024
+/// @brief How long a scraper may take to send its request or read the response, in seconds.
+#define IO_TIMEOUT_S 1
+#define PREFIX "tchatator_"
+
+struct metrics_http {
+    cfg_t *cfg;
+    int sock;
+    /// @brief The path of the Unix socket, or @c NULL for TCP.
+    char *socket_path;
+    time_t start_time;
+    pthread_t thread;
+};
+
+/// @brief Upper bounds of the histogram buckets exposed, in nanoseconds and as labels in seconds.
+static struct {
+    uint64_t ns;
+    char const *le;
+} const gs_les[] = {
+    { 1000, "1e-06" },
+    { 2500, "2.5e-06" },
+    { 5000, "5e-06" },
+    { 10000, "1e-05" },
+    { 25000, "2.5e-05" },
+    { 50000, "5e-05" },
+    { 100000, "0.0001" },
+    { 250000, "0.00025" },
+    { 500000, "0.0005" },
+    { 1000000, "0.001" },
+    { 2500000, "0.0025" },
+    { 5000000, "0.005" },
+    { 10000000, "0.01" },
+    { 25000000, "0.025" },
+    { 50000000, "0.05" },
+    { 100000000, "0.1" },
+    { 250000000, "0.25" },
+    { 500000000, "0.5" },
+    { 1000000000, "1" },
+    { 2500000000, "2.5" },
+    { 5000000000, "5" },
+    { 10000000000, "10" },
+};
+
+static inline void put_header(FILE *f, char const *name, char const *type, char const *help) {
+    fprintf(f, "# HELP " PREFIX "%s %s\n# TYPE " PREFIX "%s %s\n", name, help, name, type);
+}
+
+static void put_histogram(FILE *f, char const *stage, metrics_histogram_t const *h) {
+    // An exposed bucket counts the values of the registry buckets that end within it, so values are never under-estimated.
+    uint64_t cumulative = 0;
+    size_t b = 0;
+    for (size_t i = 0; i < array_len(gs_les); ++i) {
+        for (; b < METRICS_N_BUCKETS && metrics_bucket_max(b) <= gs_les[i].ns; ++b) cumulative += h->buckets[b];
+        fprintf(f, PREFIX "stage_duration_seconds_bucket{stage=\"%s\",le=\"%s\"} %lu\n", stage, gs_les[i].le, cumulative);
+    }
+    for (; b < METRICS_N_BUCKETS; ++b) cumulative += h->buckets[b];
+    fprintf(f, PREFIX "stage_duration_seconds_bucket{stage=\"%s\",le=\"+Inf\"} %lu\n", stage, cumulative);
+    // The count of a Prometheus histogram must match its +Inf bucket.
+    fprintf(f, PREFIX "stage_duration_seconds_count{stage=\"%s\"} %lu\n", stage, cumulative);
+    fprintf(f, PREFIX "stage_duration_seconds_sum{stage=\"%s\"} %lu.%09lu\n", stage, h->sum_ns / 1000000000, h->sum_ns % 1000000000);
+}
+
+char *metrics_format_prometheus(metrics_snapshot_t const *p_snapshot, time_t start_time, size_t *out_len) {
+    char *text;
+    FILE *f = open_memstream(&text, out_len);
+    if (!f) errno_exit("open_memstream");
+
+    put_header(f, "actions_total", "counter", "Actions evaluated, by type.");
+    fprintf(f, PREFIX "actions_total{action=\"error\"} %lu\n", p_snapshot->n_actions[action_type_error]);
+#define PUT_ACTION(name) fprintf(f, PREFIX "actions_total{action=\"" #name "\"} %lu\n", p_snapshot->n_actions[action_type_##name]);
+    X_ACTIONS(PUT_ACTION)
+#undef PUT_ACTION
+
+    put_header(f, "db_round_trips_total", "counter", "Database round-trips of actions, by type.");
+    fprintf(f, PREFIX "db_round_trips_total{action=\"error\"} %lu\n", p_snapshot->n_round_trips[action_type_error]);
+#define PUT_ACTION(name) fprintf(f, PREFIX "db_round_trips_total{action=\"" #name "\"} %lu\n", p_snapshot->n_round_trips[action_type_##name]);
+    X_ACTIONS(PUT_ACTION)
+#undef PUT_ACTION
+
+    put_header(f, "db_round_trips_max", "gauge", "Highest number of database round-trips of an action, by type.");
+    fprintf(f, PREFIX "db_round_trips_max{action=\"error\"} %lu\n", p_snapshot->max_round_trips[action_type_error]);
+#define PUT_ACTION(name) fprintf(f, PREFIX "db_round_trips_max{action=\"" #name "\"} %lu\n", p_snapshot->max_round_trips[action_type_##name]);
+    X_ACTIONS(PUT_ACTION)
+#undef PUT_ACTION
+
+    put_header(f, "responses_total", "counter", "Responses, by status.");
+    size_t i_status = 0;
+#define PUT_STATUS(name, code) fprintf(f, PREFIX "responses_total{status=\"" #code "\"} %lu\n", p_snapshot->n_statuses[i_status++]);
+    X_STATUSES(PUT_STATUS)
+#undef PUT_STATUS
+
+    put_header(f, "stage_duration_seconds", "histogram", "Latency of the stages of a request.");
+#define PUT_STAGE(name) put_histogram(f, #name, &p_snapshot->latency[metrics_stage_##name]);
+    X_METRICS_STAGES(PUT_STAGE)
+#undef PUT_STAGE
+
+    put_header(f, "stage_duration_max_seconds", "gauge", "Highest latency of the stages of a request.");
+#define PUT_STAGE(name)                                                                                       \
+    fprintf(f, PREFIX "stage_duration_max_seconds{stage=\"" #name "\"} %lu.%09lu\n",                          \
+        p_snapshot->latency[metrics_stage_##name].max_ns / 1000000000, p_snapshot->latency[metrics_stage_##name].max_ns % 1000000000);
+    X_METRICS_STAGES(PUT_STAGE)
+#undef PUT_STAGE
+
+#define PUT_QUERIES(series, type, help, fmt, ...)                                                 \
+    put_header(f, series, type, help);                                                            \
+    for (size_t i = 0; i < metrics_n_queries; ++i) {                                              \
+        metrics_query_stats_t const *q = &p_snapshot->queries[i];                                 \
+        fprintf(f, PREFIX series "{query=\"%s\"} " fmt "\n", metrics_query_name(i), __VA_ARGS__); \
+    }
+    PUT_QUERIES("db_query_calls_total", "counter", "Runs of each database statement.", "%lu", q->n_calls)
+    PUT_QUERIES("db_query_duration_seconds_total", "counter", "Total round-trip time of each database statement.", "%lu.%09lu", q->sum_ns / 1000000000, q->sum_ns % 1000000000)
+    PUT_QUERIES("db_query_duration_max_seconds", "gauge", "Highest round-trip time of each database statement.", "%lu.%09lu", q->max_ns / 1000000000, q->max_ns % 1000000000)
+    PUT_QUERIES("db_query_rows_total", "counter", "Rows returned by each database statement.", "%lu", q->n_rows)
+#undef PUT_QUERIES
+
+    put_header(f, "turnstile_rejections_total", "counter", "Connections refused by the rate limit.");
+    fprintf(f, PREFIX "turnstile_rejections_total %lu\n", p_snapshot->n_turnstile_rejections);
+    put_header(f, "received_bytes_total", "counter", "Bytes of requests received.");
+    fprintf(f, PREFIX "received_bytes_total %lu\n", p_snapshot->n_bytes_in);
+    put_header(f, "sent_bytes_total", "counter", "Bytes of responses sent.");
+    fprintf(f, PREFIX "sent_bytes_total %lu\n", p_snapshot->n_bytes_out);
+    put_header(f, "start_time_seconds", "gauge", "Unix time the server started at.");
+    fprintf(f, PREFIX "start_time_seconds %ld\n", (long)start_time);
+
+    if (fclose(f)) errno_exit("fclose");
+    return text;
+}
+
+static void send_all(int fd, char const *buf, size_t len) {
+    while (len > 0) {
+        ssize_t const sent = send(fd, buf, len, MSG_NOSIGNAL);
+        if (sent < 0) {
+            if (errno == EINTR) continue;
+            return; // The scraper went away or is too slow: its problem.
+        }
+        buf += sent;
+        len -= (size_t)sent;
+    }
+}
+
+static void respond(int fd, char const *status, char const *body, size_t body_len) {
+    char header[256];
+    int const header_len = snprintf(header, sizeof header,
+        "HTTP/1.0 %s\r\n"
+        "Content-Type: text/plain; version=0.0.4; charset=utf-8\r\n"
+        "Content-Length: %zu\r\n"
+        "Connection: close\r\n"
+        "\r\n",
+        status, body_len);
+    send_all(fd, header, (size_t)header_len);
+    send_all(fd, body, body_len);
+}
+
+static void serve(metrics_http_t *mh, int fd) {
+    struct timeval const timeout = { .tv_sec = IO_TIMEOUT_S };
+    setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof timeout);
+    setsockopt(fd, SOL_SOCKET, SO_SNDTIMEO, &timeout, sizeof timeout);
+
+    // Read up to the end of the request line
+    char req[REQUEST_MAX + 1];
+    size_t len = 0;
+    while (len < REQUEST_MAX) {
+        ssize_t const n = recv(fd, req + len, REQUEST_MAX - len, 0);
+        if (n <= 0) {
+            if (n < 0 && errno == EINTR) continue;
+            break;
+        }
+        len += (size_t)n;
+        req[len] = '\0';
+        if (strchr(req, '\n')) break;
+    }
+    req[len] = '\0';
+
+    if (strncmp(req, "GET ", 4)) {
+        respond(fd, "405 Method Not Allowed", "", 0);
+        return;
+    }
+    char const *path = req + 4;
+    size_t const path_len = strcspn(path, " ?\r\n");
+    if (!(path_len == 8 && !strncmp(path, "/metrics", 8) || path_len == 1 && path[0] == '/')) {
+        respond(fd, "404 Not Found", "", 0);
+        return;
+    }
+
+    metrics_snapshot_t *snapshot = malloc(sizeof *snapshot);
+    if (!snapshot) errno_exit("malloc");
+    metrics_snapshot(snapshot);
+    size_t body_len;
+    char *body = metrics_format_prometheus(snapshot, mh->start_time, &body_len);
+    free(snapshot);
+
+    respond(fd, "200 OK", body, body_len);
+    free(body);
+}
+
+static void *run(void *arg) {
+    metrics_http_t *mh = arg;
+    while (true) {
+        int const fd = accept(mh->sock, NULL, NULL);
+        if (fd == -1) {
+            if (errno == EINTR || errno == ECONNABORTED) continue;
+            // The socket was shut down by metrics_http_stop.
+            if (errno == EINVAL) break;
+            cfg_log(mh->cfg, log_error, "metrics: accept: %s\n", strerror(errno));
+            break;
+        }
+        serve(mh, fd);
+        close(fd);
+    }
+    return NULL;
+}
+
+metrics_http_t *metrics_http_start(cfg_t *cfg, uint16_t port, char const *socket_path) {
+    int sock;
+    if (socket_path) {
+        struct sockaddr_un addr = { .sun_family = AF_UNIX };
+        if (strlen(socket_path) >= sizeof addr.sun_path) {
+            cfg_log(cfg, log_error, "metrics: socket path too long: %s\n", socket_path);
+            return NULL;
+        }
+        strcpy(addr.sun_path, socket_path);
+        if (-1 == (sock = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0))) errno_exit("socket");
+        unlink(socket_path);
+        if (-1 == bind(sock, (struct sockaddr *)&addr, sizeof addr)) {
+            cfg_log(cfg, log_error, "metrics: bind %s: %s\n", socket_path, strerror(errno));
+            close(sock);
+            return NULL;
+        }
+    } else {
+        struct sockaddr_in addr = {
+            .sin_addr.s_addr = inet_addr(LISTEN_ADDR),
+            .sin_family = AF_INET,
+            .sin_port = htons(port),
+        };
+        if (-1 == (sock = socket(AF_INET, SOCK_STREAM | SOCK_CLOEXEC, 0))) errno_exit("socket");
+        int sock_opt = 1;
+        setsockopt(sock, SOL_SOCKET, SO_REUSEADDR, &sock_opt, sizeof sock_opt);
+        if (-1 == bind(sock, (struct sockaddr *)&addr, sizeof addr)) {
+            cfg_log(cfg, log_error, "metrics: bind " LISTEN_ADDR ":%hu: %s\n", port, strerror(errno));
+            close(sock);
+            return NULL;
+        }
+    }
+    if (-1 == listen(sock, SOMAXCONN)) {
+        cfg_log(cfg, log_error, "metrics: listen: %s\n", strerror(errno));
+        close(sock);
+        return NULL;
+    }
+
+    metrics_http_t *mh = malloc(sizeof *mh);
+    if (!mh) errno_exit("malloc");
+    mh->cfg = cfg;
+    mh->sock = sock;
+    mh->socket_path = NULL;
+    if (socket_path && !(mh->socket_path = strdup(socket_path))) errno_exit("strdup");
+    mh->start_time = time(NULL);
+
+    // Signals are for the thread serving requests: their handlers expect to interrupt its accept().
+    sigset_t all, old;
+    sigfillset(&all);
+    pthread_sigmask(SIG_SETMASK, &all, &old);
+    if ((errno = pthread_create(&mh->thread, NULL, run, mh))) errno_exit("pthread_create");
+    pthread_sigmask(SIG_SETMASK, &old, NULL);
+
+    if (socket_path) {
+        cfg_log(cfg, log_info, "metrics: listening on %s\n", socket_path);
+    } else {
+        cfg_log(cfg, log_info, "metrics: listening on " LISTEN_ADDR ":%hu\n", port);
+    }
+    return mh;
+}
+
+void metrics_http_stop(metrics_http_t *mh) {
+    if (!mh) return;
+    // Makes accept() fail with EINVAL
+    shutdown(mh->sock, SHUT_RDWR);
+    pthread_join(mh->thread, NULL);
+    close(mh->sock);
+    if (mh->socket_path) {
+        unlink(mh->socket_path);
+        free(mh->socket_path);
+    }
+    free(mh);
+}
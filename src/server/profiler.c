@@ -0,0 +1,173 @@
+/// @file
+/// @author Raphaël
+/// @brief Sampling CPU profiler - Implementation
+/// @date 18/10/2026
+
+#define _GNU_SOURCE // dladdr
+#include "tchatator413/profiler.h"
+#include "stb_ds.h"
+#include "util.h"
+#include <dlfcn.h>
+#include <errno.h>
+#include <execinfo.h>
+#include <pthread.h>
+#include <signal.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+/// @brief Number of frames of the handler itself at the top of a sample: @ref on_sigprof and the signal trampoline.
+#define HANDLER_DEPTH 2
+
+struct profiler {
+    timer_t timer;
+    struct sigaction old_action;
+    size_t max_samples;
+    /// @brief The return addresses of each sample, @ref PROFILER_MAX_DEPTH per sample, innermost first.
+    void **frames;
+    /// @brief The depth of each sample.
+    uint8_t *depths;
+    /// @brief Written by the handler only, on the profiled thread.
+    volatile size_t n_samples, n_lost;
+};
+
+/// @brief The name of a frame, by return address.
+typedef struct {
+    void *key;
+    char *value;
+} frame_name_t;
+
+/// @brief The running profiler, read by the handler.
+static profiler_t *volatile gs_profiler;
+
+static void on_sigprof(int sig) {
+    (void)sig;
+    profiler_t *profiler = gs_profiler;
+    if (!profiler) return;
+    int const saved_errno = errno;
+
+    size_t const i = profiler->n_samples;
+    if (i < profiler->max_samples) {
+        void *frames[HANDLER_DEPTH + PROFILER_MAX_DEPTH];
+        int const depth = backtrace(frames, array_len(frames)) - HANDLER_DEPTH;
+        if (depth > 0) {
+            memcpy(profiler->frames + i * PROFILER_MAX_DEPTH, frames + HANDLER_DEPTH, (size_t)depth * sizeof *frames);
+            profiler->depths[i] = (uint8_t)depth;
+            profiler->n_samples = i + 1;
+        }
+    } else {
+        profiler->n_lost = profiler->n_lost + 1;
+    }
+
+    errno = saved_errno;
+}
+
+profiler_t *profiler_start(int frequency_hz, size_t max_samples) {
+    if (gs_profiler) {
+        errno = EBUSY;
+        return NULL;
+    }
+
+    // backtrace loads libgcc on its first call, which must not happen in the handler.
+    void *frame;
+    backtrace(&frame, 1);
+
+    profiler_t *profiler = malloc(sizeof *profiler);
+    if (!profiler) errno_exit("malloc");
+    profiler->max_samples = max_samples;
+    profiler->n_samples = profiler->n_lost = 0;
+    if (!(profiler->frames = malloc(max_samples * PROFILER_MAX_DEPTH * sizeof *profiler->frames))) errno_exit("malloc");
+    if (!(profiler->depths = malloc(max_samples * sizeof *profiler->depths))) errno_exit("malloc");
+
+    clockid_t clock;
+    if ((errno = pthread_getcpuclockid(pthread_self(), &clock))
+        || timer_create(clock, &(struct sigevent) { .sigev_notify = SIGEV_SIGNAL, .sigev_signo = SIGPROF }, &profiler->timer)) {
+        int const err = errno;
+        free(profiler->frames);
+        free(profiler->depths);
+        free(profiler);
+        errno = err;
+        return NULL;
+    }
+
+    gs_profiler = profiler;
+    if (sigaction(SIGPROF, &(struct sigaction) { .sa_handler = on_sigprof, .sa_flags = SA_RESTART }, &profiler->old_action)) errno_exit("sigaction");
+
+    long const interval_ns = 1000000000L / MAX(frequency_hz, 1);
+    struct timespec const interval = { .tv_sec = interval_ns / 1000000000L, .tv_nsec = interval_ns % 1000000000L };
+    if (timer_settime(profiler->timer, 0, &(struct itimerspec) { .it_interval = interval, .it_value = interval }, NULL)) errno_exit("timer_settime");
+
+    return profiler;
+}
+
+/// @brief Append the name of a frame to a string.
+/// @param names The names already resolved, by address.
+static void put_frame(char **p_str, frame_name_t **names, void *addr, bool is_leaf) {
+    ptrdiff_t i = hmgeti(*names, addr);
+    if (i == -1) {
+        // A return address points after its call, which may be past the end of the caller.
+        void *const pc = is_leaf ? addr : (char *)addr - 1;
+        Dl_info info;
+        char *name;
+        if (!dladdr(pc, &info) || !info.dli_fname) {
+            name = strfmt("[%p]", addr);
+        } else if (info.dli_sname) {
+            name = strdup(info.dli_sname);
+        } else {
+            char const *module = strrchr(info.dli_fname, '/');
+            name = strfmt("[%s+%#tx]", module ? module + 1 : info.dli_fname, (char *)pc - (char *)info.dli_fbase);
+        }
+        if (!name) errno_exit("strfmt");
+        hmput(*names, addr, name);
+        i = hmgeti(*names, addr);
+    }
+    if (arrlen(*p_str)) arrput(*p_str, ';');
+    char const *name = (*names)[i].value;
+    memcpy(arraddnptr(*p_str, strlen(name)), name, strlen(name));
+}
+
+size_t profiler_stop(profiler_t *profiler, FILE *out, size_t *out_n_lost) {
+    timer_delete(profiler->timer);
+    gs_profiler = NULL;
+    if (sigaction(SIGPROF, &profiler->old_action, NULL)) errno_exit("sigaction");
+
+    size_t const n_samples = profiler->n_samples;
+    if (out_n_lost) *out_n_lost = profiler->n_lost;
+
+    if (out) {
+        frame_name_t *names = NULL;
+        struct {
+            char *key;
+            size_t value;
+        } *stacks = NULL;
+        sh_new_strdup(stacks);
+        char *stack = NULL;
+
+        for (size_t s = 0; s < n_samples; ++s) {
+            void *const *frames = profiler->frames + s * PROFILER_MAX_DEPTH;
+            arrsetlen(stack, 0);
+            for (int f = profiler->depths[s] - 1; f >= 0; --f) put_frame(&stack, &names, frames[f], f == 0);
+            arrput(stack, '\0');
+            ptrdiff_t const i = shgeti(stacks, stack);
+            if (i == -1) {
+                shput(stacks, stack, 1);
+            } else {
+                ++stacks[i].value;
+            }
+        }
+
+        for (ptrdiff_t i = 0; i < shlen(stacks); ++i) fprintf(out, "%s %zu\n", stacks[i].key, stacks[i].value);
+
+        arrfree(stack);
+        shfree(stacks);
+        for (ptrdiff_t i = 0; i < hmlen(names); ++i) free(names[i].value);
+        hmfree(names);
+    }
+
+    free(profiler->frames);
+    free(profiler->depths);
+    free(profiler);
+    return out ? n_samples : 0;
+}
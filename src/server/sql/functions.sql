@@ -4,42 +4,45 @@ set
     plpgsql.extra_errors to 'all';
 
 -- Functions stating with _ are internal
-create function _insert_msg (p_user_id_sender int, p_user_id_recipient int, p_content varchar) returns int as $$
-with msg_id as (insert into
+create function _insert_msg (p_user_id_sender int, p_user_id_recipient int, p_content varchar, out msg_id int, out sent_at timestamp) as $$
+insert into
     tchatator._msg (user_id_sender, user_id_recipient, content)
 values
     -- consider 0 as the root user id.
     (nullif(p_user_id_sender, 0), p_user_id_recipient, p_content)
 returning
-    msg_id
-) table msg_id
+    _msg.msg_id, _msg.sent_at
 $$ language sql strict;
 
-create function send_msg (p_user_id_sender int, p_user_id_recipient int, p_content varchar) returns int as $$
-select
-    case
-        when (
-            -- check is not blocked globally
-            select
-                full_block_expires_at < localtimestamp
-            from
-                tchatator._member
-            where
-                user_id = p_user_id_sender
-        )
-        or (
-            -- or by recipient
-            select
-                expires_at < localtimestamp
-            from
-                tchatator._single_block
-            where
-                user_id_member = p_user_id_sender
-                and user_id_pro = p_user_id_recipient
-        ) then 0 -- errstatus_error
-        else (select tchatator._insert_msg(p_user_id_sender, p_user_id_recipient, p_content))
-    end
-$$ language sql strict;
+-- Returns the id and send time of the message, which the caller can't read back from _msg in the same statement.
+create function send_msg (p_user_id_sender int, p_user_id_recipient int, p_content varchar, out msg_id int, out sent_at timestamp) as $$
+begin
+    if (
+        -- check is not blocked globally
+        select
+            full_block_expires_at > localtimestamp
+        from
+            tchatator._member
+        where
+            user_id = p_user_id_sender
+    )
+    or (
+        -- or by recipient
+        select
+            expires_at > localtimestamp
+        from
+            tchatator._single_block
+        where
+            user_id_member = p_user_id_sender
+            and user_id_pro = p_user_id_recipient
+    ) then
+        msg_id = 0; -- errstatus_error
+        return;
+    end if;
+
+    select i.msg_id, i.sent_at into msg_id, sent_at from tchatator._insert_msg(p_user_id_sender, p_user_id_recipient, p_content) i;
+end
+$$ language plpgsql strict;
 
 create function _insert_user (inout new record) as $$
 begin
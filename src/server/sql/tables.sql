@@ -49,6 +49,12 @@ create table _msg (
     constraint sender_ne_recipient check (user_id_sender <> user_id_recipient)
 );
 
+-- motd: the unread messages of a recipient, oldest first. Only unread rows are indexed, so it stays small however long inboxes get.
+create index _msg_unread on _msg (user_id_recipient, sent_at, msg_id)
+where
+    read_age is null
+    and deleted_age is null;
+
 -- ASSOCIATIONS
 
 create table _single_block (
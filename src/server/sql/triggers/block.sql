@@ -0,0 +1,21 @@
+set schema 'tchatator';
+
+set
+    plpgsql.extra_errors to 'all';
+
+-- Notify servers that blocks changed, so they can reload their block index.
+-- Delivered on commit.
+create function ftg_block_notify () returns trigger as $$
+begin
+    perform pg_notify('tchatator_block', '');
+    return null;
+end
+$$ language plpgsql;
+
+create trigger tg_single_block_notify
+after insert or update or delete on _single_block for each statement
+execute function ftg_block_notify ();
+
+create trigger tg_member_block_notify
+after update of full_block_expires_at on _member for each statement
+execute function ftg_block_notify ();
@@ -52,4 +52,17 @@ end
 $$ language plpgsql;
 
 create trigger tg_msg_delete instead of delete on msg for each row
-execute function ftg_msg_delete ();
\ No newline at end of file
+execute function ftg_msg_delete ();
+
+-- Notify servers of changes to the messages of a recipient, so they can drop their cached inbox and, for new messages, wake the connections waiting for them.
+-- The payload is the recipient ID, a space and the operation in lowercase. Delivered on commit.
+create function ftg_msg_notify () returns trigger as $$
+begin
+    perform pg_notify('tchatator_msg', (case when tg_op = 'DELETE' then old.user_id_recipient else new.user_id_recipient end)::text || ' ' || lower(tg_op));
+    return null;
+end
+$$ language plpgsql;
+
+create trigger tg_msg_notify
+after insert or update or delete on _msg for each row
+execute function ftg_msg_notify ();
@@ -0,0 +1,34 @@
+set schema 'tchatator';
+
+set
+    plpgsql.extra_errors to 'all';
+
+-- Notify servers of new API keys, so they can update their API key filter.
+-- Delivered on commit.
+create function ftg_user_api_key_notify () returns trigger as $$
+begin
+    perform pg_notify('tchatator_api_key', new.api_key::text);
+    return null;
+end
+$$ language plpgsql;
+
+create trigger tg_user_api_key_notify
+after insert or update of api_key on _user for each row
+execute function ftg_user_api_key_notify ();
+
+-- Notify servers that the keys of a user changed, so they can drop them from their user key cache.
+-- Delivered on commit.
+create function ftg_user_key_notify () returns trigger as $$
+begin
+    perform pg_notify('tchatator_user_key', (case when tg_op = 'INSERT' then new.user_id else old.user_id end)::text);
+    return null;
+end
+$$ language plpgsql;
+
+create trigger tg_member_user_key_notify
+after insert or update of user_name or delete on _member for each row
+execute function ftg_user_key_notify ();
+
+create trigger tg_pro_user_key_notify
+after insert or update of business_name or delete on _pro for each row
+execute function ftg_user_key_notify ();
@@ -32,7 +32,7 @@ select
     api_key,
     password_hash,
     case
-        when a.user_id is not null then 0 -- admin
+        when a.user_id is not null then 1 -- admin
         when m.user_id is not null then 2 -- member
         when p.user_id is not null then 4 -- pro
     end as role,
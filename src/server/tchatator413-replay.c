@@ -0,0 +1,220 @@
+/// @file
+/// @author Raphaël
+/// @brief Tchatator413 Facade - Replay implementation
+///
+/// Feeds the requests of a capture file through the interpreter, as the server would, and reports throughput and per-action latency.
+///
+/// @date 18/10/2026
+
+#include "stb_ds.h"
+#include "tchatator413/capture.h"
+#include "tchatator413/metrics.h"
+#include "tchatator413/tchatator413.h"
+#include <errno.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sysexits.h>
+#include <time.h>
+
+/// @brief X-macro that expands to the list of quantiles reported, as (name, quantile).
+#define X_QUANTILES(X) \
+    X(p50, .5)         \
+    X(p90, .9)         \
+    X(p99, .99)        \
+    X(p999, .999)
+
+#define DELIMITER "¤"
+
+/// @brief The users of the test database, that the pseudonyms of a capture are assigned to in order of first appearance.
+static struct {
+    char const *api_key, *password;
+} const gs_test_users[] = {
+    { "123e4567-e89b-12d3-a456-426614174000", "member1_mdp" },
+    { "9ea59c5b-bb75-4cc9-8f80-77b4ce851a0b", "member2_mdp" },
+    { "bb1b5a1f-a482-4858-8c6b-f4746481cffa", "pro1_mdp" },
+    { "52d43379-8f75-4fbd-8b06-d80a87b2c2b4", "pro2_mdp" },
+};
+
+/// @brief The state of a replay.
+typedef struct {
+    /// @brief Pseudonyms seen so far, with the index of the test user they are assigned to.
+    struct {
+        api_key_t key;
+        size_t value;
+    } *pseudonyms;
+    char root_api_key[UUID4_REPR_LENGTH];
+    char const *root_password;
+    /// @brief The request with its credentials restored.
+    char *buf;
+    size_t cap;
+    /// @brief The action being evaluated, and when its evaluation started.
+    action_type_t type;
+    uint64_t start_ns;
+    uint64_t n_actions;
+    metrics_histogram_t latency[metrics_n_action_types];
+} replay_t;
+
+static char const *const gs_action_names[] = {
+    [action_type_error] = "error",
+#define ACTION_NAME(name) [action_type_##name] = #name,
+    X_ACTIONS(ACTION_NAME)
+#undef ACTION_NAME
+};
+
+static void on_action(action_t const *p_action, void *ctx) {
+    replay_t *replay = ctx;
+    replay->type = p_action->type;
+    replay->start_ns = metrics_clock();
+}
+
+static void on_response(response_t const *p_response, void *ctx) {
+    (void)p_response;
+    replay_t *replay = ctx;
+    uint64_t const duration_ns = metrics_clock() - replay->start_ns;
+    metrics_histogram_t *h = &replay->latency[replay->type];
+    ++h->count;
+    h->sum_ns += duration_ns;
+    h->max_ns = MAX(h->max_ns, duration_ns);
+    ++h->buckets[metrics_bucket_of(duration_ns)];
+    ++replay->n_actions;
+}
+
+/// @brief Give the credentials of the pseudonymized constrs of a request back.
+/// @remark A bare pseudonym, captured from a constr without a password, gets the password of its user too, so it authenticates like the original request did.
+/// @return The length of the request, in @ref replay_t.buf.
+static size_t restore_credentials(replay_t *replay, char const *req, size_t len) {
+    size_t n_quotes = 0;
+    for (size_t i = 0; i < len; ++i) n_quotes += req[i] == '"';
+    size_t max_password_len = strlen(replay->root_password);
+    for (size_t i = 0; i < array_len(gs_test_users); ++i) max_password_len = MAX(max_password_len, strlen(gs_test_users[i].password));
+
+    size_t const cap = len + (n_quotes + 1) / 2 * (sizeof DELIMITER - 1 + max_password_len) + 1;
+    if (cap > replay->cap && !(replay->buf = realloc(replay->buf, replay->cap = cap))) errno_exit("realloc");
+
+    size_t w = 0, r = 0;
+    while (r < len) {
+        if (req[r] != '"') {
+            replay->buf[w++] = req[r++];
+            continue;
+        }
+        // A string: find its end.
+        size_t end = r + 1;
+        while (end < len && req[end] != '"') end += req[end] == '\\' ? 2 : 1;
+        end = MIN(end, len);
+        char const *const str = req + r + 1;
+        size_t const str_len = end - (r + 1);
+
+        // A pseudonymized constr is a string of the key and the delimiter, or of the key alone.
+        api_key_t pseudonym;
+        if ((str_len == UUID4_REPR_LENGTH || (str_len == UUID4_REPR_LENGTH + sizeof DELIMITER - 1 && !memcmp(str + UUID4_REPR_LENGTH, DELIMITER, sizeof DELIMITER - 1)))
+            && uuid4_parse(&pseudonym, str)) {
+            char const *api_key, *password;
+            if (uuid4_eq(pseudonym, (api_key_t) { 0 })) {
+                api_key = replay->root_api_key;
+                password = replay->root_password;
+            } else {
+                ptrdiff_t i = hmgeti(replay->pseudonyms, pseudonym);
+                if (i == -1) {
+                    hmput(replay->pseudonyms, pseudonym, hmlenu(replay->pseudonyms) % array_len(gs_test_users));
+                    i = hmgeti(replay->pseudonyms, pseudonym);
+                }
+                size_t const user = replay->pseudonyms[i].value;
+                api_key = gs_test_users[user].api_key;
+                password = gs_test_users[user].password;
+            }
+            size_t const password_len = strlen(password);
+            replay->buf[w++] = '"';
+            memcpy(replay->buf + w, api_key, UUID4_REPR_LENGTH);
+            w += UUID4_REPR_LENGTH;
+            memcpy(replay->buf + w, DELIMITER, sizeof DELIMITER - 1);
+            w += sizeof DELIMITER - 1;
+            memcpy(replay->buf + w, password, password_len);
+            w += password_len;
+            if (end < len) replay->buf[w++] = '"';
+            r = MIN(end + 1, len);
+            continue;
+        }
+
+        // Any other string, with its quotes.
+        size_t const n = MIN(end + 1, len) - r;
+        memcpy(replay->buf + w, req + r, n);
+        w += n;
+        r += n;
+    }
+    replay->buf[w] = '\0';
+    return w;
+}
+
+static void put_histogram(char const *name, metrics_histogram_t const *h) {
+    printf("%-9s %9lu", name, h->count);
+#define PUT(name, q) printf(" %11.3f", (double)metrics_quantile(h, q) / 1e6);
+    X_QUANTILES(PUT)
+#undef PUT
+    printf(" %11.3f\n", (double)h->max_ns / 1e6);
+}
+
+int tchatator413_run_replay(cfg_t *cfg, db_t *db, char const *filename, bool max_speed, api_key_t root_api_key, char const *root_password) {
+    FILE *file = fopen(filename, "rb");
+    if (!file) {
+        cfg_log(cfg, log_error, "replay: %s: %s\n", filename, strerror(errno));
+        return EX_NOINPUT;
+    }
+
+    replay_t *replay = calloc(1, sizeof *replay);
+    if (!replay) errno_exit("calloc");
+    uuid4_repr(root_api_key, replay->root_api_key);
+    replay->root_password = root_password;
+
+    json_writer_t writer = JSON_WRITER_INIT;
+    memlst_t *mem = memlst_init();
+    capture_record_t record = { 0 };
+    uint64_t n_requests = 0, n_dropped = 0;
+    int64_t first_at_ns = 0;
+    uint64_t const start_ns = metrics_clock();
+
+    while (capture_read(file, &record)) {
+        if (!record.len) {
+            n_dropped += record.n_dropped;
+            continue;
+        }
+        if (!n_requests++) first_at_ns = record.at_ns;
+        if (!max_speed && record.at_ns > first_at_ns) {
+            uint64_t const at_ns = start_ns + (uint64_t)(record.at_ns - first_at_ns);
+            struct timespec const at = { .tv_sec = (time_t)(at_ns / 1000000000), .tv_nsec = (long)(at_ns % 1000000000) };
+            while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &at, NULL) == EINTR);
+        }
+
+        size_t const len = restore_credentials(replay, record.buf, record.len);
+        json_writer_reset(&writer);
+        tchatator413_interpret_str(&writer, &mem, replay->buf, len, cfg, db, on_action, on_response, replay);
+    }
+    double const elapsed_s = (double)(metrics_clock() - start_ns) / 1e9;
+
+    int res = EX_OK;
+    if (!feof(file)) {
+        cfg_log(cfg, log_error, "replay: %s: truncated or not a capture file\n", filename);
+        res = EX_DATAERR;
+    }
+
+    printf("replayed   %lu requests, %lu actions in %.3f s at %s speed\n", n_requests, replay->n_actions, elapsed_s, max_speed ? "maximum" : "recorded");
+    printf("throughput %.1f req/s, %.1f actions/s\n", (double)n_requests / elapsed_s, (double)replay->n_actions / elapsed_s);
+    if (n_dropped) printf("dropped    %lu requests were not captured\n", n_dropped);
+    printf("\nlatency (ms)\n%-9s %9s", "action", "count");
+#define PUT(name, q) printf(" %11s", #name);
+    X_QUANTILES(PUT)
+#undef PUT
+    printf(" %11s\n", "max");
+    for (size_t t = 0; t < metrics_n_action_types; ++t) {
+        if (replay->latency[t].count) put_histogram(gs_action_names[t], &replay->latency[t]);
+    }
+
+    free(record.buf);
+    memlst_destroy(&mem);
+    json_writer_destroy(&writer);
+    hmfree(replay->pseudonyms);
+    free(replay->buf);
+    free(replay);
+    fclose(file);
+    return res;
+}
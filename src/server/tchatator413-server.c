@@ -7,107 +7,140 @@
 /// @date 1/02/2025
 
 #include "json-c.h"
-#include "stb_ds.h"
+#include "tchatator413/metrics.h"
+#include "tchatator413/metrics_http.h"
+#include "tchatator413/probes.h"
+#include "tchatator413/profiler.h"
 #include "tchatator413/tchatator413.h"
+#include "tchatator413/trace.h"
+#include "tchatator413/turnstile.h"
+#include "tchatator413/waitlist.h"
 #include <arpa/inet.h>
 #include <errno.h>
+#include <limits.h>
 #include <signal.h>
 #include <stdbool.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <sys/epoll.h>
 #include <sys/socket.h>
 #include <sys/types.h>
 #include <unistd.h>
 
 #define SERVER_ADDR "127.0.0.1"
 
-typedef struct {
-    /// @brief Timestamp of the last request.
-    time_t last_request_at;
-    /// @brief Number of requests performed since an hour.
-    int n_requests_h;
-    /// @brief Number of requests performed since a minute.
-    int n_requests_m;
-} user_stats_t;
-
-static inline void json_object_write(json_object *jo, cfg_t *cfg, int fd) {
-    size_t len;
+static inline void json_writer_write(json_writer_t *p_writer, cfg_t *cfg, int fd) {
+    char const *output = json_writer_str(p_writer);
+    size_t len = p_writer->len + 1; // include null terminator
     ssize_t bytes_written;
-    char const *output = json_object_to_json_string_length(jo, JSON_C_TO_STRING_PLAIN, &len);
-    ++len; // include null terminator
     cfg_log(cfg, log_info, "preparing to write %zu bytes of response\n", len);
+    evlog_response_written(cfg_evlog(cfg), &(evlog_response_written_t) { .fd = fd, .len = (uint32_t)len });
+    metrics_count_bytes(0, len);
+    PROBE(response__write, fd, len);
 
     do {
-        bytes_written = write(fd, output, len);
-        if (-1 == bytes_written) errno_exit("write");
+        // Without SIGPIPE: a client that went away must not take the server down with it.
+        bytes_written = send(fd, output, len, MSG_NOSIGNAL);
+        if (-1 == bytes_written) {
+            // Control signals are installed without SA_RESTART, so they wake epoll_wait().
+            if (EINTR == errno) continue;
+            if (EPIPE == errno || ECONNRESET == errno) {
+                // The caller closes the connection.
+                cfg_log(cfg, log_warning, "client of fd %d went away, dropping %zu bytes of response\n", fd, len);
+                return;
+            }
+            errno_exit("send");
+        }
         len -= (size_t)bytes_written;
         output += bytes_written;
         cfg_log(cfg, log_info, "wrote %zd bytes, %zu remaining\n", bytes_written, len);
     } while (len > 0);
 }
 
-static inline void interpret_request(cfg_t *cfg, db_t *db, int fd) {
-    cfg_log(cfg, log_info, "interpreting request from fd %d\n", fd);
-
-    char buf[BUFSIZ] = { 0 };
-    ssize_t bytes_read = read(fd, buf, sizeof buf - 1);
-    if (bytes_read > 0) buf[bytes_read] = '\0';
+/// @brief What the server learns of a request from its responses.
+typedef struct {
+    unsigned n_responses;
+    /// @brief Whether the last response is a @c wait with nothing unread.
+    bool may_park;
+    /// @brief The user the last @c wait was for.
+    serial_t user_id;
+} request_outcome_t;
+
+static void on_response(response_t const *p_response, void *ctx) {
+    request_outcome_t *outcome = ctx;
+    ++outcome->n_responses;
+    outcome->may_park = p_response->type == action_type_wait && !p_response->body.wait.has_unread;
+    if (outcome->may_park) outcome->user_id = p_response->body.wait.user_id;
+}
 
-    json_object *jo_input = json_tokener_parse(buf);
-    // if !jo_input : invalid JSON recieved
+static void on_new_msg(serial_t recipient_id, void *waitlist) {
+    waitlist_notify(waitlist, recipient_id);
+}
 
-    cfg_log(cfg, log_info, "received json input, interpreting request\n");
+/// @brief Park a connection until its user gets a message.
+/// @return @c false if it can't be: it must be answered now.
+static bool park(cfg_t *cfg, waitlist_t *waitlist, int epfd, int fd, serial_t user_id) {
+    uint64_t const deadline_ns = metrics_clock() + (uint64_t)cfg_wait_timeout(cfg) * 1000000000;
+    if (!waitlist_park(waitlist, fd, user_id, deadline_ns)) return false;
+    // Watch for the client hanging up.
+    if (epoll_ctl(epfd, EPOLL_CTL_ADD, fd, &(struct epoll_event) { .events = EPOLLIN | EPOLLRDHUP, .data.fd = fd })) {
+        cfg_log(cfg, log_error, "epoll_ctl: %s\n", strerror(errno));
+        waitlist_remove(waitlist, fd);
+        return false;
+    }
+    cfg_log(cfg, log_info, "parked fd %d until user %d gets a message, %zu parked\n", fd, user_id, waitlist_len(waitlist));
+    return true;
+}
 
-    json_object *jo_output = tchatator413_interpret(jo_input, cfg, db, NULL, NULL, NULL);
-    json_object_put(jo_input);
+/// @brief Answer and close a parked connection.
+/// @param has_unread Whether the user got a message, rather than the wait having timed out.
+static void answer_parked(cfg_t *cfg, json_writer_t *p_writer, int fd, bool has_unread) {
+    json_writer_reset(p_writer);
+    json_writer_char(p_writer, '[');
+    response_write(p_writer, &(response_t) { .type = action_type_wait, .body.wait.has_unread = has_unread });
+    json_writer_char(p_writer, ']');
+    json_writer_write(p_writer, cfg, fd);
+    cfg_log(cfg, log_info, "closing parked connection fd %d\n", fd);
+    close(fd);
+}
 
-    json_object_write(jo_output, cfg, fd);
-    json_object_put(jo_output);
+/// @return Whether the connection was parked rather than answered. It must not be closed then.
+static inline bool interpret_request(cfg_t *cfg, db_t *db, waitlist_t *waitlist, int epfd, json_writer_t *p_writer, memlst_t **p_mem, int fd) {
+    cfg_log(cfg, log_info, "interpreting request from fd %d\n", fd);
 
-    cfg_log(cfg, log_info, "request interpretation completed for fd %d\n", fd);
-}
+    trace_t trace;
+    trace_begin(cfg_tracer(cfg), &trace);
 
-typedef struct {
-    in_addr_t key;
-    user_stats_t value;
-} turnstile_entry;
-
-/// @brief Checks and increments the rate limit for the specified user.
-/// @param cfg The configuration.
-/// @param turnstile The turnstile hash map.
-/// @param in_addr The source IP of the request.
-/// @return @c 0 The turnstile passes (the rate limit hasn't been reached)
-/// @return > @c 0 The turnstile blocks (the rate limit has been reached). An error has been put. The return value is time of the next allowed request.
-static inline time_t turnstile_rate_limit(cfg_t *cfg, turnstile_entry *turnstile, in_addr_t in_addr) {
-
-    time_t const t = time(NULL);
-
-    int i = hmgeti(turnstile, in_addr);
-    if (i == -1) {
-        hmput(turnstile, in_addr,
-            ((user_stats_t) {
-                .last_request_at = t,
-                .n_requests_h = 1,
-                .n_requests_m = 1,
-            }));
-        return 0;
+    char buf[BUFSIZ] = { 0 };
+    uint64_t start = trace_clock();
+    ssize_t bytes_read;
+    while (-1 == (bytes_read = read(fd, buf, sizeof buf - 1)) && EINTR == errno);
+    trace_span("read", NULL, start);
+    PROBE(request__read, fd, bytes_read);
+    if (bytes_read > 0) {
+        buf[bytes_read] = '\0';
+        metrics_count_bytes((size_t)bytes_read, 0);
+        capture_request(cfg_capture(cfg), buf, (size_t)bytes_read);
     }
 
-    user_stats_t *p_stats = &turnstile[i].value;
-
-    time_t time_since_last_request = t - p_stats->last_request_at;
-    p_stats->last_request_at = t;
+    cfg_log(cfg, log_info, "received json input, interpreting request\n");
 
-    if (time_since_last_request >= 60) p_stats->n_requests_m = 0;
-    if (time_since_last_request >= 3600) p_stats->n_requests_h = 0;
+    // Actions point into buf until the response is written.
+    request_outcome_t outcome = { 0 };
+    tchatator413_interpret_str(p_writer, p_mem, buf, bytes_read > 0 ? (size_t)bytes_read : 0, cfg, db, NULL, on_response, &outcome);
 
-    ++p_stats->n_requests_m;
-    ++p_stats->n_requests_h;
+    // A wait is parked only when it is the whole request: the other responses couldn't wait for it.
+    bool const parked = outcome.n_responses == 1 && outcome.may_park && park(cfg, waitlist, epfd, fd, outcome.user_id);
+    if (!parked) {
+        start = trace_clock();
+        json_writer_write(p_writer, cfg, fd);
+        trace_span("write", NULL, start);
+    }
+    trace_end(cfg_tracer(cfg));
 
-    if (p_stats->n_requests_m >= cfg_rate_limit_m(cfg)) return t + 60 - time_since_last_request;
-    if (p_stats->n_requests_h >= cfg_rate_limit_h(cfg)) return t + 3600 - time_since_last_request;
-    return 0;
+    cfg_log(cfg, log_info, "request interpretation completed for fd %d\n", fd);
+    return parked;
 }
 
 static int gs_sock = -1;
@@ -119,9 +152,75 @@ static inline void close_sock(int sig) {
     gs_sock = -1;
 }
 
+static volatile sig_atomic_t gs_dump_queries;
+
+static inline void request_dump_queries(int sig) {
+    (void)sig;
+    gs_dump_queries = 1;
+}
+
+static volatile sig_atomic_t gs_toggle_profile, gs_end_profile;
+
+static inline void request_toggle_profile(int sig) {
+    (void)sig;
+    gs_toggle_profile = 1;
+}
+
+static inline void request_end_profile(int sig) {
+    (void)sig;
+    gs_end_profile = 1;
+}
+
+/// @brief Start profiling the server, or stop and write the profile if it is running.
+/// @param p_profiler The running profiler, @c NULL if there is none.
+/// @param start Whether to start profiling if it isn't running.
+static void toggle_profile(cfg_t *cfg, profiler_t **p_profiler, bool start) {
+    char const *const filename = cfg_profile_file_name(cfg);
+    if (*p_profiler) {
+        alarm(0);
+        FILE *f = fopen(filename, "w");
+        if (!f) cfg_log(cfg, log_error, "profile: could not open %s: %s\n", filename, strerror(errno));
+        size_t n_lost;
+        size_t const n_samples = profiler_stop(*p_profiler, f, &n_lost);
+        *p_profiler = NULL;
+        if (f) {
+            fclose(f);
+            cfg_log(cfg, log_info, "profile: %zu samples written to %s, %zu lost\n", n_samples, filename, n_lost);
+        }
+    } else if (start) {
+        if (!filename) {
+            cfg_log(cfg, log_warning, "profile: no profile_file in the configuration, ignoring SIGUSR2\n");
+            return;
+        }
+        int const hz = cfg_profile_hz(cfg), seconds = cfg_profile_seconds(cfg);
+        // Room for the whole run, at most one sample per tick of CPU time.
+        if (!(*p_profiler = profiler_start(hz, (size_t)hz * (size_t)seconds))) {
+            cfg_log(cfg, log_error, "profile: could not start: %s\n", strerror(errno));
+            return;
+        }
+        alarm((unsigned)seconds);
+        cfg_log(cfg, log_info, "profile: sampling at %d Hz for %d seconds\n", hz, seconds);
+    }
+}
+
+/// @brief Print the statistics of each database statement, in the manner of @ref cfg_dump.
+static void dump_queries(void) {
+    metrics_snapshot_t *snapshot = malloc(sizeof *snapshot);
+    if (!snapshot) errno_exit("malloc");
+    metrics_snapshot(snapshot);
+
+    puts("QUERIES");
+    for (size_t i = 0; i < metrics_n_queries; ++i) {
+        metrics_query_stats_t const *q = &snapshot->queries[i];
+        printf("%-17s %8lu calls %12.3f ms total %10.3f ms max %10lu rows\n",
+            metrics_query_name(i), q->n_calls, (double)q->sum_ns / 1e6, (double)q->max_ns / 1e6, q->n_rows);
+    }
+    fflush(stdout);
+    free(snapshot);
+}
+
 int tchatator413_run_socket(cfg_t *cfg, db_t *db) {
-    // create hashmap<ip,user_stats_t> turnstile
-    turnstile_entry *turnstile = NULL;
+    turnstile_t turnstile = { 0 };
 
     cfg_log(cfg, log_info, "initializing server...\n");
     // Acquérir le socket
@@ -134,6 +233,12 @@ int tchatator413_run_socket(cfg_t *cfg, db_t *db) {
     // Programmer sa libération sur Ctrl+C
     if (SIG_ERR == signal(SIGINT, close_sock)) errno_exit("signal");
     if (SIG_ERR == signal(SIGTERM, close_sock)) errno_exit("signal");
+    // Print the statement statistics on SIGUSR1. No SA_RESTART, so accept() returns and the dump happens outside of the handler.
+    if (sigaction(SIGUSR1, &(struct sigaction) { .sa_handler = request_dump_queries }, NULL)) errno_exit("sigaction");
+    // Start or stop profiling on SIGUSR2, and stop when the profile duration, timed by alarm(), has elapsed.
+    if (sigaction(SIGUSR2, &(struct sigaction) { .sa_handler = request_toggle_profile }, NULL)) errno_exit("sigaction");
+    if (sigaction(SIGALRM, &(struct sigaction) { .sa_handler = request_end_profile }, NULL)) errno_exit("sigaction");
+    profiler_t *profiler = NULL;
 
     struct sockaddr_in server_addr = {
         .sin_addr.s_addr = inet_addr(SERVER_ADDR),
@@ -155,39 +260,114 @@ int tchatator413_run_socket(cfg_t *cfg, db_t *db) {
 
     cfg_log(cfg, log_info, "server started on " SERVER_ADDR " port %hu\n", cfg_port(cfg));
 
+    // Scrapes are served on a socket of their own, so they don't go through the turnstile.
+    metrics_http_t *metrics_http = cfg_metrics_port(cfg) || cfg_metrics_socket_path(cfg)
+        ? metrics_http_start(cfg, cfg_metrics_port(cfg), cfg_metrics_socket_path(cfg))
+        : NULL;
+
     struct sockaddr_in addr_connection;
     int size = sizeof addr_connection;
 
+    // Reused between connections, so their buffers stop growing once they fit the largest request.
+    json_writer_t writer = JSON_WRITER_INIT;
+    memlst_t *mem = memlst_init();
+
+    // Connections parked by wait, woken by the messages sent here and, through the database socket, elsewhere.
+    waitlist_t *waitlist = cfg_wait_timeout(cfg) > 0 ? waitlist_init((size_t)cfg_max_waiters(cfg)) : NULL;
+    db_on_new_msg(db, on_new_msg, waitlist);
+    int const db_fd = db_socket(db);
+
+    int const epfd = epoll_create1(EPOLL_CLOEXEC);
+    if (-1 == epfd) errno_exit("epoll_create1");
+    if (epoll_ctl(epfd, EPOLL_CTL_ADD, gs_sock, &(struct epoll_event) { .events = EPOLLIN, .data.fd = gs_sock })) errno_exit("epoll_ctl");
+    if (waitlist && db_fd != -1 && epoll_ctl(epfd, EPOLL_CTL_ADD, db_fd, &(struct epoll_event) { .events = EPOLLIN, .data.fd = db_fd })) errno_exit("epoll_ctl");
+
     while (true) {
+        // Signals that arrived while serving are handled here, those that arrived while waiting interrupt epoll_wait().
+        if (gs_dump_queries) {
+            gs_dump_queries = 0;
+            dump_queries();
+        }
+        if (gs_toggle_profile || gs_end_profile) {
+            toggle_profile(cfg, &profiler, gs_toggle_profile);
+            gs_toggle_profile = gs_end_profile = 0;
+        }
+
+        // Notifications may have been read along with the results of the last request.
+        if (waitlist) db_consume_notifications(db, cfg);
+        int parked_fd;
+        bool woken;
+        while (waitlist_pop(waitlist, metrics_clock(), &parked_fd, &woken)) {
+            epoll_ctl(epfd, EPOLL_CTL_DEL, parked_fd, NULL);
+            answer_parked(cfg, &writer, parked_fd, woken);
+        }
+
+        uint64_t const due_ns = waitlist_next_due(waitlist), now_ns = metrics_clock();
+        // Rounded up, so the deadline has passed on wake-up.
+        int const timeout_ms = due_ns == UINT64_MAX ? -1 : due_ns <= now_ns ? 0 : (int)MIN((due_ns - now_ns + 999999) / 1000000, INT_MAX);
+
         cfg_log(cfg, log_info, "waiting for new connection...\n");
+        struct epoll_event event;
+        int const n_events = epoll_wait(epfd, &event, 1, timeout_ms);
+        if (-1 == n_events) {
+            // If a signal interrupted epoll_wait().
+            if (EINTR == errno) {
+                // If the signal handler decided to exit
+                if (gs_sock == -1) break;
+                cfg_log(cfg, log_info, "wait interrupted by signal, continuing...\n");
+                continue;
+            }
+            errno_exit("epoll_wait");
+        }
+        if (n_events == 0 || event.data.fd == db_fd) continue;
+        if (event.data.fd != gs_sock) {
+            // A parked client sent something or hung up. It can't make another request on this connection.
+            cfg_log(cfg, log_info, "parked connection fd %d hung up\n", event.data.fd);
+            waitlist_remove(waitlist, event.data.fd);
+            epoll_ctl(epfd, EPOLL_CTL_DEL, event.data.fd, NULL);
+            close(event.data.fd);
+            continue;
+        }
+
         int fd = accept(gs_sock, (struct sockaddr *)&addr_connection, (socklen_t *)&size);
         if (-1 == fd) {
-            // If a signal interrupted accept().
             if (EINTR == errno) {
-                // If the signal handler decided to exit
                 if (gs_sock == -1) break;
-                cfg_log(cfg, log_info, "accept interrupted by signal, continuing...\n");
                 continue;
             }
             errno_exit("accept");
         }
-
-        time_t next_request_at = turnstile_rate_limit(cfg, turnstile, addr_connection.sin_addr.s_addr);
+        PROBE(conn__accept, fd, addr_connection.sin_addr.s_addr, ntohs(addr_connection.sin_port));
+        evlog_conn_accepted(cfg_evlog(cfg), &(evlog_conn_accepted_t) {
+                                                .addr = addr_connection.sin_addr.s_addr,
+                                                .port = ntohs(addr_connection.sin_port),
+                                                .fd = fd,
+                                            });
+
+        time_t next_request_at = turnstile_rate_limit(cfg, &turnstile, addr_connection.sin_addr.s_addr);
         if (next_request_at == 0) {
             cfg_log(cfg, log_info, "accepted new connection from %s:%d with fd %d\n",
                 inet_ntoa(addr_connection.sin_addr),
                 ntohs(addr_connection.sin_port),
                 fd);
-            interpret_request(cfg, db, fd);
+            json_writer_reset(&writer);
+            if (interpret_request(cfg, db, waitlist, epfd, &writer, &mem, fd)) continue;
         } else {
             cfg_log(cfg, log_info, "refusing connection from %s:%d with fd %d : rate limit reached\n",
                 inet_ntoa(addr_connection.sin_addr),
                 ntohs(addr_connection.sin_port),
                 fd);
+            evlog_rate_limited(cfg_evlog(cfg), &(evlog_rate_limited_t) {
+                                                   .addr = addr_connection.sin_addr.s_addr,
+                                                   .port = ntohs(addr_connection.sin_port),
+                                                   .retry_at = next_request_at,
+                                               });
+            metrics_count_turnstile_rejection();
             response_t r = response_for_rate_limit(next_request_at);
-            json_object *resp = response_to_json(&r);
-            json_object_write(resp, cfg, fd);
-            json_object_put(resp);
+            metrics_count_status(response_status(&r));
+            json_writer_reset(&writer);
+            response_write(&writer, &r);
+            json_writer_write(&writer, cfg, fd);
         }
 
         cfg_log(cfg, log_info, "closing connection fd %d\n", fd);
@@ -196,7 +376,20 @@ int tchatator413_run_socket(cfg_t *cfg, db_t *db) {
 
     cfg_log(cfg, log_info, "server exiting...\n");
 
-    hmfree(turnstile);
+    if (profiler) toggle_profile(cfg, &profiler, false);
+
+    // Answer the parked connections as if their wait had timed out.
+    int parked_fd;
+    bool woken;
+    while (waitlist_pop(waitlist, UINT64_MAX, &parked_fd, &woken)) answer_parked(cfg, &writer, parked_fd, woken);
+    db_on_new_msg(db, NULL, NULL);
+    waitlist_destroy(waitlist);
+    close(epfd);
+
+    metrics_http_stop(metrics_http);
+    turnstile_destroy(&turnstile);
+    json_writer_destroy(&writer);
+    memlst_destroy(&mem);
 
     return EX_OK;
 }
@@ -5,6 +5,9 @@
 
 #include "tchatator413/tchatator413.h"
 #include "tchatator413/json-helpers.h"
+#include "tchatator413/metrics.h"
+#include "tchatator413/probes.h"
+#include "tchatator413/trace.h"
 #include <assert.h>
 #include <getopt.h>
 #include <stdio.h>
@@ -33,53 +36,150 @@ int tchatator413_run_interactive(cfg_t *cfg, db_t *db, int argc, char **argv) {
     CLEAN_RETURN(mem, EX_OK);
 }
 
-static inline json_object *act(json_object const *jo_action, cfg_t *cfg, db_t *db, on_action_fn on_action, on_response_fn on_response, void *on_ctx) {
-    memlst_t *mem = memlst_init();
+/// @brief The names of action types, for traces.
+static char const *const gs_action_names[] = {
+    [action_type_error] = "error",
+#define ACTION_NAME(name) [action_type_##name] = #name,
+    X_ACTIONS(ACTION_NAME)
+#undef ACTION_NAME
+};
+
+/// @brief Where the responses to a request go: a JSON array, or a writer.
+typedef struct {
+    json_object *jo_output;
+    json_writer_t *p_writer;
+    size_t n_responses;
+} output_t;
 
-    action_t action = action_parse(&mem, cfg, db, jo_action);
-    if (on_action) on_action(&action, on_ctx);
+static inline void output_response(output_t *p_out, response_t const *p_response) {
+    metrics_count_status(response_status(p_response));
+    uint64_t const start = metrics_clock();
+    char trace_id[TRACE_ID_REPR_LENGTH + 1];
+    if (tl_trace) trace_id_repr(tl_trace->id, trace_id);
+    if (p_out->p_writer) {
+        if (p_out->n_responses) json_writer_char(p_out->p_writer, ',');
+        response_write(p_out->p_writer, p_response);
+        if (tl_trace) {
+            // Reopen the response object
+            --p_out->p_writer->len;
+            json_writer_lit(p_out->p_writer, ",\"trace_id\":\"");
+            json_writer_raw(p_out->p_writer, trace_id, TRACE_ID_REPR_LENGTH);
+            json_writer_lit(p_out->p_writer, "\"}");
+        }
+    } else {
+        json_object *jo_response = response_to_json(p_response);
+        if (tl_trace) json_object_object_add_ex(jo_response, "trace_id", json_object_new_string(trace_id), JSON_C_OBJECT_ADD_KEY_IS_NEW);
+        json_object_array_add(p_out->jo_output, jo_response);
+    }
+    metrics_record(metrics_stage_serialize, metrics_clock() - start);
+    trace_span("serialize", NULL, start);
+    ++p_out->n_responses;
+}
 
-    response_t response = action_evaluate(&action, &mem, cfg, db);
+/// @brief Evaluate an action and output its response.
+/// @param round_trips The database round-trips made before the action was parsed.
+static inline void respond(output_t *p_out, action_t const *p_action, uint64_t round_trips, memlst_t **p_mem, cfg_t *cfg, db_t *db, on_action_fn on_action, on_response_fn on_response, void *on_ctx) {
+    if (on_action) on_action(p_action, on_ctx);
+    metrics_count_action(p_action->type);
+
+    uint64_t const start = trace_clock();
+    response_t response = action_evaluate(p_action, p_mem, cfg, db);
+    response.n_round_trips = (unsigned)(db_round_trips(db) - round_trips);
+    metrics_count_round_trips(p_action->type, response.n_round_trips);
+    trace_span("evaluate", gs_action_names[p_action->type], start);
+    PROBE(action__evaluated, p_action->type, response_status(&response));
     if (on_response) on_response(&response, on_ctx);
 
-    return response_to_json(&response);
+    output_response(p_out, &response);
 }
 
-json_object *tchatator413_interpret(json_object *jo_input, cfg_t *cfg, db_t *db, on_action_fn on_action, on_response_fn on_response, void *on_ctx) {
-    json_object *jo_output;
+static inline void act(output_t *p_out, memlst_t **p_mem, json_object const *jo_action, cfg_t *cfg, db_t *db, on_action_fn on_action, on_response_fn on_response, void *on_ctx) {
+    memlst_mark_t const mark = memlst_mark(*p_mem);
 
+    uint64_t const round_trips = db_round_trips(db);
+    uint64_t const start = metrics_clock();
+    action_t action = action_parse(p_mem, cfg, db, jo_action);
+    metrics_record(metrics_stage_parse, metrics_clock() - start);
+    trace_span("parse", NULL, start);
+    PROBE(action__parsed, action.type, false);
+    evlog_action_parsed(cfg_evlog(cfg), &(evlog_action_parsed_t) { .type = (uint8_t)action.type, .fast = false });
+    respond(p_out, &action, round_trips, p_mem, cfg, db, on_action, on_response, on_ctx);
+
+    memlst_rewind(p_mem, mark);
+}
+
+static void interpret(output_t *p_out, memlst_t **p_mem, json_object *jo_input, cfg_t *cfg, db_t *db, on_action_fn on_action, on_response_fn on_response, void *on_ctx) {
     json_type const input_type = json_object_get_type(jo_input);
     switch (input_type) {
     case json_type_array: {
         size_t const len = json_object_array_length(jo_input);
-        jo_output = json_object_new_array_ext((int)len);
         for (size_t i = 0; i < len; ++i) {
             json_object const *const action = json_object_array_get_idx(jo_input, i);
             assert(action);
-            json_object_array_add(jo_output, act(action, cfg, db, on_action, on_response, on_ctx));
+            act(p_out, p_mem, action, cfg, db, on_action, on_response, on_ctx);
         }
-        assert(len == json_object_array_length(jo_output)); // Same amount of input and output actions
+        assert(len == p_out->n_responses); // Same amount of input and output actions
         break;
     }
     case json_type_object:
-        jo_output = json_object_new_array_ext(1);
-        json_object_array_add(jo_output, act(jo_input, cfg, db, on_action, on_response, on_ctx));
+        act(p_out, p_mem, jo_input, cfg, db, on_action, on_response, on_ctx);
         break;
     default:
-        jo_output = json_object_new_array_ext(1);
-        json_object_array_add(jo_output,
-            response_to_json(&(response_t) {
-                .type = action_type_error,
-                .body.error = {
-                    .type = action_error_type_type,
-                    .info.type = {
-                        .expected = json_type_object,
-                        .jo_actual = jo_input,
-                        .location = "request",
-                    },
-                },
-            }));
+        output_response(p_out, &(response_t) {
+                                   .type = action_type_error,
+                                   .body.error = {
+                                       .type = action_error_type_type,
+                                       .info.type = {
+                                           .expected = json_type_object,
+                                           .jo_actual = jo_input,
+                                           .location = "request",
+                                       },
+                                   },
+                               });
+    }
+}
+
+void tchatator413_interpret_str(json_writer_t *p_writer, memlst_t **p_mem, char *buf, size_t len, cfg_t *cfg, db_t *db, on_action_fn on_action, on_response_fn on_response, void *on_ctx) {
+    output_t out = { .p_writer = p_writer };
+    json_writer_char(p_writer, '[');
+
+    memlst_mark_t const mark = memlst_mark(*p_mem);
+    // The scan of the request is timed with its first action.
+    uint64_t start = metrics_clock();
+    action_scan_t *scan = action_scan(p_mem, buf, len);
+    if (scan) {
+        size_t const n_actions = action_scan_count(scan);
+        memlst_mark_t const mark_scanned = memlst_mark(*p_mem);
+        for (size_t i = 0; i < n_actions; ++i) {
+            if (i) start = metrics_clock();
+            uint64_t const round_trips = db_round_trips(db);
+            action_t action = action_parse_scanned(p_mem, cfg, db, scan, i);
+            metrics_record(metrics_stage_parse, metrics_clock() - start);
+            trace_span("parse", NULL, start);
+            PROBE(action__parsed, action.type, true);
+            evlog_action_parsed(cfg_evlog(cfg), &(evlog_action_parsed_t) { .type = (uint8_t)action.type, .fast = true });
+            respond(&out, &action, round_trips, p_mem, cfg, db, on_action, on_response, on_ctx);
+            memlst_rewind(p_mem, mark_scanned);
+        }
+    } else {
+        json_object *jo_input = memlst_add(p_mem, dtor_json_object, json_tokener_parse(buf));
+        // if !jo_input : invalid JSON recieved
+        interpret(&out, p_mem, jo_input, cfg, db, on_action, on_response, on_ctx);
     }
+    memlst_rewind(p_mem, mark);
+
+    json_writer_char(p_writer, ']');
+}
 
-    return jo_output;
+json_object *tchatator413_interpret(json_object *jo_input, cfg_t *cfg, db_t *db, on_action_fn on_action, on_response_fn on_response, void *on_ctx) {
+    output_t out = {
+        .jo_output = json_object_new_array_ext(json_object_is_type(jo_input, json_type_array) ? (int)json_object_array_length(jo_input) : 1),
+    };
+    memlst_t *mem = memlst_init();
+    trace_t trace;
+    trace_begin(cfg_tracer(cfg), &trace);
+    interpret(&out, &mem, jo_input, cfg, db, on_action, on_response, on_ctx);
+    trace_end(cfg_tracer(cfg));
+    memlst_destroy(&mem);
+    return out.jo_output;
 }
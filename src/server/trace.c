@@ -0,0 +1,141 @@
+/// @file
+/// @author Raphaël
+/// @brief Request tracing - Implementation
+/// @date 18/10/2026
+
+#include "tchatator413/trace.h"
+#include "tchatator413/metrics.h"
+#include <fcntl.h>
+#include <stdarg.h>
+#include <stdatomic.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include <unistd.h>
+
+/// @brief Maximum length of a trace line. Enough for @ref TRACE_MAX_SPANS spans with details of usual lengths.
+#define LINE_LEN_MAX 8192
+
+struct tracer {
+    logger_t *logger;
+    int fd;
+    uint64_t threshold_ns;
+    /// @brief The state of the id generator.
+    atomic_uint_fast64_t id_state;
+};
+
+_Thread_local trace_t *tl_trace;
+
+/// @brief Mix a counter into a well-distributed id (splitmix64).
+static inline uint64_t mix(uint64_t x) {
+    x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9;
+    x = (x ^ (x >> 27)) * 0x94d049bb133111eb;
+    return x ^ (x >> 31);
+}
+
+static size_t fmt_dropped(char *buf, size_t size, size_t n_dropped) {
+    int const len = snprintf(buf, size, "{\"dropped_traces\":%zu}\n", n_dropped);
+    return MIN((size_t)len, size);
+}
+
+tracer_t *tracer_open(char const *filename, uint64_t threshold_ns, size_t ring_size, log_overflow_t overflow) {
+    int const fd = open(filename, O_WRONLY | O_CREAT | O_APPEND | O_CLOEXEC, 0644);
+    if (fd == -1) return NULL;
+
+    tracer_t *tracer = malloc(sizeof *tracer);
+    if (!tracer) errno_exit("malloc");
+    tracer->fd = fd;
+    tracer->threshold_ns = threshold_ns;
+    // Ids of different runs should not collide
+    struct timespec ts;
+    clock_gettime(CLOCK_REALTIME, &ts);
+    atomic_init(&tracer->id_state, (uint64_t)ts.tv_sec * 1000000000 + (uint64_t)ts.tv_nsec ^ (uint64_t)getpid() << 32);
+    tracer->logger = logger_start(fd, MAX(ring_size, LINE_LEN_MAX), overflow, fmt_dropped);
+    return tracer;
+}
+
+void tracer_close(tracer_t *tracer) {
+    if (!tracer) return;
+    logger_stop(tracer->logger);
+    close(tracer->fd);
+    free(tracer);
+}
+
+void trace_begin(tracer_t *tracer, trace_t *p_trace) {
+    if (!tracer) return;
+    struct timespec ts;
+    clock_gettime(CLOCK_REALTIME, &ts);
+    p_trace->id = mix(atomic_fetch_add_explicit(&tracer->id_state, 1, memory_order_relaxed));
+    p_trace->start_ns = metrics_clock();
+    p_trace->started_at_ns = (int64_t)ts.tv_sec * 1000000000 + ts.tv_nsec;
+    p_trace->n_spans = 0;
+    p_trace->n_dropped = 0;
+    tl_trace = p_trace;
+}
+
+/// @brief Append to a line, leaving it unchanged if it doesn't fit.
+ATTR_FORMAT(printf, 3, 4)
+static bool put(char *line, size_t *p_len, char const *fmt, ...) {
+    va_list ap;
+    va_start(ap, fmt);
+    int const n = vsnprintf(line + *p_len, LINE_LEN_MAX - *p_len, fmt, ap);
+    va_end(ap);
+    if (n < 0 || (size_t)n >= LINE_LEN_MAX - *p_len) return false;
+    *p_len += (size_t)n;
+    return true;
+}
+
+void trace_end(tracer_t *tracer) {
+    trace_t *t = tl_trace;
+    if (!tracer || !t) return;
+    tl_trace = NULL;
+
+    uint64_t const duration_ns = metrics_clock() - t->start_ns;
+    if (duration_ns < tracer->threshold_ns) return;
+
+    char line[LINE_LEN_MAX], id[TRACE_ID_REPR_LENGTH + 1];
+    size_t len = 0;
+    trace_id_repr(t->id, id);
+    put(line, &len, "{\"trace_id\":\"%s\",\"at_ns\":%ld,\"duration_ns\":%lu,\"spans\":[", id, t->started_at_ns, duration_ns);
+
+    size_t n_dropped = t->n_dropped;
+    for (size_t i = 0; i < t->n_spans; ++i) {
+        trace_span_t const *s = &t->spans[i];
+        size_t const len_before = len;
+        bool const ok = put(line, &len, "%s{\"name\":\"%s\"", i ? "," : "", s->name)
+            && (!s->detail || put(line, &len, ",\"detail\":\"%s\"", s->detail))
+            && put(line, &len, ",\"start_ns\":%lu,\"duration_ns\":%lu}", s->start_ns - t->start_ns, s->end_ns - s->start_ns)
+            && len + 64 < LINE_LEN_MAX; // Keep room for the end of the line
+        if (!ok) {
+            len = len_before;
+            n_dropped += t->n_spans - i;
+            break;
+        }
+    }
+    put(line, &len, "],\"dropped_spans\":%zu}\n", n_dropped);
+
+    logger_write(tracer->logger, line, len);
+}
+
+uint64_t trace_clock(void) {
+    return tl_trace ? metrics_clock() : 0;
+}
+
+void trace_span(char const *name, char const *detail, uint64_t start_ns) {
+    trace_t *t = tl_trace;
+    if (!t) return;
+    if (t->n_spans == TRACE_MAX_SPANS) {
+        ++t->n_dropped;
+        return;
+    }
+    t->spans[t->n_spans++] = (trace_span_t) {
+        .name = name,
+        .detail = detail,
+        .start_ns = start_ns,
+        .end_ns = metrics_clock(),
+    };
+}
+
+void trace_id_repr(uint64_t id, char out_repr[static TRACE_ID_REPR_LENGTH + 1]) {
+    snprintf(out_repr, TRACE_ID_REPR_LENGTH + 1, "%016lx", id);
+}
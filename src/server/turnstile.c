@@ -0,0 +1,41 @@
+/// @file
+/// @author Raphaël
+/// @brief Turnstile - Implementation
+/// @date 18/10/2026
+
+#include "tchatator413/turnstile.h"
+#include "stb_ds.h"
+
+time_t turnstile_rate_limit(cfg_t const *cfg, turnstile_t *turnstile, in_addr_t in_addr) {
+    time_t const t = time(NULL);
+
+    ptrdiff_t i = hmgeti(turnstile->entries, in_addr);
+    if (i == -1) {
+        hmput(turnstile->entries, in_addr,
+            ((user_stats_t) {
+                .last_request_at = t,
+                .n_requests_h = 1,
+                .n_requests_m = 1,
+            }));
+        return 0;
+    }
+
+    user_stats_t *p_stats = &turnstile->entries[i].value;
+
+    time_t time_since_last_request = t - p_stats->last_request_at;
+    p_stats->last_request_at = t;
+
+    if (time_since_last_request >= 60) p_stats->n_requests_m = 0;
+    if (time_since_last_request >= 3600) p_stats->n_requests_h = 0;
+
+    ++p_stats->n_requests_m;
+    ++p_stats->n_requests_h;
+
+    if (p_stats->n_requests_m >= cfg_rate_limit_m(cfg)) return t + 60 - time_since_last_request;
+    if (p_stats->n_requests_h >= cfg_rate_limit_h(cfg)) return t + 3600 - time_since_last_request;
+    return 0;
+}
+
+void turnstile_destroy(turnstile_t *turnstile) {
+    hmfree(turnstile->entries);
+}
@@ -0,0 +1,94 @@
+/// @file
+/// @author Raphaël
+/// @brief User key cache - Implementation
+/// @date 18/10/2026
+
+#include "tchatator413/user_key_cache.h"
+#include "stb_ds.h"
+#include "tchatator413/errstatus.h"
+#include "util.h"
+#include <stdint.h>
+
+typedef struct {
+    char *key; ///< @remark @c NULL if the slot is empty.
+    user_key_kind_t kind;
+    serial_t user_id;
+    time_t expires_at;
+} entry_t;
+
+struct user_key_cache {
+    size_t mask;
+    int ttl, negative_ttl;
+    entry_t entries[];
+};
+
+static inline size_t round_pow2(size_t n) {
+    size_t p = 1;
+    while (p < n) p <<= 1;
+    return p;
+}
+
+static inline entry_t *slot_of(user_key_cache_t *cache, user_key_kind_t kind, char const *key) {
+    // stbds_hash_string doesn't modify its argument, it just isn't const-correct.
+    return &cache->entries[stbds_hash_string((char *)(uintptr_t)key, kind) & cache->mask];
+}
+
+static inline void entry_clear(entry_t *p_entry) {
+    free(p_entry->key);
+    p_entry->key = NULL;
+}
+
+user_key_cache_t *user_key_cache_init(size_t capacity, int ttl, int negative_ttl) {
+    if (capacity == 0) return NULL;
+    capacity = round_pow2(capacity);
+    user_key_cache_t *cache = calloc(1, sizeof *cache + capacity * sizeof *cache->entries);
+    if (!cache) errno_exit("calloc");
+    cache->mask = capacity - 1;
+    cache->ttl = ttl;
+    cache->negative_ttl = negative_ttl;
+    return cache;
+}
+
+void user_key_cache_destroy(user_key_cache_t *cache) {
+    if (!cache) return;
+    user_key_cache_clear(cache);
+    free(cache);
+}
+
+bool user_key_cache_get(user_key_cache_t *cache, user_key_kind_t kind, char const *key, time_t now, serial_t *out_user_id) {
+    if (!cache) return false;
+    entry_t *p_entry = slot_of(cache, kind, key);
+    if (!p_entry->key || p_entry->kind != kind || !streq(p_entry->key, key)) return false;
+    if (p_entry->expires_at <= now) {
+        entry_clear(p_entry);
+        return false;
+    }
+    *out_user_id = p_entry->user_id;
+    return true;
+}
+
+void user_key_cache_put(user_key_cache_t *cache, user_key_kind_t kind, char const *key, time_t now, serial_t user_id) {
+    if (!cache || user_id == errstatus_handled) return;
+    entry_t *p_entry = slot_of(cache, kind, key);
+    if (!p_entry->key || !streq(p_entry->key, key)) {
+        free(p_entry->key);
+        if (!(p_entry->key = strdup(key))) errno_exit("strdup");
+    }
+    p_entry->kind = kind;
+    p_entry->user_id = user_id;
+    p_entry->expires_at = now + (user_id == errstatus_error ? cache->negative_ttl : cache->ttl);
+}
+
+void user_key_cache_invalidate_user(user_key_cache_t *cache, serial_t user_id) {
+    if (!cache) return;
+    for (size_t i = 0; i <= cache->mask; ++i) {
+        if (cache->entries[i].key && cache->entries[i].user_id == user_id) entry_clear(&cache->entries[i]);
+    }
+}
+
+void user_key_cache_clear(user_key_cache_t *cache) {
+    if (!cache) return;
+    for (size_t i = 0; i <= cache->mask; ++i) {
+        entry_clear(&cache->entries[i]);
+    }
+}
@@ -27,22 +27,23 @@ static inline uint8_t hex_repr_to_half(char c);
 
 #define X_42226(O, H) O O O O H O O H O O H O O H O O O O O O
 
-char *uuid4_repr(uuid4_t uuid, char repr[static const UUID4_REPR_LENGTH]) {
+// Scalar implementation
+
+static inline void repr_scalar(uuid4_t const *p_uuid, char repr[static const UUID4_REPR_LENGTH]) {
     size_t idata = 0, i = 0;
-#define O                                                    \
-    do {                                                     \
-        repr[i++] = hex_half_to_repr(uuid.data[idata] >> 4); \
-        repr[i++] = hex_half_to_repr(uuid.data[idata] & 15); \
-        ++idata;                                             \
+#define O                                                       \
+    do {                                                        \
+        repr[i++] = hex_half_to_repr(p_uuid->data[idata] >> 4); \
+        repr[i++] = hex_half_to_repr(p_uuid->data[idata] & 15); \
+        ++idata;                                                \
     } while (0);
 #define H repr[i++] = '-';
     X_42226(O, H);
 #undef O
 #undef H
-    return repr;
 }
 
-bool uuid4_parse(uuid4_t *out_uuid, char const repr[static const UUID4_REPR_LENGTH]) {
+static inline bool parse_scalar(uuid4_t *out_uuid, char const repr[static const UUID4_REPR_LENGTH]) {
     size_t idata = 0, i = 0;
     uint8_t v1, v2;
 #define O                                                            \
@@ -61,20 +62,6 @@ bool uuid4_parse(uuid4_t *out_uuid, char const repr[static const UUID4_REPR_LENG
     return true;
 }
 
-void uuid4_put(uuid4_t uuid, FILE *stream) {
-    size_t idata = 0;
-#define O                                                      \
-    do {                                                       \
-        putc(hex_half_to_repr(uuid.data[idata] >> 4), stream); \
-        putc(hex_half_to_repr(uuid.data[idata] & 15), stream); \
-        ++idata;                                               \
-    } while (0);
-#define H putc('-', stream);
-    X_42226(O, H);
-#undef O
-#undef H
-}
-
 char hex_half_to_repr(uint8_t value) {
     assert(value < 16);
     return (char)(value < 10 ? '0' + value : 'a' - 10 + value);
@@ -90,6 +77,249 @@ uint8_t hex_repr_to_half(char c) {
         : INVALID_HALF;
 }
 
+#if defined __x86_64__ || defined __i386__
+#define UUID4_X86
+#include <immintrin.h>
+
+// SIMD implementations
+//
+// The 32 digits are moved between the canonical representation and two 16-byte registers with overlapping loads and stores, blending around the hyphens.
+// Only SSE2 is needed for that. The AVX2 implementation then converts all 32 digits at once.
+
+#define ATTR_SSE2 __attribute__((target("sse2")))
+#define ATTR_AVX2 __attribute__((target("avx2")))
+
+/// @brief A mask of the bytes in [@p from; @p to).
+static inline ATTR_SSE2 __m128i range_mask(int from, int to) {
+#define M(i) (char)(from <= i && i < to ? -1 : 0)
+    return _mm_setr_epi8(M(0), M(1), M(2), M(3), M(4), M(5), M(6), M(7), M(8), M(9), M(10), M(11), M(12), M(13), M(14), M(15));
+#undef M
+}
+
+/// @brief Select bytes from @p a where @p mask is set, from @p b elsewhere.
+static inline ATTR_SSE2 __m128i blend(__m128i mask, __m128i a, __m128i b) {
+    return _mm_or_si128(_mm_and_si128(mask, a), _mm_andnot_si128(mask, b));
+}
+
+static inline ATTR_SSE2 bool has_hyphens(char const repr[static const UUID4_REPR_LENGTH]) {
+    return (repr[8] == '-') & (repr[13] == '-') & (repr[18] == '-') & (repr[23] == '-');
+}
+
+/// @brief Load the 32 digits of a representation, hyphens excluded.
+static inline ATTR_SSE2 void load_digits(char const repr[static const UUID4_REPR_LENGTH], __m128i *out_lo, __m128i *out_hi) {
+    __m128i const r0 = _mm_loadu_si128((__m128i const *)repr),
+                  r2 = _mm_loadu_si128((__m128i const *)(repr + 2)),
+                  r19 = _mm_loadu_si128((__m128i const *)(repr + 19)),
+                  r20 = _mm_loadu_si128((__m128i const *)(repr + 20));
+    // 0-7, 9-12, 14-17
+    *out_lo = blend(range_mask(0, 8), r0, blend(range_mask(8, 12), _mm_srli_si128(r0, 1), r2));
+    // 19-22, 24-35
+    *out_hi = blend(range_mask(0, 4), r19, r20);
+}
+
+/// @brief Store 32 digits as a representation, adding the hyphens.
+static inline ATTR_SSE2 void store_digits(char repr[static const UUID4_REPR_LENGTH], __m128i lo, __m128i hi) {
+    __m128i const hyphens = _mm_set1_epi8('-');
+    // 0-7, 9-12, 14-15
+    _mm_storeu_si128((__m128i *)repr,
+        blend(range_mask(0, 8), lo, blend(range_mask(9, 13), _mm_slli_si128(lo, 1), blend(range_mask(14, 16), _mm_slli_si128(lo, 2), hyphens))));
+    // 16-17
+    uint16_t const w = (uint16_t)_mm_extract_epi16(lo, 7);
+    memcpy(repr + 16, &w, sizeof w);
+    repr[18] = '-';
+    // 19
+    repr[19] = (char)_mm_cvtsi128_si32(hi);
+    // 20-22, 24-35
+    _mm_storeu_si128((__m128i *)(repr + 20),
+        blend(range_mask(0, 3), _mm_srli_si128(hi, 1), blend(range_mask(4, 16), hi, hyphens)));
+}
+
+/// @brief Decode 16 hex digits to their values.
+/// @param digits The digits.
+/// @param p_valid Cleared where a byte isn't a hex digit.
+static inline ATTR_SSE2 __m128i hex_decode_sse2(__m128i digits, __m128i *p_valid) {
+    __m128i const lower = _mm_or_si128(digits, _mm_set1_epi8(0x20));
+    __m128i const is_digit = _mm_and_si128(_mm_cmpgt_epi8(digits, _mm_set1_epi8('0' - 1)), _mm_cmplt_epi8(digits, _mm_set1_epi8('9' + 1)));
+    __m128i const is_alpha = _mm_and_si128(_mm_cmpgt_epi8(lower, _mm_set1_epi8('a' - 1)), _mm_cmplt_epi8(lower, _mm_set1_epi8('f' + 1)));
+    *p_valid = _mm_and_si128(*p_valid, _mm_or_si128(is_digit, is_alpha));
+    return _mm_or_si128(_mm_and_si128(is_digit, _mm_sub_epi8(digits, _mm_set1_epi8('0'))),
+        _mm_and_si128(is_alpha, _mm_sub_epi8(lower, _mm_set1_epi8('a' - 10))));
+}
+
+/// @brief Combine pairs of nibbles, most significant first, into bytes.
+static inline ATTR_SSE2 __m128i nibble_pairs_sse2(__m128i nibbles) {
+    return _mm_or_si128(_mm_slli_epi16(_mm_and_si128(nibbles, _mm_set1_epi16(0x00ff)), 4), _mm_srli_epi16(nibbles, 8));
+}
+
+/// @brief Split bytes into pairs of nibbles, most significant first.
+static inline ATTR_SSE2 void split_nibbles(uuid4_t const *p_uuid, __m128i *out_lo, __m128i *out_hi) {
+    __m128i const bytes = _mm_loadu_si128((__m128i const *)p_uuid->data);
+    __m128i const high = _mm_and_si128(_mm_srli_epi16(bytes, 4), _mm_set1_epi8(0x0f)),
+                  low = _mm_and_si128(bytes, _mm_set1_epi8(0x0f));
+    *out_lo = _mm_unpacklo_epi8(high, low);
+    *out_hi = _mm_unpackhi_epi8(high, low);
+}
+
+/// @brief Encode 16 nibbles to lowercase hex digits.
+static inline ATTR_SSE2 __m128i hex_encode_sse2(__m128i nibbles) {
+    __m128i const offset = _mm_add_epi8(_mm_set1_epi8('0'), _mm_and_si128(_mm_cmpgt_epi8(nibbles, _mm_set1_epi8(9)), _mm_set1_epi8('a' - '0' - 10)));
+    return _mm_add_epi8(nibbles, offset);
+}
+
+static inline ATTR_SSE2 bool parse_sse2(uuid4_t *out_uuid, char const repr[static const UUID4_REPR_LENGTH]) {
+    if (!has_hyphens(repr)) return false;
+    __m128i lo, hi, valid = _mm_set1_epi8(-1);
+    load_digits(repr, &lo, &hi);
+    lo = hex_decode_sse2(lo, &valid);
+    hi = hex_decode_sse2(hi, &valid);
+    if (_mm_movemask_epi8(valid) != 0xffff) return false;
+    _mm_storeu_si128((__m128i *)out_uuid->data, _mm_packus_epi16(nibble_pairs_sse2(lo), nibble_pairs_sse2(hi)));
+    return true;
+}
+
+static inline ATTR_SSE2 void repr_sse2(uuid4_t const *p_uuid, char repr[static const UUID4_REPR_LENGTH]) {
+    __m128i lo, hi;
+    split_nibbles(p_uuid, &lo, &hi);
+    store_digits(repr, hex_encode_sse2(lo), hex_encode_sse2(hi));
+}
+
+static inline ATTR_AVX2 bool parse_avx2(uuid4_t *out_uuid, char const repr[static const UUID4_REPR_LENGTH]) {
+    if (!has_hyphens(repr)) return false;
+    __m128i lo, hi;
+    load_digits(repr, &lo, &hi);
+    __m256i const digits = _mm256_inserti128_si256(_mm256_castsi128_si256(lo), hi, 1);
+
+    __m256i const lower = _mm256_or_si256(digits, _mm256_set1_epi8(0x20));
+    __m256i const is_digit = _mm256_and_si256(_mm256_cmpgt_epi8(digits, _mm256_set1_epi8('0' - 1)), _mm256_cmpgt_epi8(_mm256_set1_epi8('9' + 1), digits));
+    __m256i const is_alpha = _mm256_and_si256(_mm256_cmpgt_epi8(lower, _mm256_set1_epi8('a' - 1)), _mm256_cmpgt_epi8(_mm256_set1_epi8('f' + 1), lower));
+    if (_mm256_movemask_epi8(_mm256_or_si256(is_digit, is_alpha)) != -1) return false;
+    __m256i const nibbles = _mm256_or_si256(_mm256_and_si256(is_digit, _mm256_sub_epi8(digits, _mm256_set1_epi8('0'))),
+        _mm256_and_si256(is_alpha, _mm256_sub_epi8(lower, _mm256_set1_epi8('a' - 10))));
+
+    __m256i const pairs = _mm256_or_si256(_mm256_slli_epi16(_mm256_and_si256(nibbles, _mm256_set1_epi16(0x00ff)), 4), _mm256_srli_epi16(nibbles, 8));
+    _mm_storeu_si128((__m128i *)out_uuid->data, _mm_packus_epi16(_mm256_castsi256_si128(pairs), _mm256_extracti128_si256(pairs, 1)));
+    return true;
+}
+
+static inline ATTR_AVX2 void repr_avx2(uuid4_t const *p_uuid, char repr[static const UUID4_REPR_LENGTH]) {
+    __m128i lo, hi;
+    split_nibbles(p_uuid, &lo, &hi);
+    __m256i const nibbles = _mm256_inserti128_si256(_mm256_castsi128_si256(lo), hi, 1);
+
+    __m256i const offset = _mm256_add_epi8(_mm256_set1_epi8('0'), _mm256_and_si256(_mm256_cmpgt_epi8(nibbles, _mm256_set1_epi8(9)), _mm256_set1_epi8('a' - '0' - 10)));
+    __m256i const digits = _mm256_add_epi8(nibbles, offset);
+    store_digits(repr, _mm256_castsi256_si128(digits), _mm256_extracti128_si256(digits, 1));
+}
+
+#endif // x86
+
+// Dispatch
+
+/// @brief Defines the batch functions of an implementation. They call its kernels directly, so they can be inlined.
+#define DEFINE_BATCH(impl, attr)                                                                                  \
+    static attr size_t parse_batch_##impl(size_t n, uuid4_t *out_uuids, char const (*reprs)[UUID4_REPR_LENGTH]) { \
+        size_t i = 0;                                                                                             \
+        while (i < n && parse_##impl(&out_uuids[i], reprs[i])) ++i;                                               \
+        return i;                                                                                                 \
+    }                                                                                                             \
+    static attr void repr_batch_##impl(size_t n, uuid4_t const *uuids, char (*reprs)[UUID4_REPR_LENGTH]) {        \
+        for (size_t i = 0; i < n; ++i) repr_##impl(&uuids[i], reprs[i]);                                          \
+    }
+
+DEFINE_BATCH(scalar, )
+#ifdef UUID4_X86
+DEFINE_BATCH(sse2, ATTR_SSE2)
+DEFINE_BATCH(avx2, ATTR_AVX2)
+#endif
+
+#undef DEFINE_BATCH
+
+typedef struct {
+    char const *name;
+    bool (*parse)(uuid4_t *out_uuid, char const repr[static const UUID4_REPR_LENGTH]);
+    void (*repr)(uuid4_t const *p_uuid, char repr[static const UUID4_REPR_LENGTH]);
+    size_t (*parse_batch)(size_t n, uuid4_t *out_uuids, char const (*reprs)[UUID4_REPR_LENGTH]);
+    void (*repr_batch)(size_t n, uuid4_t const *uuids, char (*reprs)[UUID4_REPR_LENGTH]);
+} impl_t;
+
+#define IMPL(impl) { .name = #impl, .parse = parse_##impl, .repr = repr_##impl, .parse_batch = parse_batch_##impl, .repr_batch = repr_batch_##impl }
+
+static impl_t const gs_impls[uuid4_impl_count] = {
+    [uuid4_impl_scalar] = IMPL(scalar),
+#ifdef UUID4_X86
+    [uuid4_impl_sse2] = IMPL(sse2),
+    [uuid4_impl_avx2] = IMPL(avx2),
+#else
+    [uuid4_impl_sse2] = { .name = "sse2" },
+    [uuid4_impl_avx2] = { .name = "avx2" },
+#endif
+};
+
+#undef IMPL
+
+/// @brief The implementation in use, or @ref uuid4_impl_count until the first call.
+static uuid4_impl_t gs_current = uuid4_impl_count;
+
+static inline impl_t const *current_impl(void) {
+    return &gs_impls[uuid4_impl_current()];
+}
+
+char const *uuid4_impl_name(uuid4_impl_t impl) {
+    return gs_impls[impl].name;
+}
+
+bool uuid4_impl_supported(uuid4_impl_t impl) {
+    switch (impl) {
+    case uuid4_impl_scalar: return true;
+#ifdef UUID4_X86
+    case uuid4_impl_sse2: return __builtin_cpu_supports("sse2");
+    case uuid4_impl_avx2: return __builtin_cpu_supports("avx2");
+#endif
+    default: return false;
+    }
+}
+
+uuid4_impl_t uuid4_impl_current(void) {
+    if (gs_current == uuid4_impl_count) {
+        gs_current = uuid4_impl_scalar;
+        for (uuid4_impl_t i = uuid4_impl_count; i-- > 0;) {
+            if (uuid4_impl_supported(i)) {
+                gs_current = i;
+                break;
+            }
+        }
+    }
+    return gs_current;
+}
+
+bool uuid4_impl_select(uuid4_impl_t impl) {
+    if (!uuid4_impl_supported(impl)) return false;
+    gs_current = impl;
+    return true;
+}
+
+char *uuid4_repr(uuid4_t uuid, char repr[static const UUID4_REPR_LENGTH]) {
+    current_impl()->repr(&uuid, repr);
+    return repr;
+}
+
+bool uuid4_parse(uuid4_t *out_uuid, char const repr[static const UUID4_REPR_LENGTH]) {
+    return current_impl()->parse(out_uuid, repr);
+}
+
+void uuid4_repr_batch(size_t n, uuid4_t const *uuids, char (*reprs)[UUID4_REPR_LENGTH]) {
+    current_impl()->repr_batch(n, uuids, reprs);
+}
+
+size_t uuid4_parse_batch(size_t n, uuid4_t *out_uuids, char const (*reprs)[UUID4_REPR_LENGTH]) {
+    return current_impl()->parse_batch(n, out_uuids, reprs);
+}
+
+void uuid4_put(uuid4_t uuid, FILE *stream) {
+    char repr[UUID4_REPR_LENGTH];
+    fwrite(uuid4_repr(uuid, repr), 1, sizeof repr, stream);
+}
+
 bool uuid4_eq(uuid4_t a, uuid4_t b) {
     return memcmp(&a, &b, sizeof a) == 0;
 }
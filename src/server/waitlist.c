@@ -0,0 +1,171 @@
+/// @file
+/// @author Raphaël
+/// @brief Wait list - Implementation
+/// @date 18/10/2026
+
+#include "tchatator413/waitlist.h"
+#include "stb_ds.h"
+#include "util.h"
+
+/// @brief A parked connection.
+typedef struct waiter {
+    int fd;
+    serial_t user_id;
+    uint64_t deadline_ns;
+    /// @brief Whether the waiter is in the woken queue rather than the waiting one.
+    bool woken;
+    /// @brief Neighbours in the queue the waiter is in.
+    struct waiter *prev, *next;
+    /// @brief Next waiter for the same user. Only while waiting.
+    struct waiter *next_of_user;
+} waiter_t;
+
+typedef struct {
+    waiter_t *first, *last;
+} queue_t;
+
+struct waitlist {
+    size_t max_waiters;
+    /// @brief Waiting, by deadline.
+    queue_t waiting;
+    /// @brief Woken, in the order they were woken.
+    queue_t woken;
+    struct {
+        int key;
+        waiter_t *value;
+    } *by_fd;
+    /// @brief The first waiter of each user, the others following @ref waiter_t.next_of_user.
+    struct {
+        serial_t key;
+        waiter_t *value;
+    } *by_user;
+};
+
+static inline void queue_unlink(queue_t *queue, waiter_t *w) {
+    if (w->prev) w->prev->next = w->next;
+    else queue->first = w->next;
+    if (w->next) w->next->prev = w->prev;
+    else queue->last = w->prev;
+    w->prev = w->next = NULL;
+}
+
+/// @brief Insert a waiter after the last one that isn't due later.
+static inline void queue_insert(queue_t *queue, waiter_t *w) {
+    waiter_t *after = queue->last;
+    while (after && after->deadline_ns > w->deadline_ns) after = after->prev;
+    w->prev = after;
+    w->next = after ? after->next : queue->first;
+    if (w->next) w->next->prev = w;
+    else queue->last = w;
+    if (after) after->next = w;
+    else queue->first = w;
+}
+
+static inline void queue_push_last(queue_t *queue, waiter_t *w) {
+    w->prev = queue->last;
+    w->next = NULL;
+    if (queue->last) queue->last->next = w;
+    else queue->first = w;
+    queue->last = w;
+}
+
+/// @brief Take a waiter out of the list of its user.
+static void unlink_of_user(waitlist_t *waitlist, waiter_t *w) {
+    ptrdiff_t const i = hmgeti(waitlist->by_user, w->user_id);
+    if (i == -1) return;
+    waiter_t **p = &waitlist->by_user[i].value;
+    while (*p && *p != w) p = &(*p)->next_of_user;
+    if (*p) *p = w->next_of_user;
+    if (!waitlist->by_user[i].value) (void)hmdel(waitlist->by_user, w->user_id);
+}
+
+/// @brief Take a waiter out of the wait list and free it.
+static void drop(waitlist_t *waitlist, waiter_t *w) {
+    if (w->woken) {
+        queue_unlink(&waitlist->woken, w);
+    } else {
+        queue_unlink(&waitlist->waiting, w);
+        unlink_of_user(waitlist, w);
+    }
+    (void)hmdel(waitlist->by_fd, w->fd);
+    free(w);
+}
+
+waitlist_t *waitlist_init(size_t max_waiters) {
+    if (max_waiters == 0) return NULL;
+    waitlist_t *waitlist = calloc(1, sizeof *waitlist);
+    if (!waitlist) errno_exit("calloc");
+    waitlist->max_waiters = max_waiters;
+    return waitlist;
+}
+
+void waitlist_destroy(waitlist_t *waitlist) {
+    if (!waitlist) return;
+    for (ptrdiff_t i = 0; i < hmlen(waitlist->by_fd); ++i) free(waitlist->by_fd[i].value);
+    hmfree(waitlist->by_fd);
+    hmfree(waitlist->by_user);
+    free(waitlist);
+}
+
+size_t waitlist_len(waitlist_t const *waitlist) {
+    return waitlist ? (size_t)hmlen(waitlist->by_fd) : 0;
+}
+
+bool waitlist_park(waitlist_t *waitlist, int fd, serial_t user_id, uint64_t deadline_ns) {
+    if (!waitlist || (size_t)hmlen(waitlist->by_fd) >= waitlist->max_waiters) return false;
+
+    waiter_t *w = malloc(sizeof *w);
+    if (!w) errno_exit("malloc");
+    w->fd = fd;
+    w->user_id = user_id;
+    w->deadline_ns = deadline_ns;
+    w->woken = false;
+    queue_insert(&waitlist->waiting, w);
+
+    ptrdiff_t const i = hmgeti(waitlist->by_user, user_id);
+    w->next_of_user = i == -1 ? NULL : waitlist->by_user[i].value;
+    hmput(waitlist->by_user, user_id, w);
+    hmput(waitlist->by_fd, fd, w);
+    return true;
+}
+
+void waitlist_notify(waitlist_t *waitlist, serial_t user_id) {
+    if (!waitlist) return;
+    ptrdiff_t const i = hmgeti(waitlist->by_user, user_id);
+    if (i == -1) return;
+    for (waiter_t *w = waitlist->by_user[i].value, *next; w; w = next) {
+        next = w->next_of_user;
+        queue_unlink(&waitlist->waiting, w);
+        w->woken = true;
+        w->next_of_user = NULL;
+        queue_push_last(&waitlist->woken, w);
+    }
+    (void)hmdel(waitlist->by_user, user_id);
+}
+
+bool waitlist_remove(waitlist_t *waitlist, int fd) {
+    if (!waitlist) return false;
+    ptrdiff_t const i = hmgeti(waitlist->by_fd, fd);
+    if (i == -1) return false;
+    drop(waitlist, waitlist->by_fd[i].value);
+    return true;
+}
+
+uint64_t waitlist_next_due(waitlist_t const *waitlist) {
+    if (!waitlist) return UINT64_MAX;
+    if (waitlist->woken.first) return 0;
+    return waitlist->waiting.first ? waitlist->waiting.first->deadline_ns : UINT64_MAX;
+}
+
+bool waitlist_pop(waitlist_t *waitlist, uint64_t now_ns, int *out_fd, bool *out_woken) {
+    if (!waitlist) return false;
+    waiter_t *w = waitlist->woken.first;
+    if (!w) {
+        w = waitlist->waiting.first;
+        if (!w || w->deadline_ns > now_ns) return false;
+    }
+    *out_fd = w->fd;
+    *out_woken = w->woken;
+    drop(waitlist, w);
+    return true;
+}
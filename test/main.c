@@ -7,6 +7,7 @@
 #include "tchatator413/cfg.h"
 #include "tchatator413/const.h"
 #include "tchatator413/db.h"
+#include "tchatator413/json_cache.h"
 #include <stdlib.h>
 
 // #define DO_OBSERVE
@@ -24,6 +25,23 @@ int main(void) {
 
     test(test_uuid4());
     test(test_memlst());
+    test(test_user_key_cache());
+    test(test_inbox_cache());
+    test(test_api_key_filter());
+    test(test_block_index());
+    test(test_json_cache());
+    test(test_json_writer());
+    test(test_logger());
+    test(test_evlog());
+    test(test_metrics());
+    test(test_metrics_http());
+    test(test_turnstile());
+    test(test_trace());
+    test(test_capture());
+    test(test_profiler());
+    test(test_waitlist());
+    test(test_action_schema());
+    test(test_action_fast());
 
     // probably a bad idea to proceed if uuid4 or memlst are bad
     if (!success) return EXIT_FAILURE;
@@ -51,6 +69,9 @@ int main(void) {
             require_env(cfg, "DB_PASSWORD")));
     if (!db) CLEAN_RETURN(mem, EX_NODB);
 
+    json_cache_init((size_t)cfg_json_cache_size(cfg));
+    atexit(json_cache_destroy);
+
 #define CALL_TEST(name) test(test_tchatator413_##name(&mem, cfg, db, root_constr));
     X_TESTS(CALL_TEST)
 #undef CALL_TEST
@@ -0,0 +1,293 @@
+/// @file
+/// @author Raphaël
+/// @brief Tchatator413 test
+///
+/// Tests the edition of a message, and that it shows up in the inbox of the recipient, cached or not
+/// - member1 send
+/// - pro1 inbox
+/// - pro1 edit (not the sender)
+/// - member1 edit (too long)
+/// - member1 edit
+/// - pro1 inbox (from the cache)
+/// - pro1 inbox (from the database)
+/// - member1 rm
+/// - member1 edit (removed)
+///
+/// @date 18/10/2026
+
+#include "../tests.h"
+#include "tchatator413/action.h"
+#include "tchatator413/tchatator413.h"
+
+#define NAME member1_send_member1_edit_pro1_inbox
+
+#define MSG_CONTENT "Bonjour du language C :)"
+#define MSG_NEW_CONTENT "Bonsoir du language C :)"
+
+static serial_t gs_msg_id;
+static time_t gs_msg_sent_at;
+static int32_t gs_msg_edited_age;
+static unsigned gs_fill_round_trips;
+
+static void on_action(action_t const *action, void *t) {
+    test_t const *p_test = base_on_action(t);
+    switch (p_test->n_actions) {
+    case 1: // send
+        if (!TEST_CASE_EQ_INT(t, action->type, action_type_send, )) return;
+        TEST_CASE_EQ_UUID(t, action->with.send.constr.api_key, API_KEY_MEMBER1_UUID, );
+        TEST_CASE_EQ_STR(t, action->with.send.content.val, MSG_CONTENT, );
+        TEST_CASE_EQ_INT(t, action->with.send.dest_user_id, USER_ID_PRO1, );
+        break;
+    case 2: // inbox
+    case 6: // inbox
+    case 7: // inbox
+        if (!TEST_CASE_EQ_INT(t, action->type, action_type_inbox, )) return;
+        TEST_CASE_EQ_UUID(t, action->with.inbox.constr.api_key, API_KEY_PRO1_UUID, );
+        TEST_CASE_EQ_INT(t, action->with.inbox.page, 1, );
+        break;
+    case 3: // edit
+        if (!TEST_CASE_EQ_INT(t, action->type, action_type_edit, )) return;
+        TEST_CASE_EQ_UUID(t, action->with.edit.constr.api_key, API_KEY_PRO1_UUID, );
+        TEST_CASE_EQ_INT(t, action->with.edit.msg_id, gs_msg_id, );
+        break;
+    case 4: // edit
+        if (!TEST_CASE_EQ_INT(t, action->type, action_type_edit, )) return;
+        TEST_CASE_EQ_UUID(t, action->with.edit.constr.api_key, API_KEY_MEMBER1_UUID, );
+        TEST_CASE_EQ_INT64(t, action->with.edit.new_content.len, (size_t)cfg_max_msg_length(p_test->cfg) + 1, );
+        break;
+    case 5: // edit
+    case 9: // edit
+        if (!TEST_CASE_EQ_INT(t, action->type, action_type_edit, )) return;
+        TEST_CASE_EQ_UUID(t, action->with.edit.constr.api_key, API_KEY_MEMBER1_UUID, );
+        TEST_CASE_EQ_STR(t, action->with.edit.constr.password, "member1_mdp", );
+        TEST_CASE_EQ_INT(t, action->with.edit.msg_id, gs_msg_id, );
+        TEST_CASE_EQ_STR(t, action->with.edit.new_content.val, MSG_NEW_CONTENT, );
+        break;
+    case 8: // rm
+        if (!TEST_CASE_EQ_INT(t, action->type, action_type_rm, )) return;
+        TEST_CASE_EQ_UUID(t, action->with.rm.constr.api_key, API_KEY_MEMBER1_UUID, );
+        TEST_CASE_EQ_INT(t, action->with.rm.msg_id, gs_msg_id, );
+        break;
+    default: test_fail(t, "wrong test->n_actions: %d", p_test->n_actions);
+    }
+}
+
+/// @brief Test that an inbox holds the edited message only.
+static void test_case_inbox_edited(test_t *p_test, response_t const *p_resp) {
+    if (!TEST_CASE_EQ_INT(&p_test->t, p_resp->type, action_type_inbox, )) return;
+    if (!TEST_CASE_EQ_INT64(&p_test->t, p_resp->body.inbox.n_msgs, 1, )) return;
+    msg_t msg = p_resp->body.inbox.msgs[0];
+    TEST_CASE_EQ_INT(&p_test->t, msg.id, gs_msg_id, );
+    TEST_CASE_EQ_INT64(&p_test->t, msg.sent_at, gs_msg_sent_at, );
+    TEST_CASE_EQ_INT(&p_test->t, msg.edited_age, gs_msg_edited_age, );
+    TEST_CASE_EQ_STR(&p_test->t, msg.content, MSG_NEW_CONTENT, );
+}
+
+static void on_response(response_t const *p_resp, void *t) {
+    test_t *p_test = base_on_response(t, p_resp);
+    test_case(t, !p_resp->has_next_page, "");
+    switch (p_test->n_responses) {
+    case 1: { // send
+        if (!TEST_CASE_EQ_INT(t, p_resp->type, action_type_send, )) return;
+
+        msg_t msg = { .id = gs_msg_id = p_resp->body.send.msg_id };
+        if (!test_case(t, errstatus_ok == db_get_msg(p_test->db, p_test->p_mem, p_test->cfg, &msg),
+                "sent msg id %d exists", msg.id)) return;
+        gs_msg_sent_at = msg.sent_at;
+        break;
+    }
+    case 2: // inbox, filling the cache
+        if (!TEST_CASE_EQ_INT(t, p_resp->type, action_type_inbox, )) return;
+        if (!TEST_CASE_EQ_INT64(t, p_resp->body.inbox.n_msgs, 1, )) return;
+        TEST_CASE_EQ_STR(t, p_resp->body.inbox.msgs[0].content, MSG_CONTENT, );
+        gs_fill_round_trips = p_resp->n_round_trips;
+        break;
+    case 3: // edit, not the sender
+        if (!TEST_CASE_EQ_INT(t, p_resp->type, action_type_error, )) return;
+        if (!TEST_CASE_EQ_INT(t, p_resp->body.error.type, action_error_type_invariant, )) return;
+        TEST_CASE_EQ_STR(t, p_resp->body.error.info.invariant.name, "owns_msg", );
+        break;
+    case 4: // edit, too long
+        if (!TEST_CASE_EQ_INT(t, p_resp->type, action_type_error, )) return;
+        if (!TEST_CASE_EQ_INT(t, p_resp->body.error.type, action_error_type_other, )) return;
+        TEST_CASE_EQ_INT(t, p_resp->body.error.info.other.status, status_payload_too_large, );
+        break;
+    case 5: { // edit
+        if (!TEST_CASE_EQ_INT(t, p_resp->type, action_type_edit, )) return;
+
+        msg_t msg = { .id = gs_msg_id };
+        if (!test_case(t, errstatus_ok == db_get_msg(p_test->db, p_test->p_mem, p_test->cfg, &msg),
+                "edited msg id %d exists", msg.id)) return;
+        // Sent and edited in the same transaction: the edit age is 0, so it isn't serialized.
+        gs_msg_edited_age = msg.edited_age;
+        TEST_CASE_EQ_INT(t, gs_msg_edited_age, 0, );
+        TEST_CASE_EQ_INT64(t, msg.sent_at, gs_msg_sent_at, );
+        TEST_CASE_EQ_INT(t, msg.deleted_age, 0, );
+        TEST_CASE_EQ_STR(t, msg.content, MSG_NEW_CONTENT, );
+        break;
+    }
+    case 6: // inbox, from the cache
+        test_case(t, p_resp->n_round_trips < gs_fill_round_trips, "inbox took %u database round-trips, filling took %u",
+            p_resp->n_round_trips, gs_fill_round_trips);
+        test_case_inbox_edited(p_test, p_resp);
+        break;
+    case 7: // inbox, from the database
+        test_case_inbox_edited(p_test, p_resp);
+        break;
+    case 8: // rm
+        TEST_CASE_EQ_INT(t, p_resp->type, action_type_rm, );
+        break;
+    case 9: // edit, removed
+        if (!TEST_CASE_EQ_INT(t, p_resp->type, action_type_error, )) return;
+        if (!TEST_CASE_EQ_INT(t, p_resp->body.error.type, action_error_type_other, )) return;
+        TEST_CASE_EQ_INT(t, p_resp->body.error.info.other.status, status_not_found, );
+        break;
+    default: test_fail(t, "wrong test->n_responses: %d", p_test->n_actions);
+    }
+}
+
+static errstatus_t transaction(db_t *db, cfg_t *cfg, void *ctx) {
+    test_t *p_tst = ctx;
+
+    db_use_test_data(db, cfg, test_data_users);
+
+    // Member sends message
+    {
+        json_object *jo_input = memlst_add(p_tst->p_mem, dtor_json_object,
+            load_jsonf(IN_JSONF(NAME, "_send"), API_KEY_MEMBER1 "¤member1_mdp"));
+        json_object *jo_output = memlst_add(p_tst->p_mem, dtor_json_object,
+            tchatator413_interpret(jo_input, cfg, db, on_action, on_response, p_tst));
+
+        test_case_n_actions(p_tst, 1);
+
+        json_object *jo_expected_output = memlst_add(p_tst->p_mem, dtor_json_object,
+            load_jsonf(OUT_JSONF(NAME, "_send"), gs_msg_id));
+
+        if (!TEST_OUTPUT_JSON(&p_tst->t, jo_output, jo_expected_output)) return errstatus_tested;
+    }
+
+    // Pro queries inbox, which is cached
+    {
+        json_object *jo_input = memlst_add(p_tst->p_mem, dtor_json_object,
+            load_jsonf(IN_JSONF(NAME, "_inbox"), API_KEY_PRO1 "¤pro1_mdp"));
+        json_object *jo_output = memlst_add(p_tst->p_mem, dtor_json_object,
+            tchatator413_interpret(jo_input, cfg, db, on_action, on_response, p_tst));
+
+        test_case_n_actions(p_tst, 2);
+
+        json_object *jo_expected_output = memlst_add(p_tst->p_mem, dtor_json_object,
+            load_jsonf(OUT_JSONF(NAME, "_inbox"), gs_msg_id, gs_msg_sent_at, MSG_CONTENT, USER_ID_MEMBER1, USER_ID_PRO1));
+
+        if (!TEST_OUTPUT_JSON(&p_tst->t, jo_output, jo_expected_output)) return errstatus_tested;
+    }
+
+    // Pro tries to edit the message of member
+    {
+        json_object *jo_input = memlst_add(p_tst->p_mem, dtor_json_object,
+            load_jsonf(IN_JSONF(NAME, "_edit"), API_KEY_PRO1 "¤pro1_mdp", gs_msg_id, MSG_NEW_CONTENT));
+        json_object *jo_output = memlst_add(p_tst->p_mem, dtor_json_object,
+            tchatator413_interpret(jo_input, cfg, db, on_action, on_response, p_tst));
+
+        test_case_n_actions(p_tst, 3);
+        test_output_json_file(p_tst, jo_output, OUT_JSON(NAME, "_edit_owns_msg"));
+    }
+
+    // Member tries to edit message with a content too long
+    {
+        size_t const len = (size_t)cfg_max_msg_length(cfg) + 1;
+        char *const too_long = memlst_alloc(p_tst->p_mem, len + 1);
+        memset(too_long, 'a', len);
+        too_long[len] = '\0';
+
+        json_object *jo_input = memlst_add(p_tst->p_mem, dtor_json_object,
+            load_jsonf(IN_JSONF(NAME, "_edit"), API_KEY_MEMBER1 "¤member1_mdp", gs_msg_id, too_long));
+        json_object *jo_output = memlst_add(p_tst->p_mem, dtor_json_object,
+            tchatator413_interpret(jo_input, cfg, db, on_action, on_response, p_tst));
+
+        test_case_n_actions(p_tst, 4);
+        test_output_json_file(p_tst, jo_output, OUT_JSON(NAME, "_edit_too_long"));
+    }
+
+    // Member edits message
+    {
+        json_object *jo_input = memlst_add(p_tst->p_mem, dtor_json_object,
+            load_jsonf(IN_JSONF(NAME, "_edit"), API_KEY_MEMBER1 "¤member1_mdp", gs_msg_id, MSG_NEW_CONTENT));
+        json_object *jo_output = memlst_add(p_tst->p_mem, dtor_json_object,
+            tchatator413_interpret(jo_input, cfg, db, on_action, on_response, p_tst));
+
+        test_case_n_actions(p_tst, 5);
+        if (!test_output_json_file(p_tst, jo_output, OUT_JSON(NAME, "_edit"))) return errstatus_tested;
+    }
+
+    // Pro queries inbox again: the message was edited in the cache
+    {
+        json_object *jo_input = memlst_add(p_tst->p_mem, dtor_json_object,
+            load_jsonf(IN_JSONF(NAME, "_inbox"), API_KEY_PRO1 "¤pro1_mdp"));
+        json_object *jo_output = memlst_add(p_tst->p_mem, dtor_json_object,
+            tchatator413_interpret(jo_input, cfg, db, on_action, on_response, p_tst));
+
+        test_case_n_actions(p_tst, 6);
+
+        json_object *jo_expected_output = memlst_add(p_tst->p_mem, dtor_json_object,
+            load_jsonf(OUT_JSONF(NAME, "_inbox"), gs_msg_id, gs_msg_sent_at, MSG_NEW_CONTENT, USER_ID_MEMBER1, USER_ID_PRO1));
+
+        TEST_OUTPUT_JSON(&p_tst->t, jo_output, jo_expected_output);
+    }
+
+    // Pro queries inbox again, from the database this time
+    db_invalidate_caches(db);
+    {
+        json_object *jo_input = memlst_add(p_tst->p_mem, dtor_json_object,
+            load_jsonf(IN_JSONF(NAME, "_inbox"), API_KEY_PRO1 "¤pro1_mdp"));
+        json_object *jo_output = memlst_add(p_tst->p_mem, dtor_json_object,
+            tchatator413_interpret(jo_input, cfg, db, on_action, on_response, p_tst));
+
+        test_case_n_actions(p_tst, 7);
+
+        json_object *jo_expected_output = memlst_add(p_tst->p_mem, dtor_json_object,
+            load_jsonf(OUT_JSONF(NAME, "_inbox"), gs_msg_id, gs_msg_sent_at, MSG_NEW_CONTENT, USER_ID_MEMBER1, USER_ID_PRO1));
+
+        TEST_OUTPUT_JSON(&p_tst->t, jo_output, jo_expected_output);
+    }
+
+    // Member deletes message
+    {
+        json_object *jo_input = memlst_add(p_tst->p_mem, dtor_json_object,
+            load_jsonf(IN_JSONF(NAME, "_rm"), API_KEY_MEMBER1 "¤member1_mdp", gs_msg_id));
+        json_object *jo_output = memlst_add(p_tst->p_mem, dtor_json_object,
+            tchatator413_interpret(jo_input, cfg, db, on_action, on_response, p_tst));
+
+        test_case_n_actions(p_tst, 8);
+        if (!test_output_json_file(p_tst, jo_output, OUT_JSON(NAME, "_rm"))) return errstatus_tested;
+    }
+
+    // Member tries to edit the deleted message
+    {
+        json_object *jo_input = memlst_add(p_tst->p_mem, dtor_json_object,
+            load_jsonf(IN_JSONF(NAME, "_edit"), API_KEY_MEMBER1 "¤member1_mdp", gs_msg_id, MSG_NEW_CONTENT));
+        json_object *jo_output = memlst_add(p_tst->p_mem, dtor_json_object,
+            tchatator413_interpret(jo_input, cfg, db, on_action, on_response, p_tst));
+
+        test_case_n_actions(p_tst, 9);
+        test_output_json_file(p_tst, jo_output, OUT_JSON(NAME, "_edit_not_found"));
+    }
+
+    return errstatus_tested;
+}
+
+TEST_SIGNATURE(NAME) {
+    // - send: recipient by name (member, then pro), auth, recipient role, block index, send_msg
+    // - inbox: auth, page
+    // - edit: auth, message, refused by owns_msg
+    // - edit: auth, refused by length
+    // - edit: auth, message, edit
+    // - inbox: auth, served from the cache
+    // - inbox: auth, page
+    // - rm: auth, delete
+    // - edit: auth, message, block index, edit that finds no message
+    test_t tst = TEST_INIT(NAME, 6, 2, 2, 1, 3, 1, 2, 2, 4);
+
+    db_transaction(tst.db, tst.cfg, transaction, &tst);
+
+    return tst.t;
+}
@@ -47,7 +47,7 @@ static void on_action(action_t const *action, void *t) {
 }
 
 static void on_response(response_t const *p_resp, void *t) {
-    test_t *p_test = base_on_response(t);
+    test_t *p_test = base_on_response(t, p_resp);
     test_case(t, !p_resp->has_next_page, "");
     switch (p_test->n_responses) {
     case 1: { // send
@@ -135,7 +135,10 @@ static errstatus_t transaction(db_t *db, cfg_t *cfg, void *ctx) {
 }
 
 TEST_SIGNATURE(NAME) {
-    test_t tst = TEST_INIT(NAME);
+    // - send: recipient by name (member, then pro), auth, recipient role, block index, send_msg
+    // - inbox: auth, page
+    // - rm: auth, delete
+    test_t tst = TEST_INIT(NAME, 6, 2, 2);
 
     db_transaction(tst.db, tst.cfg, transaction, &tst);
 
@@ -0,0 +1,112 @@
+/// @file
+/// @author Raphaël
+/// @brief Tchatator413 test
+///
+/// Tests that a blocked member can't send messages until they're unblocked
+/// - pro1 block member1
+/// - member1 send (refused)
+/// - pro1 unblock member1
+///
+/// @date 18/10/2026
+
+#include "../tests.h"
+#include "tchatator413/action.h"
+#include "tchatator413/tchatator413.h"
+
+#define NAME pro1_block_member1_send_unblock
+
+static void on_action(action_t const *action, void *t) {
+    test_t const *p_test = base_on_action(t);
+    switch (p_test->n_actions) {
+    case 1: // block
+        if (!TEST_CASE_EQ_INT(t, action->type, action_type_block, )) return;
+        TEST_CASE_EQ_UUID(t, action->with.block.constr.api_key, API_KEY_PRO1_UUID, );
+        TEST_CASE_EQ_INT(t, action->with.block.user_id, USER_ID_MEMBER1, );
+        break;
+    case 2: // send
+        if (!TEST_CASE_EQ_INT(t, action->type, action_type_send, )) return;
+        TEST_CASE_EQ_UUID(t, action->with.send.constr.api_key, API_KEY_MEMBER1_UUID, );
+        TEST_CASE_EQ_INT(t, action->with.send.dest_user_id, USER_ID_PRO1, );
+        break;
+    case 3: // unblock
+        if (!TEST_CASE_EQ_INT(t, action->type, action_type_unblock, )) return;
+        TEST_CASE_EQ_UUID(t, action->with.unblock.constr.api_key, API_KEY_PRO1_UUID, );
+        TEST_CASE_EQ_INT(t, action->with.unblock.user_id, USER_ID_MEMBER1, );
+        break;
+    default: test_fail(t, "wrong test->n_actions: %d", p_test->n_actions);
+    }
+}
+
+static void on_response(response_t const *p_resp, void *t) {
+    test_t *p_test = base_on_response(t, p_resp);
+    test_case(t, !p_resp->has_next_page, "");
+    switch (p_test->n_responses) {
+    case 1: // block
+        TEST_CASE_EQ_INT(t, p_resp->type, action_type_block, );
+        test_case(t, db_is_blocked(p_test->db, p_test->cfg, USER_ID_MEMBER1, USER_ID_PRO1), "member1 is blocked by pro1");
+        test_case(t, !db_is_blocked(p_test->db, p_test->cfg, USER_ID_MEMBER1, USER_ID_PRO2), "member1 isn't blocked by pro2");
+        break;
+    case 2: // send
+        if (!TEST_CASE_EQ_INT(t, p_resp->type, action_type_error, )) return;
+        if (!TEST_CASE_EQ_INT(t, p_resp->body.error.type, action_error_type_other, )) return;
+        TEST_CASE_EQ_INT(t, p_resp->body.error.info.other.status, status_forbidden, );
+        break;
+    case 3: // unblock
+        TEST_CASE_EQ_INT(t, p_resp->type, action_type_unblock, );
+        test_case(t, !db_is_blocked(p_test->db, p_test->cfg, USER_ID_MEMBER1, USER_ID_PRO1), "member1 is unblocked");
+        break;
+    default: test_fail(t, "wrong test->n_responses: %d", p_test->n_actions);
+    }
+}
+
+static errstatus_t transaction(db_t *db, cfg_t *cfg, void *ctx) {
+    test_t *p_tst = ctx;
+
+    db_use_test_data(db, cfg, test_data_users);
+
+    // Pro blocks member
+    {
+        json_object *jo_input = memlst_add(p_tst->p_mem, dtor_json_object,
+            load_jsonf(IN_JSONF(NAME, "_block"), API_KEY_PRO1 "¤pro1_mdp"));
+        json_object *jo_output = memlst_add(p_tst->p_mem, dtor_json_object,
+            tchatator413_interpret(jo_input, cfg, db, on_action, on_response, p_tst));
+
+        test_case_n_actions(p_tst, 1);
+        if (!test_output_json_file(p_tst, jo_output, OUT_JSON(NAME, "_block"))) return errstatus_tested;
+    }
+
+    // Member tries to send a message
+    {
+        json_object *jo_input = memlst_add(p_tst->p_mem, dtor_json_object,
+            load_jsonf(IN_JSONF(NAME, "_send"), API_KEY_MEMBER1 "¤member1_mdp"));
+        json_object *jo_output = memlst_add(p_tst->p_mem, dtor_json_object,
+            tchatator413_interpret(jo_input, cfg, db, on_action, on_response, p_tst));
+
+        test_case_n_actions(p_tst, 2);
+        test_output_json_file(p_tst, jo_output, OUT_JSON(NAME, "_send"));
+    }
+
+    // Pro unblocks member
+    {
+        json_object *jo_input = memlst_add(p_tst->p_mem, dtor_json_object,
+            load_jsonf(IN_JSONF(NAME, "_unblock"), API_KEY_PRO1 "¤pro1_mdp"));
+        json_object *jo_output = memlst_add(p_tst->p_mem, dtor_json_object,
+            tchatator413_interpret(jo_input, cfg, db, on_action, on_response, p_tst));
+
+        test_case_n_actions(p_tst, 3);
+        test_output_json_file(p_tst, jo_output, OUT_JSON(NAME, "_unblock"));
+    }
+
+    return errstatus_tested;
+}
+
+TEST_SIGNATURE(NAME) {
+    // - block: target by name, auth, target role, block index, block
+    // - send: recipient by name (member, then pro), auth, recipient role, refused by the block index
+    // - unblock: auth, target role, unblock
+    test_t tst = TEST_INIT(NAME, 5, 4, 3);
+
+    db_transaction(tst.db, tst.cfg, transaction, &tst);
+
+    return tst.t;
+}
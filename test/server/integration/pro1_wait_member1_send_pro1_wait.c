@@ -0,0 +1,117 @@
+/// @file
+/// @author Raphaël
+/// @brief Tchatator413 test
+///
+/// Tests that wait tells whether a message is unread right away
+/// - pro1 wait
+/// - member1 send
+/// - pro1 wait
+///
+/// @date 18/10/2026
+
+#include "../tests.h"
+#include "tchatator413/action.h"
+#include "tchatator413/tchatator413.h"
+
+#define NAME pro1_wait_member1_send_pro1_wait
+
+#define MSG_CONTENT "Bonjour du language C :)"
+
+static serial_t gs_msg_id;
+
+static void on_action(action_t const *action, void *t) {
+    test_t const *p_test = base_on_action(t);
+    switch (p_test->n_actions) {
+    case 1: // wait
+    case 3: // wait
+        if (!TEST_CASE_EQ_INT(t, action->type, action_type_wait, )) return;
+        TEST_CASE_EQ_UUID(t, action->with.wait.constr.api_key, API_KEY_PRO1_UUID, );
+        TEST_CASE_EQ_STR(t, action->with.wait.constr.password, "pro1_mdp", );
+        break;
+    case 2: // send
+        if (!TEST_CASE_EQ_INT(t, action->type, action_type_send, )) return;
+        TEST_CASE_EQ_UUID(t, action->with.send.constr.api_key, API_KEY_MEMBER1_UUID, );
+        TEST_CASE_EQ_STR(t, action->with.send.content.val, MSG_CONTENT, );
+        TEST_CASE_EQ_INT(t, action->with.send.dest_user_id, USER_ID_PRO1, );
+        break;
+    default: test_fail(t, "wrong test->n_actions: %d", p_test->n_actions);
+    }
+}
+
+static void on_response(response_t const *p_resp, void *t) {
+    test_t *p_test = base_on_response(t, p_resp);
+    test_case(t, !p_resp->has_next_page, "");
+    switch (p_test->n_responses) {
+    case 1: // wait, nothing unread
+        if (!TEST_CASE_EQ_INT(t, p_resp->type, action_type_wait, )) return;
+        test_case(t, !p_resp->body.wait.has_unread, "nothing unread");
+        TEST_CASE_EQ_INT(t, p_resp->body.wait.user_id, USER_ID_PRO1, );
+        break;
+    case 2: // send
+        if (!TEST_CASE_EQ_INT(t, p_resp->type, action_type_send, )) return;
+        gs_msg_id = p_resp->body.send.msg_id;
+        break;
+    case 3: // wait, a message is unread
+        if (!TEST_CASE_EQ_INT(t, p_resp->type, action_type_wait, )) return;
+        test_case(t, p_resp->body.wait.has_unread, "message %d is unread", gs_msg_id);
+        TEST_CASE_EQ_INT(t, p_resp->body.wait.user_id, USER_ID_PRO1, );
+        break;
+    default: test_fail(t, "wrong test->n_responses: %d", p_test->n_actions);
+    }
+}
+
+static errstatus_t transaction(db_t *db, cfg_t *cfg, void *ctx) {
+    test_t *p_tst = ctx;
+
+    db_use_test_data(db, cfg, test_data_users);
+
+    // Pro waits with nothing unread
+    {
+        json_object *jo_input = memlst_add(p_tst->p_mem, dtor_json_object,
+            load_jsonf(IN_JSONF(NAME, "_wait"), API_KEY_PRO1 "¤pro1_mdp"));
+        json_object *jo_output = memlst_add(p_tst->p_mem, dtor_json_object,
+            tchatator413_interpret(jo_input, cfg, db, on_action, on_response, p_tst));
+
+        test_case_n_actions(p_tst, 1);
+        if (!test_output_json_file(p_tst, jo_output, OUT_JSON(NAME, "_wait_none"))) return errstatus_tested;
+    }
+
+    // Member sends message
+    {
+        json_object *jo_input = memlst_add(p_tst->p_mem, dtor_json_object,
+            load_jsonf(IN_JSONF(NAME, "_send"), API_KEY_MEMBER1 "¤member1_mdp"));
+        json_object *jo_output = memlst_add(p_tst->p_mem, dtor_json_object,
+            tchatator413_interpret(jo_input, cfg, db, on_action, on_response, p_tst));
+
+        test_case_n_actions(p_tst, 2);
+
+        json_object *jo_expected_output = memlst_add(p_tst->p_mem, dtor_json_object,
+            load_jsonf(OUT_JSONF(NAME, "_send"), gs_msg_id));
+
+        if (!TEST_OUTPUT_JSON(&p_tst->t, jo_output, jo_expected_output)) return errstatus_tested;
+    }
+
+    // Pro waits again: the answer is immediate
+    {
+        json_object *jo_input = memlst_add(p_tst->p_mem, dtor_json_object,
+            load_jsonf(IN_JSONF(NAME, "_wait"), API_KEY_PRO1 "¤pro1_mdp"));
+        json_object *jo_output = memlst_add(p_tst->p_mem, dtor_json_object,
+            tchatator413_interpret(jo_input, cfg, db, on_action, on_response, p_tst));
+
+        test_case_n_actions(p_tst, 3);
+        test_output_json_file(p_tst, jo_output, OUT_JSON(NAME, "_wait_unread"));
+    }
+
+    return errstatus_tested;
+}
+
+TEST_SIGNATURE(NAME) {
+    // - wait: auth, unread lookup
+    // - send: recipient by name (member, then pro), auth, recipient role, block index, send_msg
+    // - wait: auth, unread lookup
+    test_t tst = TEST_INIT(NAME, 2, 6, 2);
+
+    db_transaction(tst.db, tst.cfg, transaction, &tst);
+
+    return tst.t;
+}
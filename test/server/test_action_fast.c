@@ -0,0 +1,188 @@
+/// @file
+/// @author Raphaël
+/// @brief Testing - Specialized request parser unit tests
+/// @date 18/10/2026
+
+#include "tchatator413/action.h"
+#include "tests.h"
+
+#define API_KEY "bb1b5a1f-a482-4858-8c6b-f4746481cffa"
+
+static bool constr_eq(constr_t a, constr_t b) {
+    return uuid4_eq(a.api_key, b.api_key) && streq_nullable(a.password, b.password);
+}
+
+static bool slice_eq(slice_t a, slice_t b) {
+    return a.len == b.len && memcmp(a.val, b.val, a.len) == 0;
+}
+
+static bool action_eq(action_t const *a, action_t const *b) {
+    if (a->type != b->type) return false;
+    switch (a->type) {
+    case action_type_error:
+        return a->with.error.type == b->with.error.type;
+    case action_type_whois:
+        return constr_eq(a->with.whois.constr, b->with.whois.constr) && a->with.whois.user_id == b->with.whois.user_id;
+    case action_type_send:
+        return constr_eq(a->with.send.constr, b->with.send.constr)
+            && a->with.send.dest_user_id == b->with.send.dest_user_id
+            && slice_eq(a->with.send.content, b->with.send.content);
+    case action_type_motd:
+        return constr_eq(a->with.motd.constr, b->with.motd.constr);
+    case action_type_inbox:
+    case action_type_outbox:
+        return constr_eq(a->with.inbox.constr, b->with.inbox.constr) && a->with.inbox.page == b->with.inbox.page;
+    case action_type_edit:
+        return constr_eq(a->with.edit.constr, b->with.edit.constr)
+            && a->with.edit.msg_id == b->with.edit.msg_id
+            && slice_eq(a->with.edit.new_content, b->with.edit.new_content);
+    case action_type_rm:
+        return constr_eq(a->with.rm.constr, b->with.rm.constr) && a->with.rm.msg_id == b->with.rm.msg_id;
+    case action_type_block:
+    case action_type_unblock:
+    case action_type_ban:
+    case action_type_unban:
+        return constr_eq(a->with.block.constr, b->with.block.constr) && a->with.block.user_id == b->with.block.user_id;
+    case action_type_stats:
+    case action_type_wait:
+        return constr_eq(a->with.stats.constr, b->with.stats.constr);
+    }
+    return false;
+}
+
+/// @brief Check that both parsers agree on a request.
+static bool parsers_agree(cfg_t *cfg, char const *request) {
+    memlst_t *mem = memlst_init();
+    json_object *jo = memlst_add(&mem, dtor_json_object, json_tokener_parse(request));
+    char *buf = memlst_add(&mem, free, strdup(request));
+
+    action_scan_t *scan = action_scan(&mem, buf, strlen(buf));
+    bool agree = jo && scan;
+    if (agree) {
+        bool const is_array = json_object_is_type(jo, json_type_array);
+        size_t const n = is_array ? json_object_array_length(jo) : 1;
+        agree = n == action_scan_count(scan);
+        for (size_t i = 0; agree && i < n; ++i) {
+            action_t slow = action_parse(&mem, cfg, NULL, is_array ? json_object_array_get_idx(jo, i) : jo);
+            action_t fast = action_parse_scanned(&mem, cfg, NULL, scan, i);
+            agree = action_eq(&slow, &fast);
+        }
+    }
+
+    memlst_destroy(&mem);
+    return agree;
+}
+
+/// @brief Check that the specialized parser leaves a request to json-c, without touching it.
+static bool gives_up(char const *request) {
+    memlst_t *mem = memlst_init();
+    char *buf = strdup(request);
+    bool const ok = !action_scan(&mem, buf, strlen(buf)) && streq(buf, request);
+    free(buf);
+    memlst_destroy(&mem);
+    return ok;
+}
+
+struct test test_action_fast(void) {
+    struct test t = test_start("action_fast");
+    cfg_t *cfg = cfg_defaults();
+
+#define AGREE(request) test_case(&t, parsers_agree(cfg, request), "agree: %s", request)
+    AGREE(R"({"do":"send","with":{"constr":")" API_KEY R"(","content":"Bonjour","dest":3}})");
+    AGREE(R"({"with":{"dest":3,"content":"Bonjour","constr":")" API_KEY R"("},"do":"send"})");
+    AGREE(R"( { "do" : "send" , "with" : { "constr" : ")" API_KEY R"(" , "content" : "" , "dest" : 2147483647 } } )"
+          "\r\n");
+    AGREE(R"({"do":"whois","with":{"constr":")" API_KEY "¤mot de passe" R"(","user":1}})");
+    AGREE(R"({"do":"whois","with":{"constr":")" API_KEY R"(¤","user":1}})");
+    AGREE(R"({"do":"whois","with":{"constr":")" API_KEY R"(x","user":1}})");
+    AGREE(R"({"do":"whois","with":{"constr":")" API_KEY R"(¤\"é","user":1}})");
+    AGREE(R"({"do":"send","with":{"constr":")" API_KEY R"(","content":"a\"b\\c\/d\b\f\n\r\té€😀 ok","dest":3}})");
+    AGREE(R"({"do":"send","with":{"constr":")" API_KEY R"(","content":"Crème brûlée 🍮","dest":3}})");
+    AGREE(R"([])");
+    AGREE(R"([{"do":"motd","with":{"constr":")" API_KEY R"("}},)"
+          R"({"do":"inbox","with":{"constr":")" API_KEY R"("}},)"
+          R"({"do":"outbox","with":{"constr":")" API_KEY R"(","page":2}},)"
+          R"({"do":"edit","with":{"constr":")" API_KEY R"(","msg_id":-5,"new_content":"à"}},)"
+          R"({"do":"rm","with":{"constr":")" API_KEY R"(","msg_id":0}},)"
+          R"({"do":"block","with":{"constr":")" API_KEY R"(","user":2}},)"
+          R"({"do":"unblock","with":{"constr":")" API_KEY R"(","user":2}},)"
+          R"({"do":"ban","with":{"constr":")" API_KEY R"(","user":2}},)"
+          R"({"do":"unban","with":{"constr":")" API_KEY R"(","user":2}}])");
+    AGREE(R"({"do":"wait","with":{"constr":")" API_KEY R"("}})");
+    // Arguments other actions use are ignored
+    AGREE(R"({"do":"motd","with":{"constr":")" API_KEY R"(","page":"x","user":-1}})");
+#undef AGREE
+
+#define GIVES_UP(request) test_case(&t, gives_up(request), "gives up: %s", request)
+    GIVES_UP("");
+    GIVES_UP("   ");
+    GIVES_UP("not json");
+    GIVES_UP("0");
+    GIVES_UP("[");
+    GIVES_UP("[1]");
+    GIVES_UP(R"({"do":"motd","with":{"constr":")" API_KEY R"("}})"
+             "garbage");
+    GIVES_UP(R"({"do":"motd","with":{"constr":")" API_KEY R"("}},)");
+    GIVES_UP(R"([{"do":"motd","with":{"constr":")" API_KEY R"("}},])");
+    GIVES_UP(R"([{"do":"motd","with":{"constr":")" API_KEY R"("}})");
+    GIVES_UP(R"({"do":"hello","with":{"constr":")" API_KEY R"("}})");
+    GIVES_UP(R"({"do":"motd"})");
+    GIVES_UP(R"({"with":{"constr":")" API_KEY R"("}})");
+    GIVES_UP(R"({"do":"motd","do":"motd","with":{"constr":")" API_KEY R"("}})");
+    GIVES_UP(R"({"do":"motd","with":{"constr":")" API_KEY R"("},"extra":1})");
+    GIVES_UP(R"({"do":"motd","with":{"constr":")" API_KEY R"(","extra":1}})");
+    GIVES_UP(R"({"do":"motd","with":{"constr":")" API_KEY R"(","constr":")" API_KEY R"("}})");
+    GIVES_UP(R"({"do":"motd","with":{"constr":"bb1b5a1f-a482-4858-8c6b-f4746481cffz"}})");
+    GIVES_UP(R"({"do":"motd","with":{"constr":"bb1b5a1f-a482-4858-8c6b-f4746481cff"}})");
+    GIVES_UP(R"({"do":"motd","with":{"constr":1}})");
+    GIVES_UP(R"({"do":"motd","with":{"constr":")" API_KEY "\t" R"("}})");
+    GIVES_UP(R"({"do":"motd","with":{"constr":")" API_KEY R"(\u0000"}})");
+    GIVES_UP(R"({"do":"motd","with":{"constr":")" API_KEY R"(\ud83d"}})");
+    GIVES_UP(R"({"do":"motd","with":{"constr":")" API_KEY R"(\ude00"}})");
+    GIVES_UP(R"({"do":"motd","with":{"constr":")" API_KEY R"(\u12"}})");
+    GIVES_UP(R"({"do":"motd","with":{"constr":")" API_KEY R"(\x"}})");
+    GIVES_UP(R"({"do":"motd","with":{"constr":")" API_KEY R"(})");
+    GIVES_UP(R"({"do":"whois","with":{"constr":")" API_KEY R"(","user":0}})");
+    GIVES_UP(R"({"do":"whois","with":{"constr":")" API_KEY R"(","user":01}})");
+    GIVES_UP(R"({"do":"whois","with":{"constr":")" API_KEY R"(","user":1.0}})");
+    GIVES_UP(R"({"do":"whois","with":{"constr":")" API_KEY R"(","user":1e3}})");
+    GIVES_UP(R"({"do":"whois","with":{"constr":")" API_KEY R"(","user":2147483648}})");
+    GIVES_UP(R"({"do":"whois","with":{"constr":")" API_KEY R"(","user":null}})");
+    GIVES_UP(R"({"do":"whois","with":{"constr":")" API_KEY R"(","user":true}})");
+    GIVES_UP(R"({"do":"whois","with":{"constr":")" API_KEY R"(","user":{}}})");
+    GIVES_UP(R"({"do":"whois","with":{"constr":")" API_KEY R"(","user":[1]}})");
+    GIVES_UP(R"({"do":"whois","with":{"constr":")" API_KEY R"("}})");
+    GIVES_UP(R"({"do":"inbox","with":{"constr":")" API_KEY R"(","page":0}})");
+    GIVES_UP(R"({"do":"inbox","with":{"constr":")" API_KEY R"(","page":"1"}})");
+    GIVES_UP(R"({"do":"send","with":{"constr":")" API_KEY R"(","content":1,"dest":3}})");
+    GIVES_UP(R"({"do":"edit","with":{"constr":")" API_KEY R"(","msg_id":"1","new_content":""}})");
+#undef GIVES_UP
+
+    // A user key too long to exist is refused without a database round-trip, by json-c.
+    {
+        char *request = strfmt(R"({"do":"whois","with":{"constr":")" API_KEY R"(","user":"%*s"}})", MAX(EMAIL_LENGTH, PSEUDO_LENGTH) + 1, "");
+        test_case(&t, gives_up(request), "gives up: user key too long");
+        free(request);
+    }
+
+    // Strings are decoded in place and point into the buffer
+    {
+        memlst_t *mem = memlst_init();
+        char buf[] = R"({"do":"send","with":{"constr":")" API_KEY R"(¤à b","content":"😀 \"x\"","dest":3}})";
+        action_scan_t *scan = action_scan(&mem, buf, sizeof buf - 1);
+        if (test_case(&t, scan && action_scan_count(scan) == 1, "scan")) {
+            action_t action = action_parse_scanned(&mem, cfg, NULL, scan, 0);
+            if (test_case(&t, action.type == action_type_send, "type")) {
+                slice_t content = action.with.send.content;
+                test_case(&t, content.val > buf && content.val < buf + sizeof buf, "content points into the buffer");
+                test_case(&t, content.len == strlen("😀 \"x\"") && streq(content.val, "😀 \"x\""), "content decoded");
+                TEST_CASE_EQ_STR(&t, action.with.send.constr.password, "à b", );
+                test_case(&t, action.with.send.dest_user_id == 3, "dest");
+            }
+        }
+        memlst_destroy(&mem);
+    }
+
+    cfg_destroy(cfg);
+    return t;
+}
@@ -0,0 +1,49 @@
+/// @file
+/// @author Raphaël
+/// @brief Testing - Action descriptions unit tests
+/// @date 18/10/2026
+
+#include "tchatator413/action.h"
+#include "tests.h"
+
+struct test test_action_schema(void) {
+    struct test t = test_start("action_schema");
+
+#define TEST_LOOKUP(name)                                                                           \
+    do {                                                                                            \
+        action_desc_t const *p_desc = action_desc_lookup(SLICE_CONST(STR(name)));                   \
+        test_case(&t, p_desc && p_desc->type == ACTION_TYPE(name), "lookup %s", STR(name));         \
+        test_case(&t, action_desc_of(ACTION_TYPE(name)) == p_desc, "description of %s", STR(name)); \
+    } while (0);
+    X_ACTIONS(TEST_LOOKUP)
+#undef TEST_LOOKUP
+
+#define TEST_UNKNOWN(name) test_case(&t, !action_desc_lookup(SLICE_CONST(name)), "lookup unknown %s", name)
+    TEST_UNKNOWN("");
+    TEST_UNKNOWN("w");
+    TEST_UNKNOWN("whoi");
+    TEST_UNKNOWN("whoiss");
+    TEST_UNKNOWN("WHOIS");
+    TEST_UNKNOWN("bans");
+    TEST_UNKNOWN("unbanned");
+    TEST_UNKNOWN("do");
+#undef TEST_UNKNOWN
+    // Only the length is looked at
+    test_case(&t, action_desc_lookup((slice_t) { .len = 2, .val = "rmdir" }) == action_desc_of(action_type_rm), "lookup slice");
+
+    action_desc_t const *p_send = action_desc_of(action_type_send);
+    if (test_case(&t, p_send->n_args == 3, "send has 3 arguments")) {
+        test_case(&t, p_send->args[0].key == arg_key_constr && p_send->args[0].kind == arg_kind_constr, "send constr");
+        test_case(&t, p_send->args[1].key == arg_key_content && p_send->args[1].kind == arg_kind_string, "send content");
+        test_case(&t, p_send->args[2].key == arg_key_dest && p_send->args[2].kind == arg_kind_user, "send dest");
+        TEST_CASE_EQ_STR(&t, p_send->args[2].location, "send.with.dest", );
+        test_case(&t, p_send->args[2].offset == offsetof(action_t, with.send.dest_user_id), "send dest offset");
+    }
+
+    action_desc_t const *p_inbox = action_desc_of(action_type_inbox);
+    if (test_case(&t, p_inbox->n_args == 2, "inbox has 2 arguments")) {
+        test_case(&t, p_inbox->args[1].kind == arg_kind_page && !p_inbox->args[1].required, "inbox page is optional");
+    }
+
+    return t;
+}
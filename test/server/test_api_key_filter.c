@@ -0,0 +1,44 @@
+/// @file
+/// @author Raphaël
+/// @brief Testing - API key filter unit tests
+/// @date 18/10/2026
+
+#include "tchatator413/api_key_filter.h"
+#include "tests.h"
+#include <stdlib.h>
+
+#define N_KEYS 1000
+#define N_PROBES 100000
+#define FP_RATE 0.01
+
+static uuid4_t random_key(void) {
+    uuid4_t key;
+    for (size_t i = 0; i < sizeof key.data; ++i) key.data[i] = (uint8_t)rand();
+    return key;
+}
+
+struct test test_api_key_filter(void) {
+    struct test t = test_start("api_key_filter");
+    srand(413);
+
+    test_case(&t, api_key_filter_init(N_KEYS, 0) == NULL, "fp_rate 0 disables the filter");
+    test_case(&t, api_key_filter_init(N_KEYS, 1) == NULL, "fp_rate 1 disables the filter");
+
+    api_key_filter_t *filter = api_key_filter_init(N_KEYS, FP_RATE);
+    if (!test_case(&t, filter, "filter created")) return t;
+
+    uuid4_t keys[N_KEYS];
+    for (size_t i = 0; i < N_KEYS; ++i) api_key_filter_add(filter, keys[i] = random_key());
+
+    size_t false_negatives = 0;
+    for (size_t i = 0; i < N_KEYS; ++i) false_negatives += !api_key_filter_may_contain(filter, keys[i]);
+    TEST_CASE_EQ_INT64(&t, false_negatives, 0, "no false negatives");
+
+    size_t false_positives = 0;
+    for (size_t i = 0; i < N_PROBES; ++i) false_positives += api_key_filter_may_contain(filter, random_key());
+    // Leave some slack for randomness
+    test_case(&t, false_positives < N_PROBES * FP_RATE * 2, "false positive rate %zu/%d close to %g", false_positives, N_PROBES, FP_RATE);
+
+    api_key_filter_destroy(filter);
+    return t;
+}
@@ -0,0 +1,45 @@
+/// @file
+/// @author Raphaël
+/// @brief Testing - Block index unit tests
+/// @date 18/10/2026
+
+#include "tchatator413/block_index.h"
+#include "tests.h"
+
+#define MEMBER 3
+#define PRO1 1
+#define PRO2 2
+
+struct test test_block_index(void) {
+    struct test t = test_start("block_index");
+    block_index_t *index = block_index_init();
+    time_t const now = 1000;
+
+    test_case(&t, !block_index_is_blocked(index, MEMBER, PRO1, now), "empty index blocks nobody");
+
+    // Single block
+    block_index_set(index, PRO1, MEMBER, now + 10);
+    TEST_CASE_EQ_INT64(&t, block_index_get(index, PRO1, MEMBER, now), now + 10, );
+    test_case(&t, block_index_is_blocked(index, MEMBER, PRO1, now), "blocked by pro1");
+    test_case(&t, !block_index_is_blocked(index, MEMBER, PRO2, now), "not blocked by pro2");
+    test_case(&t, !block_index_is_blocked(index, PRO1, MEMBER, now), "blocks are one-way");
+    test_case(&t, !block_index_is_blocked(index, MEMBER, PRO1, now + 10), "block expires");
+    TEST_CASE_EQ_INT64(&t, block_index_get(index, PRO1, MEMBER, now), 0, "expired block is forgotten");
+
+    // Ban
+    block_index_set(index, PRO2, MEMBER, BLOCK_FOREVER);
+    test_case(&t, block_index_is_blocked(index, MEMBER, PRO2, now + 1000000), "ban never expires");
+    block_index_unset(index, PRO2, MEMBER);
+    test_case(&t, !block_index_is_blocked(index, MEMBER, PRO2, now), "unbanned");
+
+    // Global block
+    block_index_set(index, BLOCK_SCOPE_GLOBAL, MEMBER, now + 10);
+    test_case(&t, block_index_is_blocked(index, MEMBER, PRO1, now), "globally blocked, to pro1");
+    test_case(&t, block_index_is_blocked(index, MEMBER, PRO2, now), "globally blocked, to pro2");
+
+    block_index_clear(index);
+    test_case(&t, !block_index_is_blocked(index, MEMBER, PRO1, now), "cleared");
+
+    block_index_destroy(index);
+    return t;
+}
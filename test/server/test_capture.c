@@ -0,0 +1,134 @@
+/// @file
+/// @author Raphaël
+/// @brief Testing - Request capture unit tests
+/// @date 18/10/2026
+
+#include "tchatator413/capture.h"
+#include "tests.h"
+#include <sys/stat.h>
+#include <unistd.h>
+
+#define KEY 0x0123456789abcdef
+
+#define NIL_UUID "00000000-0000-0000-0000-000000000000"
+
+/// @brief Pseudonymize a string literal.
+static size_t pseudonymize(char *buf, char const *request, uint64_t key) {
+    strcpy(buf, request);
+    size_t const len = capture_pseudonymize(buf, strlen(buf), key, API_KEY_PRO1_UUID);
+    buf[len] = '\0';
+    return len;
+}
+
+/// @brief Get the API key of the first constr of a pseudonymized request.
+static char const *constr_key(char const *buf) {
+    char const *delim = strstr(buf, "¤");
+    return delim && delim - buf >= UUID4_REPR_LENGTH ? delim - UUID4_REPR_LENGTH : NULL;
+}
+
+struct test test_capture(void) {
+    struct test t = test_start("capture");
+
+    // Pseudonymization
+    {
+        char a[256], b[256], c[256];
+        pseudonymize(a, "{\"do\":\"inbox\",\"with\":{\"constr\":\"" API_KEY_MEMBER1 "¤member1_mdp\"}}", KEY);
+        test_case(&t, !strstr(a, "member1_mdp"), "password removed: %s", a);
+        test_case(&t, !strstr(a, API_KEY_MEMBER1), "key replaced");
+        test_case(&t, strstr(a, "¤\"}}"), "rest of the request kept");
+        pseudonymize(b, "[{\"do\":\"motd\",\"with\":{\"constr\":\"" API_KEY_MEMBER1 "¤other\"}}]", KEY);
+        test_case(&t, constr_key(a) && constr_key(b) && !strncmp(constr_key(a), constr_key(b), UUID4_REPR_LENGTH), "same key, same pseudonym");
+        pseudonymize(c, "{\"do\":\"inbox\",\"with\":{\"constr\":\"" API_KEY_MEMBER1 "¤member1_mdp\"}}", KEY + 1);
+        test_case(&t, constr_key(c) && strncmp(constr_key(a), constr_key(c), UUID4_REPR_LENGTH), "other secret, other pseudonym");
+        api_key_t pseudonym;
+        test_case(&t, uuid4_parse(&pseudonym, constr_key(a)), "pseudonym is a UUID");
+
+        pseudonymize(a, "{\"constr\":\"" API_KEY_PRO1 "¤pro1_mdp\"}", KEY);
+        TEST_CASE_EQ_STR(&t, a, "{\"constr\":\"" NIL_UUID "¤\"}", "root is the nil UUID");
+
+        pseudonymize(a, "{\"constr\":\"" API_KEY_MEMBER1 "\\u00A4pa\\\"ss\\\\\",\"x\":1}", KEY);
+        test_case(&t, !strstr(a, "pa") && !strstr(a, "ss") && strstr(a, "¤\",\"x\":1}"), "escaped delimiter and password: %s", a);
+
+        pseudonymize(a, "{\"constr\":\"not a key¤secret\"}", KEY);
+        TEST_CASE_EQ_STR(&t, a, "{\"constr\":\"not a key¤\"}", "password removed after anything");
+
+        pseudonymize(a, "{\"content\":\"price: 5¤\"}", KEY);
+        TEST_CASE_EQ_STR(&t, a, "{\"content\":\"price: 5¤\"}", "nothing after the delimiter");
+
+        pseudonymize(a, "{\"constr\":\"" API_KEY_MEMBER1 "¤unterminated", KEY);
+        test_case(&t, !strstr(a, "unterminated"), "unterminated password removed");
+
+        pseudonymize(b, "{\"constr\":\"" API_KEY_MEMBER1 "\",\"x\":\"" API_KEY_MEMBER1 "¤\"}", KEY);
+        test_case(&t, !strstr(b, API_KEY_MEMBER1), "bare key replaced: %s", b);
+        test_case(&t, constr_key(b) && !strncmp(b + strlen("{\"constr\":\""), constr_key(b), UUID4_REPR_LENGTH), "bare key, same pseudonym");
+        pseudonymize(a, "{\"constr\":\"" API_KEY_PRO1 "\"}", KEY);
+        TEST_CASE_EQ_STR(&t, a, "{\"constr\":\"" NIL_UUID "\"}", "bare root key is the nil UUID");
+
+        char const plain[] = "{\"do\":\"whois\",\"with\":{\"user\":\"a\\\"b\"}}";
+        TEST_CASE_EQ_INT64(&t, (int64_t)pseudonymize(a, plain, KEY), (int64_t)strlen(plain), "no credentials, same length");
+        TEST_CASE_EQ_STR(&t, a, plain, "no credentials, unchanged");
+    }
+
+    // Write and read back
+    {
+        char capture_file[] = "/tmp/test_capture_XXXXXX";
+        int const fd = mkstemp(capture_file);
+        if (fd == -1) errno_exit("mkstemp");
+        close(fd);
+
+        capture_t *capture = capture_open(capture_file, 0, 0, log_overflow_block, API_KEY_PRO1_UUID);
+        if (test_case(&t, capture, "open")) {
+            capture_request(capture, "[]", 2);
+            char const req[] = "{\"constr\":\"" API_KEY_MEMBER1 "¤member1_mdp\"}";
+            capture_request(capture, req, sizeof req - 1);
+            capture_close(capture);
+        }
+        // Reopening appends a session
+        capture = capture_open(capture_file, 0, 0, log_overflow_block, API_KEY_PRO1_UUID);
+        capture_request(capture, "{}", 2);
+        capture_close(capture);
+
+        FILE *f = fopen(capture_file, "rb");
+        if (!f) errno_exit("fopen");
+        capture_record_t rec = { 0 };
+        test_case(&t, capture_read(f, &rec) && rec.len == 2 && !strcmp(rec.buf, "[]"), "first request");
+        int64_t const first_at_ns = rec.at_ns;
+        test_case(&t, capture_read(f, &rec) && rec.len && !strstr(rec.buf, "member1_mdp") && !strstr(rec.buf, API_KEY_MEMBER1), "second request, pseudonymized");
+        test_case(&t, rec.at_ns >= first_at_ns, "arrival times");
+        test_case(&t, capture_read(f, &rec) && rec.len == 2 && !strcmp(rec.buf, "{}"), "request of the second session");
+        test_case(&t, !capture_read(f, &rec) && feof(f), "end of file");
+        free(rec.buf);
+        fclose(f);
+        unlink(capture_file);
+    }
+
+    // Rotation
+    {
+        char capture_file[] = "/tmp/test_capture_XXXXXX";
+        int const fd = mkstemp(capture_file);
+        if (fd == -1) errno_exit("mkstemp");
+        close(fd);
+        char *rotated = strfmt("%s.1", capture_file);
+
+        capture_t *capture = capture_open(capture_file, 64, 0, log_overflow_block, API_KEY_PRO1_UUID);
+        char const req[] = "{\"do\":\"motd\",\"with\":{\"constr\":\"x\"}}";
+        for (int i = 0; i < 3; ++i) capture_request(capture, req, sizeof req - 1);
+        capture_close(capture);
+
+        struct stat st;
+        test_case(&t, !stat(rotated, &st), "rotated file exists");
+        FILE *f = fopen(rotated, "rb");
+        capture_record_t rec = { 0 };
+        int n = 0;
+        while (f && capture_read(f, &rec)) ++n;
+        TEST_CASE_EQ_INT64(&t, (int64_t)n, (int64_t)2, "rotated once the size is reached");
+        if (f) fclose(f);
+        free(rec.buf);
+
+        unlink(rotated);
+        unlink(capture_file);
+        free(rotated);
+    }
+
+    return t;
+}
@@ -0,0 +1,123 @@
+/// @file
+/// @author Raphaël
+/// @brief Testing - Binary event log unit tests
+/// @date 18/10/2026
+
+#include "tchatator413/evlog.h"
+#include "tests.h"
+#include <arpa/inet.h>
+#include <time.h>
+#include <unistd.h>
+
+/// @brief Read a whole file.
+static char *read_file(char const *filename, size_t *out_len) {
+    FILE *f = fopen(filename, "rb");
+    if (!f) errno_exit("fopen");
+    fseek(f, 0, SEEK_END);
+    *out_len = (size_t)ftell(f);
+    rewind(f);
+    char *buf = malloc(*out_len);
+    if (!buf) errno_exit("malloc");
+    if (fread(buf, 1, *out_len, f) != *out_len) errno_exit("fread");
+    fclose(f);
+    return buf;
+}
+
+/// @brief A cursor over an event log.
+typedef struct {
+    char const *p, *end;
+} cursor_t;
+
+static bool take(cursor_t *c, void *out, size_t n) {
+    if ((size_t)(c->end - c->p) < n) return false;
+    memcpy(out, c->p, n);
+    c->p += n;
+    return true;
+}
+
+/// @brief Skip a session header, checking it describes @p n_events events.
+static bool skip_header(cursor_t *c, uint8_t n_events) {
+    char magic[7];
+    uint8_t version, n, len, n_fields, code;
+    if (!take(c, magic, sizeof magic) || memcmp(magic, "\xffT413EV", sizeof magic)
+        || !take(c, &version, 1) || version != 1
+        || !take(c, &n, 1) || n != n_events) return false;
+    for (int i = 0; i < n; ++i) {
+        if (!take(c, &len, 1) || (size_t)(c->end - c->p) < len) return false;
+        c->p += len;
+        if (!take(c, &n_fields, 1)) return false;
+        for (int j = 0; j < n_fields; ++j) {
+            if (!take(c, &code, 1) || !take(c, &len, 1) || (size_t)(c->end - c->p) < len) return false;
+            c->p += len;
+        }
+    }
+    return true;
+}
+
+/// @brief Read the header of a record.
+static bool record(cursor_t *c, uint8_t *out_id, uint16_t *out_len, int64_t *out_ts_ns) {
+    return take(c, out_id, 1) && take(c, out_len, 2) && take(c, out_ts_ns, 8) && (size_t)(c->end - c->p) >= *out_len;
+}
+
+#define N_EVENTS (0 X_EVLOG_EVENTS(+1 IGNORE, ))
+#define IGNORE(...)
+
+struct test test_evlog(void) {
+    struct test t = test_start("evlog");
+
+    char filename[] = "/tmp/test_evlog_XXXXXX";
+    int const fd = mkstemp(filename);
+    if (fd == -1) errno_exit("mkstemp");
+    close(fd);
+
+    int64_t const before_ns = (int64_t)time(NULL) * 1000000000;
+
+    // Two sessions, as when the server restarts
+    for (int session = 0; session < 2; ++session) {
+        evlog_t *evlog = evlog_open(filename, 0, log_overflow_block);
+        if (!test_case(&t, evlog, "open")) continue;
+        evlog_conn_accepted(evlog, &(evlog_conn_accepted_t) { .addr = htonl(0x7f000001), .port = 51234, .fd = 5 });
+        evlog_db_query(evlog, &(evlog_db_query_t) { .fn = "db_get_inbox", .duration_ns = 123456, .status = 2, .n_tuples = -1 });
+        char long_fn[300];
+        memset(long_fn, 'x', sizeof long_fn - 1);
+        long_fn[sizeof long_fn - 1] = '\0';
+        evlog_db_query(evlog, &(evlog_db_query_t) { .fn = long_fn });
+        evlog_close(evlog);
+    }
+    evlog_conn_accepted(NULL, &(evlog_conn_accepted_t) { 0 });
+
+    size_t len;
+    char *buf = read_file(filename, &len);
+    cursor_t c = { .p = buf, .end = buf + len };
+    for (int session = 0; session < 2; ++session) {
+        test_case(&t, skip_header(&c, N_EVENTS), "session %d: header", session);
+
+        uint8_t id;
+        uint16_t fields_len;
+        int64_t ts_ns;
+        if (test_case(&t, record(&c, &id, &fields_len, &ts_ns) && id == evlog_event_conn_accepted && fields_len == 4 + 2 + 4, "conn_accepted")) {
+            uint32_t addr;
+            uint16_t port;
+            int32_t fd_accepted;
+            take(&c, &addr, 4), take(&c, &port, 2), take(&c, &fd_accepted, 4);
+            test_case(&t, ntohl(addr) == 0x7f000001 && port == 51234 && fd_accepted == 5, "conn_accepted: fields");
+            test_case(&t, ts_ns >= before_ns && ts_ns < before_ns + 60 * 1000000000LL, "conn_accepted: timestamp");
+        }
+        if (test_case(&t, record(&c, &id, &fields_len, &ts_ns) && id == evlog_event_db_query && fields_len == 1 + 12 + 8 + 1 + 4, "db_query")) {
+            uint8_t fn_len, status;
+            char fn[12];
+            int64_t duration_ns;
+            int32_t n_tuples;
+            take(&c, &fn_len, 1), take(&c, fn, sizeof fn), take(&c, &duration_ns, 8), take(&c, &status, 1), take(&c, &n_tuples, 4);
+            test_case(&t, fn_len == 12 && !memcmp(fn, "db_get_inbox", 12) && duration_ns == 123456 && status == 2 && n_tuples == -1, "db_query: fields");
+        }
+        if (test_case(&t, record(&c, &id, &fields_len, &ts_ns) && id == evlog_event_db_query && fields_len == 1 + 255 + 8 + 1 + 4, "long string truncated")) {
+            c.p += fields_len;
+        }
+    }
+    test_case(&t, c.p == c.end, "nothing else");
+
+    free(buf);
+    unlink(filename);
+    return t;
+}
@@ -0,0 +1,117 @@
+/// @file
+/// @author Raphaël
+/// @brief Testing - Inbox cache unit tests
+/// @date 18/10/2026
+
+#include "tchatator413/inbox_cache.h"
+#include "tests.h"
+
+#define RING_SIZE 3
+
+static msg_t msg_of(serial_t id, serial_t recipient_id, char *content) {
+    return (msg_t) {
+        .id = id,
+        .content = content,
+        .sent_at = id,
+        .user_id_sender = 1,
+        .user_id_recipient = recipient_id,
+    };
+}
+
+/// @brief Test that a cached inbox holds exactly the given message IDs, newest first.
+static void test_case_inbox(struct test *p_test, inbox_cache_t *cache, memlst_t **p_mem, serial_t recipient_id, size_t n, serial_t const *ids) {
+    msg_list_t msgs;
+    if (!test_case(p_test, inbox_cache_get(cache, p_mem, recipient_id, &msgs), "inbox of %d is cached", recipient_id)) return;
+    if (!TEST_CASE_EQ_INT64(p_test, msgs.n_msgs, n, "n_msgs")) return;
+    for (size_t i = 0; i < n; ++i) {
+        TEST_CASE_EQ_INT(p_test, msgs.msgs[i].id, ids[i], "msg id");
+    }
+}
+
+struct test test_inbox_cache(void) {
+    struct test t = test_start("inbox_cache");
+    memlst_t *mem = memlst_init();
+    msg_list_t msgs;
+
+    test_case(&t, inbox_cache_init(0, RING_SIZE) == NULL, "0 recipients disables the cache");
+    test_case(&t, !inbox_cache_get(NULL, &mem, 1, &msgs), "disabled cache always misses");
+
+    inbox_cache_t *cache = inbox_cache_init(2, RING_SIZE);
+    TEST_CASE_EQ_INT(&t, inbox_cache_ring_size(cache), RING_SIZE, );
+
+    test_case(&t, !inbox_cache_get(cache, &mem, 10, &msgs), "empty cache misses");
+
+    // Pushing to an uncached recipient does nothing
+    msg_t msg = msg_of(100, 10, "hello");
+    inbox_cache_push(cache, &msg);
+    test_case(&t, !inbox_cache_get(cache, &mem, 10, &msgs), "push doesn't create rings");
+
+    // Exhaustive ring: the recipient has 2 messages
+    msg_t inbox10[] = { msg_of(2, 10, "b"), msg_of(1, 10, "a") };
+    inbox_cache_fill(cache, 10, (msg_list_t) { .n_msgs = array_len(inbox10), .msgs = inbox10 });
+    test_case_inbox(&t, cache, &mem, 10, 2, (serial_t[]) { 2, 1 });
+
+    msg = msg_of(3, 10, "c");
+    inbox_cache_push(cache, &msg);
+    test_case_inbox(&t, cache, &mem, 10, 3, (serial_t[]) { 3, 2, 1 });
+
+    msg = msg_of(4, 10, "d");
+    inbox_cache_push(cache, &msg);
+    test_case_inbox(&t, cache, &mem, 10, 3, (serial_t[]) { 4, 3, 2 });
+
+    inbox_cache_edit(cache, 10, 3, "c edited", 42);
+    inbox_cache_edit(cache, 11, 4, "d edited", 43);
+    {
+        msg_list_t edited;
+        if (inbox_cache_get(cache, &mem, 10, &edited)) {
+            TEST_CASE_EQ_STR(&t, edited.msgs[1].content, "c edited", );
+            TEST_CASE_EQ_INT(&t, edited.msgs[1].edited_age, 42, );
+            TEST_CASE_EQ_STR(&t, edited.msgs[0].content, "d", "other recipient");
+        }
+    }
+
+    inbox_cache_read(cache, 10, (msg_list_t) { .msgs = (msg_t[]) { { .id = 2, .read_age = 7 }, { .id = 4, .read_age = 8 } }, .n_msgs = 2 });
+    inbox_cache_read(cache, 11, (msg_list_t) { .msgs = (msg_t[]) { { .id = 3, .read_age = 9 } }, .n_msgs = 1 });
+    {
+        msg_list_t read;
+        if (inbox_cache_get(cache, &mem, 10, &read)) {
+            TEST_CASE_EQ_INT(&t, read.msgs[0].read_age, 8, );
+            TEST_CASE_EQ_INT(&t, read.msgs[1].read_age, 0, "other recipient");
+            TEST_CASE_EQ_INT(&t, read.msgs[2].read_age, 7, );
+        }
+    }
+
+    // The ring isn't exhaustive anymore (message 1 was pushed out): removing drops it
+    inbox_cache_rm(cache, 11, 3);
+    test_case_inbox(&t, cache, &mem, 10, 3, (serial_t[]) { 4, 3, 2 });
+    inbox_cache_rm(cache, 10, 3);
+    test_case(&t, !inbox_cache_get(cache, &mem, 10, &msgs), "rm from a full ring drops it");
+
+    // Removing from an exhaustive ring keeps it
+    inbox_cache_fill(cache, 10, (msg_list_t) { .n_msgs = array_len(inbox10), .msgs = inbox10 });
+    inbox_cache_rm(cache, 10, 2);
+    test_case_inbox(&t, cache, &mem, 10, 1, (serial_t[]) { 1 });
+
+    // LRU eviction: 10 is used more recently than 20, so 20 goes first
+    msg_t inbox20[] = { msg_of(5, 20, "e") }, inbox30[] = { msg_of(6, 30, "f") };
+    inbox_cache_fill(cache, 20, (msg_list_t) { .n_msgs = array_len(inbox20), .msgs = inbox20 });
+    test_case_inbox(&t, cache, &mem, 10, 1, (serial_t[]) { 1 });
+    inbox_cache_fill(cache, 30, (msg_list_t) { .n_msgs = array_len(inbox30), .msgs = inbox30 });
+    test_case(&t, !inbox_cache_get(cache, &mem, 20, &msgs), "least recently used is evicted");
+    test_case_inbox(&t, cache, &mem, 10, 1, (serial_t[]) { 1 });
+    test_case_inbox(&t, cache, &mem, 30, 1, (serial_t[]) { 6 });
+
+    inbox_cache_invalidate(cache, 30);
+    test_case(&t, !inbox_cache_get(cache, &mem, 30, &msgs), "invalidated");
+    test_case_inbox(&t, cache, &mem, 10, 1, (serial_t[]) { 1 });
+    inbox_cache_invalidate(cache, 40);
+    inbox_cache_invalidate(NULL, 10);
+
+    inbox_cache_clear(cache);
+    test_case(&t, !inbox_cache_get(cache, &mem, 10, &msgs), "cleared");
+
+    inbox_cache_destroy(cache);
+    memlst_destroy(&mem);
+
+    return t;
+}
@@ -0,0 +1,91 @@
+/// @file
+/// @author Raphaël
+/// @brief Testing - JSON fragment cache unit tests
+/// @date 18/10/2026
+
+#include "tchatator413/json_cache.h"
+#include "tests.h"
+
+static json_object *build_msg(msg_t const *p_msg) {
+    json_object *jo = json_object_new_object();
+    json_object_object_add(jo, "msg_id", json_object_new_int(p_msg->id));
+    json_object_object_add(jo, "content", json_object_new_string(p_msg->content));
+    return jo;
+}
+
+struct test test_json_cache(void) {
+    struct test t = test_start("json_cache");
+
+    msg_t msg = { .id = 7, .content = "Bonjour / \"à\" vous", .sent_at = 1000 };
+    user_t user = { .id = 3, .role = role_member, .member.user_name = "member1" };
+
+    test_case(&t, !json_cache_get_msg(&msg), "disabled cache always misses");
+    json_object *jo = build_msg(&msg);
+    json_cache_put_msg(&msg, jo); // no-op
+    json_object_put(jo);
+    test_case(&t, !json_cache_get_msg(&msg), "disabled cache doesn't store");
+
+    json_cache_init(4);
+
+    // Messages
+    test_case(&t, !json_cache_get_msg(&msg), "empty cache misses");
+    jo = build_msg(&msg);
+    char *expected = strdup(min_json(jo));
+    json_cache_put_msg(&msg, jo);
+    json_object_put(jo);
+
+    jo = json_cache_get_msg(&msg);
+    if (test_case(&t, jo, "hit")) {
+        TEST_CASE_EQ_STR(&t, min_json(jo), expected, "cached fragment");
+        // Nested, and with other flags
+        json_object *jo_array = json_object_new_array();
+        json_object_array_add(jo_array, jo);
+        json_object *jo_copy = build_msg(&msg);
+        test_case(&t, json_object_equal(jo_array, jo_array) && json_object_equal(json_object_array_get_idx(jo_array, 0), jo_copy), "cached object is still a regular object");
+        json_object_put(jo_copy);
+        char *nested = strfmt("[%s]", expected);
+        TEST_CASE_EQ_STR(&t, json_object_to_json_string_ext(jo_array, JSON_C_TO_STRING_PLAIN), nested, "nested fragment");
+        free(nested);
+        json_object_put(jo_array);
+    }
+
+    msg_t edited = msg;
+    edited.edited_age = 5;
+    test_case(&t, !json_cache_get_msg(&edited), "edited message misses");
+    edited = msg;
+    edited.content = "Bonjour / \"à\" toi";
+    test_case(&t, !json_cache_get_msg(&edited), "changed content misses");
+    msg_t other = msg;
+    other.id = msg.id + 4; // same slot
+    test_case(&t, !json_cache_get_msg(&other), "other message in the same slot misses");
+
+    // Fragments
+    size_t len;
+    char const *fragment = json_cache_get_msg_fragment(&msg, &len);
+    test_case(&t, fragment && len == strlen(expected) && !memcmp(fragment, expected, len), "fragment of a cached object");
+    test_case(&t, !json_cache_get_msg_fragment(&edited, &len), "edited message fragment misses");
+    json_cache_put_msg_fragment(&other, "{}", 2);
+    test_case(&t, (fragment = json_cache_get_msg_fragment(&other, &len)) && len == 2 && !memcmp(fragment, "{}", 2), "fragment hit");
+    test_case(&t, !json_cache_get_msg(&other), "no object for a fragment");
+    test_case(&t, !json_cache_get_msg_fragment(&msg, &len), "replaced message misses");
+
+    // Users
+    test_case(&t, !json_cache_get_user(&user), "user misses");
+    jo = json_object_new_object();
+    json_cache_put_user(&user, jo);
+    json_object_put(jo);
+    if (test_case(&t, jo = json_cache_get_user(&user), "user hit")) json_object_put(jo);
+    user_t renamed = user;
+    renamed.member.user_name = "member2";
+    test_case(&t, !json_cache_get_user(&renamed), "renamed user misses");
+    test_case(&t, (fragment = json_cache_get_user_fragment(&user, &len)) && len == 2, "user fragment of a cached object");
+    json_cache_put_user_fragment(&renamed, "{\"x\":1}", 7);
+    test_case(&t, json_cache_get_user_fragment(&renamed, &len) && len == 7, "user fragment hit");
+    test_case(&t, !json_cache_get_user(&renamed), "no object for a user fragment");
+
+    json_cache_destroy();
+    test_case(&t, !json_cache_get_msg(&msg), "destroyed cache misses");
+
+    free(expected);
+    return t;
+}
@@ -0,0 +1,185 @@
+/// @file
+/// @author Raphaël
+/// @brief Testing - Streaming JSON writer unit tests
+/// @date 18/10/2026
+
+#include "tchatator413/json_cache.h"
+#include "tchatator413/json_writer.h"
+#include "tchatator413/tchatator413.h"
+#include "tests.h"
+#include <inttypes.h>
+
+/// @brief Check that the writer formats an integer like json-c.
+static bool int_agrees(int64_t value) {
+    json_object *jo = json_object_new_int64(value);
+    json_writer_t writer = JSON_WRITER_INIT;
+    json_writer_int(&writer, value);
+    bool const ok = streq(json_writer_str(&writer), min_json(jo));
+    json_writer_destroy(&writer);
+    json_object_put(jo);
+    return ok;
+}
+
+/// @brief Check that the writer escapes a string like json-c.
+static bool string_agrees(char const *s) {
+    json_object *jo = json_object_new_string(s);
+    json_writer_t writer = JSON_WRITER_INIT;
+    json_writer_string(&writer, s);
+    bool const ok = streq(json_writer_str(&writer), min_json(jo));
+    json_writer_destroy(&writer);
+    json_object_put(jo);
+    return ok;
+}
+
+/// @brief Check that the reference implementation escapes a string like json-c.
+static bool scalar_agrees(char const *s) {
+    json_object *jo = json_object_new_string(s);
+    json_writer_t writer = JSON_WRITER_INIT;
+    json_writer_char(&writer, '"');
+    json_writer_escaped_scalar(&writer, s, strlen(s));
+    json_writer_char(&writer, '"');
+    bool const ok = streq(json_writer_str(&writer), min_json(jo));
+    json_writer_destroy(&writer);
+    json_object_put(jo);
+    return ok;
+}
+
+/// @brief Check that both facade entry points give the same response to a request that needs no database.
+static bool facade_agrees(cfg_t *cfg, char const *request) {
+    json_object *jo_input = json_tokener_parse(request);
+    json_object *jo_output = tchatator413_interpret(jo_input, cfg, NULL, NULL, NULL, NULL);
+
+    json_writer_t writer = JSON_WRITER_INIT;
+    memlst_t *mem = memlst_init();
+    char *buf = strdup(request);
+    tchatator413_interpret_str(&writer, &mem, buf, strlen(buf), cfg, NULL, NULL, NULL, NULL);
+    memlst_destroy(&mem);
+    bool const ok = streq(json_writer_str(&writer), min_json(jo_output));
+
+    free(buf);
+    json_writer_destroy(&writer);
+    json_object_put(jo_output);
+    json_object_put(jo_input);
+    return ok;
+}
+
+struct test test_json_writer(void) {
+    struct test t = test_start("json_writer");
+
+    // Integers
+    int64_t const ints[] = { 0, 1, 9, 10, 99, 100, 101, -1, -10, -100, 12345, INT32_MAX, INT32_MIN, INT64_MAX, INT64_MIN, INT64_MIN + 1 };
+    for (size_t i = 0; i < array_len(ints); ++i) {
+        test_case(&t, int_agrees(ints[i]), "int %" PRId64, ints[i]);
+    }
+
+    // Strings: every byte but NUL, alone and surrounded
+    for (int c = 1; c < 256; ++c) {
+        char s[] = { (char)c, '\0' }, surrounded[] = { 'a', (char)c, 'b', '\0' };
+        test_case(&t, string_agrees(s) && string_agrees(surrounded), "byte 0x%02x", c);
+    }
+    // Every byte but NUL, at every position of strings spanning several vectors
+    {
+        char s[41];
+        int n_mismatches = 0;
+        for (int pos = 0; pos < 40; ++pos) {
+            for (int c = 1; c < 256; ++c) {
+                memset(s, 'x', 40);
+                s[40] = '\0';
+                s[pos] = (char)c;
+                n_mismatches += !string_agrees(s) + !scalar_agrees(s);
+            }
+        }
+        test_case(&t, !n_mismatches, "long strings (%d mismatches)", n_mismatches);
+    }
+    test_case(&t, string_agrees("\"\"\"\"\"\"\"\"\"\"\"\"\"\"\"\"\"\"\"\""), "only escapes");
+    test_case(&t, string_agrees(""), "empty string");
+    test_case(&t, string_agrees("Crème brûlée 🍮, \"à\" emporter / 20€\r\n"), "mixed string");
+
+    // Reused buffer
+    {
+        json_writer_t writer = JSON_WRITER_INIT;
+        for (int i = 0; i < 1000; ++i) json_writer_lit(&writer, "0123456789");
+        test_case(&t, writer.len == 10000 && strlen(json_writer_str(&writer)) == 10000, "growth");
+        json_writer_reset(&writer);
+        json_writer_lit(&writer, "[]");
+        TEST_CASE_EQ_STR(&t, json_writer_str(&writer), "[]", "reset");
+        json_writer_destroy(&writer);
+    }
+
+    // Responses
+    json_object *jo_actual = json_object_new_string("a/\"b\"");
+    json_object *jo_bad = json_object_new_array();
+    json_object_array_add(jo_bad, json_object_new_int(0));
+    json_object_array_add(jo_bad, json_object_new_string("x"));
+
+    response_t const errors[] = {
+        { .type = action_type_error, .body.error = { .type = action_error_type_type, .info.type = { .location = "with.user", .expected = json_type_int, .jo_actual = jo_actual } } },
+        { .type = action_type_error, .body.error = { .type = action_error_type_type, .info.type = { .location = "request", .expected = json_type_object, .jo_actual = NULL } } },
+        { .type = action_type_error, .body.error = { .type = action_error_type_missing_key, .info.missing_key = { .location = "with.constr" } } },
+        { .type = action_type_error, .body.error = { .type = action_error_type_invalid, .info.invalid = { .location = "with.page", .reason = "invalid page number", .jo_bad = jo_bad } } },
+        { .type = action_type_error, .body.error = { .type = action_error_type_other, .info.other = { .status = status_forbidden } } },
+        { .type = action_type_error, .body.error = { .type = action_error_type_invariant, .info.invariant = { .name = "no_send_self" } } },
+        response_for_rate_limit(1760000000),
+    };
+    for (size_t i = 0; i < array_len(errors); ++i) {
+        test_case_response_write(&t, &errors[i]);
+    }
+
+    test_case_response_write(&t, &(response_t) { .type = action_type_whois, .body.whois.user = { .id = 1, .role = role_admin } });
+    test_case_response_write(&t, &(response_t) { .type = action_type_whois, .body.whois.user = { .id = 2, .role = role_member, .member.user_name = "Jean \"JJ\"" } });
+    test_case_response_write(&t, &(response_t) { .type = action_type_whois, .body.whois.user = { .id = 3, .role = role_pro, .pro.business_name = "L'Épicerie / Café ☕" } });
+    test_case_response_write(&t, &(response_t) { .type = action_type_send, .body.send.msg_id = 42 });
+    test_case_response_write(&t, &(response_t) { .type = action_type_motd });
+    test_case_response_write(&t, &(response_t) { .type = action_type_rm });
+    test_case_response_write(&t, &(response_t) { .type = action_type_outbox, .has_next_page = true });
+    test_case_response_write(&t, &(response_t) { .type = action_type_inbox });
+    test_case_response_write(&t, &(response_t) { .type = action_type_wait, .body.wait = { .has_unread = true, .user_id = 3 } });
+    test_case_response_write(&t, &(response_t) { .type = action_type_wait });
+
+    msg_t msgs[] = {
+        { .id = 1, .sent_at = 1760000000, .content = "Bonjour \\o/ 😀", .user_id_sender = 2, .user_id_recipient = 3 },
+        { .id = 2, .sent_at = -1, .content = "\ttab\x01\x1f\x7f", .user_id_sender = 3, .user_id_recipient = 2, .read_age = 5 },
+        { .id = 3, .sent_at = 0, .content = "", .user_id_sender = 3, .user_id_recipient = 2, .deleted_age = 1, .read_age = 2, .edited_age = 3 },
+    };
+    test_case_response_write(&t, &(response_t) { .type = action_type_inbox, .body.inbox = { .msgs = msgs, .n_msgs = array_len(msgs) } });
+    test_case_response_write(&t, &(response_t) { .type = action_type_inbox, .has_next_page = true, .body.inbox = { .msgs = msgs, .n_msgs = 1 } });
+    test_case_response_write(&t, &(response_t) { .type = action_type_motd, .body.motd = { .msgs = msgs, .n_msgs = 2 } });
+    test_case_response_write(&t, &(response_t) { .type = action_type_motd, .has_next_page = true, .body.motd = { .msgs = msgs, .n_msgs = array_len(msgs) } });
+
+    // Cached fragments are copied as-is
+    json_cache_init(4);
+    for (int i = 0; i < 2; ++i) {
+        test_case_response_write(&t, &(response_t) { .type = action_type_inbox, .body.inbox = { .msgs = msgs, .n_msgs = array_len(msgs) } });
+        test_case_response_write(&t, &(response_t) { .type = action_type_whois, .body.whois.user = { .id = 2, .role = role_member, .member.user_name = "Jean \"JJ\"" } });
+    }
+    // The writer fills the cache on its own
+    {
+        msg_t streamed = { .id = 9, .content = "streamed", .user_id_sender = 2, .user_id_recipient = 3 };
+        json_writer_t writer = JSON_WRITER_INIT;
+        response_write(&writer, &(response_t) { .type = action_type_inbox, .body.inbox = { .msgs = &streamed, .n_msgs = 1 } });
+        size_t len;
+        char const *fragment = json_cache_get_msg_fragment(&streamed, &len);
+        char const *written = json_writer_str(&writer);
+        test_case(&t, fragment && strstr(written, "{\"msg_id\":9,") && !memcmp(strstr(written, "{\"msg_id\":9,"), fragment, len), "streamed message is cached");
+        json_writer_destroy(&writer);
+    }
+    json_cache_destroy();
+
+    json_object_put(jo_bad);
+    json_object_put(jo_actual);
+
+    // Whole requests
+    cfg_t *cfg = cfg_defaults();
+#define AGREE(request) test_case(&t, facade_agrees(cfg, request), "facade: %s", request)
+    AGREE("");
+    AGREE("not json");
+    AGREE("\"hello\"");
+    AGREE("[]");
+    AGREE("{}");
+    AGREE(R"([1,{},{"do":"hello"},{"do":"motd"},{"do":"motd","with":{"constr":1}}])");
+    AGREE(R"({"do":"inbox","with":{"constr":"bb1b5a1f-a482-4858-8c6b-f4746481cffa","page":0}})");
+#undef AGREE
+    cfg_destroy(cfg);
+
+    return t;
+}
@@ -0,0 +1,170 @@
+/// @file
+/// @author Raphaël
+/// @brief Testing - Asynchronous logger unit tests
+/// @date 18/10/2026
+
+#include "tchatator413/logger.h"
+#include "tests.h"
+#include <pthread.h>
+#include <unistd.h>
+
+#define N_THREADS 4
+#define N_ENTRIES 1000
+
+ATTR_FORMAT(printf, 2, 3)
+static void put_info(logger_t *logger, char const *fmt, ...) {
+    va_list ap;
+    va_start(ap, fmt);
+    logger_vlog(logger, "test.c", 42, "info: ", fmt, ap);
+    va_end(ap);
+}
+
+/// @brief Read everything written to a file so far.
+static char *contents(FILE *f) {
+    int const fd = fileno(f);
+    off_t const size = lseek(fd, 0, SEEK_END);
+    char *buf = malloc((size_t)size + 1);
+    if (!buf) errno_exit("malloc");
+    buf[pread(fd, buf, (size_t)size, 0)] = '\0';
+    return buf;
+}
+
+static size_t count_lines(char const *s) {
+    size_t n = 0;
+    while ((s = strchr(s, '\n'))) ++n, ++s;
+    return n;
+}
+
+typedef struct {
+    logger_t *logger;
+    int thread;
+} producer_t;
+
+static void *produce(void *arg) {
+    producer_t const *p = arg;
+    for (int i = 0; i < N_ENTRIES; ++i) put_info(p->logger, "thread %d entry %d\n", p->thread, i);
+    return NULL;
+}
+
+/// @brief Check that every thread's entries are there, whole and in order.
+static bool all_in_order(char const *s) {
+    int next[N_THREADS] = { 0 };
+    for (char const *line = s; *line; line = strchr(line, '\n') + 1) {
+        int thread, entry;
+        char const *msg = strstr(line, "info: ");
+        if (!msg || sscanf(msg, "info: thread %d entry %d\n", &thread, &entry) != 2
+            || thread < 0 || thread >= N_THREADS || entry != next[thread]++) return false;
+    }
+    for (int i = 0; i < N_THREADS; ++i) {
+        if (next[i] != N_ENTRIES) return false;
+    }
+    return true;
+}
+
+struct test test_logger(void) {
+    struct test t = test_start("logger");
+
+    // Format
+    {
+        FILE *f = tmpfile();
+        logger_t *logger = logger_start(fileno(f), 4096, log_overflow_drop, NULL);
+        put_info(logger, "hello %d\n", 7);
+        logger_flush(logger);
+        char *s = contents(f);
+        int year, month, day, hour, minute, second, n = 0;
+        test_case(&t, sscanf(s, "%4d-%2d-%2d %2d:%2d:%2d:%n", &year, &month, &day, &hour, &minute, &second, &n) == 6 && n == 20, "timestamp: %s", s);
+        TEST_CASE_EQ_STR(&t, s + MIN((size_t)n, strlen(s)), "test.c:42: info: hello 7\n", "entry");
+        free(s);
+        logger_stop(logger);
+        fclose(f);
+    }
+
+    // Several threads, with rings small enough to fill up
+    {
+        FILE *f = tmpfile();
+        logger_t *logger = logger_start(fileno(f), 256, log_overflow_block, NULL);
+        pthread_t threads[N_THREADS];
+        producer_t producers[N_THREADS];
+        for (int i = 0; i < N_THREADS; ++i) {
+            producers[i] = (producer_t) { .logger = logger, .thread = i };
+            pthread_create(&threads[i], NULL, produce, &producers[i]);
+        }
+        for (int i = 0; i < N_THREADS; ++i) pthread_join(threads[i], NULL);
+        logger_stop(logger);
+        char *s = contents(f);
+        test_case(&t, all_in_order(s), "block: %zu entries", count_lines(s));
+        free(s);
+        fclose(f);
+    }
+
+    // Dropped entries are counted and reported
+    {
+        FILE *f = tmpfile();
+        logger_t *logger = logger_start(fileno(f), 64, log_overflow_drop, NULL);
+        for (int i = 0; i < N_ENTRIES; ++i) put_info(logger, "entry %d\n", i);
+        size_t const n_dropped = logger_dropped(logger);
+        logger_stop(logger);
+        char *s = contents(f);
+        size_t n_reports = 0, n_reported = 0;
+        for (char const *r = s; (r = strstr(r, "logger: ")); ++r) {
+            size_t n;
+            if (sscanf(r, "logger: %zu entries dropped\n", &n) == 1) ++n_reports, n_reported += n;
+        }
+        test_case(&t, n_dropped > 0, "drop: %zu dropped", n_dropped);
+        test_case(&t, n_reported == n_dropped, "drop: %zu reported", n_reported);
+        test_case(&t, count_lines(s) - n_reports + n_dropped == N_ENTRIES, "drop: nothing lost silently");
+        free(s);
+        fclose(f);
+    }
+
+    // Long entries are truncated, and still end lines
+    {
+        FILE *f = tmpfile();
+        logger_t *logger = logger_start(fileno(f), 1 << 16, log_overflow_drop, NULL);
+        put_info(logger, "%*s\n", 10000, "");
+        put_info(logger, "after\n");
+        logger_stop(logger);
+        char *s = contents(f);
+        char const *nl = strchr(s, '\n');
+        test_case(&t, nl && nl - s == 4094, "truncated to %td bytes", nl ? nl - s + 1 : 0);
+        test_case(&t, count_lines(s) == 2 && strstr(s, "info: after\n"), "next entry intact");
+        free(s);
+        fclose(f);
+    }
+
+    // A thread switching between loggers keeps one ring in each
+    {
+        FILE *f1 = tmpfile(), *f2 = tmpfile();
+        logger_t *logger1 = logger_start(fileno(f1), 4096, log_overflow_block, NULL);
+        logger_t *logger2 = logger_start(fileno(f2), 4096, log_overflow_block, NULL);
+        for (int i = 0; i < 200; ++i) {
+            put_info(logger1, "entry %d\n", i);
+            put_info(logger2, "entry %d\n", i);
+        }
+        test_case(&t, logger_rings(logger1) == 1 && logger_rings(logger2) == 1, "interleaved: %zu and %zu rings", logger_rings(logger1), logger_rings(logger2));
+        logger_stop(logger1);
+        logger_stop(logger2);
+        char *s1 = contents(f1), *s2 = contents(f2);
+        char const *last1 = strstr(s1, "entry 199\n"), *last2 = strstr(s2, "entry 199\n");
+        test_case(&t, last1 && !last1[strlen("entry 199\n")] && count_lines(s1) == 200, "interleaved: first logger in order");
+        test_case(&t, last2 && !last2[strlen("entry 199\n")] && count_lines(s2) == 200, "interleaved: second logger in order");
+        free(s1);
+        free(s2);
+        fclose(f1);
+        fclose(f2);
+    }
+
+    // Raw writes
+    {
+        FILE *f = tmpfile();
+        logger_t *logger = logger_start(fileno(f), 0, log_overflow_block, NULL);
+        for (char const *c = "abc\n"; *c; ++c) logger_write(logger, c, 1);
+        logger_stop(logger);
+        char *s = contents(f);
+        TEST_CASE_EQ_STR(&t, s, "abc\n", "raw");
+        free(s);
+        fclose(f);
+    }
+
+    return t;
+}
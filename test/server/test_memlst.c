@@ -6,6 +6,8 @@
 #include "memlst.h"
 #include "tests.h"
 #include <fcntl.h>
+#include <stdalign.h>
+#include <stdint.h>
 #include <signal.h>
 #include <sys/wait.h>
 #include <unistd.h>
@@ -89,5 +91,33 @@ struct test test_memlst(void) {
     TEST_CASE_EQ_INT(&p_test, gs_ncalls_testfree, 3, );
     test_case(&p_test, gs_last_freed_ptr == ptr || gs_last_freed_ptr == ptr1, "");
 
+    // Arena
+    memlst = memlst_init();
+    char *a = memlst_alloc(&memlst, 1), *b = memlst_alloc(&memlst, 3);
+    test_case(&p_test, (uintptr_t)a % alignof(max_align_t) == 0 && (uintptr_t)b % alignof(max_align_t) == 0, "arena allocations are aligned");
+    test_case(&p_test, a != b, "arena allocations are distinct");
+    char *big = memlst_alloc(&memlst, 1 << 20);
+    memset(big, 0xab, 1 << 20);
+    char *s = memlst_strndup(&memlst, "Crème brûlée", 6);
+    TEST_CASE_EQ_STR(&p_test, s, "Crème", "strndup");
+    TEST_CASE_EQ_STR(&p_test, memlst_strdup(&memlst, "brûlée"), "brûlée", "strdup");
+
+    // Collecting keeps the arena: the same allocations get the same memory back
+    memlst_collect(&memlst);
+    test_case(&p_test, memlst_alloc(&memlst, 1) == a && memlst_alloc(&memlst, 3) == b && memlst_alloc(&memlst, 1 << 20) == big, "arena reused after collect");
+
+    // Rewinding only frees what came after the mark
+    gs_ncalls_testfree = 0;
+    memlst_add(&memlst, testfree, malloc(1));
+    memlst_mark_t const mark = memlst_mark(memlst);
+    char *after = memlst_alloc(&memlst, 8);
+    memlst_add(&memlst, testfree, ptr = malloc(1));
+    memlst_rewind(&memlst, mark);
+    TEST_CASE_EQ_INT(&p_test, gs_ncalls_testfree, 1, "rewind");
+    test_case(&p_test, gs_last_freed_ptr == ptr, "rewind frees what came after the mark");
+    test_case(&p_test, memlst_alloc(&memlst, 8) == after, "arena reused after rewind");
+    memlst_destroy(&memlst);
+    TEST_CASE_EQ_INT(&p_test, gs_ncalls_testfree, 2, "destroy after rewind");
+
     return p_test;
 }
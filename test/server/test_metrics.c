@@ -0,0 +1,148 @@
+/// @file
+/// @author Raphaël
+/// @brief Testing - Metrics registry unit tests
+/// @date 18/10/2026
+
+#include "tchatator413/metrics.h"
+#include "tests.h"
+#include <pthread.h>
+
+#define N_THREADS 4
+#define N_RECORDS 10000
+
+static void *record(void *arg) {
+    (void)arg;
+    for (uint64_t i = 1; i <= N_RECORDS; ++i) {
+        metrics_record(metrics_stage_db, i);
+        metrics_record_query(metrics_query_inbox, i, 2);
+        metrics_count_action(action_type_send);
+        metrics_count_round_trips(action_type_send, i % 5);
+    }
+    return NULL;
+}
+
+/// @brief Subtract a snapshot from another, histogram buckets and counters only.
+static void subtract(metrics_snapshot_t *p_after, metrics_snapshot_t const *p_before) {
+    for (size_t i = 0; i < metrics_n_action_types; ++i) {
+        p_after->n_actions[i] -= p_before->n_actions[i];
+        p_after->n_round_trips[i] -= p_before->n_round_trips[i];
+    }
+    for (size_t i = 0; i < metrics_n_statuses; ++i) p_after->n_statuses[i] -= p_before->n_statuses[i];
+    for (size_t s = 0; s < metrics_n_stages; ++s) {
+        p_after->latency[s].count -= p_before->latency[s].count;
+        p_after->latency[s].sum_ns -= p_before->latency[s].sum_ns;
+        for (size_t b = 0; b < METRICS_N_BUCKETS; ++b) p_after->latency[s].buckets[b] -= p_before->latency[s].buckets[b];
+    }
+    for (size_t i = 0; i < metrics_n_queries; ++i) {
+        p_after->queries[i].n_calls -= p_before->queries[i].n_calls;
+        p_after->queries[i].sum_ns -= p_before->queries[i].sum_ns;
+        p_after->queries[i].n_rows -= p_before->queries[i].n_rows;
+    }
+    p_after->n_turnstile_rejections -= p_before->n_turnstile_rejections;
+    p_after->n_bytes_in -= p_before->n_bytes_in;
+    p_after->n_bytes_out -= p_before->n_bytes_out;
+}
+
+struct test test_metrics(void) {
+    struct test t = test_start("metrics");
+
+    // Statement names
+    {
+        test_case(&t, streq(metrics_query_name(metrics_query_user_by_api_key), "user_by_api_key"), "query name");
+        test_case(&t, streq(metrics_query_name(metrics_n_queries - 1), "test_data"), "last query name");
+    }
+
+    // Buckets
+    {
+        bool exact = true, fits = true, tight = true, monotonic = true;
+        for (uint64_t v = 0; v < 1 << METRICS_SUB_BUCKET_BITS; ++v) exact &= metrics_bucket_of(v) == v && metrics_bucket_max(v) == v;
+        size_t prev = 0;
+        for (uint64_t v = 1; v && v < UINT64_MAX / 3; v = v * 3 + 1) {
+            size_t const b = metrics_bucket_of(v);
+            fits &= b < METRICS_N_BUCKETS && metrics_bucket_max(b) >= v && (b == 0 || metrics_bucket_max(b - 1) < v);
+            tight &= metrics_bucket_max(b) - v <= v / 16;
+            monotonic &= b >= prev;
+            prev = b;
+        }
+        test_case(&t, exact, "small values are exact");
+        test_case(&t, fits, "values fall in their bucket");
+        test_case(&t, tight, "buckets are within 1/16th of their values");
+        test_case(&t, monotonic, "buckets are ordered");
+        test_case(&t, metrics_bucket_of(UINT64_MAX) == METRICS_N_BUCKETS - 1, "largest value in last bucket");
+        test_case(&t, metrics_bucket_max(METRICS_N_BUCKETS - 1) == UINT64_MAX, "last bucket ends at largest value");
+    }
+
+    // Quantiles
+    {
+        metrics_histogram_t h = { 0 };
+        test_case(&t, metrics_quantile(&h, .5) == 0, "empty quantile");
+        for (uint64_t v = 1; v <= 1000; ++v) {
+            ++h.buckets[metrics_bucket_of(v * 1000)];
+            ++h.count;
+            h.max_ns = v * 1000;
+        }
+        uint64_t const p50 = metrics_quantile(&h, .5), p99 = metrics_quantile(&h, .99), p100 = metrics_quantile(&h, 1);
+        test_case(&t, p50 >= 500000 && p50 <= 500000 + 500000 / 16, "p50 == %lu", p50);
+        test_case(&t, p99 >= 990000 && p99 <= 990000 + 990000 / 16, "p99 == %lu", p99);
+        test_case(&t, p100 == 1000000, "p100 capped to max == %lu", p100);
+    }
+
+    // Shards are summed
+    {
+        metrics_snapshot_t *before = malloc(sizeof *before), *after = malloc(sizeof *after);
+        if (!before || !after) errno_exit("malloc");
+        metrics_snapshot(before);
+
+        pthread_t threads[N_THREADS];
+        for (int i = 0; i < N_THREADS; ++i) pthread_create(&threads[i], NULL, record, NULL);
+        for (int i = 0; i < N_THREADS; ++i) pthread_join(threads[i], NULL);
+        metrics_count_status(status_ok);
+        metrics_count_status(status_forbidden);
+        metrics_count_turnstile_rejection();
+        metrics_count_bytes(100, 2000);
+
+        metrics_snapshot(after);
+        subtract(after, before);
+
+        metrics_histogram_t const *h = &after->latency[metrics_stage_db];
+        TEST_CASE_EQ_INT64(&t, h->count, (uint64_t)N_THREADS * N_RECORDS, "db count");
+        TEST_CASE_EQ_INT64(&t, h->sum_ns, (uint64_t)N_THREADS * N_RECORDS * (N_RECORDS + 1) / 2, "db sum");
+        test_case(&t, h->max_ns >= N_RECORDS, "db max == %lu", h->max_ns);
+        metrics_query_stats_t const *q = &after->queries[metrics_query_inbox];
+        TEST_CASE_EQ_INT64(&t, q->n_calls, (uint64_t)N_THREADS * N_RECORDS, "inbox query calls");
+        TEST_CASE_EQ_INT64(&t, q->sum_ns, (uint64_t)N_THREADS * N_RECORDS * (N_RECORDS + 1) / 2, "inbox query sum");
+        TEST_CASE_EQ_INT64(&t, q->max_ns, (uint64_t)N_RECORDS, "inbox query max");
+        TEST_CASE_EQ_INT64(&t, q->n_rows, (uint64_t)N_THREADS * N_RECORDS * 2, "inbox query rows");
+        TEST_CASE_EQ_INT64(&t, after->queries[metrics_query_send_msg].n_calls, (uint64_t)0, "other queries untouched");
+        TEST_CASE_EQ_INT64(&t, after->n_actions[action_type_send], (uint64_t)N_THREADS * N_RECORDS, "send actions");
+        TEST_CASE_EQ_INT64(&t, after->n_round_trips[action_type_send], (uint64_t)N_THREADS * N_RECORDS / 5 * (0 + 1 + 2 + 3 + 4), "send round-trips");
+        TEST_CASE_EQ_INT64(&t, after->max_round_trips[action_type_send], (uint64_t)4, "send round-trips max");
+        TEST_CASE_EQ_INT64(&t, after->n_statuses[0], (uint64_t)1, "status 200");
+        TEST_CASE_EQ_INT64(&t, after->n_statuses[3], (uint64_t)1, "status 403");
+        TEST_CASE_EQ_INT64(&t, after->n_turnstile_rejections, (uint64_t)1, "turnstile rejections");
+        TEST_CASE_EQ_INT64(&t, after->n_bytes_in, (uint64_t)100, "bytes in");
+        TEST_CASE_EQ_INT64(&t, after->n_bytes_out, (uint64_t)2000, "bytes out");
+
+        free(before);
+        free(after);
+    }
+
+    // The stats action, as root: no database needed
+    {
+        memlst_t *mem = memlst_init();
+        cfg_t *cfg = memlst_add(&mem, (dtor_fn)cfg_destroy, cfg_defaults());
+        constr_t root = { .api_key = API_KEY_PRO1_UUID, .password = "root" };
+        cfg_load_root_credentials(cfg, root.api_key, root.password);
+
+        action_t action = { .type = action_type_stats, .with.stats.constr = root };
+        response_t response = action_evaluate(&action, &mem, cfg, NULL);
+        if (test_case(&t, response.type == action_type_stats && response.body.stats, "root gets stats")) {
+            test_case(&t, response.body.stats->latency[metrics_stage_db].count >= N_THREADS * N_RECORDS, "stats hold the registry");
+            test_case_response_write(&t, &response);
+        }
+
+        memlst_destroy(&mem);
+    }
+
+    return t;
+}
@@ -0,0 +1,132 @@
+/// @file
+/// @author Raphaël
+/// @brief Testing - Prometheus metrics listener unit tests
+/// @date 18/10/2026
+
+#include "tchatator413/metrics_http.h"
+#include "tests.h"
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+/// @brief Send a request to a Unix socket and read the whole response.
+static char *scrape(char const *socket_path, char const *request) {
+    int const fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (fd == -1) errno_exit("socket");
+    struct sockaddr_un addr = { .sun_family = AF_UNIX };
+    strcpy(addr.sun_path, socket_path);
+    if (connect(fd, (struct sockaddr *)&addr, sizeof addr)) {
+        close(fd);
+        return NULL;
+    }
+    write(fd, request, strlen(request));
+
+    size_t cap = 4096, len = 0;
+    char *buf = malloc(cap);
+    if (!buf) errno_exit("malloc");
+    ssize_t n;
+    while ((n = read(fd, buf + len, cap - len - 1)) > 0) {
+        if ((len += (size_t)n) + 1 == cap && !(buf = realloc(buf, cap *= 2))) errno_exit("realloc");
+    }
+    buf[len] = '\0';
+    close(fd);
+    return buf;
+}
+
+/// @brief Get the value of a sample.
+static bool sample(char const *text, char const *series, uint64_t *out_value) {
+    size_t const len = strlen(series);
+    for (char const *line = text; line; line = strchr(line, '\n'), line = line ? line + 1 : NULL) {
+        if (!strncmp(line, series, len) && line[len] == ' ') return sscanf(line + len + 1, "%lu", out_value) == 1;
+    }
+    return false;
+}
+
+struct test test_metrics_http(void) {
+    struct test t = test_start("metrics_http");
+
+    // Format
+    {
+        metrics_snapshot_t *snapshot = calloc(1, sizeof *snapshot);
+        if (!snapshot) errno_exit("calloc");
+        snapshot->n_actions[action_type_inbox] = 7;
+        snapshot->n_statuses[0] = 5;
+        metrics_histogram_t *h = &snapshot->latency[metrics_stage_db];
+        uint64_t const values[] = { 500, 900, 40000, 2000000, 20000000000 };
+        for (size_t i = 0; i < array_len(values); ++i) {
+            ++h->buckets[metrics_bucket_of(values[i])];
+            ++h->count;
+            h->sum_ns += values[i];
+            h->max_ns = MAX(h->max_ns, values[i]);
+        }
+        snapshot->n_bytes_out = 1234;
+        snapshot->queries[metrics_query_inbox] = (metrics_query_stats_t) { .n_calls = 3, .sum_ns = 1500000000, .max_ns = 1000000000, .n_rows = 42 };
+        snapshot->n_round_trips[action_type_send] = 9;
+        snapshot->max_round_trips[action_type_send] = 4;
+
+        size_t len;
+        char *text = metrics_format_prometheus(snapshot, 1700000000, &len);
+        uint64_t v;
+        test_case(&t, strlen(text) == len, "length");
+        test_case(&t, sample(text, "tchatator_actions_total{action=\"inbox\"}", &v) && v == 7, "action counter");
+        test_case(&t, sample(text, "tchatator_actions_total{action=\"stats\"}", &v) && v == 0, "zero counter");
+        test_case(&t, sample(text, "tchatator_responses_total{status=\"200\"}", &v) && v == 5, "status counter");
+        test_case(&t, sample(text, "tchatator_stage_duration_seconds_bucket{stage=\"db\",le=\"1e-06\"}", &v) && v == 2, "1µs bucket");
+        test_case(&t, sample(text, "tchatator_stage_duration_seconds_bucket{stage=\"db\",le=\"5e-05\"}", &v) && v == 3, "50µs bucket");
+        test_case(&t, sample(text, "tchatator_stage_duration_seconds_bucket{stage=\"db\",le=\"10\"}", &v) && v == 4, "10s bucket");
+        test_case(&t, sample(text, "tchatator_stage_duration_seconds_bucket{stage=\"db\",le=\"+Inf\"}", &v) && v == 5, "+Inf bucket");
+        test_case(&t, sample(text, "tchatator_stage_duration_seconds_count{stage=\"db\"}", &v) && v == 5, "count");
+        test_case(&t, strstr(text, "tchatator_stage_duration_seconds_sum{stage=\"db\"} 20.002041400\n"), "sum");
+        test_case(&t, strstr(text, "tchatator_stage_duration_max_seconds{stage=\"db\"} 20.000000000\n"), "max");
+        test_case(&t, sample(text, "tchatator_db_query_calls_total{query=\"inbox\"}", &v) && v == 3, "query calls");
+        test_case(&t, sample(text, "tchatator_db_query_calls_total{query=\"begin\"}", &v) && v == 0, "query never run");
+        test_case(&t, sample(text, "tchatator_db_query_rows_total{query=\"inbox\"}", &v) && v == 42, "query rows");
+        test_case(&t, strstr(text, "tchatator_db_query_duration_seconds_total{query=\"inbox\"} 1.500000000\n"), "query duration");
+        test_case(&t, strstr(text, "tchatator_db_query_duration_max_seconds{query=\"inbox\"} 1.000000000\n"), "query max");
+        test_case(&t, sample(text, "tchatator_db_round_trips_total{action=\"send\"}", &v) && v == 9, "round-trips");
+        test_case(&t, sample(text, "tchatator_db_round_trips_max{action=\"send\"}", &v) && v == 4, "round-trips max");
+        test_case(&t, sample(text, "tchatator_db_round_trips_total{action=\"error\"}", &v) && v == 0, "round-trips of errors");
+        test_case(&t, sample(text, "tchatator_sent_bytes_total", &v) && v == 1234, "bytes");
+        test_case(&t, sample(text, "tchatator_start_time_seconds", &v) && v == 1700000000, "start time");
+        test_case(&t, strstr(text, "# TYPE tchatator_stage_duration_seconds histogram\n"), "histogram type");
+        free(text);
+        free(snapshot);
+    }
+
+    // Listener
+    {
+        cfg_t *cfg = cfg_defaults();
+        char socket_path[] = "/tmp/test_metrics_http_XXXXXX";
+        int const fd = mkstemp(socket_path);
+        if (fd == -1) errno_exit("mkstemp");
+        close(fd);
+
+        metrics_http_t *mh = metrics_http_start(cfg, 0, socket_path);
+        if (test_case(&t, mh, "start, replacing a stale file")) {
+            metrics_count_action(action_type_whois);
+
+            char *rep = scrape(socket_path, "GET /metrics HTTP/1.1\r\nHost: localhost\r\n\r\n");
+            test_case(&t, rep && !strncmp(rep, "HTTP/1.0 200 OK\r\n", 17), "GET /metrics: 200");
+            char const *body = rep ? strstr(rep, "\r\n\r\n") : NULL;
+            uint64_t v;
+            test_case(&t, body && sample(body + 4, "tchatator_actions_total{action=\"whois\"}", &v) && v >= 1, "GET /metrics: live registry");
+            free(rep);
+
+            rep = scrape(socket_path, "GET /nope HTTP/1.1\r\n\r\n");
+            test_case(&t, rep && !strncmp(rep, "HTTP/1.0 404 Not Found\r\n", 24), "GET /nope: 404");
+            free(rep);
+
+            rep = scrape(socket_path, "POST /metrics HTTP/1.1\r\n\r\n");
+            test_case(&t, rep && !strncmp(rep, "HTTP/1.0 405 Method Not Allowed\r\n", 33), "POST: 405");
+            free(rep);
+
+            metrics_http_stop(mh);
+            struct stat st;
+            test_case(&t, stat(socket_path, &st) == -1, "socket removed on stop");
+        }
+        cfg_destroy(cfg);
+    }
+
+    return t;
+}
@@ -0,0 +1,72 @@
+/// @file
+/// @author Raphaël
+/// @brief Testing - Sampling CPU profiler unit tests
+/// @date 18/10/2026
+
+#include "tchatator413/profiler.h"
+#include "tests.h"
+#include <errno.h>
+#include <time.h>
+
+#define HZ 1000
+#define BURN_MS 200
+
+/// @brief Spend some CPU time.
+static uint64_t burn(void) {
+    struct timespec start, now;
+    clock_gettime(CLOCK_THREAD_CPUTIME_ID, &start);
+    volatile uint64_t x = 0;
+    do {
+        for (int i = 0; i < 100000; ++i) x = x * 6364136223846793005u + 1;
+        clock_gettime(CLOCK_THREAD_CPUTIME_ID, &now);
+    } while ((now.tv_sec - start.tv_sec) * 1000 + (now.tv_nsec - start.tv_nsec) / 1000000 < BURN_MS);
+    return x;
+}
+
+struct test test_profiler(void) {
+    struct test t = test_start("profiler");
+
+    // Samples are written as collapsed stacks
+    {
+        profiler_t *profiler = profiler_start(HZ, HZ);
+        if (!test_case(&t, profiler, "start")) return t;
+        errno = 0;
+        test_case(&t, !profiler_start(HZ, HZ) && errno == EBUSY, "one profiler at a time");
+        burn();
+
+        char *text;
+        size_t len, n_lost;
+        FILE *f = open_memstream(&text, &len);
+        if (!f) errno_exit("open_memstream");
+        size_t const n_samples = profiler_stop(profiler, f, &n_lost);
+        fclose(f);
+
+        // A 10% margin: CPU-time timers fire on scheduler ticks.
+        test_case(&t, n_samples >= HZ * BURN_MS / 1000 / 10 * 9 / 10 && n_samples <= HZ, "samples == %zu", n_samples);
+        TEST_CASE_EQ_INT64(&t, (int64_t)n_lost, (int64_t)0, "lost");
+
+        size_t total = 0;
+        bool well_formed = true;
+        for (char *line = strtok(text, "\n"); line; line = strtok(NULL, "\n")) {
+            char const *count = strrchr(line, ' ');
+            well_formed &= count && count > line && count[1] >= '1' && count[1] <= '9';
+            if (count) total += strtoull(count + 1, NULL, 10);
+        }
+        test_case(&t, well_formed, "lines are a stack and a count");
+        TEST_CASE_EQ_INT64(&t, (int64_t)total, (int64_t)n_samples, "counts add up to the samples");
+        free(text);
+    }
+
+    // Samples past the buffer are lost, not written
+    {
+        profiler_t *profiler = profiler_start(HZ, 2);
+        if (!test_case(&t, profiler, "restart")) return t;
+        burn();
+        size_t n_lost;
+        size_t const n_samples = profiler_stop(profiler, NULL, &n_lost);
+        TEST_CASE_EQ_INT64(&t, (int64_t)n_samples, (int64_t)0, "discarded profile");
+        test_case(&t, n_lost > 0, "lost == %zu", n_lost);
+    }
+
+    return t;
+}
@@ -0,0 +1,153 @@
+/// @file
+/// @author Raphaël
+/// @brief Testing - Request tracing unit tests
+/// @date 18/10/2026
+
+#include "tchatator413/tchatator413.h"
+#include "tchatator413/trace.h"
+#include "tests.h"
+#include <unistd.h>
+
+#define ROOT_PASSWORD "root"
+
+/// @brief Read a whole file.
+static char *slurp(char const *filename) {
+    FILE *f = fopen(filename, "r");
+    if (!f) errno_exit("fopen");
+    size_t cap = 4096, len = 0;
+    char *buf = malloc(cap);
+    if (!buf) errno_exit("malloc");
+    size_t n;
+    while ((n = fread(buf + len, 1, cap - len - 1, f)) > 0) {
+        if ((len += n) + 1 == cap && !(buf = realloc(buf, cap *= 2))) errno_exit("realloc");
+    }
+    buf[len] = '\0';
+    fclose(f);
+    return buf;
+}
+
+/// @brief Make a temporary file name.
+static void temp_file(char name[static sizeof "/tmp/test_trace_XXXXXX"]) {
+    strcpy(name, "/tmp/test_trace_XXXXXX");
+    int const fd = mkstemp(name);
+    if (fd == -1) errno_exit("mkstemp");
+    close(fd);
+}
+
+struct test test_trace(void) {
+    struct test t = test_start("trace");
+
+    // Spans past the maximum are counted
+    {
+        char trace_file[sizeof "/tmp/test_trace_XXXXXX"];
+        temp_file(trace_file);
+        tracer_t *tracer = tracer_open(trace_file, UINT64_MAX, 0, log_overflow_block);
+        trace_t trace;
+        test_case(&t, !trace_clock(), "no clock read outside of a trace");
+        trace_span("ignored", NULL, 0);
+        trace_begin(tracer, &trace);
+        test_case(&t, trace_clock(), "clock read in a trace");
+        for (int i = 0; i < TRACE_MAX_SPANS + 6; ++i) trace_span("span", NULL, trace_clock());
+        TEST_CASE_EQ_INT64(&t, (int64_t)trace.n_spans, (int64_t)TRACE_MAX_SPANS, "spans recorded");
+        TEST_CASE_EQ_INT64(&t, (int64_t)trace.n_dropped, (int64_t)6, "spans dropped");
+        trace_end(tracer);
+        test_case(&t, !tl_trace, "trace ended");
+        tracer_close(tracer);
+
+        char *text = slurp(trace_file);
+        test_case(&t, !*text, "fast requests are not written");
+        free(text);
+        unlink(trace_file);
+    }
+
+    // The trace id is echoed by the streaming writer
+    {
+        char trace_file[sizeof "/tmp/test_trace_XXXXXX"];
+        temp_file(trace_file);
+        tracer_t *tracer = tracer_open(trace_file, UINT64_MAX, 0, log_overflow_block);
+        cfg_t *cfg = cfg_defaults();
+        memlst_t *mem = memlst_init();
+        json_writer_t writer = JSON_WRITER_INIT;
+        char request[] = "[{\"do\":\"stats\",\"with\":{\"constr\":\"not a key\"}},{\"do\":\"nope\"}]";
+
+        trace_t trace;
+        trace_begin(tracer, &trace);
+        tchatator413_interpret_str(&writer, &mem, request, sizeof request - 1, cfg, NULL, NULL, NULL, NULL);
+        char id[TRACE_ID_REPR_LENGTH + 1];
+        trace_id_repr(trace.id, id);
+        trace_end(tracer);
+
+        json_object *jo_output = json_tokener_parse(json_writer_str(&writer));
+        json_object *jo_trace_id;
+        bool all_echoed = json_object_array_length(jo_output) == 2;
+        for (size_t i = 0; i < json_object_array_length(jo_output); ++i) {
+            all_echoed &= json_object_object_get_ex(json_object_array_get_idx(jo_output, i), "trace_id", &jo_trace_id)
+                       && streq(json_object_get_string(jo_trace_id), id);
+        }
+        test_case(&t, all_echoed, "every response carries the trace id: %s", json_writer_str(&writer));
+
+        json_object_put(jo_output);
+        json_writer_destroy(&writer);
+        memlst_destroy(&mem);
+        cfg_destroy(cfg);
+        tracer_close(tracer);
+        unlink(trace_file);
+    }
+
+    // A traced request, end to end
+    {
+        char cfg_file[sizeof "/tmp/test_trace_XXXXXX"], trace_file[sizeof "/tmp/test_trace_XXXXXX"];
+        temp_file(cfg_file);
+        temp_file(trace_file);
+        FILE *f = fopen(cfg_file, "w");
+        if (!f) errno_exit("fopen");
+        fprintf(f, "{\"trace_file\":\"%s\",\"trace_threshold_ms\":0,\"log_buffer_size\":0}", trace_file);
+        fclose(f);
+
+        cfg_t *cfg = cfg_defaults();
+        cfg_load_from_file(cfg, cfg_file);
+        cfg_load_root_credentials(cfg, API_KEY_PRO1_UUID, ROOT_PASSWORD);
+        cfg_log_start(cfg);
+        test_case(&t, cfg_tracer(cfg), "tracer opened from the configuration");
+
+        json_object *jo_input = json_tokener_parse("{\"do\":\"stats\",\"with\":{\"constr\":\"" API_KEY_PRO1 "¤" ROOT_PASSWORD "\"}}");
+        json_object *jo_output = tchatator413_interpret(jo_input, cfg, NULL, NULL, NULL, NULL);
+        json_object *jo_trace_id;
+        char trace_id[TRACE_ID_REPR_LENGTH + 1] = "";
+        if (test_case(&t, json_object_object_get_ex(json_object_array_get_idx(jo_output, 0), "trace_id", &jo_trace_id), "trace id echoed")) {
+            strncpy(trace_id, json_object_get_string(jo_trace_id), TRACE_ID_REPR_LENGTH);
+            TEST_CASE_EQ_INT64(&t, (int64_t)json_object_get_string_len(jo_trace_id), (int64_t)TRACE_ID_REPR_LENGTH, "trace id length");
+        }
+        json_object_put(jo_input);
+        json_object_put(jo_output);
+
+        // Writes what the tracer holds
+        cfg_destroy(cfg);
+
+        char *text = slurp(trace_file);
+        json_object *jo_line = json_tokener_parse(text);
+        json_object *jo, *jo_spans;
+        test_case(&t, jo_line, "trace is a JSON line: %s", text);
+        test_case(&t, json_object_object_get_ex(jo_line, "trace_id", &jo) && streq(json_object_get_string(jo), trace_id), "trace id matches");
+        if (test_case(&t, json_object_object_get_ex(jo_line, "spans", &jo_spans), "trace has spans")) {
+            char const *expected[][2] = { { "parse", NULL }, { "bcrypt", NULL }, { "evaluate", "stats" }, { "serialize", NULL } };
+            bool found[array_len(expected)] = { 0 };
+            for (size_t i = 0; i < json_object_array_length(jo_spans); ++i) {
+                json_object *jo_span = json_object_array_get_idx(jo_spans, i), *jo_name, *jo_detail;
+                json_object_object_get_ex(jo_span, "name", &jo_name);
+                char const *detail = json_object_object_get_ex(jo_span, "detail", &jo_detail) ? json_object_get_string(jo_detail) : NULL;
+                for (size_t e = 0; e < array_len(expected); ++e) {
+                    found[e] |= streq(json_object_get_string(jo_name), expected[e][0])
+                             && (!expected[e][1] || detail && streq(detail, expected[e][1]));
+                }
+            }
+            for (size_t e = 0; e < array_len(expected); ++e) test_case(&t, found[e], "span %s", expected[e][0]);
+        }
+        json_object_put(jo_line);
+        free(text);
+        unlink(trace_file);
+        unlink(cfg_file);
+    }
+
+    return t;
+}
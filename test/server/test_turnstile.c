@@ -0,0 +1,31 @@
+/// @file
+/// @author Raphaël
+/// @brief Testing - Turnstile unit tests
+/// @date 18/10/2026
+
+#include "stb_ds.h"
+#include "tchatator413/turnstile.h"
+#include "tests.h"
+
+struct test test_turnstile(void) {
+    struct test t = test_start("turnstile");
+
+    cfg_t *cfg = cfg_defaults();
+    turnstile_t turnstile = { 0 };
+    in_addr_t const a = 0x0100007f, b = 0x0200007f;
+
+    int n_passed = 0;
+    time_t next_request_at = 0;
+    while (!(next_request_at = turnstile_rate_limit(cfg, &turnstile, a)) && n_passed <= cfg_rate_limit_m(cfg)) ++n_passed;
+    TEST_CASE_EQ_INT(&t, n_passed, cfg_rate_limit_m(cfg) - 1, "requests passed in a minute");
+    test_case(&t, next_request_at > time(NULL), "next request within a minute");
+    test_case(&t, turnstile_rate_limit(cfg, &turnstile, a), "still blocked");
+    test_case(&t, !turnstile_rate_limit(cfg, &turnstile, b), "other IPs pass");
+    TEST_CASE_EQ_INT64(&t, (int64_t)hmlen(turnstile.entries), (int64_t)2, "one entry per IP");
+
+    turnstile_destroy(&turnstile);
+    test_case(&t, !turnstile.entries, "destroyed");
+    cfg_destroy(cfg);
+
+    return t;
+}
@@ -0,0 +1,69 @@
+/// @file
+/// @author Raphaël
+/// @brief Testing - User key cache unit tests
+/// @date 18/10/2026
+
+#include "tchatator413/errstatus.h"
+#include "tchatator413/user_key_cache.h"
+#include "tests.h"
+
+struct test test_user_key_cache(void) {
+    struct test t = test_start("user_key_cache");
+
+    serial_t user_id;
+
+    test_case(&t, user_key_cache_init(0, 60, 10) == NULL, "capacity 0 disables the cache");
+    test_case(&t, !user_key_cache_get(NULL, user_key_name, "member1", 0, &user_id), "disabled cache always misses");
+    user_key_cache_put(NULL, user_key_name, "member1", 0, 1003); // no-op
+
+    user_key_cache_t *cache = user_key_cache_init(16, 60, 10);
+
+    test_case(&t, !user_key_cache_get(cache, user_key_name, "member1", 0, &user_id), "empty cache misses");
+
+    user_key_cache_put(cache, user_key_name, "member1", 0, 1003);
+    user_id = 0;
+    test_case(&t, user_key_cache_get(cache, user_key_name, "member1", 59, &user_id), "hit before expiry");
+    TEST_CASE_EQ_INT(&t, user_id, 1003, );
+    test_case(&t, !user_key_cache_get(cache, user_key_email, "member1", 59, &user_id), "kinds don't collide");
+    test_case(&t, !user_key_cache_get(cache, user_key_name, "member1", 60, &user_id), "miss on expiry");
+    test_case(&t, !user_key_cache_get(cache, user_key_name, "member1", 0, &user_id), "expired entry is dropped");
+
+    // Negative entries
+    user_key_cache_put(cache, user_key_email, "nobody@example.org", 0, errstatus_error);
+    user_id = 0;
+    test_case(&t, user_key_cache_get(cache, user_key_email, "nobody@example.org", 9, &user_id), "negative hit");
+    TEST_CASE_EQ_INT(&t, user_id, errstatus_error, );
+    test_case(&t, !user_key_cache_get(cache, user_key_email, "nobody@example.org", 10, &user_id), "negative entries expire sooner");
+
+    // Errors are not cached
+    user_key_cache_put(cache, user_key_name, "pro1 corp", 0, errstatus_handled);
+    test_case(&t, !user_key_cache_get(cache, user_key_name, "pro1 corp", 0, &user_id), "errstatus_handled isn't cached");
+
+    // Invalidation
+    user_key_cache_put(cache, user_key_name, "pro1 corp", 0, 1001);
+    user_key_cache_put(cache, user_key_email, "pro1@example.org", 0, 1001);
+    user_key_cache_put(cache, user_key_name, "pro2 inc", 0, 1002);
+    user_key_cache_invalidate_user(cache, 1001);
+    test_case(&t, !user_key_cache_get(cache, user_key_name, "pro1 corp", 0, &user_id), "invalidated by user");
+    test_case(&t, !user_key_cache_get(cache, user_key_email, "pro1@example.org", 0, &user_id), "invalidated by user");
+    test_case(&t, user_key_cache_get(cache, user_key_name, "pro2 inc", 0, &user_id), "other users are kept");
+    user_key_cache_put(cache, user_key_name, "pro3 ltd", 0, errstatus_error);
+    user_key_cache_invalidate_user(cache, errstatus_error);
+    test_case(&t, !user_key_cache_get(cache, user_key_name, "pro3 ltd", 0, &user_id), "negative entries invalidated");
+    test_case(&t, user_key_cache_get(cache, user_key_name, "pro2 inc", 0, &user_id), "positive entries are kept");
+
+    user_key_cache_clear(cache);
+    test_case(&t, !user_key_cache_get(cache, user_key_name, "pro2 inc", 0, &user_id), "cleared");
+
+    // Bounded: filling far beyond capacity keeps working
+    char key[16];
+    for (int i = 0; i < 1000; ++i) {
+        snprintf(key, sizeof key, "user%d", i);
+        user_key_cache_put(cache, user_key_name, key, 0, i + 1);
+    }
+    test_case(&t, user_key_cache_get(cache, user_key_name, "user999", 0, &user_id) && user_id == 1000, "last put is always a hit");
+
+    user_key_cache_destroy(cache);
+
+    return t;
+}
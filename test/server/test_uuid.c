@@ -9,6 +9,106 @@
 #include "tests.h"
 #include "util.h"
 
+/// @brief A small deterministic pseudo-random generator.
+static inline uint64_t xorshift64(uint64_t *p_state) {
+    *p_state ^= *p_state << 13;
+    *p_state ^= *p_state >> 7;
+    *p_state ^= *p_state << 17;
+    return *p_state;
+}
+
+static uuid4_t random_uuid(uint64_t *p_state) {
+    uuid4_t uuid;
+    uint64_t const a = xorshift64(p_state), b = xorshift64(p_state);
+    memcpy(uuid.data, &a, sizeof a);
+    memcpy(uuid.data + sizeof a, &b, sizeof b);
+    return uuid;
+}
+
+static bool parse_with(uuid4_impl_t impl, uuid4_t *out_uuid, char const *repr) {
+    uuid4_impl_select(impl);
+    return uuid4_parse(out_uuid, repr);
+}
+
+static void repr_with(uuid4_impl_t impl, uuid4_t uuid, char repr[static const UUID4_REPR_LENGTH]) {
+    uuid4_impl_select(impl);
+    uuid4_repr(uuid, repr);
+}
+
+/// @brief Check an implementation against the scalar one.
+static void test_impl(struct test *p_test, uuid4_impl_t impl) {
+    char const *const name = uuid4_impl_name(impl);
+    // Exactly the size of a representation, so reading past it can be caught by memory checkers.
+    char *const repr = malloc(UUID4_REPR_LENGTH);
+    if (!repr) errno_exit("malloc");
+
+    // Parsing: every byte value at every position
+    {
+        static char const base[] = "f81d4fae-7dec-11d0-a765-00a0c91e6bf6";
+        int n_mismatches = 0, first_pos = -1, first_c = -1;
+        for (int pos = 0; pos < UUID4_REPR_LENGTH; ++pos) {
+            for (int c = 0; c < 256; ++c) {
+                memcpy(repr, base, UUID4_REPR_LENGTH);
+                repr[pos] = (char)c;
+                uuid4_t expected = { 0 }, actual = { 0 };
+                bool const expected_ok = parse_with(uuid4_impl_scalar, &expected, repr);
+                bool const actual_ok = parse_with(impl, &actual, repr);
+                if (expected_ok != actual_ok || expected_ok && !uuid4_eq(expected, actual)) {
+                    if (!n_mismatches++) first_pos = pos, first_c = c;
+                }
+            }
+        }
+        test_case(p_test, !n_mismatches, "%s: parse agrees with scalar (%d mismatches, first at %d = 0x%02x)", name, n_mismatches, first_pos, first_c);
+    }
+
+    // Formatting: every byte value at every position, then random UUIDs, round-tripped
+    {
+        uint64_t state = 0x2545f4914f6cdd1d;
+        int n_mismatches = 0;
+        for (int pos = 0; pos < (int)sizeof(uuid4_t); ++pos) {
+            for (int c = 0; c < 256; ++c) {
+                uuid4_t uuid = random_uuid(&state);
+                uuid.data[pos] = (uint8_t)c;
+                char expected[UUID4_REPR_LENGTH];
+                repr_with(uuid4_impl_scalar, uuid, expected);
+                repr_with(impl, uuid, repr);
+                n_mismatches += memcmp(expected, repr, UUID4_REPR_LENGTH) != 0;
+            }
+        }
+        for (int i = 0; i < 4096; ++i) {
+            uuid4_t const uuid = random_uuid(&state);
+            uuid4_t rt;
+            repr_with(impl, uuid, repr);
+            n_mismatches += !parse_with(impl, &rt, repr) || !uuid4_eq(uuid, rt);
+        }
+        test_case(p_test, !n_mismatches, "%s: repr agrees with scalar (%d mismatches)", name, n_mismatches);
+    }
+
+    // Batches
+    {
+        enum { N = 64 };
+        uint64_t state = 42;
+        uuid4_t uuids[N], parsed[N];
+        char reprs[N][UUID4_REPR_LENGTH];
+        for (int i = 0; i < N; ++i) uuids[i] = random_uuid(&state);
+
+        uuid4_impl_select(impl);
+        uuid4_repr_batch(N, uuids, reprs);
+        bool ok = uuid4_parse_batch(N, parsed, (char const(*)[UUID4_REPR_LENGTH])reprs) == N;
+        for (int i = 0; i < N; ++i) {
+            repr_with(uuid4_impl_scalar, uuids[i], repr);
+            ok &= memcmp(repr, reprs[i], UUID4_REPR_LENGTH) == 0 && uuid4_eq(uuids[i], parsed[i]);
+        }
+        test_case(p_test, ok, "%s: batch round trip", name);
+
+        reprs[40][35] = 'g';
+        uuid4_impl_select(impl);
+        TEST_CASE_COUNT(p_test, (int)uuid4_parse_batch(N, parsed, (char const(*)[UUID4_REPR_LENGTH])reprs), 40, "parsed UUID");
+    }
+
+    free(repr);
+}
+
 struct test test_uuid4(void) {
     struct test p_test = test_start("uuid4");
 
@@ -57,5 +157,13 @@ struct test test_uuid4(void) {
     uuid4_parse(&uuid0_rt, uuids[0]);
     test_case(&p_test, uuid4_eq(uuid0, uuid0_rt), "literal == from repr");
 
+    uuid4_impl_t const initial = uuid4_impl_current();
+    test_case(&p_test, uuid4_impl_supported(initial), "default implementation %s is supported", uuid4_impl_name(initial));
+    test_case(&p_test, uuid4_impl_select(uuid4_impl_scalar) && uuid4_impl_current() == uuid4_impl_scalar, "scalar is always supported");
+    for (uuid4_impl_t impl = uuid4_impl_scalar + 1; impl < uuid4_impl_count; ++impl) {
+        if (uuid4_impl_supported(impl)) test_impl(&p_test, impl);
+    }
+    uuid4_impl_select(initial);
+
     return p_test;
 }
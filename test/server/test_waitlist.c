@@ -0,0 +1,66 @@
+/// @file
+/// @author Raphaël
+/// @brief Testing - Wait list unit tests
+/// @date 18/10/2026
+
+#include "tchatator413/waitlist.h"
+#include "tests.h"
+
+struct test test_waitlist(void) {
+    struct test t = test_start("waitlist");
+
+    test_case(&t, !waitlist_init(0), "0 waiters disables");
+    test_case(&t, !waitlist_park(NULL, 3, 1, 0), "disabled never parks");
+
+    waitlist_t *waitlist = waitlist_init(4);
+    int fd;
+    bool woken;
+    TEST_CASE_EQ_INT64(&t, (int64_t)waitlist_next_due(waitlist), (int64_t)UINT64_MAX, "nothing due when empty");
+    test_case(&t, !waitlist_pop(waitlist, UINT64_MAX, &fd, &woken), "empty pops nothing");
+
+    test_case(&t, waitlist_park(waitlist, 10, 1, 100), "park");
+    test_case(&t, waitlist_park(waitlist, 11, 2, 200), "park");
+    test_case(&t, waitlist_park(waitlist, 12, 1, 300), "park twice for a user");
+    test_case(&t, waitlist_park(waitlist, 13, 3, 150), "park out of order");
+    test_case(&t, !waitlist_park(waitlist, 14, 4, 400), "full");
+    TEST_CASE_EQ_INT64(&t, (int64_t)waitlist_len(waitlist), (int64_t)4, );
+    TEST_CASE_EQ_INT64(&t, (int64_t)waitlist_next_due(waitlist), (int64_t)100, "earliest deadline");
+    test_case(&t, !waitlist_pop(waitlist, 99, &fd, &woken), "not due yet");
+
+    // Both connections of user 1 are woken
+    waitlist_notify(waitlist, 1);
+    waitlist_notify(waitlist, 5);
+    TEST_CASE_EQ_INT64(&t, (int64_t)waitlist_next_due(waitlist), (int64_t)0, "woken are due now");
+    test_case(&t, waitlist_pop(waitlist, 0, &fd, &woken) && fd == 12 && woken, "woken first");
+    test_case(&t, waitlist_pop(waitlist, 0, &fd, &woken) && fd == 10 && woken, "then the other");
+    test_case(&t, !waitlist_pop(waitlist, 0, &fd, &woken), "no more woken");
+    waitlist_notify(waitlist, 1);
+    test_case(&t, !waitlist_pop(waitlist, 0, &fd, &woken), "notified once");
+
+    // Timeouts
+    TEST_CASE_EQ_INT64(&t, (int64_t)waitlist_next_due(waitlist), (int64_t)150, "next deadline");
+    test_case(&t, waitlist_pop(waitlist, 1000, &fd, &woken) && fd == 13 && !woken, "timed out by deadline");
+
+    // Hanging up
+    test_case(&t, waitlist_remove(waitlist, 11), "remove");
+    test_case(&t, !waitlist_remove(waitlist, 11), "remove twice");
+    waitlist_notify(waitlist, 2);
+    test_case(&t, !waitlist_pop(waitlist, UINT64_MAX, &fd, &woken), "removed isn't woken");
+    TEST_CASE_EQ_INT64(&t, (int64_t)waitlist_len(waitlist), (int64_t)0, );
+
+    // Removing from the middle of the list of a user
+    for (int i = 0; i < 3; ++i) waitlist_park(waitlist, 20 + i, 7, 500);
+    waitlist_remove(waitlist, 21);
+    waitlist_notify(waitlist, 7);
+    test_case(&t, waitlist_pop(waitlist, 0, &fd, &woken) && fd == 22 && woken, "woken after a removal");
+    test_case(&t, waitlist_pop(waitlist, 0, &fd, &woken) && fd == 20 && woken, "woken after a removal");
+    test_case(&t, !waitlist_pop(waitlist, UINT64_MAX, &fd, &woken), "all popped");
+
+    // Destroying with connections still parked
+    waitlist_park(waitlist, 30, 8, 600);
+    waitlist_notify(waitlist, 8);
+    waitlist_park(waitlist, 31, 8, 600);
+    waitlist_destroy(waitlist);
+
+    return t;
+}
@@ -17,12 +17,28 @@ test_t *base_on_action(void *test) {
     return p_test;
 }
 
-test_t *base_on_response(void *test) {
+test_t *base_on_response(void *test, response_t const *p_response) {
     test_t *p_test = (test_t *)test;
     ++p_test->n_responses;
+    test_case_response_write(&p_test->t, p_response);
+    if (test_case(&p_test->t, (size_t)p_test->n_responses <= p_test->n_round_trip_budgets, "action %d has a round-trip budget", p_test->n_responses)) {
+        unsigned const budget = p_test->round_trip_budgets[p_test->n_responses - 1];
+        test_case(&p_test->t, p_response->n_round_trips <= budget, "action %d took %u database round-trips, budget is %u",
+            p_test->n_responses, p_response->n_round_trips, budget);
+    }
     return p_test;
 }
 
+bool test_case_response_write(struct test *t, response_t const *p_response) {
+    json_object *jo = response_to_json(p_response);
+    json_writer_t writer = JSON_WRITER_INIT;
+    response_write(&writer, p_response);
+    bool ok = test_case(t, streq(json_writer_str(&writer), min_json(jo)), "written:    %s\nserialized: %s", json_writer_str(&writer), min_json(jo));
+    json_writer_destroy(&writer);
+    json_object_put(jo);
+    return ok;
+}
+
 void test_case_n_actions(test_t *p_test, int expected) {
     TEST_CASE_COUNT(&p_test->t, p_test->n_actions, expected, "action");
     TEST_CASE_COUNT(&p_test->t, p_test->n_responses, expected, "response");
@@ -7,6 +7,7 @@
 #define TESTS_H
 
 #include "stb_test.h"
+#include "tchatator413/action.h"
 #include "tchatator413/cfg.h"
 #include "tchatator413/db.h"
 #include "tchatator413/json-helpers.h"
@@ -17,6 +18,23 @@
 
 struct test test_uuid4(void);
 struct test test_memlst(void);
+struct test test_user_key_cache(void);
+struct test test_inbox_cache(void);
+struct test test_api_key_filter(void);
+struct test test_block_index(void);
+struct test test_json_cache(void);
+struct test test_json_writer(void);
+struct test test_logger(void);
+struct test test_evlog(void);
+struct test test_metrics(void);
+struct test test_metrics_http(void);
+struct test test_turnstile(void);
+struct test test_trace(void);
+struct test test_capture(void);
+struct test test_profiler(void);
+struct test test_waitlist(void);
+struct test test_action_schema(void);
+struct test test_action_fast(void);
 
 void observe_put_role(void);
 
@@ -37,28 +55,35 @@ void observe_put_role(void);
 #pragma GCC diagnostic ignored "-Wcomment"
 
 /// @brief X-macro that expands to the list of Tchattator413 tests.
-#define X_TESTS(X)                        \
-    /* Integration tests (> 1 action) */  \
-    X(member1_send_pro1_inbox_member1_rm) \
-    /* Unit tests */                      \
-    X(db_get_user)                        \
-    X(db_verify_user_constr)              \
-    X(admin_whois_imax)                   \
-    /*X(admin_whois_neg1)*/               \
-    /*X(admin_whois_pro1)*/               \
-    X(empty)                              \
-    /*X(invalid_whois_pro1)*/             \
-    /*X(malformed)*/                      \
-    /*X(member1_send)*/                   \
-    /*X(member1_whois_member1_by_email)*/ \
-    /*X(member1_whois_member1_by_name)*/  \
-    /*X(member1_whois_member1)*/          \
-    /*X(member1_whois_pro1_by_email)*/    \
-    /*X(member1_whois_pro1_by_name)*/     \
-    /*X(member1_whois_pro1)*/             \
-    /*X(pro1_inbox)*/                     \
-    /*X(pro1_send)*/                      \
-    X(zero)                               \
+#define X_TESTS(X)                          \
+    /* Integration tests (> 1 action) */    \
+    X(member1_send_pro1_inbox_member1_rm)   \
+    X(pro1_block_member1_send_unblock)      \
+    X(member1_send_pro1_motd_motd)          \
+    X(pro1_inbox_member1_send_pro1_inbox)   \
+    X(member1_send_member1_edit_pro1_inbox) \
+    X(pro1_wait_member1_send_pro1_wait)     \
+    /* Unit tests */                        \
+    X(db_consume_notifications)             \
+    X(db_get_user)                          \
+    X(db_verify_user_constr)                \
+    X(admin_whois_imax)                     \
+    /*X(admin_whois_neg1)*/                 \
+    /*X(admin_whois_pro1)*/                 \
+    X(empty)                                \
+    /*X(invalid_whois_pro1)*/               \
+    /*X(malformed)*/                        \
+    /*X(member1_send)*/                     \
+    /*X(member1_whois_member1_by_email)*/   \
+    /*X(member1_whois_member1_by_name)*/    \
+    /*X(member1_whois_member1)*/            \
+    /*X(member1_whois_pro1_by_email)*/      \
+    /*X(member1_whois_pro1_by_name)*/       \
+    /*X(member1_whois_pro1)*/               \
+    /*X(pro1_inbox)*/                       \
+    /*X(pro1_send)*/                        \
+    X(pro1_stats)                           \
+    X(zero)                                 \
     //
 #pragma GCC diagnostic pop
 
@@ -70,12 +95,18 @@ void observe_put_role(void);
 X_TESTS(DECLARE_TEST)
 #undef DECLARE_TEST
 
-#define TEST_INIT(name) {        \
-    .t = test_start(STR(name)),  \
-    .p_mem = i_p_mem,            \
-    .cfg = i_cfg,                \
-    .db = i_db,                  \
-    .root_constr = i_root_constr \
+/// @brief Expands to the initializer of a @ref test_t.
+/// @param name The unquoted name of the test.
+/// @param ... The round-trip budget of each action of the test, in order, for cold caches. None for tests that evaluate no action.
+/// @remark Keep budgets tight: an action that goes over fails the test, which is how N+1 patterns get caught.
+#define TEST_INIT(name, ...) {                                                                   \
+    .t = test_start(STR(name)),                                                                  \
+    .p_mem = i_p_mem,                                                                            \
+    .cfg = i_cfg,                                                                                \
+    .db = i_db,                                                                                  \
+    .root_constr = i_root_constr,                                                                \
+    .round_trip_budgets = (unsigned const[]) { __VA_ARGS__ __VA_OPT__(, ) 0 },                   \
+    .n_round_trip_budgets = array_len(((unsigned const[]) { __VA_ARGS__ __VA_OPT__(, ) 0 })) - 1 \
 };
 
 #define OUT_JSON(NAME, suffix) "test/server/json/" STR(NAME) "/out" suffix ".json"
@@ -134,6 +165,9 @@ typedef struct {
     cfg_t *cfg;
     db_t *db;
     constr_t root_constr;
+    /// @brief The most database round-trips each action may take, from its parsing to its response, in order.
+    unsigned const *round_trip_budgets;
+    size_t n_round_trip_budgets;
 } test_t;
 _Static_assert(offsetof(test_t, t) == 0, "backing test must be at start of struct for implicit base type punning");
 
@@ -151,8 +185,11 @@ bool test_output_json_file(test_t *test, json_object *jo_output, char const *exp
 
 /// @brief Base on_action event handler.
 test_t *base_on_action(void *test);
-/// @brief Base on_response event handler.
-test_t *base_on_response(void *test);
+/// @brief Base on_response event handler. Checks that both response writers agree, and that the action kept within its round-trip budget.
+test_t *base_on_response(void *test, response_t const *p_response);
+
+/// @brief Test that the streaming writer produces the same bytes as json-c for a response.
+bool test_case_response_write(struct test *t, response_t const *p_response);
 
 /// @brief Actions count test case
 void test_case_n_actions(test_t *test, int expected);
@@ -16,7 +16,7 @@ static void on_action(action_t const *action, void *t) {
 }
 
 static void on_response(response_t const *response, void *t) {
-    base_on_response(t);
+    base_on_response(t, response);
     test_case(t, !response->has_next_page, "");
     if (!TEST_CASE_EQ_INT(t, response->type, action_type_error, )) return;
     if (!TEST_CASE_EQ_INT(t, response->body.error.type, action_error_type_other, )) return;
@@ -24,7 +24,7 @@ static void on_response(response_t const *response, void *t) {
 }
 
 TEST_SIGNATURE(NAME) {
-    test_t tst = TEST_INIT(NAME);
+    test_t tst = TEST_INIT(NAME, 1);
     
     char uuid_repr[UUID4_REPR_LENGTH];
     json_object *jo_input = memlst_add(tst.p_mem, dtor_json_object,
@@ -0,0 +1,59 @@
+/// @file
+/// @author Raphaël
+/// @brief Tchatator413 test - db_consume_notifications waking a wait list
+/// @date 18/10/2026
+
+#include "../tests.h"
+#include "tchatator413/db.h"
+#include "tchatator413/waitlist.h"
+
+#define NAME db_consume_notifications
+
+#define CHANNEL_MSG "tchatator_msg"
+
+static void on_new_msg(serial_t recipient_id, void *waitlist) {
+    waitlist_notify(waitlist, recipient_id);
+}
+
+/// @brief Send a message notification and consume it.
+static void notify_msg(test_t *p_tst, char const *payload) {
+    if (!test_case(&p_tst->t, errstatus_ok == db_notify(p_tst->db, p_tst->cfg, CHANNEL_MSG, payload), "notify %s", payload)) return;
+    db_consume_notifications(p_tst->db, p_tst->cfg);
+}
+
+TEST_SIGNATURE(NAME) {
+    test_t tst = TEST_INIT(NAME);
+
+    waitlist_t *waitlist = waitlist_init(2);
+    db_on_new_msg(tst.db, on_new_msg, waitlist);
+    waitlist_park(waitlist, 10, USER_ID_PRO1, UINT64_MAX);
+    waitlist_park(waitlist, 11, USER_ID_MEMBER1, UINT64_MAX);
+
+    int fd;
+    bool woken;
+    char payload[32];
+
+    // Changes to existing messages wake no one
+    snprintf(payload, sizeof payload, "%d update", USER_ID_PRO1);
+    notify_msg(&tst, payload);
+    snprintf(payload, sizeof payload, "%d delete", USER_ID_PRO1);
+    notify_msg(&tst, payload);
+    test_case(&tst.t, !waitlist_pop(waitlist, 0, &fd, &woken), "a change wakes no one");
+
+    // Invalid payloads are ignored
+    notify_msg(&tst, "pro1 insert");
+    snprintf(payload, sizeof payload, "%d", USER_ID_PRO1);
+    notify_msg(&tst, payload);
+    test_case(&tst.t, !waitlist_pop(waitlist, 0, &fd, &woken), "an invalid payload wakes no one");
+
+    // A new message wakes its recipient only
+    snprintf(payload, sizeof payload, "%d insert", USER_ID_PRO1);
+    notify_msg(&tst, payload);
+    test_case(&tst.t, waitlist_pop(waitlist, 0, &fd, &woken) && fd == 10 && woken, "the recipient is woken");
+    test_case(&tst.t, !waitlist_pop(waitlist, 0, &fd, &woken), "no one else is woken");
+
+    db_on_new_msg(tst.db, NULL, NULL);
+    waitlist_destroy(waitlist);
+
+    return tst.t;
+}
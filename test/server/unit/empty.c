@@ -16,8 +16,7 @@ static void on_action(action_t const *action, void *t) {
 }
 
 static void on_response(response_t const *response, void *t) {
-    base_on_response(t);
-    (void)response;
+    base_on_response(t, response);
 }
 
 TEST_SIGNATURE(NAME) {
@@ -0,0 +1,36 @@
+/// @file
+/// @author Raphaël
+/// @brief Tchatator413 test - stats by pro 1
+/// @date 18/10/2026
+
+#include "../tests.h"
+#include "tchatator413/tchatator413.h"
+
+#define NAME pro1_stats
+
+static void on_action(action_t const *action, void *t) {
+    base_on_action(t);
+    if (!test_case(t, action->type == action_type_stats, "type == %d", action->type)) return;
+    TEST_CASE_EQ_UUID(t, action->with.stats.constr.api_key, API_KEY_PRO1_UUID, );
+}
+
+static void on_response(response_t const *response, void *t) {
+    base_on_response(t, response);
+    if (!TEST_CASE_EQ_INT(t, response->type, action_type_error, )) return;
+    if (!TEST_CASE_EQ_INT(t, response->body.error.type, action_error_type_other, )) return;
+    TEST_CASE_EQ_INT(t, response->body.error.info.other.status, status_forbidden, );
+}
+
+TEST_SIGNATURE(NAME) {
+    test_t tst = TEST_INIT(NAME, 2);
+
+    json_object *jo_input = memlst_add(tst.p_mem, dtor_json_object, load_json(IN_JSON(NAME, )));
+
+    json_object *jo_output = memlst_add(tst.p_mem, dtor_json_object,
+        tchatator413_interpret(jo_input, tst.cfg, tst.db, on_action, on_response, &tst));
+    test_case_n_actions(&tst, 1);
+
+    test_output_json_file(&tst, jo_output, OUT_JSON(NAME, ));
+
+    return tst.t;
+}
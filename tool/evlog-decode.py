@@ -0,0 +1,106 @@
+#!/usr/bin/env python3
+
+# Decode a binary event log written by the server (config key event_log_file) to text or JSON lines.
+# The log describes its own events in session headers, see lib/own/tchatator413/evlog.h.
+#
+# evlog-decode.py events.bin
+# evlog-decode.py --json events.bin | jq 'select(.event == "db_query") | .duration_ns'
+
+import argparse as ap
+import datetime as dt
+import ipaddress
+import json
+import signal
+import struct
+import sys
+
+MAGIC = b'\xffT413EV'
+FORMAT_VERSION = 1
+RECORD_HEADER = struct.Struct('<BHq')
+
+
+class Reader:
+    def __init__(self, data):
+        self.data = data
+        self.pos = 0
+
+    def take(self, n):
+        if self.pos + n > len(self.data):
+            raise EOFError
+        b = self.data[self.pos:self.pos + n]
+        self.pos += n
+        return b
+
+    def unpack(self, fmt):
+        s = struct.Struct('<' + fmt)
+        return s.unpack(self.take(s.size))[0]
+
+    def str(self):
+        return self.take(self.unpack('B')).decode(errors='replace')
+
+
+def read_header(r):
+    if r.take(len(MAGIC)) != MAGIC:
+        raise ValueError(f'bad session header at offset {r.pos - len(MAGIC)}')
+    version = r.unpack('B')
+    if version != FORMAT_VERSION:
+        raise ValueError(f'unsupported format version {version}')
+    events = []
+    for _ in range(r.unpack('B')):
+        name = r.str()
+        fields = [(chr(r.unpack('B')), r.str()) for _ in range(r.unpack('B'))]
+        events.append((name, fields))
+    return events
+
+
+def read_field(r, code):
+    if code == 's':
+        return r.str()
+    if code == '4':
+        return str(ipaddress.IPv4Address(r.take(4)))
+    return r.unpack(code)
+
+
+def records(data):
+    r = Reader(data)
+    events = None
+    while r.pos < len(data):
+        if data[r.pos] == MAGIC[0]:
+            events = read_header(r)
+            continue
+        if events is None:
+            raise ValueError('missing session header')
+        event_id, length, ts_ns = RECORD_HEADER.unpack(r.take(RECORD_HEADER.size))
+        payload = Reader(r.take(length))
+        if event_id >= len(events):
+            yield ts_ns, f'unknown_{event_id}', {}
+            continue
+        name, fields = events[event_id]
+        yield ts_ns, name, {field: read_field(payload, code) for code, field in fields}
+
+
+def main():
+    parser = ap.ArgumentParser('evlog-decode')
+    parser.add_argument('file', nargs='?', type=ap.FileType('rb'), default=sys.stdin.buffer)
+    parser.add_argument('--json', action='store_true', help='output one JSON object per line')
+    a = parser.parse_args()
+    signal.signal(signal.SIGPIPE, signal.SIG_DFL)
+
+    try:
+        for ts_ns, name, fields in records(a.file.read()):
+            if a.json:
+                print(json.dumps({'ts_ns': ts_ns, 'event': name, **fields}, ensure_ascii=False))
+            else:
+                ts = dt.datetime.fromtimestamp(ts_ns // 1_000_000_000).strftime('%F %H:%M:%S')
+                print(f'{ts}.{ts_ns % 1_000_000_000:09d} {name}', *(f'{k}={v}' for k, v in fields.items()))
+    except EOFError:
+        print('evlog-decode: truncated record at end of file', file=sys.stderr)
+        return 1
+    except ValueError as e:
+        print(f'evlog-decode: {e}', file=sys.stderr)
+        return 1
+    return 0
+
+
+if __name__ == '__main__':
+    sys.exit(main())